@@ -0,0 +1,777 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2023 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next paragraph) shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * This signing plugin shares a pool of worker threads between all sessions and signs hashes
+ * earliest-deadline-first.
+ *
+ * Every hash to sign is tagged with a deadline; the time the next hash of the same session is
+ * expected. The time between hashes is estimated from the observed cadence of the session, which
+ * is the GOP length unless intermediate SEIs are used. Hence, a high frame rate or short GOP stream
+ * gets a close deadline, whereas a long GOP stream can wait. When the signing capacity is limited,
+ * the hashes with the closest deadlines are signed first. Signatures completed after their
+ * deadline are counted per session and can be read through sv_interface_get_deadline_stats().
+ *
+ * Each session hands over hashes through a ring of |MAX_HASHES_IN_FLIGHT| slots, like the threaded
+ * plugin. Since slots may be signed out of order by different workers, every slot has its own
+ * |is_signed| flag and signatures are pulled in order. Every completed signature is signaled on an
+ * eventfd, which can be polled by the user through sv_interface_get_signature_fd().
+ *
+ * If all slots of a session are in use by the time of a new request, that new hash is not signed.
+ */
+
+#define _GNU_SOURCE  // pthread_setaffinity_np, pthread_setname_np, CPU_SET
+#include <assert.h>
+#include <pthread.h>  // pthread_*
+#include <sched.h>  // SCHED_*, cpu_set_t, sched_get_priority_min, sched_get_priority_max
+#include <stdatomic.h>  // atomic_bool, atomic_uint_fast64_t
+#include <stdlib.h>  // calloc, realloc, free
+#include <string.h>  // memcpy, strlen
+#include <sys/eventfd.h>  // eventfd, eventfd_read, eventfd_write
+#include <sys/resource.h>  // setpriority, PRIO_PROCESS
+#include <time.h>  // clock_gettime
+#include <unistd.h>  // close, sysconf
+
+#include "includes/signed_video_interfaces.h"
+#include "includes/signed_video_openssl.h"
+#include "../plugin_helpers.h"
+
+// The number of hashes a session can hand over before their signatures have been pulled. The
+// library never has more than MAX_NALUS_TO_PREPEND (5) SEIs waiting for a signature.
+#define MAX_HASHES_IN_FLIGHT 8
+// The maximum number of worker threads shared by all sessions. The number of online CPUs is used
+// if less.
+#define MAX_WORKER_THREADS 4
+// The deadline used until the cadence of a session is known.
+#define DEFAULT_DEADLINE_US 1000000
+// The default name of the worker threads.
+#define WORKER_THREAD_NAME "sv-signing-edf"
+// Thread names are limited to 16 bytes including the terminating null byte.
+#define MAX_THREAD_NAME_LENGTH 15
+
+typedef struct _sv_deadline_plugin sv_deadline_plugin_t;
+
+/* A slot in the ring of a session. The |hash| and |deadline_us| are written by the encoder thread
+ * before the slot is handed over, and the |signature| and |status| are written by a worker before
+ * |is_signed| is set. */
+typedef struct {
+  uint8_t *hash;
+  uint8_t *signature;
+  size_t signature_size;
+  SignedVideoReturnCode status;
+  uint64_t deadline_us;
+  atomic_bool is_signed;
+} signing_slot_t;
+
+/* A hash waiting in the queue of the scheduler. */
+typedef struct {
+  sv_deadline_plugin_t *session;
+  signing_slot_t *slot;
+  uint64_t deadline_us;
+  uint64_t seq;  // Order of arrival. Requests with the same deadline are served in this order.
+} signing_request_t;
+
+/* A worker thread of the pool. The counters are only written by the worker itself. */
+typedef struct {
+  pthread_t thread;
+  atomic_uint tid;  // Thread id needed to set the nice value. Zero until the worker has started.
+  atomic_uint_fast64_t busy_time_us;
+  atomic_uint_fast64_t num_signed_hashes;
+} signing_worker_t;
+
+/* The scheduler shared by all sessions. All members are protected by |lock|. The workers are
+ * started by the first session and stopped by the last one, which is serialized by
+ * |lifecycle_lock|. */
+typedef struct {
+  pthread_mutex_t lifecycle_lock;
+  pthread_mutex_t lock;
+  pthread_cond_t has_work;  // Signaled when a request is queued or the workers should stop.
+  pthread_cond_t request_done;  // Broadcasted when the last request of a session is done.
+  // Binary min-heap of requests ordered by deadline.
+  signing_request_t *queue;
+  size_t queue_size;
+  size_t queue_capacity;
+  uint64_t next_seq;
+  bool is_running;
+  int num_sessions;
+  signing_worker_t workers[MAX_WORKER_THREADS];
+  int num_workers;
+  uint64_t start_time_us;
+} signing_scheduler_t;
+
+/* Plugin handle of a session.
+ *
+ * The ring is tracked by two ever increasing counters, which are only accessed by the encoder
+ * thread:
+ *   |num_requested| Number of hashes handed over to the scheduler.
+ *   |num_pulled| Number of signatures pulled.
+ * A slot is owned by the scheduler from being handed over until it is signed. */
+struct _sv_deadline_plugin {
+  signing_slot_t slots[MAX_HASHES_IN_FLIGHT];
+  unsigned num_requested;
+  unsigned num_pulled;
+  int nbr_of_unsigned_hashes;  // Tracks hashes that could not be signed.
+  size_t hash_size;
+  // Readable when a slot has been signed. Cleared by the encoder thread when there are no more
+  // signatures to pull.
+  int signature_fd;
+
+  // Number of requests queued or being signed. Protected by the lock of the scheduler.
+  int num_in_progress;
+
+  // Cadence of hashes to sign, only accessed by the encoder thread.
+  uint64_t last_request_us;
+  uint64_t cadence_us;  // Smoothed time between two hashes. Zero until known.
+
+  // Deadline statistics, only written by the workers.
+  atomic_uint_fast64_t num_signed_hashes;
+  atomic_uint_fast64_t num_missed_deadlines;
+  atomic_uint_fast64_t max_lateness_us;
+
+  // A local copy of the signature_info is used for signing. Only the |private_key| and the |algo|
+  // are used. It is created before the first hash is handed over and read-only after that.
+  signature_info_t *signature_info;
+};
+
+static signing_scheduler_t scheduler = {
+    .lifecycle_lock = PTHREAD_MUTEX_INITIALIZER,
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .has_work = PTHREAD_COND_INITIALIZER,
+    .request_done = PTHREAD_COND_INITIALIZER,
+};
+
+/**
+ * Queue helpers. Must be called with the scheduler locked.
+ */
+
+static bool
+request_is_before(const signing_request_t *a, const signing_request_t *b)
+{
+  if (a->deadline_us != b->deadline_us) return a->deadline_us < b->deadline_us;
+  return a->seq < b->seq;
+}
+
+static void
+queue_sift_up(size_t idx)
+{
+  signing_request_t *queue = scheduler.queue;
+  while (idx > 0) {
+    size_t parent = (idx - 1) / 2;
+    if (!request_is_before(&queue[idx], &queue[parent])) break;
+    signing_request_t tmp = queue[parent];
+    queue[parent] = queue[idx];
+    queue[idx] = tmp;
+    idx = parent;
+  }
+}
+
+static void
+queue_sift_down(size_t idx)
+{
+  signing_request_t *queue = scheduler.queue;
+  while (true) {
+    size_t first = idx;
+    size_t left = 2 * idx + 1;
+    size_t right = left + 1;
+    if (left < scheduler.queue_size && request_is_before(&queue[left], &queue[first])) first = left;
+    if (right < scheduler.queue_size && request_is_before(&queue[right], &queue[first])) {
+      first = right;
+    }
+    if (first == idx) break;
+    signing_request_t tmp = queue[first];
+    queue[first] = queue[idx];
+    queue[idx] = tmp;
+    idx = first;
+  }
+}
+
+static bool
+queue_push(sv_deadline_plugin_t *session, signing_slot_t *slot)
+{
+  if (scheduler.queue_size == scheduler.queue_capacity) {
+    size_t new_capacity = scheduler.queue_capacity ? 2 * scheduler.queue_capacity
+                                                   : MAX_HASHES_IN_FLIGHT;
+    signing_request_t *new_queue =
+        realloc(scheduler.queue, new_capacity * sizeof(signing_request_t));
+    if (!new_queue) return false;
+    scheduler.queue = new_queue;
+    scheduler.queue_capacity = new_capacity;
+  }
+  signing_request_t *request = &scheduler.queue[scheduler.queue_size];
+  request->session = session;
+  request->slot = slot;
+  request->deadline_us = slot->deadline_us;
+  request->seq = scheduler.next_seq++;
+  queue_sift_up(scheduler.queue_size++);
+  return true;
+}
+
+static signing_request_t
+queue_pop()
+{
+  assert(scheduler.queue_size > 0);
+  signing_request_t first = scheduler.queue[0];
+  scheduler.queue[0] = scheduler.queue[--scheduler.queue_size];
+  queue_sift_down(0);
+  return first;
+}
+
+/* Removes all queued requests of |session| and returns how many were removed. */
+static int
+queue_remove_session(const sv_deadline_plugin_t *session)
+{
+  size_t kept = 0;
+  for (size_t i = 0; i < scheduler.queue_size; i++) {
+    if (scheduler.queue[i].session != session) scheduler.queue[kept++] = scheduler.queue[i];
+  }
+  int num_removed = (int)(scheduler.queue_size - kept);
+  scheduler.queue_size = kept;
+  // Restore the heap property.
+  for (size_t i = kept / 2; i-- > 0;) {
+    queue_sift_down(i);
+  }
+  return num_removed;
+}
+
+/**
+ * Session helpers.
+ */
+
+/* Frees the memory of all slots. */
+static void
+slots_free(sv_deadline_plugin_t *self)
+{
+  for (int i = 0; i < MAX_HASHES_IN_FLIGHT; i++) {
+    free(self->slots[i].hash);
+    self->slots[i].hash = NULL;
+    openssl_free(self->slots[i].signature);
+    self->slots[i].signature = NULL;
+  }
+}
+
+/* Allocates memory for the |hash| and |signature| of all slots. */
+static bool
+slots_create(sv_deadline_plugin_t *self, const signature_info_t *signature_info)
+{
+  for (int i = 0; i < MAX_HASHES_IN_FLIGHT; i++) {
+    self->slots[i].hash = calloc(1, signature_info->hash_size);
+    self->slots[i].signature = openssl_malloc(signature_info->max_signature_size);
+    if (!self->slots[i].hash || !self->slots[i].signature) {
+      slots_free(self);
+      return false;
+    }
+  }
+  return true;
+}
+
+/* Frees all allocated memory and resets members. Must not be called while there are hashes
+ * handed over to the scheduler. */
+static void
+sv_deadline_plugin_reset(sv_deadline_plugin_t *self)
+{
+  local_signature_info_free(self->signature_info);
+  self->signature_info = NULL;
+  slots_free(self);
+  self->hash_size = 0;
+}
+
+/* Updates the estimated time between two hashes of the session, and returns the deadline of a hash
+ * requested at |now_us|. */
+static uint64_t
+update_cadence_and_get_deadline(sv_deadline_plugin_t *self, uint64_t now_us)
+{
+  if (self->last_request_us > 0) {
+    uint64_t interval_us = now_us - self->last_request_us;
+    // Smooth the estimate to not let one odd GOP length move the deadline too much.
+    self->cadence_us = self->cadence_us ? (3 * self->cadence_us + interval_us) / 4 : interval_us;
+  }
+  self->last_request_us = now_us;
+
+  return now_us + (self->cadence_us ? self->cadence_us : DEFAULT_DEADLINE_US);
+}
+
+/**
+ * Worker threads.
+ */
+
+/* Signs the hash of a request and updates the statistics of the worker and the session. */
+static void
+sign_request(signing_worker_t *worker, const signing_request_t *request)
+{
+  sv_deadline_plugin_t *session = request->session;
+  signing_slot_t *slot = request->slot;
+
+  // Each worker uses its own copy of the |signature_info|, since several slots of the same session
+  // may be signed in parallel.
+  signature_info_t signature_info = *session->signature_info;
+  signature_info.hash = slot->hash;
+  signature_info.signature = slot->signature;
+  signature_info.signature_size = 0;
+
+  uint64_t sign_start_us = get_time_us();
+  slot->status = openssl_sign_hash(&signature_info);
+  slot->signature_size = (slot->status == SV_OK) ? signature_info.signature_size : 0;
+  uint64_t sign_end_us = get_time_us();
+
+  atomic_fetch_add_explicit(
+      &worker->busy_time_us, sign_end_us - sign_start_us, memory_order_relaxed);
+  atomic_fetch_add_explicit(&worker->num_signed_hashes, 1, memory_order_relaxed);
+  atomic_fetch_add_explicit(&session->num_signed_hashes, 1, memory_order_relaxed);
+  if (sign_end_us > request->deadline_us) {
+    uint64_t lateness_us = sign_end_us - request->deadline_us;
+    atomic_fetch_add_explicit(&session->num_missed_deadlines, 1, memory_order_relaxed);
+    uint64_t max_lateness_us =
+        atomic_load_explicit(&session->max_lateness_us, memory_order_relaxed);
+    while (lateness_us > max_lateness_us &&
+        !atomic_compare_exchange_weak(&session->max_lateness_us, &max_lateness_us, lateness_us)) {
+    }
+  }
+
+  // Hand back the slot. Signal after that, so a readable |signature_fd| means that there may be a
+  // signature to pull.
+  atomic_store_explicit(&slot->is_signed, true, memory_order_release);
+  eventfd_write(session->signature_fd, 1);
+}
+
+/* The worker thread signs the request with the earliest deadline as long as there are any, then
+ * sleeps until a new request is queued. */
+static void *
+signing_worker_thread(void *user_data)
+{
+  signing_worker_t *worker = (signing_worker_t *)user_data;
+
+  publish_thread_id(&worker->tid);
+
+  pthread_mutex_lock(&scheduler.lock);
+  while (true) {
+    while (scheduler.is_running && scheduler.queue_size == 0) {
+      pthread_cond_wait(&scheduler.has_work, &scheduler.lock);
+    }
+    if (!scheduler.is_running) break;
+
+    signing_request_t request = queue_pop();
+    pthread_mutex_unlock(&scheduler.lock);
+
+    sign_request(worker, &request);
+
+    pthread_mutex_lock(&scheduler.lock);
+    request.session->num_in_progress--;
+    if (request.session->num_in_progress == 0) pthread_cond_broadcast(&scheduler.request_done);
+  }
+  pthread_mutex_unlock(&scheduler.lock);
+
+  return NULL;
+}
+
+/* Stops and joins all workers. Must be called with |lifecycle_lock| held and no sessions left. */
+static void
+scheduler_stop()
+{
+  pthread_mutex_lock(&scheduler.lock);
+  scheduler.is_running = false;
+  pthread_cond_broadcast(&scheduler.has_work);
+  pthread_mutex_unlock(&scheduler.lock);
+
+  for (int i = 0; i < scheduler.num_workers; i++) {
+    pthread_join(scheduler.workers[i].thread, NULL);
+  }
+  scheduler.num_workers = 0;
+
+  free(scheduler.queue);
+  scheduler.queue = NULL;
+  scheduler.queue_size = 0;
+  scheduler.queue_capacity = 0;
+}
+
+/* Starts the workers. Must be called with |lifecycle_lock| held. Returns false if no worker could
+ * be started. */
+static bool
+scheduler_start()
+{
+  long num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  int num_workers = (num_cpus > 0 && num_cpus < MAX_WORKER_THREADS) ? (int)num_cpus
+                                                                     : MAX_WORKER_THREADS;
+
+  scheduler.is_running = true;
+  scheduler.start_time_us = get_time_us();
+  for (int i = 0; i < num_workers; i++) {
+    signing_worker_t *worker = &scheduler.workers[i];
+    atomic_init(&worker->tid, 0);
+    atomic_init(&worker->busy_time_us, 0);
+    atomic_init(&worker->num_signed_hashes, 0);
+    if (pthread_create(&worker->thread, NULL, signing_worker_thread, (void *)worker) != 0) break;
+    // Naming the thread is only for convenience, hence failures are ignored.
+    pthread_setname_np(worker->thread, WORKER_THREAD_NAME);
+    scheduler.num_workers++;
+  }
+
+  if (scheduler.num_workers == 0) {
+    scheduler.is_running = false;
+    return false;
+  }
+  return true;
+}
+
+/* Applies the |config| to all workers. All values are checked before anything is applied. If a
+ * setting fails, e.g., due to lack of permissions, the remaining ones are still applied. */
+static SignedVideoReturnCode
+scheduler_set_worker_config(const sv_worker_config_t *config)
+{
+  if (config->sched_policy < SV_SCHED_INHERIT || config->sched_policy >= SV_SCHED_NUM) {
+    return SV_INVALID_PARAMETER;
+  }
+
+  int policy = get_linux_sched_policy(config->sched_policy);
+  bool is_realtime = (policy == SCHED_FIFO || policy == SCHED_RR);
+  bool has_nice = (config->sched_policy != SV_SCHED_INHERIT) &&
+      (policy == SCHED_OTHER || policy == SCHED_BATCH);
+
+  if (is_realtime && (config->sched_priority < sched_get_priority_min(policy) ||
+                         config->sched_priority > sched_get_priority_max(policy))) {
+    return SV_INVALID_PARAMETER;
+  }
+  if (has_nice && (config->nice < -20 || config->nice > 19)) return SV_INVALID_PARAMETER;
+  if (config->name && strlen(config->name) > MAX_THREAD_NAME_LENGTH) return SV_INVALID_PARAMETER;
+
+  cpu_set_t cpus;
+  CPU_ZERO(&cpus);
+  for (int cpu = 0; cpu < 64; cpu++) {
+    if (config->cpu_mask & ((uint64_t)1 << cpu)) CPU_SET(cpu, &cpus);
+  }
+  struct sched_param param = {.sched_priority = is_realtime ? config->sched_priority : 0};
+
+  SignedVideoReturnCode status = SV_OK;
+  pthread_mutex_lock(&scheduler.lifecycle_lock);
+  if (scheduler.num_workers == 0) status = SV_NOT_SUPPORTED;
+  for (int i = 0; i < scheduler.num_workers; i++) {
+    signing_worker_t *worker = &scheduler.workers[i];
+    if (config->name && pthread_setname_np(worker->thread, config->name) != 0) {
+      status = SV_EXTERNAL_ERROR;
+    }
+    if (config->cpu_mask && pthread_setaffinity_np(worker->thread, sizeof(cpus), &cpus) != 0) {
+      status = SV_EXTERNAL_ERROR;
+    }
+    if (config->sched_policy != SV_SCHED_INHERIT) {
+      if (pthread_setschedparam(worker->thread, policy, &param) != 0) status = SV_EXTERNAL_ERROR;
+      // On Linux the nice value is a per thread attribute, set through its thread id.
+      if (has_nice && setpriority(PRIO_PROCESS, wait_for_thread_id(&worker->tid), config->nice) != 0) {
+        status = SV_EXTERNAL_ERROR;
+      }
+    }
+  }
+  pthread_mutex_unlock(&scheduler.lifecycle_lock);
+
+  return status;
+}
+
+/* Writes the utilization of at most |max_workers| workers to |stats|. */
+static size_t
+scheduler_get_worker_stats(sv_worker_stats_t *stats, size_t max_workers)
+{
+  size_t num_stats = 0;
+
+  pthread_mutex_lock(&scheduler.lifecycle_lock);
+  uint64_t elapsed_time_us = get_time_us() - scheduler.start_time_us;
+  for (int i = 0; i < scheduler.num_workers && num_stats < max_workers; i++, num_stats++) {
+    signing_worker_t *worker = &scheduler.workers[i];
+    sv_worker_stats_t *worker_stats = &stats[num_stats];
+    memset(worker_stats, 0, sizeof(sv_worker_stats_t));
+    worker_stats->elapsed_time_us = elapsed_time_us;
+    worker_stats->busy_time_us = atomic_load_explicit(&worker->busy_time_us, memory_order_relaxed);
+    worker_stats->num_signed_hashes =
+        atomic_load_explicit(&worker->num_signed_hashes, memory_order_relaxed);
+    clockid_t cpu_clock;
+    struct timespec ts = {0};
+    if (pthread_getcpuclockid(worker->thread, &cpu_clock) == 0 &&
+        clock_gettime(cpu_clock, &ts) == 0) {
+      worker_stats->cpu_time_us = (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+    }
+  }
+  pthread_mutex_unlock(&scheduler.lifecycle_lock);
+
+  return num_stats;
+}
+
+/**
+ * Signing.
+ */
+
+/* This function is called from the library upon signing and the input |signature_info| includes
+ * all necessary information to do so.
+ *
+ * The |hash| is copied to the next free slot, which is tagged with a deadline and queued in the
+ * scheduler. If this is the first time of signing, memory for the slots and |self->signature_info|
+ * is allocated and the |private_key| is copied from |signature_info|.
+ *
+ * If all slots are in use, the hash is not signed. This is tracked in |nbr_of_unsigned_hashes|
+ * and reported when getting the signature. */
+static SignedVideoReturnCode
+deadline_openssl_sign_hash(sv_deadline_plugin_t *self, const signature_info_t *signature_info)
+{
+  assert(self && signature_info);
+  if (!signature_info->private_key || !signature_info->hash) return SV_INVALID_PARAMETER;
+
+  uint64_t deadline_us = update_cadence_and_get_deadline(self, get_time_us());
+
+  // If all slots are in use, a new hash cannot be signed. Further, once a hash has been skipped no
+  // new hashes are handed over until that has been reported, otherwise signatures would be
+  // reported in the wrong order. Log in |nbr_of_unsigned_hashes| and return.
+  if ((self->num_requested - self->num_pulled >= MAX_HASHES_IN_FLIGHT) ||
+      (self->nbr_of_unsigned_hashes > 0)) {
+    self->nbr_of_unsigned_hashes++;
+    return SV_OK;
+  }
+
+  // If no |self->signature_info| exists. Allocate necessary memory for it and the slots. At this
+  // point there is nothing handed over to the scheduler, hence it is safe.
+  if (!self->signature_info) {
+    self->signature_info = local_signature_info_create(signature_info);
+    if (!self->signature_info || !slots_create(self, signature_info)) goto catch_error;
+    self->hash_size = signature_info->hash_size;
+  }
+
+  // Currently a fixed |hash_size| throughout the session is assumed.
+  if (signature_info->hash_size != self->hash_size) return SV_UNKNOWN_FAILURE;
+
+  // Copy the |hash| ready for signing and hand over the slot.
+  signing_slot_t *slot = &self->slots[self->num_requested % MAX_HASHES_IN_FLIGHT];
+  memcpy(slot->hash, signature_info->hash, signature_info->hash_size);
+  slot->deadline_us = deadline_us;
+
+  pthread_mutex_lock(&scheduler.lock);
+  bool is_queued = queue_push(self, slot);
+  if (is_queued) {
+    self->num_in_progress++;
+    pthread_cond_signal(&scheduler.has_work);
+  }
+  pthread_mutex_unlock(&scheduler.lock);
+  if (!is_queued) return SV_MEMORY;
+
+  self->num_requested++;
+
+  return SV_OK;
+
+catch_error:
+  // Failed in memory allocation. Free all memory and report SV_MEMORY.
+  sv_deadline_plugin_reset(self);
+  return SV_MEMORY;
+}
+
+/* If the oldest slot in use has been signed, the new |signature| is copied to the output and the
+ * slot is released.
+ *
+ * Returns true if a new |signature| has been copied to output, otherwise false.
+ * If the hash could not be signed since all slots were in use, |signature_size| is set to zero,
+ * but still returning true. */
+static bool
+deadline_openssl_get_signature(sv_deadline_plugin_t *self,
+    uint8_t *signature,
+    size_t max_signature_size,
+    size_t *written_signature_size,
+    SignedVideoReturnCode *error)
+{
+  assert(self && signature && written_signature_size);
+
+  bool has_copied_signature = false;
+  SignedVideoReturnCode status = SV_OK;
+  signing_slot_t *slot = &self->slots[self->num_pulled % MAX_HASHES_IN_FLIGHT];
+
+  bool has_signature = (self->num_pulled != self->num_requested) &&
+      atomic_load_explicit(&slot->is_signed, memory_order_acquire);
+  if (!has_signature && self->num_pulled != self->num_requested) {
+    // Nothing to pull. Clear |signature_fd| and check again, since a worker may have completed the
+    // signature in between. A signature completed after this point will make |signature_fd|
+    // readable again.
+    eventfd_t count = 0;
+    eventfd_read(self->signature_fd, &count);
+    has_signature = atomic_load_explicit(&slot->is_signed, memory_order_acquire);
+  }
+
+  if (has_signature) {
+    if (slot->status != SV_OK) {
+      *written_signature_size = 0;
+      // Propagate SV_EXTERNAL_ERROR when signing failed.
+      status = SV_EXTERNAL_ERROR;
+    } else if (slot->signature_size > max_signature_size) {
+      // If there is no room to copy the signature, report zero size.
+      *written_signature_size = 0;
+    } else {
+      memcpy(signature, slot->signature, slot->signature_size);
+      *written_signature_size = slot->signature_size;
+    }
+    // Release the slot and mark as copied.
+    atomic_store_explicit(&slot->is_signed, false, memory_order_relaxed);
+    self->num_pulled++;
+    has_copied_signature = true;
+  } else if (self->nbr_of_unsigned_hashes > 0 && self->num_requested == self->num_pulled) {
+    // There are unsigned hashes in the pipe. Report them with zero size, since no signature exists.
+    *written_signature_size = 0;
+    self->nbr_of_unsigned_hashes--;
+    has_copied_signature = true;
+  }
+
+  if (error) *error = status;
+
+  return has_copied_signature;
+}
+
+/**
+ * Definitions of declared interfaces. For declarations see signed_video_interfaces.h.
+ */
+
+SignedVideoReturnCode
+sv_interface_sign_hash(void *plugin_handle, signature_info_t *signature_info)
+{
+  sv_deadline_plugin_t *self = (sv_deadline_plugin_t *)plugin_handle;
+
+  if (!self || !signature_info) return SV_INVALID_PARAMETER;
+
+  return deadline_openssl_sign_hash(self, signature_info);
+}
+
+bool
+sv_interface_get_signature(void *plugin_handle,
+    uint8_t *signature,
+    size_t max_signature_size,
+    size_t *written_signature_size,
+    SignedVideoReturnCode *error)
+{
+  sv_deadline_plugin_t *self = (sv_deadline_plugin_t *)plugin_handle;
+
+  if (!self || !signature || !written_signature_size) return false;
+
+  return deadline_openssl_get_signature(
+      self, signature, max_signature_size, written_signature_size, error);
+}
+
+int
+sv_interface_get_signature_fd(void *plugin_handle)
+{
+  sv_deadline_plugin_t *self = (sv_deadline_plugin_t *)plugin_handle;
+
+  if (!self) return -1;
+
+  return self->signature_fd;
+}
+
+/* The workers are shared by all sessions, hence the |config| applies to all of them. */
+SignedVideoReturnCode
+sv_interface_set_worker_config(void *plugin_handle, const sv_worker_config_t *config)
+{
+  if (!plugin_handle || !config) return SV_INVALID_PARAMETER;
+
+  return scheduler_set_worker_config(config);
+}
+
+size_t
+sv_interface_get_worker_stats(void *plugin_handle, sv_worker_stats_t *stats, size_t max_workers)
+{
+  if (!plugin_handle || !stats || max_workers == 0) return 0;
+
+  return scheduler_get_worker_stats(stats, max_workers);
+}
+
+SignedVideoReturnCode
+sv_interface_get_deadline_stats(void *plugin_handle, sv_deadline_stats_t *stats)
+{
+  sv_deadline_plugin_t *self = (sv_deadline_plugin_t *)plugin_handle;
+
+  if (!self || !stats) return SV_INVALID_PARAMETER;
+
+  stats->num_signed_hashes = atomic_load_explicit(&self->num_signed_hashes, memory_order_relaxed);
+  stats->num_missed_deadlines =
+      atomic_load_explicit(&self->num_missed_deadlines, memory_order_relaxed);
+  stats->max_lateness_us = atomic_load_explicit(&self->max_lateness_us, memory_order_relaxed);
+  stats->cadence_us = self->cadence_us;
+
+  return SV_OK;
+}
+
+/* This function is called when a Signed Video session is created. The first session starts the
+ * shared worker threads.
+ *
+ * returns sv_deadline_plugin_t upon success, and NULL upon failure. */
+void *
+sv_interface_setup()
+{
+  sv_deadline_plugin_t *self = calloc(1, sizeof(sv_deadline_plugin_t));
+
+  if (!self) return NULL;
+
+  for (int i = 0; i < MAX_HASHES_IN_FLIGHT; i++) {
+    atomic_init(&self->slots[i].is_signed, false);
+  }
+  atomic_init(&self->num_signed_hashes, 0);
+  atomic_init(&self->num_missed_deadlines, 0);
+  atomic_init(&self->max_lateness_us, 0);
+  self->signature_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (self->signature_fd < 0) goto catch_error;
+
+  pthread_mutex_lock(&scheduler.lifecycle_lock);
+  bool is_running = (scheduler.num_sessions > 0) || scheduler_start();
+  if (is_running) scheduler.num_sessions++;
+  pthread_mutex_unlock(&scheduler.lifecycle_lock);
+  if (!is_running) goto catch_error;
+
+  return (void *)self;
+
+catch_error:
+  if (self->signature_fd >= 0) close(self->signature_fd);
+  free(self);
+  return NULL;
+}
+
+/* Hashes of the session still queued are dropped and the ones being signed are waited for. The
+ * last session stops the shared worker threads. */
+void
+sv_interface_teardown(void *plugin_handle)
+{
+  sv_deadline_plugin_t *self = (sv_deadline_plugin_t *)plugin_handle;
+
+  if (!self) return;
+
+  pthread_mutex_lock(&scheduler.lifecycle_lock);
+  pthread_mutex_lock(&scheduler.lock);
+  self->num_in_progress -= queue_remove_session(self);
+  while (self->num_in_progress > 0) {
+    pthread_cond_wait(&scheduler.request_done, &scheduler.lock);
+  }
+  pthread_mutex_unlock(&scheduler.lock);
+  scheduler.num_sessions--;
+  if (scheduler.num_sessions == 0) scheduler_stop();
+  pthread_mutex_unlock(&scheduler.lifecycle_lock);
+
+  close(self->signature_fd);
+  sv_deadline_plugin_reset(self);
+  free(self);
+}
+
+uint8_t *
+sv_interface_malloc(size_t data_size)
+{
+  return openssl_malloc(data_size);
+}
+
+void
+sv_interface_free(uint8_t *data)
+{
+  openssl_free(data);
+}
@@ -0,0 +1,114 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2023 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next paragraph) shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#define _GNU_SOURCE  // SCHED_BATCH, SCHED_IDLE
+#include "plugin_helpers.h"
+
+#include <limits.h>  // INT_MAX
+#include <linux/futex.h>  // FUTEX_WAIT_PRIVATE, FUTEX_WAKE_PRIVATE
+#include <sched.h>  // SCHED_*
+#include <stdlib.h>  // calloc, malloc, free
+#include <string.h>  // memcpy
+#include <sys/syscall.h>  // SYS_futex, SYS_gettid
+#include <time.h>  // clock_gettime
+#include <unistd.h>  // syscall
+
+long
+futex(atomic_uint *uaddr, int futex_op, unsigned val)
+{
+  return syscall(SYS_futex, (unsigned *)uaddr, futex_op, val, NULL, NULL, 0);
+}
+
+uint64_t
+get_time_us()
+{
+  struct timespec ts = {0};
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+void
+local_signature_info_free(signature_info_t *signature_info)
+{
+  if (!signature_info) return;
+
+  free(signature_info->private_key);
+  free(signature_info);
+}
+
+signature_info_t *
+local_signature_info_create(const signature_info_t *signature_info)
+{
+  signature_info_t *local_signature_info = calloc(1, sizeof(signature_info_t));
+  if (!local_signature_info) goto catch_error;
+
+  // Allocate memory and copy |private_key|.
+  local_signature_info->private_key = malloc(signature_info->private_key_size);
+  if (!local_signature_info->private_key) goto catch_error;
+  memcpy(local_signature_info->private_key, signature_info->private_key,
+      signature_info->private_key_size);
+  local_signature_info->private_key_size = signature_info->private_key_size;
+  local_signature_info->max_signature_size = signature_info->max_signature_size;
+  local_signature_info->hash_size = signature_info->hash_size;
+  // Copy the |algo|.
+  local_signature_info->algo = signature_info->algo;
+
+  return local_signature_info;
+
+catch_error:
+  local_signature_info_free(local_signature_info);
+  return NULL;
+}
+
+int
+get_linux_sched_policy(sv_sched_policy_t sched_policy)
+{
+  switch (sched_policy) {
+    case SV_SCHED_BATCH:
+      return SCHED_BATCH;
+    case SV_SCHED_IDLE:
+      return SCHED_IDLE;
+    case SV_SCHED_FIFO:
+      return SCHED_FIFO;
+    case SV_SCHED_RR:
+      return SCHED_RR;
+    case SV_SCHED_OTHER:
+    default:
+      return SCHED_OTHER;
+  }
+}
+
+void
+publish_thread_id(atomic_uint *tid)
+{
+  atomic_store(tid, (unsigned)syscall(SYS_gettid));
+  futex(tid, FUTEX_WAKE_PRIVATE, INT_MAX);
+}
+
+pid_t
+wait_for_thread_id(atomic_uint *tid)
+{
+  unsigned thread_id = atomic_load(tid);
+  while (thread_id == 0) {
+    futex(tid, FUTEX_WAIT_PRIVATE, 0);
+    thread_id = atomic_load(tid);
+  }
+  return (pid_t)thread_id;
+}
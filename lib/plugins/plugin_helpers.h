@@ -0,0 +1,74 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2023 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next paragraph) shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef __PLUGIN_HELPERS_H__
+#define __PLUGIN_HELPERS_H__
+
+/**
+ * Helpers shared by the threaded and the deadline signing plugins. The source file is compiled
+ * into each of them, hence the helpers are hidden to not clash between the library with a built-in
+ * plugin and a plugin loaded at runtime.
+ */
+
+#include <stdatomic.h>  // atomic_uint
+#include <stdint.h>  // uint64_t
+#include <sys/types.h>  // pid_t
+
+#include "includes/signed_video_interfaces.h"  // signature_info_t, sv_sched_policy_t
+
+#if defined(__GNUC__)
+#define PLUGIN_HELPER __attribute__((visibility("hidden")))
+#else
+#define PLUGIN_HELPER
+#endif
+
+/* Thin wrapper of the futex system call, since there is no glibc wrapper. */
+PLUGIN_HELPER long
+futex(atomic_uint *uaddr, int futex_op, unsigned val);
+
+/* Returns the monotonic time in microseconds. */
+PLUGIN_HELPER uint64_t
+get_time_us();
+
+/* Frees the memory of |signature_info|. */
+PLUGIN_HELPER void
+local_signature_info_free(signature_info_t *signature_info);
+
+/* Allocate memory and copy data for the local |signature_info|.
+ *
+ * This is only done once and the necessary |private_key| as well as the |algo| is copied. The
+ * memory for the |signature| and the |hash| is owned by the slots. */
+PLUGIN_HELPER signature_info_t *
+local_signature_info_create(const signature_info_t *signature_info);
+
+/* Maps a sv_sched_policy_t to the Linux scheduling policy. */
+PLUGIN_HELPER int
+get_linux_sched_policy(sv_sched_policy_t sched_policy);
+
+/* Stores the thread id of the calling thread in |tid| and wakes up threads waiting for it. Called
+ * once by a worker thread when started. */
+PLUGIN_HELPER void
+publish_thread_id(atomic_uint *tid);
+
+/* Waits, if necessary, until a thread id has been published in |tid| and returns it. */
+PLUGIN_HELPER pid_t
+wait_for_thread_id(atomic_uint *tid);
+
+#endif  // __PLUGIN_HELPERS_H__
@@ -21,150 +21,196 @@
 
 /**
  * This signing plugin sets up a worker thread and calls openssl_sign_hash(), from the worker
- * thread, when there is a new hash to sign. The plugin can only handle one signature at a time,
- * that is, there is no queue of hashes to sign. If the latest signature is not completed by the
- * time of a new request, that new hash is not signed.
+ * thread, when there are new hashes to sign.
+ *
+ * The encoder thread and the worker thread communicate through a lock-free single-producer/single-
+ * consumer ring of |MAX_HASHES_IN_FLIGHT| slots. The encoder thread is the only one writing hashes
+ * to sign and reading completed signatures, and the worker thread is the only one signing. Hence,
+ * polling for a signature is a couple of atomic loads. The worker thread sleeps on a futex when
+ * there is nothing to sign and is only woken up if it actually sleeps. Every completed signature is
+ * also signaled on an eventfd, which can be polled by the user through
+ * sv_interface_get_signature_fd().
+ *
+ * If all slots are in use by the time of a new request, that new hash is not signed.
+ *
+ * The CPU affinity, scheduling policy and name of the worker thread can be configured through
+ * sv_interface_set_worker_config(), and the time spent signing is tracked for
+ * sv_interface_get_worker_stats().
  */
 
+#define _GNU_SOURCE  // pthread_setaffinity_np, pthread_setname_np, CPU_SET
 #include <assert.h>
-#include <glib.h>
-#include <stdlib.h>  // calloc, malloc, free
-#include <string.h>  // memcpy
+#include <linux/futex.h>  // FUTEX_WAIT_PRIVATE, FUTEX_WAKE_PRIVATE
+#include <pthread.h>  // pthread_create, pthread_join, pthread_setschedparam, pthread_getcpuclockid
+#include <sched.h>  // SCHED_*, cpu_set_t, sched_get_priority_min, sched_get_priority_max
+#include <stdatomic.h>  // atomic_uint, atomic_bool
+#include <stdlib.h>  // calloc, free
+#include <string.h>  // memcpy, strlen
+#include <sys/eventfd.h>  // eventfd, eventfd_read, eventfd_write
+#include <sys/resource.h>  // setpriority, PRIO_PROCESS
+#include <time.h>  // clock_gettime
+#include <unistd.h>  // close
 
 #include "includes/signed_video_interfaces.h"
 #include "includes/signed_video_openssl.h"
-
-typedef enum {
-  THREADED_SIGNING_WAITS_FOR_HASH_TO_SIGN,
-  THREADED_SIGNING_HAS_HASH_TO_SIGN,
-  THREADED_SIGNING_SIGNS_HASH,
-  THREADED_SIGNING_HAS_SIGNATURE,
-  THREADED_SIGNING_ERROR,
-} threaded_signing_plugin_state;
-
-/* Threaded plugin handle maintaining the thread and locks. Further, stores the hash to sign and the
- * written signature (part of |signature_info|): */
+#include "../plugin_helpers.h"
+
+// The number of hashes that can be handed over to the worker thread before their signatures have
+// been pulled. Has to be a power of two. The library never has more than MAX_NALUS_TO_PREPEND
+// (5) SEIs waiting for a signature.
+#define MAX_HASHES_IN_FLIGHT 8
+// The default name of the worker thread.
+#define WORKER_THREAD_NAME "sv-signing"
+// Thread names are limited to 16 bytes including the terminating null byte.
+#define MAX_THREAD_NAME_LENGTH 15
+
+/* A slot in the ring. The |hash| is written by the encoder thread before the slot is handed over,
+ * and the |signature| and |status| are written by the worker thread before the slot is handed
+ * back. */
+typedef struct {
+  uint8_t *hash;
+  uint8_t *signature;
+  size_t signature_size;
+  SignedVideoReturnCode status;
+} signing_slot_t;
+
+/* Threaded plugin handle maintaining the thread and the ring of slots.
+ *
+ * The ring is tracked by three ever increasing counters, which wrap around together:
+ *   |num_requested| Number of hashes handed over to the worker. Only written by the encoder thread.
+ *   |num_signed| Number of hashes signed. Only written by the worker thread.
+ *   |num_pulled| Number of signatures pulled. Only accessed by the encoder thread.
+ * A slot is owned by the worker if num_signed <= slot < num_requested, otherwise by the encoder
+ * thread. */
 typedef struct _sv_threaded_plugin {
-  GThread *thread;
-  GMutex mutex;
-  GCond cond;
-
-  // Variables that has to be r/w under mutex lock.
-  bool is_running;
-  threaded_signing_plugin_state plugin_state;
-  uint8_t *hash_to_sign;
+  pthread_t thread;
+  bool has_thread;
+
+  atomic_bool is_running;
+  atomic_uint num_requested;
+  atomic_uint num_signed;
+  unsigned num_pulled;
+  // Futex word the worker thread sleeps on. Bumped every time there is a reason to wake up.
+  atomic_uint wakeup_seq;
+  atomic_bool worker_is_sleeping;
+  // Readable when there are signatures to pull. Written by the worker thread after a hash has been
+  // signed and cleared by the encoder thread when there are no more signatures to pull.
+  int signature_fd;
+
+  signing_slot_t slots[MAX_HASHES_IN_FLIGHT];
+
+  // Thread id of the worker thread, needed to set its nice value. Written once by the worker
+  // thread when started, and zero until then.
+  atomic_uint worker_tid;
+  // Utilization of the worker thread. The counters are only written by the worker thread.
+  uint64_t start_time_us;
+  atomic_uint_fast64_t busy_time_us;
+  atomic_uint_fast64_t num_signed_hashes;
+
+  // Variables only accessed by the encoder thread.
   size_t hash_size;
   int nbr_of_unsigned_hashes;  // Tracks hashes that could not be signed.
 
-  // Variables that can operate without mutex lock.
-  // A local copy of the signature_info is used for signing. The hash to be signed is copied to it
-  // when it is time to sign.
+  // A local copy of the signature_info is used for signing. Only the |private_key| and the |algo|
+  // are used. The |hash| and |signature| are pointed to the slot to sign. It is created before the
+  // first hash is handed over to the worker thread.
   signature_info_t *signature_info;
 } sv_threaded_plugin_t;
 
-/* Frees the memory of |signature_info|. */
+/* Frees the memory of all slots. */
 static void
-local_signature_info_free(signature_info_t *signature_info)
+slots_free(sv_threaded_plugin_t *self)
 {
-  if (!signature_info) return;
-
-  free(signature_info->private_key);
-  openssl_free(signature_info->signature);
-  free(signature_info->hash);
-  free(signature_info);
+  for (int i = 0; i < MAX_HASHES_IN_FLIGHT; i++) {
+    free(self->slots[i].hash);
+    self->slots[i].hash = NULL;
+    openssl_free(self->slots[i].signature);
+    self->slots[i].signature = NULL;
+  }
 }
 
-/* Allocate memory and copy data for the local |signature_info|.
- *
- * This is only done once and the necessary |private_key| as well as the |algo| is copied. Memory
- * for the |signature| and the |hash| is allocated. */
-static signature_info_t *
-local_signature_info_create(const signature_info_t *signature_info)
+/* Allocates memory for the |hash| and |signature| of all slots. */
+static bool
+slots_create(sv_threaded_plugin_t *self, const signature_info_t *signature_info)
 {
-  signature_info_t *local_signature_info = calloc(1, sizeof(signature_info_t));
-  if (!local_signature_info) goto catch_error;
-
-  // Allocate memory and copy |private_key|.
-  local_signature_info->private_key = malloc(signature_info->private_key_size);
-  if (!local_signature_info->private_key) goto catch_error;
-  memcpy(local_signature_info->private_key, signature_info->private_key,
-      signature_info->private_key_size);
-  local_signature_info->private_key_size = signature_info->private_key_size;
-
-  // Allocate memory for the |signature|.
-  local_signature_info->signature = openssl_malloc(signature_info->max_signature_size);
-  if (!local_signature_info->signature) goto catch_error;
-  local_signature_info->max_signature_size = signature_info->max_signature_size;
-
-  // Allocate memory for the |hash|.
-  local_signature_info->hash = calloc(1, signature_info->hash_size);
-  if (!local_signature_info->hash) goto catch_error;
-  local_signature_info->hash_size = signature_info->hash_size;
-  // Copy the |algo|.
-  local_signature_info->algo = signature_info->algo;
-
-  return local_signature_info;
-
-catch_error:
-  local_signature_info_free(local_signature_info);
-  return NULL;
+  for (int i = 0; i < MAX_HASHES_IN_FLIGHT; i++) {
+    self->slots[i].hash = calloc(1, signature_info->hash_size);
+    self->slots[i].signature = openssl_malloc(signature_info->max_signature_size);
+    if (!self->slots[i].hash || !self->slots[i].signature) {
+      slots_free(self);
+      return false;
+    }
+  }
+  return true;
 }
 
-/* Frees all allocated memory and resets members. Excluded are the worker thread members |thread|,
- * |mutex|, |cond| and |is_running|, but also the counter |nbr_of_unsigned_hashes|. */
+/* Frees all allocated memory and resets members. Must not be called while there are hashes
+ * handed over to a running worker thread. */
 static void
 sv_threaded_plugin_reset(sv_threaded_plugin_t *self)
 {
   local_signature_info_free(self->signature_info);
   self->signature_info = NULL;
-  free(self->hash_to_sign);
-  self->hash_to_sign = NULL;
+  slots_free(self);
   self->hash_size = 0;
-  self->plugin_state = THREADED_SIGNING_WAITS_FOR_HASH_TO_SIGN;
 }
 
-/* The worker thread waits for a condition signal, triggered when there is a hash to sign. */
+/* Wakes up the worker thread if it is sleeping. */
+static void
+wake_up_worker(sv_threaded_plugin_t *self)
+{
+  atomic_fetch_add(&self->wakeup_seq, 1);
+  if (atomic_load(&self->worker_is_sleeping)) futex(&self->wakeup_seq, FUTEX_WAKE_PRIVATE, 1);
+}
+
+/* The worker thread signs hashes as long as there are any, then sleeps until woken up. */
 static void *
 signing_worker_thread(void *user_data)
 {
   sv_threaded_plugin_t *self = (sv_threaded_plugin_t *)user_data;
-
-  g_mutex_lock(&self->mutex);
-  if (self->is_running) goto done;
-
-  self->is_running = true;
-  // Send a signal that thread has started.
-  g_cond_signal(&self->cond);
-
-  while (self->is_running) {
-    // Wait for a signal, triggered when it is time to sign a hash.
-    g_cond_wait(&self->cond, &self->mutex);
-
-    if (self->plugin_state == THREADED_SIGNING_HAS_HASH_TO_SIGN) {
-      // Copy the |hash_to_sign| to |signature_info| and start signing. In principle, it is now
-      // possible to prepare for a new |hash_to_sign|.
-      assert(self->hash_size == self->signature_info->hash_size);
-      memcpy(self->signature_info->hash, self->hash_to_sign, self->hash_size);
-      self->plugin_state = THREADED_SIGNING_SIGNS_HASH;
-
-      // Let the signing operate outside a lock. Otherwise sv_interface_get_signature() is blocked,
-      // since variables need to be read under a lock.
-      g_mutex_unlock(&self->mutex);
-      SignedVideoReturnCode status = openssl_sign_hash(self->signature_info);
-
-      g_mutex_lock(&self->mutex);
-      // When successfully done with signing, move |plugin_state| to THREADED_SIGNING_HAS_SIGNATURE,
-      // otherwise move to THREADED_SIGNING_ERROR to report the error when getting the signature.
-      if (status == SV_OK) {
-        self->plugin_state = THREADED_SIGNING_HAS_SIGNATURE;
-      } else {
-        self->plugin_state = THREADED_SIGNING_ERROR;
+  unsigned num_signed = atomic_load_explicit(&self->num_signed, memory_order_relaxed);
+
+  // Publish the thread id for sv_interface_set_worker_config().
+  publish_thread_id(&self->worker_tid);
+
+  while (true) {
+    // Read the futex word before checking for work. A wake-up after this point makes the futex
+    // wait return immediately.
+    unsigned seq = atomic_load(&self->wakeup_seq);
+    if (!atomic_load(&self->is_running)) break;
+
+    unsigned num_requested = atomic_load_explicit(&self->num_requested, memory_order_acquire);
+    if (num_signed == num_requested) {
+      atomic_store(&self->worker_is_sleeping, true);
+      // Check once more after announcing sleep, since the encoder thread only wakes up a sleeping
+      // worker.
+      if (atomic_load(&self->num_requested) == num_signed && atomic_load(&self->is_running)) {
+        futex(&self->wakeup_seq, FUTEX_WAIT_PRIVATE, seq);
       }
+      atomic_store(&self->worker_is_sleeping, false);
+      continue;
     }
-  };
 
-done:
-  g_mutex_unlock(&self->mutex);
+    // Sign the oldest hash. The slot is owned by the worker until |num_signed| is incremented, and
+    // the |signature_info| is only modified by the encoder thread before the first hand-over.
+    signing_slot_t *slot = &self->slots[num_signed % MAX_HASHES_IN_FLIGHT];
+    signature_info_t *signature_info = self->signature_info;
+    signature_info->hash = slot->hash;
+    signature_info->signature = slot->signature;
+    signature_info->signature_size = 0;
+    uint64_t sign_start_us = get_time_us();
+    slot->status = openssl_sign_hash(signature_info);
+    slot->signature_size = (slot->status == SV_OK) ? signature_info->signature_size : 0;
+    atomic_fetch_add_explicit(
+        &self->busy_time_us, get_time_us() - sign_start_us, memory_order_relaxed);
+    atomic_fetch_add_explicit(&self->num_signed_hashes, 1, memory_order_relaxed);
+
+    num_signed++;
+    atomic_store_explicit(&self->num_signed, num_signed, memory_order_release);
+    // Signal after |num_signed| has been updated, so a readable |signature_fd| means that there is
+    // a signature to pull.
+    eventfd_write(self->signature_fd, 1);
+  }
 
   return NULL;
 }
@@ -172,75 +218,61 @@ done:
 /* This function is called from the library upon signing and the input |signature_info| includes
  * all necessary information to do so.
  *
- * The |hash| is copied to |hash_to_sign| and the |plugin_state| is moved to
- * THREADED_SIGNING_HAS_HASH_TO_SIGN. If this is the first time of signing, memory for
- * |self->signature_info| and |hash_to_sign| is allocated and the |private_key| is copied from
- * |signature_info|.
+ * The |hash| is copied to the next free slot, which is then handed over to the worker thread. If
+ * this is the first time of signing, memory for the slots and |self->signature_info| is allocated
+ * and the |private_key| is copied from |signature_info|.
  *
- * Further, if there is no worker thread running or if the latest signing has not yet finished an
- * SV_NOT_SUPPORTED is returned. */
+ * If all slots are in use, the hash is not signed. This is tracked in |nbr_of_unsigned_hashes|
+ * and reported when getting the signature. */
 static SignedVideoReturnCode
 threaded_openssl_sign_hash(sv_threaded_plugin_t *self, const signature_info_t *signature_info)
 {
   assert(self && signature_info);
   if (!signature_info->private_key || !signature_info->hash) return SV_INVALID_PARAMETER;
 
-  SignedVideoReturnCode status = SV_UNKNOWN_FAILURE;
-  g_mutex_lock(&self->mutex);
+  unsigned num_requested = atomic_load_explicit(&self->num_requested, memory_order_relaxed);
 
-  // If the signature has not yet been pulled, or even generated, a new signature cannot be
-  // generated without replacing it. Log in |nbr_of_unsigned_hashes| and move to done.
-  if (self->plugin_state != THREADED_SIGNING_WAITS_FOR_HASH_TO_SIGN) {
+  // If all slots are in use, a new hash cannot be signed. Further, once a hash has been skipped no
+  // new hashes are handed over until that has been reported, otherwise signatures would be
+  // reported in the wrong order. Log in |nbr_of_unsigned_hashes| and return.
+  if ((num_requested - self->num_pulled >= MAX_HASHES_IN_FLIGHT) ||
+      (self->nbr_of_unsigned_hashes > 0)) {
     self->nbr_of_unsigned_hashes++;
-    status = SV_OK;
-    goto done;
+    return SV_OK;
   }
 
-  // If no |self->signature_info| exists. Allocate necessary memory for it and copy the
-  // |private_key| and |algo|.
+  // If no |self->signature_info| exists. Allocate necessary memory for it and the slots. At this
+  // point there is nothing handed over to the worker thread, hence it is safe.
   if (!self->signature_info) {
     self->signature_info = local_signature_info_create(signature_info);
-    if (!self->signature_info) goto catch_error;
-  }
-
-  // Allocate memory for the |hash_to_sign| if necessary.
-  if (!self->hash_to_sign) {
-    self->hash_to_sign = calloc(1, signature_info->hash_size);
-    if (!self->hash_to_sign) goto catch_error;
+    if (!self->signature_info || !slots_create(self, signature_info)) goto catch_error;
     self->hash_size = signature_info->hash_size;
   }
 
   // Currently a fixed |hash_size| throughout the session is assumed.
   // TODO: Should we allow to change the hash_size in runtime?
-  if (signature_info->hash_size != self->hash_size) goto catch_error;
+  if (signature_info->hash_size != self->hash_size) return SV_UNKNOWN_FAILURE;
 
-  // Copy the |hash| ready for signing.
-  memcpy(self->hash_to_sign, signature_info->hash, signature_info->hash_size);
+  // Copy the |hash| ready for signing and hand over the slot.
+  memcpy(self->slots[num_requested % MAX_HASHES_IN_FLIGHT].hash, signature_info->hash,
+      signature_info->hash_size);
+  atomic_store(&self->num_requested, num_requested + 1);
+  wake_up_worker(self);
 
-  status = SV_OK;
-  self->plugin_state = THREADED_SIGNING_HAS_HASH_TO_SIGN;
+  return SV_OK;
 
 catch_error:
-  if (status == SV_UNKNOWN_FAILURE) {
-    // Failed in memory allocation. Free all memory and set status to SV_MEMORY.
-    sv_threaded_plugin_reset(self);
-    status = SV_MEMORY;
-  }
-
-  g_cond_signal(&self->cond);
-done:
-  g_mutex_unlock(&self->mutex);
-
-  return status;
+  // Failed in memory allocation. Free all memory and report SV_MEMORY.
+  sv_threaded_plugin_reset(self);
+  return SV_MEMORY;
 }
 
-/* If |plugin_state| = THREADED_SIGNING_HAS_SIGNATURE a new |signature| has been written to
- * |signature_info|. The new |signature| is then copied to the output and the |plugin_state|
- * is set to THREADED_SIGNING_WAITS_FOR_HASH_TO_SIGN.
+/* If the oldest slot in use has been signed, the new |signature| is copied to the output and the
+ * slot is released.
  *
  * Returns true if a new |signature| has been copied to output, otherwise false.
- * If the hash could not be signed due to a blocked openssl_sign_hash(), |signature_size| is set to
- * zero, but still returning true. */
+ * If the hash could not be signed since all slots were in use, |signature_size| is set to zero,
+ * but still returning true. */
 static bool
 threaded_openssl_get_signature(sv_threaded_plugin_t *self,
     uint8_t *signature,
@@ -253,39 +285,112 @@ threaded_openssl_get_signature(sv_threaded_plugin_t *self,
   bool has_copied_signature = false;
   SignedVideoReturnCode status = SV_OK;
 
-  g_mutex_lock(&self->mutex);
-  if (self->plugin_state == THREADED_SIGNING_HAS_SIGNATURE && self->signature_info) {
-    if (self->signature_info->signature_size > max_signature_size) {
+  unsigned num_signed = atomic_load_explicit(&self->num_signed, memory_order_acquire);
+  if (self->num_pulled == num_signed) {
+    // Nothing to pull. Clear |signature_fd| and check again, since the worker thread may have
+    // completed a signature in between. A signature completed after this point will make
+    // |signature_fd| readable again.
+    eventfd_t count = 0;
+    eventfd_read(self->signature_fd, &count);
+    num_signed = atomic_load_explicit(&self->num_signed, memory_order_acquire);
+  }
+  if (self->num_pulled != num_signed) {
+    signing_slot_t *slot = &self->slots[self->num_pulled % MAX_HASHES_IN_FLIGHT];
+    if (slot->status != SV_OK) {
+      *written_signature_size = 0;
+      // Propagate SV_EXTERNAL_ERROR when signing failed.
+      status = SV_EXTERNAL_ERROR;
+    } else if (slot->signature_size > max_signature_size) {
       // If there is no room to copy the signature, report zero size.
       *written_signature_size = 0;
     } else {
-      memcpy(signature, self->signature_info->signature, self->signature_info->signature_size);
-      *written_signature_size = self->signature_info->signature_size;
+      memcpy(signature, slot->signature, slot->signature_size);
+      *written_signature_size = slot->signature_size;
     }
-    // Change state and mark as copied.
-    self->plugin_state = THREADED_SIGNING_WAITS_FOR_HASH_TO_SIGN;
-    has_copied_signature = true;
-  } else if (self->plugin_state == THREADED_SIGNING_ERROR) {
-    *written_signature_size = 0;
-    // Change state and mark as copied.
-    self->plugin_state = THREADED_SIGNING_WAITS_FOR_HASH_TO_SIGN;
+    // Release the slot and mark as copied.
+    self->num_pulled++;
     has_copied_signature = true;
-    // Propagate SV_EXTERNAL_ERROR when signing failed.
-    status = SV_EXTERNAL_ERROR;
-  } else if (self->plugin_state == THREADED_SIGNING_WAITS_FOR_HASH_TO_SIGN &&
-      self->nbr_of_unsigned_hashes > 0) {
+  } else if (self->nbr_of_unsigned_hashes > 0 &&
+      atomic_load_explicit(&self->num_requested, memory_order_relaxed) == self->num_pulled) {
     // There are unsigned hashes in the pipe. Report them with zero size, since no signature exists.
     *written_signature_size = 0;
     self->nbr_of_unsigned_hashes--;
     has_copied_signature = true;
   }
-  g_mutex_unlock(&self->mutex);
 
   if (error) *error = status;
 
   return has_copied_signature;
 }
 
+/* Applies the |config| to the worker thread. All values are checked before anything is applied.
+ * If a setting fails, e.g., due to lack of permissions, the remaining ones are still applied. */
+static SignedVideoReturnCode
+threaded_set_worker_config(sv_threaded_plugin_t *self, const sv_worker_config_t *config)
+{
+  assert(self && config);
+  if (!self->has_thread) return SV_NOT_SUPPORTED;
+  if (config->sched_policy < SV_SCHED_INHERIT || config->sched_policy >= SV_SCHED_NUM) {
+    return SV_INVALID_PARAMETER;
+  }
+
+  int policy = get_linux_sched_policy(config->sched_policy);
+  bool is_realtime = (policy == SCHED_FIFO || policy == SCHED_RR);
+  bool has_nice = (config->sched_policy != SV_SCHED_INHERIT) &&
+      (policy == SCHED_OTHER || policy == SCHED_BATCH);
+  if (is_realtime && (config->sched_priority < sched_get_priority_min(policy) ||
+                         config->sched_priority > sched_get_priority_max(policy))) {
+    return SV_INVALID_PARAMETER;
+  }
+  if (has_nice && (config->nice < -20 || config->nice > 19)) return SV_INVALID_PARAMETER;
+  if (config->name && strlen(config->name) > MAX_THREAD_NAME_LENGTH) return SV_INVALID_PARAMETER;
+
+  SignedVideoReturnCode status = SV_OK;
+
+  if (config->name && pthread_setname_np(self->thread, config->name) != 0) {
+    status = SV_EXTERNAL_ERROR;
+  }
+
+  if (config->cpu_mask) {
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    for (int cpu = 0; cpu < 64; cpu++) {
+      if (config->cpu_mask & ((uint64_t)1 << cpu)) CPU_SET(cpu, &cpus);
+    }
+    if (pthread_setaffinity_np(self->thread, sizeof(cpus), &cpus) != 0) status = SV_EXTERNAL_ERROR;
+  }
+
+  if (config->sched_policy != SV_SCHED_INHERIT) {
+    struct sched_param param = {.sched_priority = is_realtime ? config->sched_priority : 0};
+    if (pthread_setschedparam(self->thread, policy, &param) != 0) status = SV_EXTERNAL_ERROR;
+    // On Linux the nice value is a per thread attribute, set through its thread id.
+    if (has_nice && setpriority(PRIO_PROCESS, wait_for_thread_id(&self->worker_tid), config->nice) != 0) {
+      status = SV_EXTERNAL_ERROR;
+    }
+  }
+
+  return status;
+}
+
+/* Writes the utilization of the worker thread to |stats|. */
+static void
+threaded_get_worker_stats(sv_threaded_plugin_t *self, sv_worker_stats_t *stats)
+{
+  assert(self && stats);
+
+  memset(stats, 0, sizeof(sv_worker_stats_t));
+  stats->elapsed_time_us = get_time_us() - self->start_time_us;
+  stats->busy_time_us = atomic_load_explicit(&self->busy_time_us, memory_order_relaxed);
+  stats->num_signed_hashes = atomic_load_explicit(&self->num_signed_hashes, memory_order_relaxed);
+
+  clockid_t cpu_clock;
+  struct timespec ts = {0};
+  if (pthread_getcpuclockid(self->thread, &cpu_clock) == 0 &&
+      clock_gettime(cpu_clock, &ts) == 0) {
+    stats->cpu_time_us = (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+  }
+}
+
 /**
  * Definitions of declared interfaces. For declarations see signed_video_interfaces.h.
  */
@@ -315,6 +420,48 @@ sv_interface_get_signature(void *plugin_handle,
       self, signature, max_signature_size, written_signature_size, error);
 }
 
+int
+sv_interface_get_signature_fd(void *plugin_handle)
+{
+  sv_threaded_plugin_t *self = (sv_threaded_plugin_t *)plugin_handle;
+
+  if (!self) return -1;
+
+  return self->signature_fd;
+}
+
+SignedVideoReturnCode
+sv_interface_set_worker_config(void *plugin_handle, const sv_worker_config_t *config)
+{
+  sv_threaded_plugin_t *self = (sv_threaded_plugin_t *)plugin_handle;
+
+  if (!self || !config) return SV_INVALID_PARAMETER;
+
+  return threaded_set_worker_config(self, config);
+}
+
+size_t
+sv_interface_get_worker_stats(void *plugin_handle, sv_worker_stats_t *stats, size_t max_workers)
+{
+  sv_threaded_plugin_t *self = (sv_threaded_plugin_t *)plugin_handle;
+
+  if (!self || !stats || max_workers == 0 || !self->has_thread) return 0;
+
+  // There is one worker thread.
+  threaded_get_worker_stats(self, stats);
+
+  return 1;
+}
+
+/* Hashes are signed in the order they arrive, hence there are no deadlines. */
+SignedVideoReturnCode
+sv_interface_get_deadline_stats(void *plugin_handle, sv_deadline_stats_t *stats)
+{
+  (void)plugin_handle;
+  (void)stats;
+  return SV_NOT_SUPPORTED;
+}
+
 /* This function is called when a Signed Video session is created.
  * Here, a worker thread for signing is started.
  *
@@ -322,32 +469,34 @@ sv_interface_get_signature(void *plugin_handle,
 void *
 sv_interface_setup()
 {
-  GError *error = NULL;
   sv_threaded_plugin_t *self = calloc(1, sizeof(sv_threaded_plugin_t));
 
   if (!self) return NULL;
 
   // Initialize |self|.
-  self->plugin_state = THREADED_SIGNING_WAITS_FOR_HASH_TO_SIGN;
-  g_mutex_init(&(self->mutex));
-  g_cond_init(&(self->cond));
-
-  self->thread =
-      g_thread_try_new("signing-worker-thread", signing_worker_thread, (void *)self, &error);
-
-  if (!self->thread) goto catch_error;
-
-  // Wait for the thread to start before returning.
-  g_mutex_lock(&self->mutex);
-  // TODO: Consider using g_cond_wait_until() instead, to avoid deadlock.
-  while (!self->is_running) g_cond_wait(&self->cond, &self->mutex);
-
-  g_mutex_unlock(&self->mutex);
+  atomic_init(&self->is_running, true);
+  atomic_init(&self->num_requested, 0);
+  atomic_init(&self->num_signed, 0);
+  atomic_init(&self->wakeup_seq, 0);
+  atomic_init(&self->worker_is_sleeping, false);
+  atomic_init(&self->worker_tid, 0);
+  atomic_init(&self->busy_time_us, 0);
+  atomic_init(&self->num_signed_hashes, 0);
+  self->start_time_us = get_time_us();
+  self->signature_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (self->signature_fd < 0) goto catch_error;
+
+  if (pthread_create(&self->thread, NULL, signing_worker_thread, (void *)self) != 0) {
+    goto catch_error;
+  }
+  self->has_thread = true;
+  // Naming the thread is only for convenience, hence failures are ignored.
+  pthread_setname_np(self->thread, WORKER_THREAD_NAME);
 
   return (void *)self;
 
 catch_error:
-  g_error_free(error);
+  if (self->signature_fd >= 0) close(self->signature_fd);
   free(self);
   return NULL;
 }
@@ -357,23 +506,17 @@ sv_interface_teardown(void *plugin_handle)
 {
   sv_threaded_plugin_t *self = (sv_threaded_plugin_t *)plugin_handle;
 
-  g_mutex_lock(&self->mutex);
+  if (!self) return;
 
-  if (!self->thread) {
-    g_mutex_unlock(&self->mutex);
-    goto done;
+  if (self->has_thread) {
+    // The worker thread finishes the hash it is signing, if any, and then stops.
+    atomic_store(&self->is_running, false);
+    wake_up_worker(self);
+    pthread_join(self->thread, NULL);
+    self->has_thread = false;
   }
 
-  GThread *thread = self->thread;
-
-  self->is_running = false;
-  self->thread = NULL;
-  g_cond_signal(&self->cond);
-  g_mutex_unlock(&self->mutex);
-
-  g_thread_join(thread);
-
-done:
+  close(self->signature_fd);
   sv_threaded_plugin_reset(self);
   free(self);
 }
@@ -115,6 +115,41 @@ sv_interface_get_signature(void *plugin_handle,
   return has_signature;
 }
 
+/* The signature is generated at once when signing, hence there is nothing to wait for. */
+int
+sv_interface_get_signature_fd(void *plugin_handle)
+{
+  (void)plugin_handle;
+  return -1;
+}
+
+/* Signing is done in the calling thread, hence there are no worker threads to configure. */
+SignedVideoReturnCode
+sv_interface_set_worker_config(void *plugin_handle, const sv_worker_config_t *config)
+{
+  (void)plugin_handle;
+  (void)config;
+  return SV_NOT_SUPPORTED;
+}
+
+size_t
+sv_interface_get_worker_stats(void *plugin_handle, sv_worker_stats_t *stats, size_t max_workers)
+{
+  (void)plugin_handle;
+  (void)stats;
+  (void)max_workers;
+  return 0;
+}
+
+/* Signing is done at once, hence there are no deadlines. */
+SignedVideoReturnCode
+sv_interface_get_deadline_stats(void *plugin_handle, sv_deadline_stats_t *stats)
+{
+  (void)plugin_handle;
+  (void)stats;
+  return SV_NOT_SUPPORTED;
+}
+
 void *
 sv_interface_setup()
 {
@@ -23,7 +23,7 @@
 #define __SIGNED_VIDEO_AUTH_H__
 
 #include <stdbool.h>  // bool
-#include <stdint.h>  // uint8_t
+#include <stdint.h>  // uint8_t, uint64_t
 #include <string.h>  // size_t
 
 #include "signed_video_common.h"  // signed_video_t, SignedVideoReturnCode
@@ -94,6 +94,11 @@ typedef struct {
   // is still ignored.
   //   ..._..PP_P
   //         .._...PPP
+  bool is_provisional;
+  // The result was produced when the SEI arrived, before the NALU completing the GOP was received;
+  // See signed_video_set_early_verdict(...). A final result for the same GOP follows. In the
+  // |validation_str| above, pending NALUs which hashes were found in the SEI are shown with the
+  // status they are expected to get.
 } signed_video_latest_validation_t;
 
 /**
@@ -249,4 +254,274 @@ signed_video_add_nalu_and_authenticate(signed_video_t *self,
     size_t nalu_data_size,
     signed_video_authenticity_t **authenticity);
 
+/**
+ * @brief Add NALU data with a sequence number to the session from any thread
+ *
+ * This function is an alternative to signed_video_add_nalu_and_authenticate(...) for applications
+ * where several threads receive NALUs of the same stream, for example, one thread per network
+ * queue. Each NALU is tagged with its |sequence_number| in the stream, starting from 0 after
+ * signed_video_create(...) or signed_video_reset(...), and the threads may call this function
+ * concurrently and in any order.
+ *
+ * The NALU data is copied, parsed and hashed on the calling thread, hence the most expensive part
+ * of the work runs in parallel. The NALUs are then added to the session strictly in sequence order.
+ * If the NALU next in sequence is added by this call, the calling thread continues adding all
+ * NALUs next in sequence that have arrived, including NALUs from other threads, before returning.
+ * A NALU with a |sequence_number| far ahead of the NALU next in sequence blocks the calling thread
+ * until there is room for it.
+ *
+ * Every sequence number has to be added exactly once, otherwise the session waits forever for the
+ * missing NALU. Hence, NALUs lost before reaching the application should not be given a sequence
+ * number.
+ *
+ * When a NALU triggers a validation, a copy of the authenticity report is queued and can be
+ * fetched by any thread through signed_video_pop_authenticity_report(...).
+ *
+ * NOTE: This API should not be mixed with signed_video_add_nalu_and_authenticate(...) in the same
+ * session. Other APIs should not be called while NALUs are added.
+ *
+ * @param self Pointer to the signed_video_t object to update
+ * @param sequence_number The position of the NALU in the stream
+ * @param nalu_data Pointer to the H26x NALU data to be added
+ * @param nalu_data_size Size of the nalu_data
+ *
+ * @returns SV_OK The NALU was added. If the calling thread added NALUs to the session, all of them
+ *                were added successfully,
+ *          SV_INVALID_PARAMETER Invalid parameter,
+ *          SV_NOT_SUPPORTED The |sequence_number| has already been added,
+ *          Otherwise a failure from adding NALUs to the session on the calling thread. Note that
+ *          the failure may be caused by a NALU added by another thread.
+ */
+SignedVideoReturnCode
+signed_video_add_sequenced_nalu_and_authenticate(signed_video_t *self,
+    uint64_t sequence_number,
+    const uint8_t *nalu_data,
+    size_t nalu_data_size);
+
+/**
+ * @brief Pops the oldest authenticity report of sequenced NALUs
+ *
+ * Authenticity reports from validations triggered by NALUs added through
+ * signed_video_add_sequenced_nalu_and_authenticate(...) are queued in the order they were produced.
+ * This function pops the oldest one and can be called from any thread.
+ *
+ * @param self Pointer to the signed_video_t session.
+ *
+ * @returns The oldest authenticity report, or a NULL pointer if there are no reports. The user is
+ *          responsible for freeing it using signed_video_authenticity_report_free(...).
+ */
+signed_video_authenticity_t *
+signed_video_pop_authenticity_report(signed_video_t *self);
+
+/**
+ * @brief Enables early verdicts when the SEI arrives
+ *
+ * By default a GOP is validated when the NALU following its SEI has been received, since the hash
+ * of that NALU is part of the signature. With frame level signing (SV_AUTHENTICITY_LEVEL_FRAME)
+ * the signature can be verified, and the NALUs already received checked, as soon as the SEI
+ * arrives. If enabled, such a SEI triggers an additional authenticity report with
+ * |is_provisional| set, which saves one frame interval of latency for live monitoring. The
+ * validation of the GOP is then completed as usual, and reported, when the next NALU arrives.
+ *
+ * No early verdict is given for GOP level signing, for the first validation, for SEIs arriving
+ * late, or while waiting for the public key.
+ *
+ * The setting is kept upon signed_video_reset(...).
+ *
+ * @param self Pointer to the signed_video_t session.
+ * @param enable Set to true to enable early verdicts. Disabled by default.
+ *
+ * @returns SV_OK upon success, otherwise SV_INVALID_PARAMETER.
+ */
+SignedVideoReturnCode
+signed_video_set_early_verdict(signed_video_t *self, bool enable);
+
+/**
+ * @brief Sets the size of the verification cache
+ *
+ * The session keeps the outcomes of the latest signature verifications. When a user scrubs back and
+ * forth over the same part of a recording, the SEIs already verified are then looked up instead of
+ * verified once more with the public key, which is the most expensive part of a validation. The
+ * NALUs are still hashed, hence a modified NALU is always detected. The least recently used
+ * outcome is replaced when the cache is full. The cache is kept upon signed_video_reset(...), and
+ * cleared if the public key changes.
+ *
+ * A cache of 64 outcomes is used by default. Changing the size empties the cache.
+ *
+ * @param self Pointer to the signed_video_t session.
+ * @param num_entries The number of outcomes to keep. Set to 0 to disable the cache.
+ *
+ * @returns SV_OK            - the size was successfully set,
+ *          SV_MEMORY        - the cache could not be allocated, the previous cache is kept,
+ *          otherwise a different error code.
+ */
+SignedVideoReturnCode
+signed_video_set_verification_cache_size(signed_video_t *self, size_t num_entries);
+
+/**
+ * @brief Resets the session after a seek
+ *
+ * A seek-aware version of signed_video_reset(...) to be used when scrubbing the video. Only the
+ * states of pending GOPs are dropped. The session-wide data, that is, the public key and the
+ * product info, is kept, hence the validation does not have to wait for the next SEI carrying that
+ * data.
+ *
+ * A seek is always done to an I-frame. If the stream resumes at the SEI preceding the I-frame, as
+ * with the access unit format, that SEI completes the GOP before the seek point. That GOP is
+ * validated silently without an authenticity report. The first report is then the definitive
+ * verdict of the first complete GOP after the seek point, instead of an
+ * SV_AUTH_RESULT_SIGNATURE_PRESENT for the GOP before. Otherwise, the validation starts over as
+ * after signed_video_reset(...).
+ *
+ * @param self Pointer to the signed_video_t session.
+ *
+ * @returns SV_OK            - the session was successfully reset,
+ *          SV_NOT_SUPPORTED - the session is registered to a validation service,
+ *          otherwise a different error code.
+ */
+SignedVideoReturnCode
+signed_video_reset_after_seek(signed_video_t *self);
+
+/**
+ * @brief Validates a range of GOPs
+ *
+ * signed_video_add_nalu_and_authenticate(...) assumes that the NALUs are added from the start of
+ * the stream. When starting in the middle of a stream, the first validation is not trusted, since
+ * the first SEI may sign NALUs that were never added. This API instead validates an explicit range
+ * of GOPs, for example, located through a GOP index; See signed_video_gop_index.h. The |data| has
+ * to start at the GOP boundary, that is, at the SEI completing the GOP before the range, which is
+ * followed by the first NALU of the range. The validation of that previous GOP is discarded, hence
+ * all GOPs in the range get definitive verdicts.
+ *
+ * The |data| is an Annex B byte stream, for example, a part of a memory mapped recording. NALUs
+ * are added from the start of |data| until |num_gops| GOPs have been validated, or the end of
+ * |data| is reached. Note that a GOP is validated when its SEI and the NALU after it have been
+ * added, and that the public key may be transmitted in a later SEI. Hence, let |data| extend beyond
+ * the range, preferably to the end of the recording. SEIs delayed past the next GOP boundary are
+ * not supported.
+ *
+ * The session is reset before the validation starts, but keeps the public key, if already
+ * received. The |data| is only read, hence several sessions can validate ranges of the same data
+ * concurrently. A session validating a range cannot be registered to a validation service.
+ *
+ * Example code of usage with a GOP index, validating the GOPs of records |first| to |last|:
+ *
+ *   sv_gop_index_record_t boundary;
+ *   signed_video_gop_index_get_record(index, index_size, first - 1, &boundary);
+ *   SignedVideoAuthenticityResult results[last - first + 1];
+ *   size_t num_validated_gops = 0;
+ *   signed_video_validate_gop_range(sv, recording + boundary.sei_offset,
+ *       recording_size - boundary.sei_offset, results, last - first + 1, &num_validated_gops);
+ *
+ * @param self Pointer to the signed_video_t session.
+ * @param data Pointer to the byte stream, starting at the SEI completing the GOP before the range.
+ * @param data_size Size of |data|.
+ * @param results Array of at least |num_gops| elements, in which the verdicts are written in GOP
+ *   order.
+ * @param num_gops Number of GOPs to validate.
+ * @param num_validated_gops Pointer to the number of GOPs that were validated, which is less than
+ *   |num_gops| if |data| ended before the range was validated.
+ *
+ * @returns SV_OK            - the range was processed successfully,
+ *          SV_NOT_SUPPORTED - the session is registered to a validation service,
+ *          otherwise a different error code.
+ */
+SignedVideoReturnCode
+signed_video_validate_gop_range(signed_video_t *self,
+    const uint8_t *data,
+    size_t data_size,
+    SignedVideoAuthenticityResult *results,
+    size_t num_gops,
+    size_t *num_validated_gops);
+
+/**
+ * @brief Gets a checkpoint of the validation
+ *
+ * A checkpoint lets a validation of a long recording be paused, and resumed later in another
+ * session, for example, after a process restart. The checkpoint is a compact, versioned, byte
+ * array holding the session-wide data decoded so far, that is, the public key, the product info and
+ * the GOP counter, together with the position where to resume.
+ *
+ * A checkpoint is always taken at the latest GOP boundary. The position |resume_nalu_idx| is the
+ * number of NALUs added before the SEI completing the latest validated GOP, counted from the start,
+ * or the latest reset. When resuming, the NALUs are added from that SEI. NALUs added after it are
+ * added again, and their GOP is validated as if there was no pause. SEIs delayed past the next GOP
+ * boundary are not supported. If no GOP has been validated yet, the validation resumes from the
+ * start of the stream.
+ *
+ * Call the function with |checkpoint| set to NULL to get the required size.
+ *
+ * Example code of usage:
+ *
+ *   size_t checkpoint_size = 0;
+ *   uint64_t resume_nalu_idx = 0;
+ *   signed_video_get_checkpoint(sv, NULL, &checkpoint_size, NULL);
+ *   uint8_t *checkpoint = malloc(checkpoint_size);
+ *   signed_video_get_checkpoint(sv, checkpoint, &checkpoint_size, &resume_nalu_idx);
+ *   // Store |checkpoint| and |resume_nalu_idx|. Later, in a new session:
+ *   signed_video_restore_checkpoint(sv, checkpoint, checkpoint_size);
+ *   // Add NALUs from position |resume_nalu_idx| of the stream.
+ *
+ * @param self Pointer to the signed_video_t session.
+ * @param checkpoint Pointer to memory where the checkpoint is written, or NULL to get the size.
+ * @param checkpoint_size Pointer to the size of |checkpoint|, which is updated with the written,
+ *   or required, size.
+ * @param resume_nalu_idx Pointer to where the position to resume from is written. Can be NULL.
+ *
+ * @returns SV_OK            - the checkpoint, or its size, was successfully written,
+ *          SV_NOT_SUPPORTED - the session is registered to a validation service,
+ *          otherwise a different error code.
+ */
+SignedVideoReturnCode
+signed_video_get_checkpoint(signed_video_t *self,
+    uint8_t *checkpoint,
+    size_t *checkpoint_size,
+    uint64_t *resume_nalu_idx);
+
+/**
+ * @brief Restores a checkpoint of the validation
+ *
+ * Resets the session and restores the state from a checkpoint; See signed_video_get_checkpoint().
+ * The NALUs should then be added from the position given by the checkpoint. The GOP completed by
+ * the first SEI was reported before the checkpoint was taken, and is not reported again.
+ *
+ * @param self Pointer to the signed_video_t session.
+ * @param checkpoint Pointer to the checkpoint.
+ * @param checkpoint_size Size of |checkpoint|.
+ *
+ * @returns SV_OK                   - the checkpoint was successfully restored,
+ *          SV_INVALID_PARAMETER    - invalid parameter, or the |checkpoint| is malformed,
+ *          SV_INCOMPATIBLE_VERSION - the |checkpoint| has an unknown version,
+ *          SV_NOT_SUPPORTED        - the session is registered to a validation service,
+ *          otherwise a different error code.
+ */
+SignedVideoReturnCode
+signed_video_restore_checkpoint(signed_video_t *self,
+    const uint8_t *checkpoint,
+    size_t checkpoint_size);
+
+/**
+ * @brief Adds a SEI from a detached SEI stream
+ *
+ * In detached mode the SEIs are carried in a sidecar stream instead of the video; See
+ * signed_video_detached.h. The sidecar records are added with this API side by side with the
+ * video, and the SEIs are validated as if they were part of the video. A SEI is copied and held
+ * until the video NALU at its position is added through signed_video_add_nalu_and_authenticate(),
+ * and is then added in front of that NALU. Hence, add the records at least as early as the video
+ * NALUs they belong to, in stream order. The positions count the video NALUs added since the
+ * start of the session, or the latest reset, which also drops any held SEIs.
+ *
+ * @param self Pointer to the signed_video_t session.
+ * @param record Pointer to the serialized record.
+ * @param record_size Size of |record|.
+ *
+ * @returns SV_OK                   - the SEI is held until its position in the video is reached,
+ *          SV_INVALID_PARAMETER    - invalid parameter, or the record is malformed or out of order,
+ *          SV_INCOMPATIBLE_VERSION - the record has an unknown version,
+ *          SV_NOT_SUPPORTED        - the session is registered to a validation service,
+ *          otherwise a different error code.
+ */
+SignedVideoReturnCode
+signed_video_add_detached_sei(signed_video_t *self, const uint8_t *record, size_t record_size);
+
 #endif  // __SIGNED_VIDEO_AUTH_H__
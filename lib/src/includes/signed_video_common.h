@@ -74,6 +74,9 @@ signed_video_create(SignedVideoCodec codec);
  * All memory allocated to and by the signed_video_t object will be freed. This will affectivly end
  * the signed video session.
  *
+ * If the session is registered to a validation service, it is first removed from the service as
+ * through signed_video_service_remove_session(), which blocks until all its NALUs are validated.
+ *
  * @param self Pointer to the object which memory to free.
  */
 void
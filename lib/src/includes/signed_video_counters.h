@@ -0,0 +1,106 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2023 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next paragraph) shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __SIGNED_VIDEO_COUNTERS_H__
+#define __SIGNED_VIDEO_COUNTERS_H__
+
+#include <stdbool.h>  // bool
+#include <stdint.h>  // uint64_t
+
+#include "signed_video_common.h"  // SignedVideoReturnCode, signed_video_t
+
+/**
+ * Performance counters of a session, signing or validating. The counters are always on and cheap
+ * enough to be scraped periodically in production; See signed_video_get_counters().
+ *
+ * The counters cover the NALUs added through the session APIs. NALUs added with
+ * signed_video_add_sequenced_nalu_and_authenticate() are parsed and hashed on the producer threads,
+ * hence those hashes are counted, but the parsing and hashing are not part of the stage times.
+ */
+
+/**
+ * Stages of the processing, timed with a monotonic clock.
+ */
+typedef enum {
+  SV_STAGE_PARSE = 0,  // Parsing added NALUs.
+  SV_STAGE_HASH = 1,  // Hashing NALUs and updating the gop_hash.
+  SV_STAGE_TLV_ENCODE = 2,  // Encoding the TLVs of generated SEIs.
+  SV_STAGE_TLV_DECODE = 3,  // Decoding the TLVs of received SEIs.
+  SV_STAGE_SIGN = 4,  // Handing over hashes to the signing plugin, which may sign on other threads.
+  SV_STAGE_VERIFY = 5,  // Verifying signatures.
+  SV_STAGE_REPORT = 6,  // Creating authenticity reports.
+  SV_STAGE_NUM
+} SignedVideoStage;
+
+/**
+ * Counters of a session.
+ */
+typedef struct {
+  uint64_t num_i_nalus;  // Added I-NALUs, that is, slices of I-frames.
+  uint64_t num_p_nalus;  // Added P-NALUs, that is, slices of P- and B-frames.
+  uint64_t num_parameter_set_nalus;  // Added SPS, PPS and VPS NALUs.
+  uint64_t num_sei_nalus;  // Added SEIs, generated by Signed Video or not.
+  uint64_t num_other_nalus;  // Added NALUs of other types.
+  uint64_t num_invalid_nalus;  // Added NALUs which could not be parsed.
+  uint64_t num_hash_calls;  // NALUs hashed.
+  uint64_t num_hashed_bytes;  // Bytes of NALU data hashed.
+  uint64_t num_combination_hashes;  // Hashes of hashes, e.g., updates of the gop_hash.
+  uint64_t num_generated_seis;  // SEIs generated by a signing session.
+  uint64_t num_signatures;  // Signatures added to generated SEIs.
+  uint64_t num_dropped_seis;  // Generated SEIs dropped unsigned; See signed_video_get_counters().
+  uint64_t num_decoded_seis;  // SEIs decoded by a validating session.
+  uint64_t num_verifications;  // Signatures verified, not counting cached outcomes.
+  uint64_t num_verified_ok;  // Verifications where the signature matched.
+  uint64_t num_verified_not_ok;  // Verifications where the signature did not match.
+  uint64_t num_verification_errors;  // Verifications which could not be performed.
+  uint64_t num_reports;  // Authenticity reports created.
+  uint64_t max_nalu_list_length;  // High-water mark of the NALUs waiting for validation.
+  uint64_t max_pending_gops;
+  // High-water mark of the GOPs waiting for validation, or of the SEIs waiting for signatures.
+  uint64_t stage_time_ns[SV_STAGE_NUM];  // Cumulative time per SignedVideoStage in nanoseconds.
+} sv_counters_t;
+
+/**
+ * @brief Gets the performance counters of a session
+ *
+ * The counters are cumulative from the creation of the session, and are not affected by
+ * signed_video_reset(). For periodic scraping the counters can be reset when read. Then the
+ * high-water marks restart from the current levels.
+ *
+ * A SEI generated when the buffer of SEIs waiting for signatures is full is dropped. So is a SEI
+ * for which the signing plugin failed to produce a signature. Both are counted as
+ * |num_dropped_seis|, and lead to unsigned GOPs in the video.
+ *
+ * @param self Pointer to the Signed Video session.
+ * @param counters Pointer to the counters to fill in.
+ * @param reset Set to true to reset the counters after reading them.
+ *
+ * The counters can be read at any time, also while NALUs are added in sequence from other threads,
+ * e.g., by a validation service. The counters are then read in between two NALUs, and the call
+ * waits for the NALU being processed, if any.
+ *
+ * @returns SV_OK The counters were successfully read,
+ *          SV_INVALID_PARAMETER Invalid parameter.
+ */
+SignedVideoReturnCode
+signed_video_get_counters(signed_video_t *self, sv_counters_t *counters, bool reset);
+
+#endif  // __SIGNED_VIDEO_COUNTERS_H__
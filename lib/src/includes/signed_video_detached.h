@@ -0,0 +1,79 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2023 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next paragraph) shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __SIGNED_VIDEO_DETACHED_H__
+#define __SIGNED_VIDEO_DETACHED_H__
+
+#include <stdint.h>  // uint8_t, uint64_t
+#include <string.h>  // size_t
+
+#include "signed_video_common.h"  // SignedVideoReturnCode
+
+/**
+ * In detached mode the SEIs are not added to the video stream, but passed on as a separate stream
+ * of records, a sidecar; See signed_video_set_detached_sei_sink(). Hence, the bitrate of the video
+ * is unaffected, and the signatures survive transcoders and re-muxers stripping unknown SEIs. A
+ * validator adds the records side by side with the video; See signed_video_add_detached_sei().
+ *
+ * A record holds a SEI together with the position in the video stream the SEI belongs to, that is,
+ * the number of NALUs added for signing before the NALU the SEI would have been prepended to. The
+ * video NALUs have to be added to the validator as they were added for signing, since the position
+ * of a NALU is its number in the stream.
+ *
+ * Each record is serialized, with all integers in big endian, as
+ *
+ * | version (1) | reserved (3) | nalu_idx (8) | sei_size (4) | sei (sei_size) |
+ *
+ * Hence, a sidecar stored as the records back to back can be read sequentially.
+ */
+#define SV_DETACHED_SEI_HEADER_SIZE 16
+#define SV_DETACHED_SEI_VERSION 1
+
+/**
+ * A callback receiving serialized detached SEI records, one at a time, in stream order. The
+ * |record| is only valid during the call.
+ */
+typedef void (*sv_detached_sei_sink_t)(const uint8_t *record, size_t record_size, void *user_data);
+
+/**
+ * @brief Parses a serialized detached SEI record
+ *
+ * The |sei| points into |data|, hence no memory is allocated. The size of the record is
+ * SV_DETACHED_SEI_HEADER_SIZE + |sei_size|, which is where the next record of a sidecar starts.
+ *
+ * @param data Pointer to the serialized record.
+ * @param data_size Size of |data|. Can extend beyond the record.
+ * @param nalu_idx Pointer to the position in the video stream the SEI belongs to.
+ * @param sei Pointer to the SEI, including its start code.
+ * @param sei_size Pointer to the size of the SEI.
+ *
+ * @returns SV_OK The record was successfully parsed,
+ *          SV_INVALID_PARAMETER Invalid parameter, or |data| is too short,
+ *          SV_INCOMPATIBLE_VERSION The record has an unknown version.
+ */
+SignedVideoReturnCode
+signed_video_detached_sei_parse_record(const uint8_t *data,
+    size_t data_size,
+    uint64_t *nalu_idx,
+    const uint8_t **sei,
+    size_t *sei_size);
+
+#endif  // __SIGNED_VIDEO_DETACHED_H__
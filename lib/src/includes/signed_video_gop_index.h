@@ -0,0 +1,143 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2023 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next paragraph) shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __SIGNED_VIDEO_GOP_INDEX_H__
+#define __SIGNED_VIDEO_GOP_INDEX_H__
+
+#include <stdbool.h>  // bool
+#include <stdint.h>  // uint8_t, uint32_t, uint64_t
+#include <string.h>  // size_t
+
+#include "signed_video_common.h"  // SignedVideoReturnCode
+
+/**
+ * A GOP index is a sidecar to a signed video stream, for example, a recording, with one record per
+ * generated SEI. The records are produced by the signing side; See
+ * signed_video_set_gop_index_sink(). With the index a validator can jump straight to a GOP without
+ * scanning the stream for SEIs.
+ *
+ * Each record is serialized into SV_GOP_INDEX_RECORD_SIZE bytes, with all integers in big endian,
+ * as
+ *
+ * | version (1) | flags (1) | reserved (2) | gop_counter (4) | num_nalus (4) | sei_size (4) |
+ * | gop_offset (8) | sei_offset (8) | hash (32) |
+ *
+ * Hence, an index stored as the records back to back can be accessed randomly.
+ */
+#define SV_GOP_INDEX_RECORD_SIZE 64
+#define SV_GOP_INDEX_VERSION 1
+#define SV_GOP_INDEX_HASH_SIZE 32
+
+/**
+ * A parsed GOP index record.
+ *
+ * The byte offsets are counted from the first NALU added for signing, assuming that all added
+ * NALUs are written to the stream as is, and that the generated SEIs are prepended as instructed;
+ * See signed_video_get_nalu_to_prepend().
+ */
+typedef struct {
+  uint64_t gop_offset;
+  // Byte offset of the first NALU of the GOP, that is, the I-frame.
+  uint64_t sei_offset;
+  // Byte offset of the SEI signing the GOP.
+  uint32_t sei_size;
+  // Size of the SEI in bytes, including the start code.
+  uint32_t gop_counter;
+  // The GOP counter encoded in the SEI.
+  uint32_t num_nalus;
+  // Number of hashable NALUs added since the previous SEI, up to and including the NALU this SEI
+  // is prepended to.
+  bool is_intermediate;
+  // True if the SEI signs a part of a GOP; See signed_video_set_intermediate_sei_interval().
+  uint8_t hash[SV_GOP_INDEX_HASH_SIZE];
+  // The hash that was signed.
+} sv_gop_index_record_t;
+
+/**
+ * A callback receiving serialized GOP index records, one at a time, in the order the SEIs are
+ * added to the stream. The |record| is only valid during the call.
+ */
+typedef void (*sv_gop_index_sink_t)(const uint8_t *record, size_t record_size, void *user_data);
+
+/**
+ * @brief Parses a serialized GOP index record
+ *
+ * @param data Pointer to the serialized record.
+ * @param data_size Size of |data|. Must be at least SV_GOP_INDEX_RECORD_SIZE bytes.
+ * @param record Pointer to the record to fill in.
+ *
+ * @returns SV_OK The record was successfully parsed,
+ *          SV_INVALID_PARAMETER Invalid parameter,
+ *          SV_INCOMPATIBLE_VERSION The record has an unknown version.
+ */
+SignedVideoReturnCode
+signed_video_gop_index_parse_record(const uint8_t *data,
+    size_t data_size,
+    sv_gop_index_record_t *record);
+
+/**
+ * @brief Gets a record from an index
+ *
+ * @param index Pointer to the records, stored back to back.
+ * @param index_size Size of |index|.
+ * @param record_idx The position of the record in the index, starting at 0.
+ * @param record Pointer to the record to fill in.
+ *
+ * @returns SV_OK The record was successfully read,
+ *          SV_INVALID_PARAMETER Invalid parameter, or |record_idx| is out of range,
+ *          SV_INCOMPATIBLE_VERSION The record has an unknown version.
+ */
+SignedVideoReturnCode
+signed_video_gop_index_get_record(const uint8_t *index,
+    size_t index_size,
+    size_t record_idx,
+    sv_gop_index_record_t *record);
+
+/**
+ * @brief Finds the GOP containing a byte offset
+ *
+ * Searches the index for the latest GOP starting at, or before, |offset|, and gets the record of
+ * the SEI completing that GOP. If the GOP is split by intermediate SEIs, the first one is
+ * returned. The records are binary searched, hence the lookup time is logarithmic in the size of
+ * the index.
+ *
+ * To validate the video from |offset|, start at the SEI completing the GOP before, that is, at
+ * the |sei_offset| of the previous record; See signed_video_validate_gop_range().
+ *
+ * @param index Pointer to the records, stored back to back.
+ * @param index_size Size of |index|.
+ * @param offset The byte offset in the stream to search for.
+ * @param record Pointer to the record to fill in.
+ * @param record_idx Pointer to the position of the found record in the index. Can be NULL.
+ *
+ * @returns SV_OK A record was found,
+ *          SV_INVALID_PARAMETER Invalid parameter,
+ *          SV_NOT_SUPPORTED No GOP in the index starts before |offset|,
+ *          SV_INCOMPATIBLE_VERSION The index has records of an unknown version.
+ */
+SignedVideoReturnCode
+signed_video_gop_index_find(const uint8_t *index,
+    size_t index_size,
+    uint64_t offset,
+    sv_gop_index_record_t *record,
+    size_t *record_idx);
+
+#endif  // __SIGNED_VIDEO_GOP_INDEX_H__
@@ -59,8 +59,68 @@ struct _signature_info_t {
   size_t max_signature_size;  // The allocated size of the |signature|.
 };
 
+/**
+ * @brief Scheduling policy of a signing worker thread
+ *
+ * The policies map to the Linux scheduling policies with the same names. SV_SCHED_INHERIT leaves
+ * the policy inherited from the thread creating the session untouched.
+ */
+typedef enum {
+  SV_SCHED_INHERIT = 0,
+  SV_SCHED_OTHER = 1,
+  SV_SCHED_BATCH = 2,
+  SV_SCHED_IDLE = 3,
+  SV_SCHED_FIFO = 4,
+  SV_SCHED_RR = 5,
+  SV_SCHED_NUM
+} sv_sched_policy_t;
+
+/**
+ * Placement and priority of the signing worker thread(s) of a plugin.
+ *
+ * A zero initialized struct leaves everything as inherited from the thread creating the session.
+ */
+typedef struct {
+  uint64_t cpu_mask;  // The CPUs the worker may run on, bit n for CPU n. Zero keeps the affinity.
+  sv_sched_policy_t sched_policy;  // The scheduling policy of the worker.
+  int sched_priority;  // The real-time priority. Only used with SV_SCHED_FIFO and SV_SCHED_RR.
+  int nice;  // The nice value in [-20, 19]. Only used with SV_SCHED_OTHER and SV_SCHED_BATCH.
+  const char *name;  // The thread name of at most 15 characters. NULL keeps the default name.
+} sv_worker_config_t;
+
+/**
+ * Utilization of a signing worker thread.
+ *
+ * All values are accumulated since the worker was started. The utilization over a period is the
+ * difference in |busy_time_us| divided by the difference in |elapsed_time_us|.
+ */
+typedef struct {
+  uint64_t elapsed_time_us;  // Wall clock time since the worker was started.
+  uint64_t busy_time_us;  // Wall clock time spent signing.
+  uint64_t cpu_time_us;  // CPU time consumed by the worker.
+  uint64_t num_signed_hashes;  // The number of hashes the worker has signed.
+} sv_worker_stats_t;
+
+/**
+ * Deadline statistics of the signing in a session.
+ *
+ * A hash to sign has a deadline when the next hash of the session is expected, which is estimated
+ * from the observed cadence of hashes. A signature completed after its deadline is a missed
+ * deadline. All values are accumulated since the session was created.
+ */
+typedef struct {
+  uint64_t num_signed_hashes;  // The number of hashes signed for the session.
+  uint64_t num_missed_deadlines;  // The number of signatures completed after their deadline.
+  uint64_t max_lateness_us;  // The longest time a signature has been completed after its deadline.
+  uint64_t cadence_us;  // The current estimated time between two hashes. Zero if not yet known.
+} sv_deadline_stats_t;
+
 /**
  * Cryptography library calling interface APIs are declared here.
+ *
+ * The interfaces marked as optional may be left out by a plugin, whether loaded at runtime or built
+ * into the library. The built-in plugin gets default implementations of them through weak symbols,
+ * except on Windows where it has to define all interfaces.
  */
 
 /**
@@ -103,6 +163,74 @@ sv_interface_get_signature(void *plugin_handle,
     size_t *written_signature_size,
     SignedVideoReturnCode *error);
 
+/**
+ * @brief Gets a file descriptor signaling available signatures
+ *
+ * This function should return a file descriptor, which becomes readable when there is a signature
+ * to get with sv_interface_get_signature(...). The file descriptor is owned by the plugin, and it
+ * is up to the plugin to clear it when all available signatures have been collected. The user may
+ * poll it, e.g., using epoll, to get signatures without waiting for the next NALU.
+ *
+ * A plugin that generates the signature in sv_interface_sign_hash(...) has no need for a file
+ * descriptor and should return -1. The interface is optional, and a plugin without it is treated as
+ * returning -1.
+ *
+ * @param plugin_handle A pointer to the handle for the plugin, generated by sv_interface_setup().
+ *
+ * @returns A readable file descriptor, or -1 if the plugin does not support it.
+ */
+int
+sv_interface_get_signature_fd(void *plugin_handle);
+
+/**
+ * @brief Configures the signing worker threads
+ *
+ * This function should apply the CPU affinity, scheduling policy and thread name in |config| to
+ * all worker threads of the plugin. If the |config| cannot be applied in full, the plugin should
+ * apply as much as possible and report the failure.
+ *
+ * A plugin that has no worker threads should return SV_NOT_SUPPORTED. The interface is optional.
+ *
+ * @param plugin_handle A pointer to the handle for the plugin, generated by sv_interface_setup().
+ * @param config A pointer to the configuration to apply.
+ *
+ * @returns SV_OK upon success, SV_NOT_SUPPORTED if the plugin has no worker threads, and an
+ *   adequate value upon failure.
+ */
+SignedVideoReturnCode
+sv_interface_set_worker_config(void *plugin_handle, const sv_worker_config_t *config);
+
+/**
+ * @brief Gets the utilization of the signing worker threads
+ *
+ * This function should write the statistics of at most |max_workers| worker threads to |stats|.
+ *
+ * A plugin that has no worker threads should return 0. The interface is optional.
+ *
+ * @param plugin_handle A pointer to the handle for the plugin, generated by sv_interface_setup().
+ * @param stats An array of at least |max_workers| elements to which the statistics are written.
+ * @param max_workers The number of elements in |stats|.
+ *
+ * @returns The number of elements written to |stats|.
+ */
+size_t
+sv_interface_get_worker_stats(void *plugin_handle, sv_worker_stats_t *stats, size_t max_workers);
+
+/**
+ * @brief Gets the deadline statistics of the session
+ *
+ * A plugin scheduling the signing by deadlines should write the statistics of the session to
+ * |stats|. Other plugins should return SV_NOT_SUPPORTED. The interface is optional.
+ *
+ * @param plugin_handle A pointer to the handle for the plugin, generated by sv_interface_setup().
+ * @param stats A pointer to where the statistics are written.
+ *
+ * @returns SV_OK upon success, SV_NOT_SUPPORTED if the plugin has no deadlines, and an adequate
+ *   value upon failure.
+ */
+SignedVideoReturnCode
+sv_interface_get_deadline_stats(void *plugin_handle, sv_deadline_stats_t *stats);
+
 /**
  * @brief Sets up the signing plugin
  *
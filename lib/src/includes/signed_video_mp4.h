@@ -0,0 +1,119 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2023 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next paragraph) shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __SIGNED_VIDEO_MP4_H__
+#define __SIGNED_VIDEO_MP4_H__
+
+#include <stdint.h>  // uint8_t
+#include <string.h>  // size_t
+
+#include "signed_video_auth.h"  // SignedVideoAuthenticityResult
+#include "signed_video_common.h"  // SignedVideoCodec, SignedVideoReturnCode
+
+/**
+ * A reader of MP4 (ISO-BMFF) files, for example, recordings exported from a VMS, in which the
+ * NALUs are stored length prefixed. It locates the samples of the video track through the sample
+ * tables of the 'moov' box, and feeds the NALUs into validation without copying them to Annex B
+ * form. The codec is detected from the 'avcC' or 'hvcC' box of the track.
+ *
+ * Only progressive files are supported, that is, fragmented files ('moof' boxes) are not. It is
+ * assumed that the SEIs are stored in the same sample as the I-frame they precede, which is the
+ * case when the signed stream is muxed access unit by access unit.
+ */
+typedef struct _sv_mp4_t sv_mp4_t;
+
+/**
+ * @brief Opens an MP4 file
+ *
+ * The file is memory mapped and read only, hence several validations can run on the same file at
+ * the same time. Not supported on Windows; See signed_video_mp4_open_buffer().
+ *
+ * @param path The path to the file.
+ * @param mp4 Pointer to the opened file. Close it with signed_video_mp4_close().
+ *
+ * @returns SV_OK The file was successfully opened and has a supported video track,
+ *          SV_INVALID_PARAMETER Invalid parameter, or the file could not be opened,
+ *          SV_NOT_SUPPORTED The file has no supported video track, or is fragmented,
+ *          SV_MEMORY Failed allocating memory.
+ */
+SignedVideoReturnCode
+signed_video_mp4_open(const char *path, sv_mp4_t **mp4);
+
+/**
+ * @brief Opens an MP4 file already in memory
+ *
+ * As signed_video_mp4_open(), but reads the file from |data|, which has to outlive |mp4|.
+ */
+SignedVideoReturnCode
+signed_video_mp4_open_buffer(const uint8_t *data, size_t data_size, sv_mp4_t **mp4);
+
+/**
+ * @brief Closes an MP4 file
+ *
+ * @param mp4 Pointer to the file to close.
+ */
+void
+signed_video_mp4_close(sv_mp4_t *mp4);
+
+/**
+ * @brief Gets the codec of the video track
+ *
+ * @param mp4 Pointer to the opened file.
+ * @param codec Pointer to the codec, detected from the 'avcC' or 'hvcC' box.
+ *
+ * @returns SV_OK The codec was successfully detected,
+ *          SV_INVALID_PARAMETER Invalid parameter.
+ */
+SignedVideoReturnCode
+signed_video_mp4_get_codec(const sv_mp4_t *mp4, SignedVideoCodec *codec);
+
+/**
+ * @brief Validates the video track of an MP4 file
+ *
+ * Splits the video track at GOP boundaries, that is, at sync samples, into |num_parts| parts of
+ * about the same number of GOPs, and validates them in parallel, each in a session of its own. The
+ * verdicts of all validations are written to |results| in stream order. The GOP before the first
+ * SEI of the file cannot be validated, hence it is not reported. If the file has no sync sample
+ * table, the video track is validated in one part.
+ *
+ * The public key may not be sent in every SEI; See signed_video_set_recurrence_interval_frames().
+ * Hence, the parts after the first one get the public key from the first SEI of the file holding
+ * it, before they are validated.
+ *
+ * @param mp4 Pointer to the opened file.
+ * @param num_parts The number of parts to validate in parallel. 1 validates the file sequentially.
+ * @param results Array of at least |max_results| elements, in which the verdicts are written.
+ * @param max_results The number of elements of |results|.
+ * @param num_results Pointer to the number of validations, which may exceed |max_results|.
+ *
+ * @returns SV_OK The video track was validated,
+ *          SV_INVALID_PARAMETER Invalid parameter, or a sample is malformed,
+ *          SV_MEMORY Failed allocating memory,
+ *          otherwise a different error code.
+ */
+SignedVideoReturnCode
+signed_video_mp4_validate(const sv_mp4_t *mp4,
+    unsigned num_parts,
+    SignedVideoAuthenticityResult *results,
+    size_t max_results,
+    size_t *num_results);
+
+#endif  // __SIGNED_VIDEO_MP4_H__
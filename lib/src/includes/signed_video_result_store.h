@@ -0,0 +1,150 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2023 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next paragraph) shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __SIGNED_VIDEO_RESULT_STORE_H__
+#define __SIGNED_VIDEO_RESULT_STORE_H__
+
+#include <stdint.h>  // uint8_t, uint32_t, uint64_t
+#include <string.h>  // size_t
+
+#include "signed_video_auth.h"  // SignedVideoAuthenticityResult
+#include "signed_video_common.h"  // SignedVideoReturnCode, signed_video_t
+
+/**
+ * A result store holds the verdicts of a validated recording, with one record per validated GOP.
+ * It lets an application skip a full validation when the same recording is opened again, for
+ * example, in an evidence management system.
+ *
+ * The records are produced by signed_video_validate_and_store_results(). Each record holds the
+ * verdict of a GOP together with the position and a digest of the SEI completing it. When the
+ * recording is opened again, signed_video_result_store_check() confirms that all SEIs, including
+ * their signatures, are unchanged by reading the SEIs at the stored positions only. No other NALU
+ * is read or hashed.
+ *
+ * Note that a check does not detect NALUs modified in between the SEIs. The store is meant to be
+ * kept by the application, in a trusted location, and keyed by the identity of the recording, for
+ * example, its size and modification time. If the identity has changed, or the check fails, the
+ * recording should be validated again.
+ *
+ * Each record is serialized into SV_RESULT_RECORD_SIZE bytes, with all integers in big endian, as
+ *
+ * | version (1) | authenticity (1) | reserved (2) | gop_counter (4) | sei_offset (8) |
+ * | sei_size (4) | expected_nalus (4) | received_nalus (4) | reserved (4) | sei_digest (32) |
+ *
+ * Hence, a store is the records back to back.
+ */
+#define SV_RESULT_RECORD_SIZE 64
+#define SV_RESULT_RECORD_VERSION 1
+#define SV_RESULT_DIGEST_SIZE 32
+
+/**
+ * A parsed result record.
+ */
+typedef struct {
+  SignedVideoAuthenticityResult authenticity;
+  // The verdict of the GOP.
+  uint32_t gop_counter;
+  // The GOP counter encoded in the SEI.
+  uint64_t sei_offset;
+  // Byte offset of the SEI completing the GOP, including the start code.
+  uint32_t sei_size;
+  // Size of the SEI in bytes, including the start code. Zero if the GOP was not signed.
+  int32_t number_of_expected_picture_nalus;
+  // As in signed_video_latest_validation_t.
+  int32_t number_of_received_picture_nalus;
+  // As in signed_video_latest_validation_t.
+  uint8_t sei_digest[SV_RESULT_DIGEST_SIZE];
+  // SHA-256 digest of the SEI.
+} sv_result_record_t;
+
+/**
+ * A callback receiving serialized result records, one at a time, in stream order. The |record| is
+ * only valid during the call.
+ */
+typedef void (*sv_result_sink_t)(const uint8_t *record, size_t record_size, void *user_data);
+
+/**
+ * @brief Validates a recording and stores the results
+ *
+ * Validates the recording |data|, an Annex B byte stream, from its start and passes one result
+ * record per validated GOP to the |sink|. The session is reset before the validation starts, and
+ * provisional results are not stored; See signed_video_set_early_verdict(). SEIs delayed past the
+ * next GOP boundary are not supported.
+ *
+ * @param self Pointer to the signed_video_t session.
+ * @param data Pointer to the recording.
+ * @param data_size Size of |data|.
+ * @param sink The callback receiving the records.
+ * @param user_data Passed on to |sink|.
+ *
+ * @returns SV_OK            - the recording was validated,
+ *          SV_NOT_SUPPORTED - the session is registered to a validation service,
+ *          otherwise a different error code.
+ */
+SignedVideoReturnCode
+signed_video_validate_and_store_results(signed_video_t *self,
+    const uint8_t *data,
+    size_t data_size,
+    sv_result_sink_t sink,
+    void *user_data);
+
+/**
+ * @brief Parses a serialized result record
+ *
+ * @param data Pointer to the serialized record.
+ * @param data_size Size of |data|. Must be at least SV_RESULT_RECORD_SIZE bytes.
+ * @param record Pointer to the record to fill in.
+ *
+ * @returns SV_OK The record was successfully parsed,
+ *          SV_INVALID_PARAMETER Invalid parameter,
+ *          SV_INCOMPATIBLE_VERSION The record has an unknown version.
+ */
+SignedVideoReturnCode
+signed_video_result_store_parse_record(const uint8_t *data,
+    size_t data_size,
+    sv_result_record_t *record);
+
+/**
+ * @brief Checks that a recording still matches its stored results
+ *
+ * Reads the SEI of each record in |results| from the recording |data| and compares its digest with
+ * the stored one. If no record has changed, the stored verdicts can be used instead of validating
+ * the recording again.
+ *
+ * @param data Pointer to the recording.
+ * @param data_size Size of |data|.
+ * @param results Pointer to the records, stored back to back.
+ * @param results_size Size of |results|.
+ * @param num_changed_records Pointer to the number of records which SEI has changed, or is outside
+ *   of |data|.
+ *
+ * @returns SV_OK The check was performed,
+ *          SV_INVALID_PARAMETER Invalid parameter, or |results| has no records,
+ *          SV_INCOMPATIBLE_VERSION The store has records of an unknown version.
+ */
+SignedVideoReturnCode
+signed_video_result_store_check(const uint8_t *data,
+    size_t data_size,
+    const uint8_t *results,
+    size_t results_size,
+    size_t *num_changed_records);
+
+#endif  // __SIGNED_VIDEO_RESULT_STORE_H__
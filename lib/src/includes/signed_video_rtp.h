@@ -0,0 +1,151 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2023 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next paragraph) shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __SIGNED_VIDEO_RTP_H__
+#define __SIGNED_VIDEO_RTP_H__
+
+#include <stdint.h>  // uint8_t, uint16_t, uint64_t
+#include <string.h>  // size_t
+
+#include "signed_video_auth.h"  // signed_video_authenticity_t
+#include "signed_video_common.h"  // signed_video_t, SignedVideoReturnCode
+
+/**
+ * A depacketizer of RTP packets carrying H.264 (RFC 6184) or H.265 (RFC 7798), adding the NALUs to
+ * a validation session as they are received. Single NALU packets and the NALUs of aggregation
+ * packets (STAP-A and AP) are added in place, without copying. Fragmentation units (FU-A and FU)
+ * are gathered into one reusable buffer, and the NALU is added when its last fragment arrives.
+ *
+ * Lost packets are detected through gaps in the RTP sequence number. A NALU with a lost fragment is
+ * dropped, whereas fully lost NALUs never reach the session. Either way the validation reports the
+ * NALUs as missing. Late and duplicate packets are ignored. Aggregation packets with decoding order
+ * numbers (sprop-max-don-diff > 0), STAP-B, MTAP, FU-B and PACI packets are not supported.
+ *
+ * The depacketizer follows one stream at a time. A packet with a new SSRC, or two packets in
+ * sequence far behind the expected sequence number, are taken as the sender restarting, and the
+ * depacketizer resynchronizes to the new sequence numbers without counting lost packets; See
+ * RFC 3550, Appendix A.1.
+ *
+ * For offline use, recorded streams can be added from pcap files; See
+ * signed_video_rtp_depacketizer_add_pcap().
+ */
+typedef struct _sv_rtp_depacketizer_t sv_rtp_depacketizer_t;
+
+/**
+ * A callback receiving the authenticity reports of the validation, in order. The callback takes
+ * ownership of the |report|; See signed_video_authenticity_report_free().
+ */
+typedef void (*sv_rtp_report_cb_t)(signed_video_authenticity_t *report, void *user_data);
+
+/**
+ * Statistics of a depacketizer.
+ */
+typedef struct {
+  uint64_t num_packets;  // RTP packets added.
+  uint64_t num_lost_packets;  // Packets missing in the sequence numbers.
+  uint64_t num_ignored_packets;  // Late and duplicate packets.
+  uint64_t num_nalus;  // NALUs added for validation.
+  uint64_t num_dropped_nalus;  // Fragmented NALUs dropped due to lost packets.
+  uint64_t num_resyncs;  // Restarts of the stream, from a new SSRC or sequence numbering.
+} sv_rtp_stats_t;
+
+/**
+ * @brief Creates an RTP depacketizer
+ *
+ * @param sv The validation session to add the NALUs to. The session has to outlive the
+ *   depacketizer, and the packets are depacketized according to its codec.
+ * @param report_cb The callback receiving the authenticity reports. Can be NULL.
+ * @param user_data User data passed on to |report_cb|.
+ *
+ * @returns A pointer to the depacketizer, or NULL upon failure.
+ */
+sv_rtp_depacketizer_t *
+signed_video_rtp_depacketizer_create(signed_video_t *sv,
+    sv_rtp_report_cb_t report_cb,
+    void *user_data);
+
+/**
+ * @brief Frees an RTP depacketizer
+ *
+ * A partially received fragmented NALU is dropped.
+ *
+ * @param rtp Pointer to the depacketizer to free.
+ */
+void
+signed_video_rtp_depacketizer_free(sv_rtp_depacketizer_t *rtp);
+
+/**
+ * @brief Adds an RTP packet
+ *
+ * The packets should be added in sequence number order, as received from the network, for example,
+ * an RTSP session using RTP over UDP, or interleaved over TCP with the '$' framing removed.
+ *
+ * @param rtp Pointer to the depacketizer.
+ * @param packet Pointer to the RTP packet, including the RTP header.
+ * @param packet_size Size of |packet|.
+ *
+ * @returns SV_OK The packet was successfully added,
+ *          SV_INVALID_PARAMETER Invalid parameter, or a malformed packet,
+ *          SV_NOT_SUPPORTED The packet type is not supported,
+ *          SV_MEMORY Failed allocating memory,
+ *          otherwise a different error code from the validation.
+ */
+SignedVideoReturnCode
+signed_video_rtp_depacketizer_add_packet(sv_rtp_depacketizer_t *rtp,
+    const uint8_t *packet,
+    size_t packet_size);
+
+/**
+ * @brief Adds the RTP packets of a pcap file
+ *
+ * Reads a classic pcap file, in either byte order, with Ethernet frames, and adds the UDP payloads
+ * sent to |udp_port| as RTP packets. IPv4 and IPv6, without extension headers, are supported, as
+ * well as 802.1Q VLAN tags. The pcapng format is not supported.
+ *
+ * @param rtp Pointer to the depacketizer.
+ * @param data Pointer to the content of the pcap file.
+ * @param data_size Size of |data|.
+ * @param udp_port The UDP destination port of the RTP stream. If 0, all UDP packets are added.
+ *
+ * @returns SV_OK The file was successfully read,
+ *          SV_INVALID_PARAMETER Invalid parameter, or a malformed file,
+ *          SV_NOT_SUPPORTED The file format or link type is not supported,
+ *          otherwise a different error code from signed_video_rtp_depacketizer_add_packet().
+ */
+SignedVideoReturnCode
+signed_video_rtp_depacketizer_add_pcap(sv_rtp_depacketizer_t *rtp,
+    const uint8_t *data,
+    size_t data_size,
+    uint16_t udp_port);
+
+/**
+ * @brief Gets the statistics of an RTP depacketizer
+ *
+ * @param rtp Pointer to the depacketizer.
+ * @param stats Pointer to the statistics to fill in.
+ *
+ * @returns SV_OK The statistics were successfully read,
+ *          SV_INVALID_PARAMETER Invalid parameter.
+ */
+SignedVideoReturnCode
+signed_video_rtp_depacketizer_get_stats(const sv_rtp_depacketizer_t *rtp, sv_rtp_stats_t *stats);
+
+#endif  // __SIGNED_VIDEO_RTP_H__
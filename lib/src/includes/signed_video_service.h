@@ -0,0 +1,175 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2023 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next paragraph) shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __SIGNED_VIDEO_SERVICE_H__
+#define __SIGNED_VIDEO_SERVICE_H__
+
+#include <stdint.h>  // uint8_t
+#include <string.h>  // size_t
+
+#include "signed_video_common.h"  // signed_video_t, SignedVideoReturnCode
+
+typedef struct _signed_video_service_t signed_video_service_t;
+
+/**
+ * @brief Creates a validation service
+ *
+ * A validation service owns a pool of worker threads that validates NALUs of many signed video
+ * sessions, for example, one session per camera in a recorder. NALUs added to a registered session
+ * are parsed, hashed and validated by the workers, while the NALUs of each session are added to the
+ * session strictly in the order they were added to the service. Hence, the throughput scales with
+ * the number of workers, regardless of how many threads deliver the NALUs and how the load is
+ * distributed over the sessions.
+ *
+ * Each session has a home worker, which picks the NALUs of that session first. Idle workers steal
+ * NALUs from other workers, so a few sessions with high bitrate can occupy all workers.
+ * The signatures of a registered session are verified on the worker validating the session,
+ * instead of on threads of its own. Hence, the service never uses more threads than its workers.
+ *
+ * The user is responsible to free the memory at the end by calling signed_video_service_free().
+ *
+ * Example code of usage:
+ *
+ *   signed_video_service_t *service = signed_video_service_create(0);
+ *   signed_video_t *sv = signed_video_create(SV_CODEC_H264);
+ *   if (signed_video_service_add_session(service, sv) != SV_OK) {
+ *     // Handle error
+ *   }
+ *   while (still_nalus_remaining) {
+ *     if (signed_video_service_add_nalu(service, sv, nalu_data, nalu_data_size) != SV_OK) {
+ *       // Handle error
+ *     }
+ *     signed_video_authenticity_t *auth_report = signed_video_pop_authenticity_report(sv);
+ *     while (auth_report) {
+ *       // Act on the report and free it
+ *       signed_video_authenticity_report_free(auth_report);
+ *       auth_report = signed_video_pop_authenticity_report(sv);
+ *     }
+ *   }
+ *   signed_video_service_remove_session(service, sv);
+ *   signed_video_free(sv);
+ *   signed_video_service_free(service);
+ *
+ * @param num_workers The number of worker threads. Set to 0 to use one worker per online CPU.
+ *
+ * @returns A pointer to the service, or NULL upon failure. Always NULL on Windows, where the
+ *          service is not supported.
+ */
+signed_video_service_t *
+signed_video_service_create(unsigned num_workers);
+
+/**
+ * @brief Frees a validation service
+ *
+ * All NALUs already added are validated before the workers are stopped. Sessions still
+ * registered are removed from the service, but not freed.
+ *
+ * @param service Pointer to the service.
+ */
+void
+signed_video_service_free(signed_video_service_t *service);
+
+/**
+ * @brief Registers a session to a validation service
+ *
+ * After registration, NALUs of the session should only be added through
+ * signed_video_service_add_nalu(...). Authenticity reports are fetched through
+ * signed_video_pop_authenticity_report(...). Other APIs operating on the session, including
+ * signed_video_reset(...), should not be called while the session is registered.
+ *
+ * A session can only be registered to one service at a time.
+ *
+ * @param service Pointer to the service.
+ * @param sv Pointer to the session to register.
+ *
+ * @returns SV_OK The session was registered,
+ *          SV_INVALID_PARAMETER Invalid parameter,
+ *          SV_NOT_SUPPORTED The session is already registered to a service,
+ *          SV_MEMORY Failed allocating memory.
+ */
+SignedVideoReturnCode
+signed_video_service_add_session(signed_video_service_t *service, signed_video_t *sv);
+
+/**
+ * @brief Removes a session from a validation service
+ *
+ * Blocks until all NALUs of the session have been validated. Authenticity reports not yet popped
+ * remain in the session. After removal the session can be freed, or used as usual. Freeing a
+ * session still registered removes it first.
+ *
+ * @param service Pointer to the service.
+ * @param sv Pointer to the session to remove.
+ *
+ * @returns SV_OK The session was removed and all its NALUs validated successfully,
+ *          SV_INVALID_PARAMETER Invalid parameter, or the session is not registered to |service|,
+ *          Otherwise the first failure when validating NALUs of the session. The session has still
+ *          been removed.
+ */
+SignedVideoReturnCode
+signed_video_service_remove_session(signed_video_service_t *service, signed_video_t *sv);
+
+/**
+ * @brief Adds NALU data to a session registered to the service
+ *
+ * Same as signed_video_add_nalu_and_authenticate(...), but the NALU is validated asynchronously by
+ * the workers of the |service|. The NALU data is copied, hence the memory can be released when the
+ * call returns. NALUs of one session should be added in stream order, but can be added from any
+ * thread.
+ *
+ * If too many NALUs of the session are waiting to be validated, the call blocks until the workers
+ * have caught up.
+ *
+ * Failures when validating are not reported by this call, but by the next call to
+ * signed_video_service_flush(...) or signed_video_service_remove_session(...).
+ *
+ * @param service Pointer to the service.
+ * @param sv Pointer to the session to which the NALU belongs.
+ * @param nalu_data Pointer to the H26x NALU data to be added.
+ * @param nalu_data_size Size of the nalu_data.
+ *
+ * @returns SV_OK The NALU was handed over to the workers,
+ *          SV_INVALID_PARAMETER Invalid parameter, or the session is not registered to |service|,
+ *          SV_MEMORY Failed allocating memory.
+ */
+SignedVideoReturnCode
+signed_video_service_add_nalu(signed_video_service_t *service,
+    signed_video_t *sv,
+    const uint8_t *nalu_data,
+    size_t nalu_data_size);
+
+/**
+ * @brief Waits until all NALUs of a session have been validated
+ *
+ * Blocks until all NALUs added to the session, prior to this call, have been validated. All
+ * authenticity reports produced by these NALUs can then be popped through
+ * signed_video_pop_authenticity_report(...).
+ *
+ * @param service Pointer to the service.
+ * @param sv Pointer to the session to flush.
+ *
+ * @returns SV_OK All NALUs were validated successfully,
+ *          SV_INVALID_PARAMETER Invalid parameter, or the session is not registered to |service|,
+ *          Otherwise the first failure when validating NALUs of the session since the last flush.
+ */
+SignedVideoReturnCode
+signed_video_service_flush(signed_video_service_t *service, signed_video_t *sv);
+
+#endif  // __SIGNED_VIDEO_SERVICE_H__
@@ -26,6 +26,8 @@
 #include <string.h>  // size_t
 
 #include "signed_video_common.h"  // signed_video_t, SignedVideoReturnCode
+#include "signed_video_detached.h"  // sv_detached_sei_sink_t
+#include "signed_video_gop_index.h"  // sv_gop_index_sink_t
 #include "signed_video_interfaces.h"  // sign_algo_t
 
 /**
@@ -200,6 +202,51 @@ signed_video_get_nalu_to_prepend(signed_video_t *self,
 void
 signed_video_nalu_data_free(uint8_t *nalu_data);
 
+/**
+ * @brief Gets a file descriptor signaling completed signatures
+ *
+ * With a signing plugin that signs asynchronously, a completed signature is normally not added to
+ * its SEI-NALU until the next primary picture NALU is added through
+ * signed_video_add_nalu_for_signing(...). On low frame rate, or event driven, streams this delays
+ * the SEI-NALUs by whole frame intervals.
+ *
+ * This function provides a file descriptor that becomes readable when the signing plugin has a
+ * completed signature. The file descriptor can be added to, e.g., an epoll loop and when readable
+ * the user should call signed_video_finalize_pending_seis(...) followed by pulling the NALUs to
+ * prepend as normal. The file descriptor is owned by the session and should not be closed or read
+ * by the user. It is valid until the session is freed.
+ *
+ * @param self Pointer to the signed_video_t object in use.
+ * @param fd Pointer to where the file descriptor is written.
+ *
+ * @returns SV_OK            - |fd| was successfully set,
+ *          SV_NOT_SUPPORTED - the signing plugin does not provide a file descriptor, since it
+ *                             generates the signature at once,
+ *          otherwise        - an error code.
+ */
+SignedVideoReturnCode
+signed_video_get_signature_fd(signed_video_t *self, int *fd);
+
+/**
+ * @brief Adds completed signatures to pending SEI-NALUs
+ *
+ * Collects all signatures completed by the signing plugin and adds them to their SEI-NALUs without
+ * waiting for the next primary picture NALU. Typically called when the file descriptor from
+ * signed_video_get_signature_fd(...) is readable. The completed SEI-NALUs are then pulled using
+ * signed_video_get_nalu_to_prepend(...), and should be added to the stream before the next NALU.
+ *
+ * Calling this function when there are no completed signatures is harmless.
+ *
+ * @param self Pointer to the signed_video_t object in use.
+ *
+ * @returns SV_OK            - all completed signatures were successfully added,
+ *          SV_NOT_SUPPORTED - the private key has not been set, or there are NALUs to prepend that
+ *                             have not been pulled,
+ *          otherwise        - an error code.
+ */
+SignedVideoReturnCode
+signed_video_finalize_pending_seis(signed_video_t *self);
+
 /**
  * @brief Tells Signed Video that the stream has ended
  *
@@ -278,6 +325,104 @@ signed_video_set_private_key(signed_video_t *self,
     const char *private_key,
     size_t private_key_size);
 
+/**
+ * @brief Loads a signing plugin for this session
+ *
+ * By default a session signs using the plugin built into the library, selected through the meson
+ * option 'signingplugin'. This API replaces it with a plugin built as a separate shared object,
+ * which implements the interfaces declared in signed_video_interfaces.h. Different sessions may
+ * use different plugins.
+ *
+ * If |plugin| contains a '/' it is treated as a path to the shared object. Otherwise it is treated
+ * as the name of a plugin, e.g., "threaded-signing", and the shared object <plugin>.so is first
+ * searched for among the installed plugins, and then through the default search path of the
+ * dynamic linker.
+ *
+ * The plugin can only be changed before the first NALU has been added for signing. When
+ * successful, the previous plugin is torn down. Upon failure the session keeps its current plugin.
+ *
+ * @param self Pointer to the signed_video_t object session.
+ * @param plugin A path to, or the name of, the signing plugin to load.
+ *
+ * @return SV_OK If the plugin was loaded and set up,
+ *         SV_INVALID_PARAMETER Invalid input parameter(s),
+ *         SV_NOT_SUPPORTED If signing has already started, or on Windows, where plugins cannot be
+ *           loaded at runtime,
+ *         SV_EXTERNAL_ERROR The plugin could not be loaded, lacks an interface, or failed to set
+ *           up.
+ */
+SignedVideoReturnCode
+signed_video_set_signing_plugin(signed_video_t *self, const char *plugin);
+
+/**
+ * @brief Configures the placement and priority of the signing worker threads
+ *
+ * Signing plugins that sign in separate worker threads, e.g., the threaded plugin, start them with
+ * the CPU affinity and scheduling policy inherited from the thread creating the session. On systems
+ * where the encoder runs on dedicated CPUs, possibly with a real-time policy, the signing can be
+ * moved away from the encoder, or given a lower priority, through this API. See sv_worker_config_t
+ * in signed_video_interfaces.h for the available settings.
+ *
+ * The configuration applies to the signing plugin in use. If the plugin is changed through
+ * signed_video_set_signing_plugin(...), the configuration has to be set again.
+ *
+ * NOTE: Raising the priority, e.g., setting a real-time policy or a negative nice value, usually
+ * requires the CAP_SYS_NICE capability.
+ *
+ * @param self Pointer to the signed_video_t object session.
+ * @param config Pointer to the configuration to apply.
+ *
+ * @return SV_OK If the configuration was applied,
+ *         SV_INVALID_PARAMETER Invalid input parameter(s), or values out of range,
+ *         SV_NOT_SUPPORTED If the signing plugin has no worker threads,
+ *         SV_EXTERNAL_ERROR The configuration could not be applied, e.g., due to lack of
+ *           permissions.
+ */
+SignedVideoReturnCode
+signed_video_set_signing_worker_config(signed_video_t *self, const sv_worker_config_t *config);
+
+/**
+ * @brief Gets the utilization of the signing worker threads
+ *
+ * Writes the statistics of each worker thread of the signing plugin to |stats|, e.g., to monitor
+ * how much CPU the signing consumes. The values are accumulated since the workers were started;
+ * See sv_worker_stats_t in signed_video_interfaces.h.
+ *
+ * @param self Pointer to the signed_video_t object session.
+ * @param stats An array of at least |max_stats| elements to which the statistics are written.
+ * @param max_stats The number of elements in |stats|.
+ * @param num_stats Pointer to where the number of written elements is stored.
+ *
+ * @return SV_OK If statistics were written,
+ *         SV_INVALID_PARAMETER Invalid input parameter(s),
+ *         SV_NOT_SUPPORTED If the signing plugin has no worker threads.
+ */
+SignedVideoReturnCode
+signed_video_get_signing_worker_stats(signed_video_t *self,
+    sv_worker_stats_t *stats,
+    size_t max_stats,
+    size_t *num_stats);
+
+/**
+ * @brief Gets the deadline statistics of the signing
+ *
+ * The deadline signing plugin shares its worker threads between all sessions and signs the hash
+ * with the closest deadline first. The deadline of a hash is when the next hash of the session is
+ * expected, which is estimated from the observed cadence of the session, e.g., the GOP length. A
+ * signature that is completed after its deadline delays the SEI-NALU by at least one GOP and may
+ * make the signing fall behind. This API reports how often that has happened for this session;
+ * See sv_deadline_stats_t in signed_video_interfaces.h.
+ *
+ * @param self Pointer to the signed_video_t object session.
+ * @param stats Pointer to where the statistics are written.
+ *
+ * @return SV_OK If the statistics were written,
+ *         SV_INVALID_PARAMETER Invalid input parameter(s),
+ *         SV_NOT_SUPPORTED If the signing plugin does not schedule by deadlines.
+ */
+SignedVideoReturnCode
+signed_video_get_signing_deadline_stats(signed_video_t *self, sv_deadline_stats_t *stats);
+
 /**
  * @brief Sets the authenticity level to be used.
  *
@@ -322,4 +467,87 @@ signed_video_set_authenticity_level(signed_video_t *self,
 SignedVideoReturnCode
 signed_video_set_recurrence_interval_frames(signed_video_t *self, unsigned recurrence);
 
+/**
+ * @brief Sets the interval of intermediate SEIs within a GOP
+ *
+ * By default a SEI with a signature is generated at each GOP transition. Hence, with long GOPs
+ * the receiving end cannot validate the authenticity until the GOP has ended. This API enables
+ * intermediate SEIs, each one signing the NALUs added since the previous SEI. An intermediate SEI
+ * is generated in front of the first P-frame exceeding the interval, and that P-frame is the last
+ * one signed by it. Hence, the validation latency is bounded by the interval rather than by the
+ * GOP length.
+ *
+ * The interval can be set in frames, in milliseconds, or both, whichever comes first. The time is
+ * measured by the monotonic clock when NALUs are added. Intermediate SEIs are validated like any
+ * other SEIs and the receiving end needs no configuration.
+ *
+ * NOTE: Every intermediate SEI adds to the bitrate and requires a signature.
+ *
+ * @param self Session struct pointer
+ * @param interval_frames The maximum number of frames signed by one SEI. Set to 0 to not limit the
+ *   number of frames.
+ * @param interval_ms The maximum time in milliseconds between SEIs. Set to 0 to not limit the time.
+ *
+ * @returns SV_OK The interval was successfully set,
+ *          SV_INVALID_PARAMETER Invalid parameter,
+ *          SV_NOT_SUPPORTED The |interval_frames| is longer than the maximum GOP length.
+ */
+SignedVideoReturnCode
+signed_video_set_intermediate_sei_interval(signed_video_t *self,
+    unsigned interval_frames,
+    unsigned interval_ms);
+
+/**
+ * @brief Sets a sink for GOP index records
+ *
+ * When set, a compact binary record is produced for every SEI added to the stream, holding the
+ * byte offsets of the I-frame and the SEI, the GOP counter, the number of NALUs and the signed
+ * hash. Stored back to back, the records form an index from which a validator can jump straight
+ * to any GOP; See signed_video_gop_index.h.
+ *
+ * The |sink| is called from signed_video_add_nalu_for_signing(),
+ * signed_video_finalize_pending_seis() and signed_video_set_end_of_stream() when a SEI has been
+ * completed and is about to be pulled. The byte offsets assume that the NALUs are written to the
+ * stream as added and that the SEIs are prepended as instructed. Only
+ * SIGNED_VIDEO_PREPEND_NALU instructions are used.
+ *
+ * @param self Session struct pointer
+ * @param sink The callback receiving the serialized records. Set to NULL to stop producing
+ *   records.
+ * @param user_data User data passed on to |sink|.
+ *
+ * @returns SV_OK The sink was successfully set,
+ *          SV_INVALID_PARAMETER Invalid parameter.
+ */
+SignedVideoReturnCode
+signed_video_set_gop_index_sink(signed_video_t *self, sv_gop_index_sink_t sink, void *user_data);
+
+/**
+ * @brief Sets a sink for detached SEIs
+ *
+ * When set, the generated SEIs are not added to the list of NALUs to prepend, but passed on to the
+ * |sink| as serialized records holding the SEI and its position in the video stream; See
+ * signed_video_detached.h. Hence, signed_video_get_nalu_to_prepend() only returns
+ * SIGNED_VIDEO_PREPEND_NOTHING, and the video stream is left as is. The records form a sidecar
+ * stream, which can be stored or transmitted separately from the video.
+ *
+ * The |sink| is called from signed_video_add_nalu_for_signing(),
+ * signed_video_finalize_pending_seis() and signed_video_set_end_of_stream() when a SEI has been
+ * completed. The position of a SEI is the number of NALUs added for signing before the NALU it
+ * would have been prepended to. If a GOP index sink is set, the byte offsets of the GOP index
+ * records count the video NALUs only.
+ *
+ * @param self Session struct pointer
+ * @param sink The callback receiving the serialized records. Set to NULL to add the SEIs to the
+ *   video stream.
+ * @param user_data User data passed on to |sink|.
+ *
+ * @returns SV_OK The sink was successfully set,
+ *          SV_INVALID_PARAMETER Invalid parameter.
+ */
+SignedVideoReturnCode
+signed_video_set_detached_sei_sink(signed_video_t *self,
+    sv_detached_sei_sink_t sink,
+    void *user_data);
+
 #endif  // __SIGNED_VIDEO_SIGN_H__
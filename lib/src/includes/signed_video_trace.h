@@ -0,0 +1,118 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2023 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next paragraph) shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __SIGNED_VIDEO_TRACE_H__
+#define __SIGNED_VIDEO_TRACE_H__
+
+#include <stdbool.h>  // bool
+#include <stdint.h>  // uint8_t, uint32_t, uint64_t
+#include <string.h>  // size_t
+
+#include "signed_video_common.h"  // SignedVideoReturnCode, SignedVideoCodec, signed_video_t
+
+/**
+ * A NALU trace records how NALUs are added to a session, without the video content, to reproduce
+ * field problems offline. There is one record per call to signed_video_add_nalu_for_signing(), on
+ * the signing side, and per call to signed_video_add_nalu_and_authenticate(), on the validation
+ * side. The records are produced when a sink is set; See signed_video_set_trace_sink(). A trace
+ * stored as the records back to back can be replayed with synthetic NALUs of the same types and
+ * sizes; See tests/bench/replay_trace.c.
+ *
+ * Each record is serialized into SV_TRACE_RECORD_SIZE bytes, with all integers in big endian, as
+ *
+ * | version (1) | flags (1) | codec (1) | reserved (1) | header (4) | nalu_size (4) |
+ * | return_code (4) | timestamp_ns (8) | duration_ns (8) | digest (8) |
+ */
+#define SV_TRACE_RECORD_SIZE 40
+#define SV_TRACE_VERSION 1
+#define SV_TRACE_HEADER_SIZE 4
+
+/**
+ * A parsed trace record.
+ */
+typedef struct {
+  bool is_validation;
+  // True if recorded by a validation session, otherwise by a signing session.
+  bool is_signed_video_sei;
+  // True if the NALU is a SEI generated by Signed Video.
+  bool is_primary_slice;
+  // True if the NALU is the first slice of a picture.
+  bool has_report;
+  // True if the call produced an authenticity report.
+  SignedVideoCodec codec;
+  uint8_t header[SV_TRACE_HEADER_SIZE];
+  // The first bytes of the NALU after any start code, that is, the NALU header and the start of
+  // the payload. Padded with zeros for shorter NALUs.
+  uint8_t nalu_type;
+  // The nal_unit_type of the |header|. Not serialized.
+  uint32_t nalu_size;
+  // Size of the NALU in bytes, excluding any start code.
+  SignedVideoReturnCode return_code;
+  // The value returned by the call.
+  uint64_t timestamp_ns;
+  // Monotonic time in nanoseconds when the call started.
+  uint64_t duration_ns;
+  // Time in nanoseconds spent in the call.
+  uint64_t digest;
+  // A 64-bit FNV-1a digest of the NALU, excluding any start code. Identical NALUs have identical
+  // digests. Can be used as a seed when synthesizing a payload.
+} sv_trace_record_t;
+
+/**
+ * A callback receiving serialized trace records, one at a time, in the order the NALUs are added.
+ * The |record| is only valid during the call. The callback runs on the thread adding the NALU,
+ * after the timed part of the call.
+ */
+typedef void (*sv_trace_sink_t)(const uint8_t *record, size_t record_size, void *user_data);
+
+/**
+ * @brief Sets a sink for NALU trace records
+ *
+ * When set, a record is produced for every NALU added to the session. The time to produce a
+ * record, which includes parsing the NALU and computing its digest, is not part of the recorded
+ * duration. Setting a NULL |sink| stops the trace.
+ *
+ * @param self Pointer to the Signed Video session, signing or validating.
+ * @param sink The callback receiving the records. NULL disables the trace.
+ * @param user_data Pointer passed on to the |sink|.
+ *
+ * @returns SV_OK The sink was successfully set,
+ *          SV_INVALID_PARAMETER Invalid parameter,
+ *          SV_NOT_SUPPORTED The session is registered to a validation service.
+ */
+SignedVideoReturnCode
+signed_video_set_trace_sink(signed_video_t *self, sv_trace_sink_t sink, void *user_data);
+
+/**
+ * @brief Parses a serialized trace record
+ *
+ * @param data Pointer to the serialized record.
+ * @param data_size Size of |data|. Must be at least SV_TRACE_RECORD_SIZE bytes.
+ * @param record Pointer to the record to fill in.
+ *
+ * @returns SV_OK The record was successfully parsed,
+ *          SV_INVALID_PARAMETER Invalid parameter, or an unknown codec,
+ *          SV_INCOMPATIBLE_VERSION The record has an unknown version.
+ */
+SignedVideoReturnCode
+signed_video_trace_parse_record(const uint8_t *data, size_t data_size, sv_trace_record_t *record);
+
+#endif  // __SIGNED_VIDEO_TRACE_H__
@@ -0,0 +1,136 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2023 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next paragraph) shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __SIGNED_VIDEO_TS_H__
+#define __SIGNED_VIDEO_TS_H__
+
+#include <stdint.h>  // uint8_t, uint64_t
+#include <string.h>  // size_t
+
+#include "signed_video_auth.h"  // signed_video_authenticity_t
+#include "signed_video_common.h"  // signed_video_t, SignedVideoReturnCode
+
+/**
+ * A reader of MPEG transport streams, for example, HLS segments. It parses the PAT and the PMT,
+ * follows the PID of the first H.264 or H.265 stream of the first program, reassembles the PES
+ * payloads and adds the NALUs to a validation session. The payloads are gathered across the 188
+ * bytes packets into one buffer, from which the NALUs are added in place.
+ *
+ * The data can be added in chunks of any size, hence a set of segments is validated by adding them
+ * in order, one after the other. A PES is added for validation when the next one starts, or when
+ * signed_video_ts_reader_flush() is called. If a packet of the video PID is lost, detected through
+ * its continuity counter, the PES it belongs to is dropped. The validation then reports the missing
+ * NALUs. A packet repeating the previous one is a duplicate and ignored, and the continuity counter
+ * is not checked on a packet with the discontinuity_indicator set.
+ *
+ * Corrupt data does not stop the reader. A malformed PES is dropped, like one with a lost packet,
+ * and if the packet alignment is lost the reader skips to the next sync byte.
+ *
+ * The PAT and PMT sections are assumed to fit in one packet each, and their CRCs are not checked.
+ */
+typedef struct _sv_ts_reader_t sv_ts_reader_t;
+
+/**
+ * A callback receiving the authenticity reports of the validation, in order. The callback takes
+ * ownership of the |report|; See signed_video_authenticity_report_free().
+ */
+typedef void (*sv_ts_report_cb_t)(signed_video_authenticity_t *report, void *user_data);
+
+/**
+ * Statistics of a reader.
+ */
+typedef struct {
+  uint64_t num_bytes;  // Bytes of transport stream added.
+  uint64_t num_packets;  // Packets read.
+  uint64_t num_nalus;  // NALUs added for validation.
+  uint64_t num_dropped_pes;  // PES dropped due to lost packets or malformed data.
+  uint64_t processing_time_us;  // Time spent in signed_video_ts_reader_add_data() and flushing.
+  double megabytes_per_second;  // Throughput, that is, |num_bytes| per |processing_time_us|.
+  uint64_t num_resyncs;  // Times the packet alignment was lost and found again at a sync byte.
+} sv_ts_stats_t;
+
+/**
+ * @brief Creates a reader of a transport stream
+ *
+ * @param sv The validation session to add the NALUs to. The session has to outlive the reader, and
+ *   its codec has to match the video stream.
+ * @param report_cb The callback receiving the authenticity reports. Can be NULL.
+ * @param user_data User data passed on to |report_cb|.
+ *
+ * @returns A pointer to the reader, or NULL upon failure.
+ */
+sv_ts_reader_t *
+signed_video_ts_reader_create(signed_video_t *sv, sv_ts_report_cb_t report_cb, void *user_data);
+
+/**
+ * @brief Frees a reader
+ *
+ * A PES not yet added for validation is dropped; See signed_video_ts_reader_flush().
+ *
+ * @param reader Pointer to the reader to free.
+ */
+void
+signed_video_ts_reader_free(sv_ts_reader_t *reader);
+
+/**
+ * @brief Adds transport stream data
+ *
+ * @param reader Pointer to the reader.
+ * @param data Pointer to the data, which does not have to start or end at a packet boundary.
+ * @param data_size Size of |data|.
+ *
+ * @returns SV_OK The data was successfully read,
+ *          SV_INVALID_PARAMETER Invalid parameter, or data was skipped to find the next sync byte,
+ *          SV_NOT_SUPPORTED The video stream does not match the codec of the session,
+ *          SV_MEMORY Failed allocating memory,
+ *          otherwise a different error code from the validation.
+ *          Upon an error the rest of the data is still read, and the first error is returned.
+ */
+SignedVideoReturnCode
+signed_video_ts_reader_add_data(sv_ts_reader_t *reader, const uint8_t *data, size_t data_size);
+
+/**
+ * @brief Adds the latest PES for validation
+ *
+ * Call at the end of the stream, since the latest PES is otherwise added when the next one starts.
+ *
+ * @param reader Pointer to the reader.
+ *
+ * @returns SV_OK The PES was successfully added,
+ *          SV_INVALID_PARAMETER Invalid parameter,
+ *          otherwise a different error code from the validation.
+ */
+SignedVideoReturnCode
+signed_video_ts_reader_flush(sv_ts_reader_t *reader);
+
+/**
+ * @brief Gets the statistics of a reader
+ *
+ * @param reader Pointer to the reader.
+ * @param stats Pointer to the statistics to fill in.
+ *
+ * @returns SV_OK The statistics were successfully read,
+ *          SV_INVALID_PARAMETER Invalid parameter.
+ */
+SignedVideoReturnCode
+signed_video_ts_reader_get_stats(const sv_ts_reader_t *reader, sv_ts_stats_t *stats);
+
+#endif  // __SIGNED_VIDEO_TS_H__
@@ -161,6 +161,7 @@ transfer_latest_validation(signed_video_latest_validation_t *dst,
     dst->number_of_expected_picture_nalus = src->number_of_expected_picture_nalus;
     dst->number_of_received_picture_nalus = src->number_of_received_picture_nalus;
     dst->number_of_pending_picture_nalus = src->number_of_pending_picture_nalus;
+    dst->is_provisional = src->is_provisional;
   SVI_CATCH()
   SVI_DONE(status)
 
@@ -242,6 +243,7 @@ latest_validation_init(signed_video_latest_validation_t *self)
   self->number_of_expected_picture_nalus = -1;
   self->number_of_received_picture_nalus = -1;
   self->number_of_pending_picture_nalus = 0;
+  self->is_provisional = false;
 
   free(self->validation_str);
   self->validation_str = NULL;
@@ -286,6 +288,7 @@ signed_video_get_authenticity_report(signed_video_t *self)
   // Return a nullptr if no local authenticity report exists.
   if (self->authenticity == NULL) return NULL;
 
+  const uint64_t start_ns = get_monotonic_time_ns();
   char *validation_str = NULL;
   signed_video_authenticity_t *authenticity_report = signed_video_authenticity_report_create();
 
@@ -309,6 +312,8 @@ signed_video_get_authenticity_report(signed_video_t *self)
   // Sanity check the output since we do not return a SignedVideoReturnCode.
   assert(((status == SVI_OK) ? (authenticity_report != NULL) : (authenticity_report == NULL)));
   free(validation_str);
+  if (authenticity_report) self->counters.num_reports++;
+  counters_add_stage_time(self, SV_STAGE_REPORT, start_ns);
 
   return authenticity_report;
 }
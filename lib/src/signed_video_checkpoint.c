@@ -0,0 +1,217 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2023 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next paragraph) shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <stdbool.h>  // bool
+#include <stdint.h>  // uint8_t, uint32_t, uint64_t
+#include <stdlib.h>  // realloc
+#include <string.h>  // memcpy, strlen
+
+#include "includes/signed_video_auth.h"
+#include "includes/signed_video_openssl.h"  // openssl_key_memory_allocated()
+#include "signed_video_authenticity.h"  // transfer_product_info()
+#include "signed_video_defines.h"  // svi_rc
+#include "signed_video_internal.h"  // signed_video_t, write_be(), read_be()
+
+/* A checkpoint is serialized as follows, with all integers in big endian,
+ *
+ * | magic (4) | version (1) | flags (1) | algo (1) | reserved (1) | global_gop_counter (4) |
+ * | resume_nalu_idx (8) | public_key_size (4) | public_key |
+ *
+ * followed by the product info strings, |hardware_id|, |firmware_version|, |serial_number|,
+ * |manufacturer| and |address|, each as | size (2) | characters, without null termination |.
+ */
+#define CHECKPOINT_MAGIC 0x53564350  // "SVCP"
+#define CHECKPOINT_VERSION 1
+#define CHECKPOINT_HEADER_SIZE 24
+#define CHECKPOINT_FLAG_HAS_PUBLIC_KEY 0x01
+#define CHECKPOINT_FLAG_HAS_VALIDATED_GOP 0x02
+#define CHECKPOINT_NUM_STRINGS 5
+
+/* Gets pointers to the product info strings in serialization order. */
+static void
+get_product_info_strings(signed_video_product_info_t *product_info,
+    char **strings[CHECKPOINT_NUM_STRINGS])
+{
+  strings[0] = &product_info->hardware_id;
+  strings[1] = &product_info->firmware_version;
+  strings[2] = &product_info->serial_number;
+  strings[3] = &product_info->manufacturer;
+  strings[4] = &product_info->address;
+}
+
+static size_t
+get_checkpoint_size(signed_video_t *self)
+{
+  size_t checkpoint_size = CHECKPOINT_HEADER_SIZE;
+  if (self->has_public_key) checkpoint_size += self->signature_info->public_key_size;
+
+  char **strings[CHECKPOINT_NUM_STRINGS];
+  get_product_info_strings(self->product_info, strings);
+  for (int i = 0; i < CHECKPOINT_NUM_STRINGS; i++) {
+    checkpoint_size += 2 + (*strings[i] ? strlen(*strings[i]) : 0);
+  }
+
+  return checkpoint_size;
+}
+
+/* Reads a string of the product info into |str| and moves |data_ptr| past it. */
+static svi_rc
+read_string(const uint8_t **data_ptr, const uint8_t *data_end, char **str)
+{
+  uint64_t str_size = 0;
+  if (data_end - *data_ptr < 2) return SVI_INVALID_PARAMETER;
+  *data_ptr = read_be(*data_ptr, &str_size, 2);
+  if ((uint64_t)(data_end - *data_ptr) < str_size) return SVI_INVALID_PARAMETER;
+
+  char *new_str = realloc(*str, str_size + 1);
+  if (!new_str) return SVI_MEMORY;
+  memcpy(new_str, *data_ptr, str_size);
+  new_str[str_size] = '\0';
+  *str = new_str;
+  *data_ptr += str_size;
+
+  return SVI_OK;
+}
+
+/**
+ * @brief Public signed_video_auth.h APIs
+ */
+
+SignedVideoReturnCode
+signed_video_get_checkpoint(signed_video_t *self,
+    uint8_t *checkpoint,
+    size_t *checkpoint_size,
+    uint64_t *resume_nalu_idx)
+{
+  if (!self || !checkpoint_size) return SV_INVALID_PARAMETER;
+  // Sequenced NALUs may be added while writing the checkpoint.
+  if (self->service_session) return SV_NOT_SUPPORTED;
+
+  const size_t required_size = get_checkpoint_size(self);
+  const uint64_t nalu_idx = self->has_validated_gop ? self->checkpoint_idx : 0;
+  if (resume_nalu_idx) *resume_nalu_idx = nalu_idx;
+  if (!checkpoint) {
+    *checkpoint_size = required_size;
+    return SV_OK;
+  }
+  if (*checkpoint_size < required_size) return SV_INVALID_PARAMETER;
+
+  signature_info_t *signature_info = self->signature_info;
+  uint8_t flags = 0;
+  if (self->has_public_key) flags |= CHECKPOINT_FLAG_HAS_PUBLIC_KEY;
+  if (self->has_validated_gop) flags |= CHECKPOINT_FLAG_HAS_VALIDATED_GOP;
+
+  uint8_t *data_ptr = checkpoint;
+  data_ptr = write_be(data_ptr, CHECKPOINT_MAGIC, 4);
+  *data_ptr++ = CHECKPOINT_VERSION;
+  *data_ptr++ = flags;
+  *data_ptr++ = (uint8_t)signature_info->algo;
+  *data_ptr++ = 0;  // Reserved
+  data_ptr = write_be(data_ptr, self->gop_info->global_gop_counter, 4);
+  data_ptr = write_be(data_ptr, nalu_idx, 8);
+  if (self->has_public_key) {
+    data_ptr = write_be(data_ptr, signature_info->public_key_size, 4);
+    memcpy(data_ptr, signature_info->public_key, signature_info->public_key_size);
+    data_ptr += signature_info->public_key_size;
+  } else {
+    data_ptr = write_be(data_ptr, 0, 4);
+  }
+
+  char **strings[CHECKPOINT_NUM_STRINGS];
+  get_product_info_strings(self->product_info, strings);
+  for (int i = 0; i < CHECKPOINT_NUM_STRINGS; i++) {
+    const size_t str_size = *strings[i] ? strlen(*strings[i]) : 0;
+    data_ptr = write_be(data_ptr, str_size, 2);
+    if (str_size > 0) memcpy(data_ptr, *strings[i], str_size);
+    data_ptr += str_size;
+  }
+  *checkpoint_size = data_ptr - checkpoint;
+
+  return SV_OK;
+}
+
+SignedVideoReturnCode
+signed_video_restore_checkpoint(signed_video_t *self,
+    const uint8_t *checkpoint,
+    size_t checkpoint_size)
+{
+  if (!self || !checkpoint || checkpoint_size < CHECKPOINT_HEADER_SIZE) {
+    return SV_INVALID_PARAMETER;
+  }
+  if (self->service_session) return SV_NOT_SUPPORTED;
+
+  uint64_t value = 0;
+  const uint8_t *data_ptr = read_be(checkpoint, &value, 4);
+  const uint8_t *data_end = checkpoint + checkpoint_size;
+  if (value != CHECKPOINT_MAGIC) return SV_INVALID_PARAMETER;
+  if (*data_ptr++ != CHECKPOINT_VERSION) return SV_INCOMPATIBLE_VERSION;
+
+  svi_rc status = SVI_UNKNOWN;
+  SVI_TRY()
+    SVI_THROW(sv_rc_to_svi_rc(signed_video_reset(self)));
+    SVI_THROW(create_local_authenticity_report_if_needed(self));
+
+    const uint8_t flags = *data_ptr++;
+    const sign_algo_t algo = (sign_algo_t)*data_ptr++;
+    data_ptr++;  // Reserved
+    SVI_THROW_IF(algo < SIGN_ALGO_RSA || algo >= SIGN_ALGO_NUM, SVI_INVALID_PARAMETER);
+    data_ptr = read_be(data_ptr, &value, 4);
+    const uint32_t global_gop_counter = (uint32_t)value;
+    uint64_t resume_nalu_idx = 0;
+    data_ptr = read_be(data_ptr, &resume_nalu_idx, 8);
+    uint64_t public_key_size = 0;
+    data_ptr = read_be(data_ptr, &public_key_size, 4);
+    SVI_THROW_IF((uint64_t)(data_end - data_ptr) < public_key_size, SVI_INVALID_PARAMETER);
+    SVI_THROW_IF(((flags & CHECKPOINT_FLAG_HAS_PUBLIC_KEY) != 0) != (public_key_size > 0),
+        SVI_INVALID_PARAMETER);
+
+    signed_video_product_info_t *product_info = self->product_info;
+    char **strings[CHECKPOINT_NUM_STRINGS];
+    get_product_info_strings(product_info, strings);
+    const uint8_t *strings_ptr = data_ptr + public_key_size;
+    for (int i = 0; i < CHECKPOINT_NUM_STRINGS; i++) {
+      SVI_THROW(read_string(&strings_ptr, data_end, strings[i]));
+    }
+    SVI_THROW_IF(strings_ptr != data_end, SVI_INVALID_PARAMETER);
+    SVI_THROW(transfer_product_info(&self->authenticity->product_info, product_info));
+
+    if (public_key_size > 0) {
+      signature_info_t *signature_info = self->signature_info;
+      SVI_THROW(sv_rc_to_svi_rc(openssl_key_memory_allocated(
+          &signature_info->public_key, &signature_info->public_key_size, public_key_size)));
+      memcpy(signature_info->public_key, data_ptr, public_key_size);
+      signature_info->algo = algo;
+      self->has_public_key = true;
+      // Outcomes verified with another public key must not be used.
+      verification_cache_clear(self->verification_cache);
+    }
+    self->gop_info->global_gop_counter = global_gop_counter;
+
+    // The NALUs are added again from the SEI completing the latest validated GOP. That GOP has
+    // already been reported, hence skip it as after a seek.
+    self->num_added_nalus = resume_nalu_idx;
+    self->checkpoint_idx = resume_nalu_idx;
+    self->has_validated_gop = (flags & CHECKPOINT_FLAG_HAS_VALIDATED_GOP) != 0;
+    self->is_after_seek = self->has_validated_gop;
+  SVI_CATCH()
+  SVI_DONE(status)
+
+  return svi_rc_to_signed_video_rc(status);
+}
@@ -0,0 +1,165 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2023 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next paragraph) shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "includes/signed_video_counters.h"
+
+#include <string.h>  // memset
+#if defined(_WIN32) || defined(_WIN64)
+#include <windows.h>  // QueryPerformanceCounter, QueryPerformanceFrequency
+#else
+#include <time.h>  // clock_gettime
+#endif
+
+#include "signed_video_h26x_internal.h"  // h26x_nalu_t, h26x_nalu_list_t
+#include "signed_video_internal.h"  // signed_video_t
+#include "signed_video_sequencer.h"  // sequencer_run_exclusive()
+
+/* Declared in signed_video_internal.h */
+uint64_t
+get_monotonic_time_ns(void)
+{
+#if defined(_WIN32) || defined(_WIN64)
+  // There is no clock_gettime() on Windows. The performance counter is monotonic, and its frequency
+  // is fixed at boot.
+  LARGE_INTEGER frequency;
+  LARGE_INTEGER counter;
+  QueryPerformanceFrequency(&frequency);
+  QueryPerformanceCounter(&counter);
+  const uint64_t ticks = (uint64_t)counter.QuadPart;
+  const uint64_t ticks_per_second = (uint64_t)frequency.QuadPart;
+
+  // Split in seconds and remainder to not overflow.
+  return (ticks / ticks_per_second) * 1000000000 +
+      (ticks % ticks_per_second) * 1000000000 / ticks_per_second;
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+/* Declared in signed_video_internal.h */
+void
+counters_add_stage_time(signed_video_t *self, SignedVideoStage stage, uint64_t start_ns)
+{
+  self->counters.stage_time_ns[stage] += get_monotonic_time_ns() - start_ns;
+}
+
+/* Declared in signed_video_internal.h */
+void
+counters_add_verification(signed_video_t *self, svi_rc status, int verified)
+{
+  sv_counters_t *counters = &self->counters;
+  counters->num_verifications++;
+  if (status != SVI_OK || verified < 0) {
+    counters->num_verification_errors++;
+  } else if (verified == 1) {
+    counters->num_verified_ok++;
+  } else {
+    counters->num_verified_not_ok++;
+  }
+}
+
+/* Declared in signed_video_h26x_internal.h */
+void
+counters_add_nalu(signed_video_t *self, const h26x_nalu_t *nalu)
+{
+  sv_counters_t *counters = &self->counters;
+  if (nalu->is_valid < 0) {
+    counters->num_invalid_nalus++;
+    return;
+  }
+  switch (nalu->nalu_type) {
+    case NALU_TYPE_I:
+      counters->num_i_nalus++;
+      break;
+    case NALU_TYPE_P:
+      counters->num_p_nalus++;
+      break;
+    case NALU_TYPE_PS:
+      counters->num_parameter_set_nalus++;
+      break;
+    case NALU_TYPE_SEI:
+      counters->num_sei_nalus++;
+      break;
+    default:
+      counters->num_other_nalus++;
+      break;
+  }
+}
+
+/* Declared in signed_video_h26x_internal.h */
+void
+counters_update_high_water_marks(signed_video_t *self)
+{
+  sv_counters_t *counters = &self->counters;
+  const h26x_nalu_list_t *nalu_list = self->nalu_list;
+  uint64_t list_length = 0;
+  uint64_t pending_gops = (uint64_t)self->payload_buffer_idx;
+  if (nalu_list) {
+    list_length = (uint64_t)nalu_list->num_items;
+    if ((uint64_t)nalu_list->gop_idx > pending_gops) pending_gops = (uint64_t)nalu_list->gop_idx;
+  }
+  if (list_length > counters->max_nalu_list_length) counters->max_nalu_list_length = list_length;
+  if (pending_gops > counters->max_pending_gops) counters->max_pending_gops = pending_gops;
+}
+
+/* The arguments of read_counters(...). */
+typedef struct {
+  sv_counters_t *counters;
+  bool reset;
+} counters_request_t;
+
+/* Copies, and possibly resets, the counters of the session |user_data|. Runs while the session
+ * processes no NALUs; See signed_video_get_counters(). */
+static void
+read_counters(void *user_data, void *arg)
+{
+  signed_video_t *self = (signed_video_t *)user_data;
+  const counters_request_t *request = (const counters_request_t *)arg;
+
+  *request->counters = self->counters;
+  if (request->reset) {
+    memset(&self->counters, 0, sizeof(sv_counters_t));
+    counters_update_high_water_marks(self);
+  }
+}
+
+/**
+ * @brief Public signed_video_counters.h APIs
+ */
+
+SignedVideoReturnCode
+signed_video_get_counters(signed_video_t *self, sv_counters_t *counters, bool reset)
+{
+  if (!self || !counters) return SV_INVALID_PARAMETER;
+
+  counters_request_t request = {.counters = counters, .reset = reset};
+  // NALUs added in sequence, e.g., by the workers of a validation service, are processed on other
+  // threads. The counters are then read in between two NALUs.
+  if (self->sequencer) {
+    sequencer_run_exclusive(self->sequencer, read_counters, &request);
+  } else {
+    read_counters(self, &request);
+  }
+
+  return SV_OK;
+}
@@ -0,0 +1,88 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2023 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next paragraph) shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "includes/signed_video_detached.h"
+
+#include <stdlib.h>  // free, malloc
+
+#include "signed_video_internal.h"  // detached_sei_record_create(), write_be(), read_be()
+
+/* Serializes the |sei| and its position |nalu_idx| into a newly allocated record of |record_size|
+ * bytes. Returns NULL upon failure. Declared in signed_video_internal.h */
+uint8_t *
+detached_sei_record_create(const uint8_t *sei,
+    size_t sei_size,
+    uint64_t nalu_idx,
+    size_t *record_size)
+{
+  if (!sei || sei_size == 0 || sei_size > UINT32_MAX || !record_size) return NULL;
+
+  uint8_t *record = malloc(SV_DETACHED_SEI_HEADER_SIZE + sei_size);
+  if (!record) return NULL;
+
+  uint8_t *data_ptr = record;
+  *data_ptr++ = SV_DETACHED_SEI_VERSION;
+  data_ptr = write_be(data_ptr, 0, 3);  // Reserved
+  data_ptr = write_be(data_ptr, nalu_idx, 8);
+  data_ptr = write_be(data_ptr, sei_size, 4);
+  memcpy(data_ptr, sei, sei_size);
+  *record_size = SV_DETACHED_SEI_HEADER_SIZE + sei_size;
+
+  return record;
+}
+
+/* Frees all SEIs waiting for their positions. Declared in signed_video_internal.h */
+void
+free_detached_seis(signed_video_t *self)
+{
+  for (size_t i = 0; i < self->num_detached_seis; i++) {
+    free(self->detached_seis[i].sei);
+  }
+  free(self->detached_seis);
+  self->detached_seis = NULL;
+  self->num_detached_seis = 0;
+}
+
+/**
+ * @brief Public signed_video_detached.h APIs
+ */
+
+SignedVideoReturnCode
+signed_video_detached_sei_parse_record(const uint8_t *data,
+    size_t data_size,
+    uint64_t *nalu_idx,
+    const uint8_t **sei,
+    size_t *sei_size)
+{
+  if (!data || data_size < SV_DETACHED_SEI_HEADER_SIZE || !nalu_idx || !sei || !sei_size) {
+    return SV_INVALID_PARAMETER;
+  }
+  if (data[0] != SV_DETACHED_SEI_VERSION) return SV_INCOMPATIBLE_VERSION;
+
+  uint64_t value = 0;
+  const uint8_t *data_ptr = data + 4;  // Skip version and reserved bytes.
+  data_ptr = read_be(data_ptr, nalu_idx, 8);
+  data_ptr = read_be(data_ptr, &value, 4);
+  if (value == 0 || value > data_size - SV_DETACHED_SEI_HEADER_SIZE) return SV_INVALID_PARAMETER;
+  *sei = data_ptr;
+  *sei_size = (size_t)value;
+
+  return SV_OK;
+}
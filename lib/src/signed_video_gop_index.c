@@ -0,0 +1,165 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2023 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next paragraph) shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "includes/signed_video_gop_index.h"
+
+#include <assert.h>  // assert
+
+#include "signed_video_internal.h"  // gop_index_record_write()
+
+#define GOP_INDEX_FLAG_INTERMEDIATE 0x01
+
+/* Writes the |num_bytes| least significant bytes of |value| in big endian. Returns a pointer to
+ * the byte after the written ones. Declared in signed_video_internal.h */
+uint8_t *
+write_be(uint8_t *data, uint64_t value, int num_bytes)
+{
+  for (int i = num_bytes - 1; i >= 0; i--) {
+    data[i] = (uint8_t)(value & 0xff);
+    value >>= 8;
+  }
+  return data + num_bytes;
+}
+
+/* Reads |num_bytes| bytes in big endian into |value|. Returns a pointer to the byte after the read
+ * ones. Declared in signed_video_internal.h */
+const uint8_t *
+read_be(const uint8_t *data, uint64_t *value, int num_bytes)
+{
+  *value = 0;
+  for (int i = 0; i < num_bytes; i++) {
+    *value = (*value << 8) | data[i];
+  }
+  return data + num_bytes;
+}
+
+/* Serializes |record| into SV_GOP_INDEX_RECORD_SIZE bytes of |data|. Declared in
+ * signed_video_internal.h */
+void
+gop_index_record_write(const sv_gop_index_record_t *record, uint8_t *data)
+{
+  uint8_t *data_ptr = data;
+  *data_ptr++ = SV_GOP_INDEX_VERSION;
+  *data_ptr++ = record->is_intermediate ? GOP_INDEX_FLAG_INTERMEDIATE : 0;
+  data_ptr = write_be(data_ptr, 0, 2);  // Reserved
+  data_ptr = write_be(data_ptr, record->gop_counter, 4);
+  data_ptr = write_be(data_ptr, record->num_nalus, 4);
+  data_ptr = write_be(data_ptr, record->sei_size, 4);
+  data_ptr = write_be(data_ptr, record->gop_offset, 8);
+  data_ptr = write_be(data_ptr, record->sei_offset, 8);
+  memcpy(data_ptr, record->hash, SV_GOP_INDEX_HASH_SIZE);
+  data_ptr += SV_GOP_INDEX_HASH_SIZE;
+  assert(data_ptr - data == SV_GOP_INDEX_RECORD_SIZE);
+}
+
+/* Reads only the |gop_offset| of record |record_idx|. The version is assumed to be checked. */
+static uint64_t
+read_gop_offset(const uint8_t *index, size_t record_idx)
+{
+  uint64_t gop_offset = 0;
+  read_be(index + record_idx * SV_GOP_INDEX_RECORD_SIZE + 16, &gop_offset, 8);
+  return gop_offset;
+}
+
+/**
+ * @brief Public signed_video_gop_index.h APIs
+ */
+
+SignedVideoReturnCode
+signed_video_gop_index_parse_record(const uint8_t *data,
+    size_t data_size,
+    sv_gop_index_record_t *record)
+{
+  if (!data || data_size < SV_GOP_INDEX_RECORD_SIZE || !record) return SV_INVALID_PARAMETER;
+  if (data[0] != SV_GOP_INDEX_VERSION) return SV_INCOMPATIBLE_VERSION;
+
+  uint64_t value = 0;
+  const uint8_t *data_ptr = data + 1;
+  record->is_intermediate = (*data_ptr++ & GOP_INDEX_FLAG_INTERMEDIATE) != 0;
+  data_ptr += 2;  // Reserved
+  data_ptr = read_be(data_ptr, &value, 4);
+  record->gop_counter = (uint32_t)value;
+  data_ptr = read_be(data_ptr, &value, 4);
+  record->num_nalus = (uint32_t)value;
+  data_ptr = read_be(data_ptr, &value, 4);
+  record->sei_size = (uint32_t)value;
+  data_ptr = read_be(data_ptr, &record->gop_offset, 8);
+  data_ptr = read_be(data_ptr, &record->sei_offset, 8);
+  memcpy(record->hash, data_ptr, SV_GOP_INDEX_HASH_SIZE);
+
+  return SV_OK;
+}
+
+SignedVideoReturnCode
+signed_video_gop_index_get_record(const uint8_t *index,
+    size_t index_size,
+    size_t record_idx,
+    sv_gop_index_record_t *record)
+{
+  if (!index || !record) return SV_INVALID_PARAMETER;
+  if (record_idx >= index_size / SV_GOP_INDEX_RECORD_SIZE) return SV_INVALID_PARAMETER;
+
+  return signed_video_gop_index_parse_record(
+      index + record_idx * SV_GOP_INDEX_RECORD_SIZE, SV_GOP_INDEX_RECORD_SIZE, record);
+}
+
+SignedVideoReturnCode
+signed_video_gop_index_find(const uint8_t *index,
+    size_t index_size,
+    uint64_t offset,
+    sv_gop_index_record_t *record,
+    size_t *record_idx)
+{
+  if (!index || !record) return SV_INVALID_PARAMETER;
+
+  const size_t num_records = index_size / SV_GOP_INDEX_RECORD_SIZE;
+  if (num_records == 0) return SV_NOT_SUPPORTED;
+  // All records are expected to have the same version. Check the first one only, to not lose the
+  // benefit of the binary search.
+  if (index[0] != SV_GOP_INDEX_VERSION) return SV_INCOMPATIBLE_VERSION;
+
+  // The GOP offsets never decrease. Find the first record of a GOP starting after |offset|.
+  size_t low = 0;
+  size_t high = num_records;
+  while (low < high) {
+    size_t mid = low + (high - low) / 2;
+    if (read_gop_offset(index, mid) <= offset) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  if (low == 0) return SV_NOT_SUPPORTED;
+  // Then find the first record of the GOP before that one.
+  const uint64_t gop_offset = read_gop_offset(index, low - 1);
+  high = low - 1;
+  low = 0;
+  while (low < high) {
+    size_t mid = low + (high - low) / 2;
+    if (read_gop_offset(index, mid) < gop_offset) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  if (record_idx) *record_idx = low;
+
+  return signed_video_gop_index_get_record(index, index_size, low, record);
+}
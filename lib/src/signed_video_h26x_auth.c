@@ -19,17 +19,22 @@
  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 #include <assert.h>  // assert
-#include <stdlib.h>  // free
+#include <stdlib.h>  // calloc, free, malloc
+#include <string.h>  // memcpy
 
 #include "includes/signed_video_auth.h"
+#include "includes/signed_video_detached.h"  // signed_video_detached_sei_parse_record()
 #include "includes/signed_video_interfaces.h"  // signature_info_t
 #include "includes/signed_video_openssl.h"  // openssl_verify_hash()
+#include "includes/signed_video_result_store.h"  // sv_result_sink_t
 #include "signed_video_authenticity.h"  // create_local_authenticity_report_if_needed()
 #include "signed_video_defines.h"  // svi_rc
 #include "signed_video_h26x_internal.h"  // gop_state_reset(), update_gop_hash()
 #include "signed_video_h26x_nalu_list.h"  // h26x_nalu_list_append()
 #include "signed_video_internal.h"  // gop_info_t, gop_state_t, reset_gop_hash()
-#include "signed_video_tlv.h"  // tlv_find_tag()
+#include "signed_video_tlv.h"  // tlv_find_tag(), tlv_find_signature()
+#include "signed_video_verification_cache.h"  // verification_cache_lookup()
+#include "signed_video_worker_pool.h"  // worker_pool_run()
 
 static svi_rc
 decode_sei_data(signed_video_t *signed_video, const uint8_t *payload, size_t payload_size);
@@ -79,6 +84,7 @@ decode_sei_data(signed_video_t *self, const uint8_t *payload, size_t payload_siz
   svi_rc status = SVI_UNKNOWN;
   SVI_TRY()
     SVI_THROW_WITH_MSG(tlv_decode(self, payload, payload_size), "Failed decoding SEI payload");
+    self->counters.num_decoded_seis++;
 
     // Compare new with last number of GOPs to detect potentially lost SEIs.
     uint32_t new_gop_number = self->gop_info->global_gop_counter;
@@ -609,6 +615,7 @@ compute_gop_hash(signed_video_t *self, h26x_nalu_list_item_t *sei)
 
   h26x_nalu_list_print(nalu_list);
 
+  const uint64_t start_ns = get_monotonic_time_ns();
   svi_rc status = SVI_UNKNOWN;
   SVI_TRY()
     // Initialize the gop_hash by resetting it.
@@ -648,6 +655,7 @@ compute_gop_hash(signed_video_t *self, h26x_nalu_list_item_t *sei)
       hash_to_add = item->need_second_verification ? item->second_hash : item->hash;
       // Copy to the |nalu_hash| slot in the memory and update the gop_hash.
       memcpy(nalu_hash, hash_to_add, HASH_DIGEST_SIZE);
+      self->counters.num_combination_hashes++;
       SVI_THROW(update_gop_hash(gop_info));
 
       // Mark the item and move to next.
@@ -657,6 +665,7 @@ compute_gop_hash(signed_video_t *self, h26x_nalu_list_item_t *sei)
 
     // Complete the gop_hash with the hash of the SEI.
     memcpy(nalu_hash, sei->hash, HASH_DIGEST_SIZE);
+    self->counters.num_combination_hashes++;
     SVI_THROW(update_gop_hash(gop_info));
     sei->used_in_gop_hash = true;
 
@@ -666,6 +675,31 @@ compute_gop_hash(signed_video_t *self, h26x_nalu_list_item_t *sei)
     remove_used_in_gop_hash(nalu_list);
   }
   SVI_DONE(status)
+  counters_add_stage_time(self, SV_STAGE_HASH, start_ns);
+
+  return status;
+}
+
+/* Verifies the signature of |signature_info|, unless the outcome is in the |verification_cache|.
+ * The outcome is then cached for the next time the same content is validated, for example, when
+ * scrubbing back and forth. */
+static svi_rc
+verify_signature(signed_video_t *self, const signature_info_t *signature_info, int *verified_result)
+{
+  verification_cache_key_t key = {0};
+  const bool has_key = self->verification_cache &&
+      verification_cache_key_init(&key, signature_info) == SVI_OK;
+  if (has_key && verification_cache_lookup(self->verification_cache, &key, verified_result)) {
+    return SVI_OK;
+  }
+
+  const uint64_t start_ns = get_monotonic_time_ns();
+  svi_rc status = sv_rc_to_svi_rc(openssl_verify_hash(signature_info, verified_result));
+  counters_add_stage_time(self, SV_STAGE_VERIFY, start_ns);
+  counters_add_verification(self, status, *verified_result);
+  if (status == SVI_OK && has_key) {
+    verification_cache_store(self->verification_cache, &key, *verified_result);
+  }
 
   return status;
 }
@@ -714,8 +748,13 @@ prepare_for_validation(signed_video_t *self)
         gop_state->signing_present && !self->has_public_key, SVI_UNKNOWN, "No public key present");
     // If we have received a SEI there is a signature to use for verification.
     if (self->gop_info_detected.has_gop_sei) {
-      SVI_THROW(sv_rc_to_svi_rc(
-          openssl_verify_hash(signature_info, &self->gop_info->verified_signature_hash)));
+      if (sei && sei->has_verified_signature && !self->latest_validation->public_key_has_changed &&
+          self->gop_info->signature_hash_type == DOCUMENT_HASH) {
+        // The signature has already been verified together with other pending GOPs.
+        self->gop_info->verified_signature_hash = sei->verified_signature;
+      } else {
+        SVI_THROW(verify_signature(self, signature_info, &self->gop_info->verified_signature_hash));
+      }
     }
 
   SVI_CATCH()
@@ -756,6 +795,298 @@ is_recurrent_data_decoded(signed_video_t *self)
   return recurrent_data_decoded;
 }
 
+/* A signature verification job. It holds a copy of the session's |signature_info| with the
+ * |hash| and |signature| pointing to the data of a pending SEI. */
+typedef struct {
+  h26x_nalu_list_item_t *sei;
+  signature_info_t signature_info;
+  verification_cache_key_t key;
+  bool has_key;
+  SignedVideoReturnCode sv_rc;
+  int verified_signature;
+} signature_job_t;
+
+static void
+verify_signature_job(void *job)
+{
+  signature_job_t *signature_job = (signature_job_t *)job;
+
+  signature_job->sv_rc =
+      openssl_verify_hash(&signature_job->signature_info, &signature_job->verified_signature);
+}
+
+/* Returns true if |item| is a pending SEI, which signature has not yet been verified. */
+static bool
+is_sei_to_verify(const h26x_nalu_list_item_t *item)
+{
+  return item->nalu && item->nalu->is_gop_sei && item->validation_status == 'P' &&
+      !item->has_been_decoded && !item->has_verified_signature;
+}
+
+/* Verifies the signatures of all pending SEIs in parallel.
+ *
+ * When several GOPs are pending, e.g., when the public key arrives late or after a burst of delayed
+ * SEIs, the GOPs are validated one at a time in maybe_validate_gop(...). The signature verification
+ * is by far the most expensive part, and for SEIs signing the document hash it only depends on the
+ * SEI itself and the public key. Those verifications are therefore done up front by a worker pool,
+ * and the results are stored in the SEI items to be picked up by prepare_for_validation(...). For a
+ * session registered to a validation service, they are done inline on the worker of the service.
+ *
+ * SEIs signing a gop_hash depend on the validation of previous GOPs and are left to be verified
+ * as before. A failure in this function is not critical, since the signatures not verified here
+ * are verified when the GOP is validated.
+ *
+ * Returns true if any signature was verified. */
+static bool
+verify_pending_signatures(signed_video_t *self)
+{
+  h26x_nalu_list_t *nalu_list = self->nalu_list;
+
+  if (nalu_list->gop_idx < 2 || !self->has_public_key) return false;
+
+  int num_seis = 0;
+  h26x_nalu_list_item_t *item = nalu_list->first_item;
+  while (item) {
+    if (is_sei_to_verify(item)) num_seis++;
+    item = item->next;
+  }
+  if (num_seis < 2) return false;
+
+  signature_job_t *jobs = (signature_job_t *)calloc(num_seis, sizeof(signature_job_t));
+  if (!jobs) return false;
+
+  bool has_verified_signatures = false;
+  size_t num_jobs = 0;
+  item = nalu_list->first_item;
+  while (item) {
+    hash_type_t hash_type = GOP_HASH;
+    const uint8_t *signature = NULL;
+    size_t signature_size = 0;
+    if (is_sei_to_verify(item) &&
+        tlv_find_signature(item->nalu->tlv_data, item->nalu->tlv_size, &hash_type, &signature,
+            &signature_size) == SVI_OK &&
+        hash_type == DOCUMENT_HASH) {
+      signature_job_t *job = &jobs[num_jobs];
+      job->sei = item;
+      // The public key and algo are shared, read-only, by all jobs.
+      job->signature_info = *self->signature_info;
+      job->signature_info.hash = item->hash;
+      job->signature_info.signature = (uint8_t *)signature;
+      job->signature_info.signature_size = signature_size;
+      // The cache is not thread safe, hence looked up here and updated once the jobs are done.
+      job->has_key = self->verification_cache &&
+          verification_cache_key_init(&job->key, &job->signature_info) == SVI_OK;
+      int verified_signature = -1;
+      if (job->has_key &&
+          verification_cache_lookup(self->verification_cache, &job->key, &verified_signature)) {
+        item->has_verified_signature = true;
+        item->verified_signature = verified_signature;
+        has_verified_signatures = true;
+      } else {
+        num_jobs++;
+      }
+    }
+    item = item->next;
+  }
+
+  const uint64_t start_ns = get_monotonic_time_ns();
+  svi_rc status = SVI_OK;
+  if (self->service_session) {
+    // A session registered to a validation service is processed by the workers of the service,
+    // which already keep the CPUs busy. A pool per worker would only oversubscribe them.
+    for (size_t i = 0; i < num_jobs; i++) {
+      verify_signature_job(&jobs[i]);
+    }
+  } else {
+    status = worker_pool_run(verify_signature_job, jobs, sizeof(signature_job_t), num_jobs);
+  }
+  // The jobs run in parallel, hence the wall time is counted.
+  if (num_jobs > 0) counters_add_stage_time(self, SV_STAGE_VERIFY, start_ns);
+  if (status == SVI_OK) {
+    for (size_t i = 0; i < num_jobs; i++) {
+      counters_add_verification(self, sv_rc_to_svi_rc(jobs[i].sv_rc), jobs[i].verified_signature);
+      // Leave failed verifications to prepare_for_validation(...) to get the same error handling.
+      if (jobs[i].sv_rc != SV_OK) continue;
+      jobs[i].sei->has_verified_signature = true;
+      jobs[i].sei->verified_signature = jobs[i].verified_signature;
+      has_verified_signatures = true;
+      if (jobs[i].has_key) {
+        verification_cache_store(
+            self->verification_cache, &jobs[i].key, jobs[i].verified_signature);
+      }
+    }
+  }
+  free(jobs);
+
+  return has_verified_signatures;
+}
+
+/* Removes the |has_verified_signature| flag from all items. The results are only valid with the
+ * public key used when verifying, hence they should not outlive maybe_validate_gop(...). */
+static void
+remove_verified_signatures(h26x_nalu_list_t *nalu_list)
+{
+  h26x_nalu_list_item_t *item = nalu_list->first_item;
+  while (item) {
+    item->has_verified_signature = false;
+    item = item->next;
+  }
+}
+
+/* Removes the |provisional_status| from all items. */
+static void
+remove_provisional_statuses(h26x_nalu_list_t *nalu_list)
+{
+  h26x_nalu_list_item_t *item = nalu_list->first_item;
+  while (item) {
+    item->provisional_status = '\0';
+    item = item->next;
+  }
+}
+
+/* Sets the |provisional_status| of the pending NALUs prior to the |sei| by comparing their hashes
+ * against the hash list, in the same order as verify_hashes_with_hash_list(...), but without
+ * touching their |validation_status|. The last hash in the list belongs to the NALU after the
+ * |sei|, which has not yet been received.
+ *
+ * Returns the number of NALUs with hashes not found in the hash list. */
+static int
+set_provisional_statuses(signed_video_t *self, h26x_nalu_list_item_t *sei, int *num_received_nalus)
+{
+  const uint8_t *expected_hashes = self->gop_info->hash_list;
+  const int num_expected_hashes = self->gop_info->list_idx / HASH_DIGEST_SIZE;
+  const bool is_verified = (self->gop_info->verified_signature_hash == 1);
+
+  int num_invalid_nalus = 0;
+  int latest_match_idx = -1;
+  h26x_nalu_list_item_t *item = self->nalu_list->first_item;
+  while (item && item != sei) {
+    // Skip items not pending, e.g., ignored or missing NALUs.
+    if (item->validation_status != 'P') {
+      item = item->next;
+      continue;
+    }
+    (*num_received_nalus)++;
+    // Fetch the |hash_to_verify| as in verify_hashes_with_hash_list(...).
+    const uint8_t *hash_to_verify = item->need_second_verification ? item->second_hash : item->hash;
+    int compare_idx = latest_match_idx + 1;
+    while (is_verified && compare_idx < num_expected_hashes) {
+      const uint8_t *expected_hash = &expected_hashes[compare_idx * HASH_DIGEST_SIZE];
+      if (memcmp(hash_to_verify, expected_hash, HASH_DIGEST_SIZE) == 0) break;
+      compare_idx++;
+    }
+    if (is_verified && compare_idx < num_expected_hashes) {
+      item->provisional_status = item->first_verification_not_authentic ? 'N' : '.';
+      latest_match_idx = compare_idx;
+    } else {
+      // Without a verified signature no hash can be trusted.
+      item->provisional_status = 'N';
+    }
+    if (item->provisional_status == 'N') num_invalid_nalus++;
+    item = item->next;
+  }
+  switch (self->gop_info->verified_signature_hash) {
+    case 1:
+      sei->provisional_status = '.';
+      break;
+    case 0:
+      sei->provisional_status = 'N';
+      num_invalid_nalus++;
+      break;
+    default:
+      sei->provisional_status = 'E';
+      num_invalid_nalus++;
+      break;
+  }
+
+  return num_invalid_nalus;
+}
+
+/* Gives an early verdict on the GOP as soon as its SEI arrives, if enabled through
+ * signed_video_set_early_verdict(...).
+ *
+ * A GOP is normally validated when the NALU after the SEI has been received, since the hash of that
+ * NALU completes the signed hash list. With frame level signing the signature only depends on the
+ * SEI itself, hence it can be verified, and the NALUs already received compared against the hash
+ * list, right away. The result is reported as provisional. When the next NALU arrives the GOP is
+ * validated as usual, reusing the decoded SEI and the verified signature. */
+static svi_rc
+maybe_give_early_verdict(signed_video_t *self, h26x_nalu_t *nalu)
+{
+  assert(self && nalu);
+
+  gop_state_t *gop_state = &(self->gop_state);
+  gop_info_detected_t *gop_info_detected = &(self->gop_info_detected);
+  signed_video_latest_validation_t *latest = self->latest_validation;
+  h26x_nalu_list_t *nalu_list = self->nalu_list;
+
+  if (!self->early_verdict || !nalu->is_gop_sei) return SVI_OK;
+  // Only an on time SEI can be given an early verdict. Further, if this is the first validation,
+  // or if there are pending GOPs waiting for the public key, the result is not known until the GOP
+  // has been validated.
+  if (gop_state->auth_state != AUTH_STATE_WAIT_FOR_NEXT_NALU || gop_state->is_first_validation ||
+      nalu_list->gop_idx > 0 || !self->has_public_key) {
+    return SVI_OK;
+  }
+  h26x_nalu_list_item_t *sei = nalu_list->last_item;
+  if (sei->validation_status != 'P' || h26x_nalu_list_get_next_sei_item(nalu_list) != sei) {
+    return SVI_OK;
+  }
+  // Only a signed document hash, that is, frame level signing, can be verified at this point.
+  hash_type_t hash_type = GOP_HASH;
+  const uint8_t *signature = NULL;
+  size_t signature_size = 0;
+  if (tlv_find_signature(nalu->tlv_data, nalu->tlv_size, &hash_type, &signature,
+          &signature_size) != SVI_OK ||
+      hash_type != DOCUMENT_HASH) {
+    return SVI_OK;
+  }
+
+  svi_rc status = SVI_UNKNOWN;
+  SVI_TRY()
+    latest->public_key_has_changed = false;
+    SVI_THROW(decode_sei_data(self, nalu->tlv_data, nalu->tlv_size));
+    sei->has_been_decoded = true;
+    memcpy(self->signature_info->hash, sei->hash, HASH_DIGEST_SIZE);
+    // In decode_sei_data(...) a lost GOP transition is detected when the SEI is decoded upon the
+    // next NALU. This SEI is on time, hence it applies already.
+    if (gop_info_detected->has_lost_sei) gop_info_detected->gop_transition_is_lost = true;
+    const uint64_t verify_start_ns = get_monotonic_time_ns();
+    const svi_rc verify_status = sv_rc_to_svi_rc(
+        openssl_verify_hash(self->signature_info, &self->gop_info->verified_signature_hash));
+    counters_add_stage_time(self, SV_STAGE_VERIFY, verify_start_ns);
+    counters_add_verification(self, verify_status, self->gop_info->verified_signature_hash);
+    SVI_THROW(verify_status);
+    // Hand over the result to prepare_for_validation(...).
+    sei->has_verified_signature = true;
+    sei->verified_signature = self->gop_info->verified_signature_hash;
+    gop_state->has_early_verdict = true;
+
+    int num_received_nalus = 0;
+    const int num_expected_nalus = self->gop_info->list_idx / HASH_DIGEST_SIZE;
+    const int num_invalid_nalus = set_provisional_statuses(self, sei, &num_received_nalus);
+    SignedVideoAuthenticityResult valid = SV_AUTH_RESULT_OK;
+    if (num_invalid_nalus > 0 || latest->public_key_has_changed) {
+      valid = SV_AUTH_RESULT_NOT_OK;
+    } else if (num_received_nalus < num_expected_nalus - 1) {
+      valid = SV_AUTH_RESULT_OK_WITH_MISSING_INFO;
+    }
+    latest->authenticity = valid;
+    latest->number_of_expected_picture_nalus = num_expected_nalus;
+    latest->number_of_received_picture_nalus = num_received_nalus;
+    latest->number_of_pending_picture_nalus = h26x_nalu_list_num_pending_items(nalu_list);
+    latest->is_provisional = true;
+    // The signature is verified again upon validation unless picked up from the |sei|.
+    self->gop_info->verified_signature_hash = -1;
+    gop_state->has_auth_result = true;
+  SVI_CATCH()
+  SVI_DONE(status)
+
+  DEBUG_LOG("Early verdict on GOP as %s", kAuthResultValidStr[latest->authenticity]);
+
+  return status;
+}
+
 /* Validates the authenticity of the video since last time if the state says so. After the
  * validation the gop state is reset w.r.t. a new GOP. */
 static svi_rc
@@ -772,6 +1103,12 @@ maybe_validate_gop(signed_video_t *self, h26x_nalu_t *nalu)
   // We cannot end up in AUTH_STATE_VALIDATE if the NALU is not hashable.
   assert(nalu->is_hashable);
 
+  // This validation replaces the provisional result of an early verdict, if any.
+  const bool has_early_verdict = gop_state->has_early_verdict;
+  gop_state->has_early_verdict = false;
+  latest->is_provisional = false;
+  if (has_early_verdict) remove_provisional_statuses(nalu_list);
+
   // Copy |gop_info_detected| and |gop_state| to struct |nalu_list|. This is needed if the public
   // key arrives late. When public key eventually arrives, correct |gop_info_detected| and
   // |gop_state| can be used for that specific gop.
@@ -780,6 +1117,7 @@ maybe_validate_gop(signed_video_t *self, h26x_nalu_t *nalu)
     memcpy(&nalu_list->gop_info_detected_pending[nalu_list->gop_idx], gop_info_detected,
         sizeof(gop_info_detected_t));
     nalu_list->gop_idx++;
+    counters_update_high_water_marks(self);
   } else {
     DEBUG_LOG("Warning: Number of pending gops exeeds limit > %d", MAX_PENDING_GOPS);
     return SVI_MEMORY;
@@ -795,7 +1133,15 @@ maybe_validate_gop(signed_video_t *self, h26x_nalu_t *nalu)
   latest->number_of_expected_picture_nalus = -1;
   latest->number_of_received_picture_nalus = -1;
   latest->number_of_pending_picture_nalus = -1;
-  latest->public_key_has_changed = false;
+  // A change of public key has already been detected if the SEI was decoded for an early verdict.
+  if (!has_early_verdict) latest->public_key_has_changed = false;
+
+  // Verify the signatures of all pending GOPs in parallel before validating them in order.
+  bool has_verified_signatures = verify_pending_signatures(self);
+
+  // Set if the GOP before a seek point is validated.
+  bool has_boundary_validation = false;
+  const int num_validations = nalu_list->gop_idx;
 
   svi_rc status = SVI_UNKNOWN;
   SVI_TRY()
@@ -816,6 +1162,19 @@ maybe_validate_gop(signed_video_t *self, h26x_nalu_t *nalu)
       } else {
         validate_authenticity(self);
       }
+      // The first validation of a range is the GOP before it, which is only represented by the SEI
+      // completing it.
+      if (self->range_results && self->range_num_validations++ > 0 &&
+          self->range_num_validations <= self->range_num_gops + 1) {
+        self->range_results[self->range_num_validations - 2] = latest->authenticity;
+      }
+
+      // After a seek to a SEI, the first validation is of the GOP before the seek point, which is
+      // only represented by that SEI.
+      if (self->skip_boundary_validation) {
+        has_boundary_validation = true;
+        self->skip_boundary_validation = false;
+      }
 
       // The flag |is_first_validation| is used to ignore the first validation if we start the
       // validation in the middle of a stream. Now it is time to reset it.
@@ -838,6 +1197,17 @@ maybe_validate_gop(signed_video_t *self, h26x_nalu_t *nalu)
   SVI_CATCH()
   SVI_DONE(status)
 
+  if (has_verified_signatures) remove_verified_signatures(nalu_list);
+  // With on-time SEIs, the latest SEI completed the GOP just validated, and everything before it
+  // has been validated.
+  if (status == SVI_OK && num_validations > 0) {
+    self->checkpoint_idx = self->latest_sei_idx;
+    self->has_validated_gop = true;
+  }
+  // The verdict of the GOP before a seek point has no meaning to the user. Report nothing unless
+  // later GOPs were validated as well.
+  if (has_boundary_validation && num_validations == 1) gop_state->has_auth_result = false;
+
   // All statistics but pending NALUs have already been collected.
   latest->number_of_pending_picture_nalus = h26x_nalu_list_num_pending_items(nalu_list);
 
@@ -897,16 +1267,20 @@ register_nalu(signed_video_t *self, h26x_nalu_t *nalu)
  *    AUTH_STATE_INIT.
  */
 static svi_rc
-signed_video_add_h26x_nalu(signed_video_t *self, const uint8_t *nalu_data, size_t nalu_data_size)
+add_h26x_nalu(signed_video_t *self, h26x_nalu_t *nalu)
 {
-  if (!self || !nalu_data || (nalu_data_size == 0)) return SVI_INVALID_PARAMETER;
+  assert(self && nalu);
 
   h26x_nalu_list_t *nalu_list = self->nalu_list;
   gop_state_t *gop_state = &(self->gop_state);
   gop_info_detected_t *gop_info_detected = &(self->gop_info_detected);
   gop_state->has_auth_result = false;
-  h26x_nalu_t nalu = parse_nalu_info(nalu_data, nalu_data_size, self->codec, true);
-  DEBUG_LOG("Received a %s of size %zu B", nalu_type_to_str(&nalu), nalu.nalu_data_size);
+  DEBUG_LOG("Received a %s of size %zu B", nalu_type_to_str(nalu), nalu->nalu_data_size);
+  // Keep track of the position in the stream for checkpoints.
+  const uint64_t nalu_idx = self->num_added_nalus++;
+  if (nalu->is_gop_sei) self->latest_sei_idx = nalu_idx;
+  self->is_latest_nalu_sei = nalu->is_gop_sei;
+  counters_add_nalu(self, nalu);
 
   svi_rc status = SVI_UNKNOWN;
   SVI_TRY()
@@ -915,12 +1289,20 @@ signed_video_add_h26x_nalu(signed_video_t *self, const uint8_t *nalu_data, size_
         !nalu_list, SVI_MEMORY, "No existing nalu_list. Cannot validate authenticity");
     // Append the |nalu_list| with a new item holding a pointer to |nalu|. The |validation_status|
     // is set accordingly.
-    SVI_THROW(h26x_nalu_list_append(nalu_list, &nalu));
-    SVI_THROW_IF(nalu.is_valid < 0, SVI_UNKNOWN);
-    gop_state_pre_actions(&self->gop_state, &nalu);
-    SVI_THROW(register_nalu(self, &nalu));
-    gop_state_update(gop_state, gop_info_detected, &nalu);
-    SVI_THROW(maybe_validate_gop(self, &nalu));
+    SVI_THROW(h26x_nalu_list_append(nalu_list, nalu));
+    counters_update_high_water_marks(self);
+    SVI_THROW_IF(nalu->is_valid < 0, SVI_UNKNOWN);
+    // The first hashable NALU after a seek tells if the stream resumes at the SEI of the GOP before
+    // the seek point.
+    if (self->is_after_seek && nalu->is_hashable) {
+      self->skip_boundary_validation = nalu->is_gop_sei;
+      self->is_after_seek = false;
+    }
+    gop_state_pre_actions(&self->gop_state, nalu);
+    SVI_THROW(register_nalu(self, nalu));
+    gop_state_update(gop_state, gop_info_detected, nalu);
+    SVI_THROW(maybe_validate_gop(self, nalu));
+    SVI_THROW(maybe_give_early_verdict(self, nalu));
   SVI_CATCH()
   {
     // We aborted while processing the NALU; reset |auth_state|.
@@ -934,11 +1316,112 @@ signed_video_add_h26x_nalu(signed_video_t *self, const uint8_t *nalu_data, size_
   status = (status == SVI_OK) ? copy_nalu_status : status;
   if (status != SVI_OK) nalu_list->last_item->validation_status = 'E';
 
+  return status;
+}
+
+static svi_rc
+signed_video_add_h26x_nalu(signed_video_t *self, const uint8_t *nalu_data, size_t nalu_data_size)
+{
+  if (!self || !nalu_data || (nalu_data_size == 0)) return SVI_INVALID_PARAMETER;
+
+  const uint64_t start_ns = get_monotonic_time_ns();
+  h26x_nalu_t nalu = parse_nalu_info(nalu_data, nalu_data_size, self->codec, true);
+  counters_add_stage_time(self, SV_STAGE_PARSE, start_ns);
+  svi_rc status = add_h26x_nalu(self, &nalu);
   free(nalu.tmp_tlv_memory);
 
   return status;
 }
 
+/* Adds the detached SEIs positioned at, or before, the next video NALU. Sets |has_auth_result| if
+ * any of them resulted in an authenticity result. */
+static svi_rc
+add_detached_seis(signed_video_t *self, bool *has_auth_result)
+{
+  size_t num_added_seis = 0;
+  svi_rc status = SVI_OK;
+  while (num_added_seis < self->num_detached_seis &&
+      self->detached_seis[num_added_seis].nalu_idx <= self->num_video_nalus) {
+    const detached_sei_t *detached_sei = &self->detached_seis[num_added_seis++];
+    status = signed_video_add_h26x_nalu(self, detached_sei->sei, detached_sei->sei_size);
+    if (status != SVI_OK) break;
+    if (self->gop_state.has_auth_result) *has_auth_result = true;
+  }
+  if (num_added_seis == 0) return status;
+
+  // The added SEIs have been copied to the |nalu_list|.
+  for (size_t i = 0; i < num_added_seis; i++) {
+    free(self->detached_seis[i].sei);
+  }
+  self->num_detached_seis -= num_added_seis;
+  memmove(self->detached_seis, self->detached_seis + num_added_seis,
+      self->num_detached_seis * sizeof(detached_sei_t));
+
+  return status;
+}
+
+/* A NALU added through add_sequenced_nalu(...), waiting in the |sequencer| to be added to the
+ * session. */
+typedef struct {
+  uint8_t *nalu_data;  // A copy of the NALU data owned by this struct. The |nalu| points into it.
+  h26x_nalu_t nalu;  // The parsed NALU.
+  uint8_t hash[HASH_DIGEST_SIZE];  // The hash of the |nalu| computed by the producer.
+} sequenced_nalu_t;
+
+/* Declared in signed_video_h26x_internal.h */
+void
+sequenced_nalu_free(void *item)
+{
+  sequenced_nalu_t *sequenced_nalu = (sequenced_nalu_t *)item;
+  if (!sequenced_nalu) return;
+
+  free(sequenced_nalu->nalu.tmp_tlv_memory);
+  free(sequenced_nalu->nalu_data);
+  free(sequenced_nalu);
+}
+
+/* Declared in signed_video_h26x_internal.h */
+void
+sequenced_report_free(void *report)
+{
+  signed_video_authenticity_report_free((signed_video_authenticity_t *)report);
+}
+
+/* Declared in signed_video_h26x_internal.h
+ *
+ * Adds a NALU to the session in sequence order. This runs on one producer thread at a time, hence
+ * it is safe to touch the session states. If a GOP was validated, a copy of the authenticity
+ * report is queued to be popped through signed_video_pop_authenticity_report(...). */
+svi_rc
+process_sequenced_nalu(void *user_data, void *item)
+{
+  signed_video_t *self = (signed_video_t *)user_data;
+  sequenced_nalu_t *sequenced_nalu = (sequenced_nalu_t *)item;
+  assert(self && sequenced_nalu);
+
+  signed_video_authenticity_t *authenticity = NULL;
+
+  svi_rc status = SVI_UNKNOWN;
+  SVI_TRY()
+    SVI_THROW(create_local_authenticity_report_if_needed(self));
+    SVI_THROW(add_h26x_nalu(self, &sequenced_nalu->nalu));
+    if (self->gop_state.has_auth_result) {
+      authenticity = signed_video_get_authenticity_report(self);
+      SVI_THROW_IF(!authenticity, SVI_MEMORY);
+      SVI_THROW(sequencer_push_output(self->sequencer, authenticity));
+      authenticity = NULL;
+    }
+  SVI_CATCH()
+  {
+    signed_video_authenticity_report_free(authenticity);
+  }
+  SVI_DONE(status)
+
+  sequenced_nalu_free(sequenced_nalu);
+
+  return status;
+}
+
 SignedVideoReturnCode
 signed_video_add_nalu_and_authenticate(signed_video_t *self,
     const uint8_t *nalu_data,
@@ -947,20 +1430,323 @@ signed_video_add_nalu_and_authenticate(signed_video_t *self,
 {
   if (!self || !nalu_data || nalu_data_size == 0) return SV_INVALID_PARAMETER;
 
+  const uint64_t trace_start_ns = self->trace_sink ? get_monotonic_time_ns() : 0;
   // If the user requests an authenticity report, initialize to NULL.
   if (authenticity) *authenticity = NULL;
 
+  bool has_auth_result = false;
   svi_rc status = SVI_UNKNOWN;
   SVI_TRY()
     SVI_THROW(create_local_authenticity_report_if_needed(self));
 
+    SVI_THROW(add_detached_seis(self, &has_auth_result));
     SVI_THROW(signed_video_add_h26x_nalu(self, nalu_data, nalu_data_size));
-    if (self->gop_state.has_auth_result) {
+    self->num_video_nalus++;
+    if (self->gop_state.has_auth_result) has_auth_result = true;
+    if (has_auth_result) {
       if (authenticity) *authenticity = signed_video_get_authenticity_report(self);
     }
 
   SVI_CATCH()
   SVI_DONE(status)
 
+  const SignedVideoReturnCode return_code = svi_rc_to_signed_video_rc(status);
+  if (self->trace_sink) {
+    trace_nalu(self, true, nalu_data, nalu_data_size, trace_start_ns, return_code, has_auth_result);
+  }
+
+  return return_code;
+}
+
+/* Declared in signed_video_h26x_internal.h */
+svi_rc
+add_sequenced_nalu(signed_video_t *self,
+    uint64_t sequence_number,
+    uint8_t *nalu_data,
+    size_t nalu_data_size)
+{
+  if (!self || !nalu_data || nalu_data_size == 0) {
+    free(nalu_data);
+    return SVI_INVALID_PARAMETER;
+  }
+
+  sequenced_nalu_t *sequenced_nalu = NULL;
+
+  svi_rc status = SVI_UNKNOWN;
+  SVI_TRY()
+    // If there is no |sequencer| we failed allocating memory for it.
+    SVI_THROW_IF_WITH_MSG(
+        !self->sequencer, SVI_MEMORY, "No existing sequencer. Cannot validate authenticity");
+    sequenced_nalu = calloc(1, sizeof(sequenced_nalu_t));
+    SVI_THROW_IF(!sequenced_nalu, SVI_MEMORY);
+    sequenced_nalu->nalu_data = nalu_data;
+    nalu_data = NULL;
+
+    // Parsing and hashing do not depend on the session states, hence they run on the producer
+    // thread, in parallel with other producers.
+    h26x_nalu_t *nalu = &sequenced_nalu->nalu;
+    *nalu = parse_nalu_info(sequenced_nalu->nalu_data, nalu_data_size, self->codec, true);
+    if (nalu->is_valid > 0 && nalu->is_hashable) {
+      update_hashable_data(nalu);
+      SVI_THROW(sv_rc_to_svi_rc(
+          openssl_hash_data(nalu->hashable_data, nalu->hashable_data_size, sequenced_nalu->hash)));
+      nalu->precomputed_hash = sequenced_nalu->hash;
+    }
+
+    // The |sequencer| takes ownership of the |sequenced_nalu|, also upon failure.
+    svi_rc submit_status = sequencer_submit(self->sequencer, sequence_number, sequenced_nalu);
+    sequenced_nalu = NULL;
+    SVI_THROW(submit_status);
+  SVI_CATCH()
+  {
+    sequenced_nalu_free(sequenced_nalu);
+    free(nalu_data);
+  }
+  SVI_DONE(status)
+
+  return status;
+}
+
+SignedVideoReturnCode
+signed_video_add_sequenced_nalu_and_authenticate(signed_video_t *self,
+    uint64_t sequence_number,
+    const uint8_t *nalu_data,
+    size_t nalu_data_size)
+{
+  if (!self || !nalu_data || nalu_data_size == 0) return SV_INVALID_PARAMETER;
+
+  // Copy the NALU data, since the user may release its memory before the NALU is processed.
+  uint8_t *nalu_data_copy = malloc(nalu_data_size);
+  if (!nalu_data_copy) return SV_MEMORY;
+  memcpy(nalu_data_copy, nalu_data, nalu_data_size);
+
+  return svi_rc_to_signed_video_rc(
+      add_sequenced_nalu(self, sequence_number, nalu_data_copy, nalu_data_size));
+}
+
+/* Declared in signed_video_h26x_internal.h */
+size_t
+get_next_nalu_in_bytestream(const uint8_t *data, size_t data_size, size_t *offset)
+{
+  size_t start = *offset;
+  // Skip the zero bytes of the start code.
+  size_t pos = start;
+  while (pos < data_size && data[pos] == 0) pos++;
+  if (pos == start || pos - start < 2 || pos >= data_size || data[pos] != 1) return 0;
+  pos++;
+
+  // Search for the next start code.
+  while (pos + 2 < data_size && !(data[pos] == 0 && data[pos + 1] == 0 && data[pos + 2] == 1)) {
+    pos++;
+  }
+  if (pos + 2 >= data_size) {
+    pos = data_size;
+  } else {
+    // Trailing zero bytes belong to the next start code.
+    while (pos > start && data[pos - 1] == 0) pos--;
+  }
+  *offset = pos;
+
+  return pos - start;
+}
+
+signed_video_authenticity_t *
+signed_video_pop_authenticity_report(signed_video_t *self)
+{
+  if (!self) return NULL;
+
+  return (signed_video_authenticity_t *)sequencer_pop_output(self->sequencer);
+}
+
+SignedVideoReturnCode
+signed_video_set_early_verdict(signed_video_t *self, bool enable)
+{
+  if (!self) return SV_INVALID_PARAMETER;
+
+  self->early_verdict = enable;
+
+  return SV_OK;
+}
+
+SignedVideoReturnCode
+signed_video_set_verification_cache_size(signed_video_t *self, size_t num_entries)
+{
+  if (!self) return SV_INVALID_PARAMETER;
+
+  verification_cache_t *verification_cache = NULL;
+  if (num_entries > 0) {
+    verification_cache = verification_cache_create(num_entries);
+    if (!verification_cache) return SV_MEMORY;
+  }
+  verification_cache_free(self->verification_cache);
+  self->verification_cache = verification_cache;
+
+  return SV_OK;
+}
+
+SignedVideoReturnCode
+signed_video_reset_after_seek(signed_video_t *self)
+{
+  if (!self) return SV_INVALID_PARAMETER;
+  // The states of a session registered to a validation service are touched by the workers.
+  if (self->service_session) return SV_NOT_SUPPORTED;
+
+  SignedVideoReturnCode rc = signed_video_reset(self);
+  if (rc != SV_OK) return rc;
+  self->is_after_seek = true;
+
+  return SV_OK;
+}
+
+/* Declared in signed_video_h26x_internal.h */
+void
+range_validation_begin(signed_video_t *self,
+    SignedVideoAuthenticityResult *results,
+    size_t num_gops)
+{
+  self->range_results = results;
+  self->range_num_gops = num_gops;
+  self->range_num_validations = 0;
+}
+
+/* Declared in signed_video_h26x_internal.h */
+size_t
+range_validation_end(signed_video_t *self)
+{
+  const size_t num_validations = self->range_num_validations;
+  self->range_results = NULL;
+  self->range_num_gops = 0;
+  self->range_num_validations = 0;
+
+  return num_validations > 1 ? num_validations - 1 : 0;
+}
+
+SignedVideoReturnCode
+signed_video_validate_gop_range(signed_video_t *self,
+    const uint8_t *data,
+    size_t data_size,
+    SignedVideoAuthenticityResult *results,
+    size_t num_gops,
+    size_t *num_validated_gops)
+{
+  if (!self || !data || data_size == 0 || !results || num_gops == 0 || !num_validated_gops) {
+    return SV_INVALID_PARAMETER;
+  }
+  // A range cannot be validated while NALUs are added in sequence.
+  if (self->service_session) return SV_NOT_SUPPORTED;
+
+  *num_validated_gops = 0;
+  SignedVideoReturnCode rc = signed_video_reset(self);
+  if (rc != SV_OK) return rc;
+
+  range_validation_begin(self, results, num_gops);
+
+  svi_rc status = SVI_UNKNOWN;
+  SVI_TRY()
+    SVI_THROW(create_local_authenticity_report_if_needed(self));
+    size_t offset = 0;
+    // Add NALUs until the GOP before the range and all GOPs of the range have been validated.
+    while (self->range_num_validations <= num_gops && offset < data_size) {
+      const uint8_t *nalu_data = data + offset;
+      size_t nalu_data_size = get_next_nalu_in_bytestream(data, data_size, &offset);
+      SVI_THROW_IF_WITH_MSG(nalu_data_size == 0, SVI_INVALID_PARAMETER, "Missing start code");
+      SVI_THROW(signed_video_add_h26x_nalu(self, nalu_data, nalu_data_size));
+    }
+  SVI_CATCH()
+  SVI_DONE(status)
+
+  *num_validated_gops = range_validation_end(self);
+  if (*num_validated_gops > num_gops) *num_validated_gops = num_gops;
+
+  return svi_rc_to_signed_video_rc(status);
+}
+
+SignedVideoReturnCode
+signed_video_validate_and_store_results(signed_video_t *self,
+    const uint8_t *data,
+    size_t data_size,
+    sv_result_sink_t sink,
+    void *user_data)
+{
+  if (!self || !data || data_size == 0 || !sink) return SV_INVALID_PARAMETER;
+  // The recording is validated from its start, which is not possible while NALUs are added in
+  // sequence.
+  if (self->service_session) return SV_NOT_SUPPORTED;
+
+  SignedVideoReturnCode rc = signed_video_reset(self);
+  if (rc != SV_OK) return rc;
+
+  svi_rc status = SVI_UNKNOWN;
+  SVI_TRY()
+    SVI_THROW(create_local_authenticity_report_if_needed(self));
+    const signed_video_latest_validation_t *latest = self->latest_validation;
+    // With on-time SEIs, a GOP is validated when the NALU after the SEI completing it is added.
+    // Hence, the latest added SEI is the one of the validated GOP.
+    sv_result_record_t record = {0};
+    size_t offset = 0;
+    while (offset < data_size) {
+      const size_t nalu_offset = offset;
+      size_t nalu_data_size = get_next_nalu_in_bytestream(data, data_size, &offset);
+      SVI_THROW_IF_WITH_MSG(nalu_data_size == 0, SVI_INVALID_PARAMETER, "Missing start code");
+      SVI_THROW(signed_video_add_h26x_nalu(self, data + nalu_offset, nalu_data_size));
+      if (self->is_latest_nalu_sei) {
+        record.sei_offset = nalu_offset;
+        record.sei_size = (uint32_t)nalu_data_size;
+        SVI_THROW(sv_rc_to_svi_rc(
+            openssl_hash_data(data + nalu_offset, nalu_data_size, record.sei_digest)));
+      }
+      if (!self->gop_state.has_auth_result || latest->is_provisional) continue;
+
+      record.authenticity = latest->authenticity;
+      record.gop_counter = self->gop_info->global_gop_counter;
+      record.number_of_expected_picture_nalus = latest->number_of_expected_picture_nalus;
+      record.number_of_received_picture_nalus = latest->number_of_received_picture_nalus;
+      // A GOP without a SEI has nothing to check later on.
+      if (latest->authenticity == SV_AUTH_RESULT_NOT_SIGNED) {
+        record.sei_offset = 0;
+        record.sei_size = 0;
+        memset(record.sei_digest, 0, SV_RESULT_DIGEST_SIZE);
+      }
+      uint8_t serialized_record[SV_RESULT_RECORD_SIZE] = {0};
+      result_record_write(&record, serialized_record);
+      sink(serialized_record, SV_RESULT_RECORD_SIZE, user_data);
+    }
+  SVI_CATCH()
+  SVI_DONE(status)
+
   return svi_rc_to_signed_video_rc(status);
 }
+
+SignedVideoReturnCode
+signed_video_add_detached_sei(signed_video_t *self, const uint8_t *record, size_t record_size)
+{
+  if (!self) return SV_INVALID_PARAMETER;
+  // NALUs added in sequence have no position in the video stream.
+  if (self->service_session) return SV_NOT_SUPPORTED;
+
+  uint64_t nalu_idx = 0;
+  const uint8_t *sei = NULL;
+  size_t sei_size = 0;
+  SignedVideoReturnCode rc =
+      signed_video_detached_sei_parse_record(record, record_size, &nalu_idx, &sei, &sei_size);
+  if (rc != SV_OK) return rc;
+  // The SEIs are added in stream order.
+  if (self->num_detached_seis > 0 &&
+      nalu_idx < self->detached_seis[self->num_detached_seis - 1].nalu_idx) {
+    return SV_INVALID_PARAMETER;
+  }
+
+  uint8_t *sei_copy = malloc(sei_size);
+  if (!sei_copy) return SV_MEMORY;
+  memcpy(sei_copy, sei, sei_size);
+  detached_sei_t *detached_seis =
+      realloc(self->detached_seis, (self->num_detached_seis + 1) * sizeof(detached_sei_t));
+  if (!detached_seis) {
+    free(sei_copy);
+    return SV_MEMORY;
+  }
+  self->detached_seis = detached_seis;
+  self->detached_seis[self->num_detached_seis++] = (detached_sei_t){nalu_idx, sei_copy, sei_size};
+
+  return SV_OK;
+}
@@ -162,14 +162,15 @@ signature_create()
 }
 
 static void
-signature_free(signature_info_t *self)
+signature_free(signature_info_t *self, const sv_plugin_t *plugin)
 {
   if (!self) return;
 
   free(self->private_key);
   free(self->public_key);
   free(self->hash);
-  sv_interface_free(self->signature);
+  // The |signature| is allocated by the signing plugin and has to be freed by the same plugin.
+  plugin->free(self->signature);
   free(self);
 }
 
@@ -285,6 +286,7 @@ reset_gop_hash(signed_video_t *self)
   assert(gop_info);
 
   gop_info->num_nalus_in_gop_hash = 0;
+  self->counters.num_combination_hashes++;
   return sv_rc_to_svi_rc(openssl_hash_data(&gop_info->gop_hash_init, 1, gop_info->gop_hash));
 }
 
@@ -937,11 +939,18 @@ get_hash_wrapper(signed_video_t *self, const h26x_nalu_t *nalu)
 
 /* simply_hash()
  *
- * takes the |hashable_data| from the NALU, hash it and store the hash in |nalu_hash|. */
+ * takes the |hashable_data| from the NALU, hash it and store the hash in |nalu_hash|. If the hash
+ * has already been computed, e.g., by a producer thread, the |precomputed_hash| is copied. */
 static svi_rc
-simply_hash(signed_video_t ATTR_UNUSED *self, const h26x_nalu_t *nalu, uint8_t *nalu_hash)
+simply_hash(signed_video_t *self, const h26x_nalu_t *nalu, uint8_t *nalu_hash)
 {
-  assert(nalu && nalu_hash);
+  assert(self && nalu && nalu_hash);
+  self->counters.num_hash_calls++;
+  self->counters.num_hashed_bytes += nalu->hashable_data_size;
+  if (nalu->precomputed_hash) {
+    memcpy(nalu_hash, nalu->precomputed_hash, HASH_DIGEST_SIZE);
+    return SVI_OK;
+  }
   const uint8_t *hashable_data = nalu->hashable_data;
   size_t hashable_data_size = nalu->hashable_data_size;
 
@@ -1002,6 +1011,7 @@ hash_with_reference(signed_video_t *self, const h26x_nalu_t *nalu, uint8_t *budd
     // Hash NALU data and store as |nalu_hash|.
     SVI_THROW(simply_hash(self, nalu, nalu_hash));
     // Hash reference hash together with the |nalu_hash| and store in |buddy_hash|.
+    self->counters.num_combination_hashes++;
     SVI_THROW(sv_rc_to_svi_rc(
         openssl_hash_data(gop_info->hash_buddies, HASH_DIGEST_SIZE * 2, buddy_hash)));
   SVI_CATCH()
@@ -1024,12 +1034,14 @@ hash_and_add(signed_video_t *self, const h26x_nalu_t *nalu)
   uint8_t *nalu_hash = gop_info->nalu_hash;
   assert(nalu_hash);
 
+  const uint64_t start_ns = get_monotonic_time_ns();
   svi_rc status = SVI_UNKNOWN;
   SVI_TRY()
     // Select hash function, hash the NALU and store as 'latest hash'
     hash_wrapper_t hash_wrapper = get_hash_wrapper(self, nalu);
     SVI_THROW(hash_wrapper(self, nalu, nalu_hash));
     check_and_copy_hash_to_hash_list(self, nalu_hash);
+    self->counters.num_combination_hashes++;
     SVI_THROW(update_gop_hash(gop_info));
     update_num_nalus_in_gop_hash(self, nalu);
   SVI_CATCH()
@@ -1038,6 +1050,7 @@ hash_and_add(signed_video_t *self, const h26x_nalu_t *nalu)
     gop_info->list_idx = -1;
   }
   SVI_DONE(status)
+  counters_add_stage_time(self, SV_STAGE_HASH, start_ns);
 
   return status;
 }
@@ -1061,6 +1074,7 @@ hash_and_add_for_auth(signed_video_t *self, const h26x_nalu_t *nalu)
   uint8_t *nalu_hash = this_item->hash;
   assert(nalu_hash);
 
+  const uint64_t start_ns = get_monotonic_time_ns();
   svi_rc status = SVI_UNKNOWN;
   SVI_TRY()
     // Select hash wrapper, hash the NALU and store as |nalu_hash|.
@@ -1088,6 +1102,7 @@ hash_and_add_for_auth(signed_video_t *self, const h26x_nalu_t *nalu)
 
   SVI_CATCH()
   SVI_DONE(status)
+  counters_add_stage_time(self, SV_STAGE_HASH, start_ns);
 
   return status;
 }
@@ -1106,6 +1121,8 @@ signed_video_create(SignedVideoCodec codec)
 
     self = (signed_video_t *)calloc(1, sizeof(signed_video_t));
     SVI_THROW_IF(!self, SVI_MEMORY);
+    // Use the built-in signing plugin until another one is loaded.
+    plugin_init_builtin(&self->plugin);
 
     version_str_to_bytes(self->code_version, SIGNED_VIDEO_VERSION);
     self->codec = codec;
@@ -1125,6 +1142,11 @@ signed_video_create(SignedVideoCodec codec)
     self->nalu_list = h26x_nalu_list_create();
     // No need to check if |nalu_list| is a nullptr, since it is only of importance on the
     // authentication side. The check is done there instead.
+    // The same applies to the |sequencer|.
+    self->sequencer =
+        sequencer_create(process_sequenced_nalu, sequenced_nalu_free, sequenced_report_free, self);
+    // The |verification_cache| is only an optimization, hence a failure is not critical.
+    self->verification_cache = verification_cache_create(VERIFICATION_CACHE_DEFAULT_SIZE);
 
     self->signing_present = -1;
     gop_state_init(&(self->gop_state));
@@ -1138,9 +1160,10 @@ signed_video_create(SignedVideoCodec codec)
 
     self->frame_count = RECURRENCE_OFFSET_DEFAULT;
     self->has_recurrent_data = false;
+    self->frames_since_sei = -1;
 
     // Setup the plugin.
-    self->plugin_handle = sv_interface_setup();
+    self->plugin_handle = self->plugin.setup();
     SVI_THROW_IF(!self->plugin_handle, SVI_EXTERNAL_FAILURE);
     // Setup vendor handle.
 #ifdef SV_VENDOR_AXIS_COMMUNICATIONS
@@ -1179,6 +1202,20 @@ signed_video_reset(signed_video_t *self)
     latest_validation_init(self->latest_validation);
     // Empty the |nalu_list|.
     h26x_nalu_list_free_items(self->nalu_list);
+    // Drop NALUs and reports of sequenced validation and start over from sequence number 0.
+    sequencer_reset(self->sequencer);
+    // Intermediate SEIs are counted from the first SEI after the reset.
+    self->frames_since_sei = -1;
+    self->is_after_seek = false;
+    self->skip_boundary_validation = false;
+    // Positions are counted from the reset.
+    self->num_added_nalus = 0;
+    self->latest_sei_idx = 0;
+    self->is_latest_nalu_sei = false;
+    self->checkpoint_idx = 0;
+    self->has_validated_gop = false;
+    self->num_video_nalus = 0;
+    free_detached_seis(self);
 
     SVI_THROW(reset_gop_hash(self));
   SVI_CATCH()
@@ -1193,8 +1230,11 @@ signed_video_free(signed_video_t *self)
   DEBUG_LOG("Free signed video %p", self);
   if (!self) return;
 
+  // Workers of a service may still be adding NALUs to the session. Wait for them and unregister.
+  service_remove_session(self);
+
   // Teardown the plugin before closing.
-  sv_interface_teardown(self->plugin_handle);
+  self->plugin.teardown(self->plugin_handle);
   // Teardown the vendor handle.
 #ifdef SV_VENDOR_AXIS_COMMUNICATIONS
   sv_vendor_axis_communications_teardown(self->vendor_handle);
@@ -1205,11 +1245,16 @@ signed_video_free(signed_video_t *self)
   free_payload_buffer(self->payload_buffer);
 
   h26x_nalu_list_free(self->nalu_list);
+  sequencer_free(self->sequencer);
+  verification_cache_free(self->verification_cache);
+  free_detached_seis(self);
 
   signed_video_authenticity_report_free(self->authenticity);
   product_info_free(self->product_info);
   gop_info_free(self->gop_info);
-  signature_free(self->signature_info);
+  signature_free(self->signature_info, &self->plugin);
+  // Unload the plugin last, since it owns the memory of the signature.
+  plugin_unload(&self->plugin);
 
   free(self);
 }
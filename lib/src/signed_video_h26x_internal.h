@@ -109,6 +109,13 @@ struct _h26x_nalu_list_item_t {
   bool has_been_decoded;  // Marks a SEI as decoded. Decoding it twice might overwrite vital
   // information.
   bool used_in_gop_hash;  // Marks the NALU as being part of a computed |gop_hash|.
+  bool has_verified_signature;  // Marks a SEI as having its signature verified ahead of being
+  // decoded. This happens when several pending GOPs are validated at once; See
+  // verify_pending_signatures(...).
+  int verified_signature;  // The result of that verification; 1 (success), 0 (failure), or < 0
+  // (error). Only valid if |has_verified_signature| is set.
+  char provisional_status;  // The |validation_status| this pending NALU got from an early verdict,
+  // or '\0' if none. It is reported instead of 'P' until the GOP has been validated.
 
   // Linked list
   h26x_nalu_list_item_t *prev;  // Points to the previously added NALU. Is NULL if this is the first
@@ -127,6 +134,7 @@ struct _h26x_nalu_t {
   size_t nalu_data_size;  // The total size of the NALU data
   const uint8_t *hashable_data;  // The NALU data for potential hashing
   size_t hashable_data_size;  // Size of the data to hash, excluding stop bit
+  const uint8_t *precomputed_hash;  // Hash of |hashable_data| if already computed, otherwise NULL
   SignedVideoFrameType nalu_type;  // Frame type: I, P, SPS, PPS, VPS or SEI
   SignedVideoUUIDType uuid_type;  // UUID type if a SEI nalu
   int is_valid;  // Is a valid H26x NALU (1), invalid (0) or has errors (-1)
@@ -194,6 +202,55 @@ parse_nalu_info(const uint8_t *nalu_data,
     SignedVideoCodec codec,
     bool check_trailing_bytes);
 
+/* Functions operating on NALUs, and authenticity reports, held by the |sequencer| of a session.
+ * Defined in signed_video_h26x_auth.c. */
+
+/* Parses and hashes a NALU on the calling thread, then submits it to the |sequencer| of the
+ * session. Takes ownership of the |nalu_data|, also upon failure. */
+svi_rc
+add_sequenced_nalu(signed_video_t *self,
+    uint64_t sequence_number,
+    uint8_t *nalu_data,
+    size_t nalu_data_size);
+
+svi_rc
+process_sequenced_nalu(void *user_data, void *item);
+
+void
+sequenced_nalu_free(void *item);
+
+void
+sequenced_report_free(void *report);
+
+/* Finds the NALU starting at |*offset| in the Annex B byte stream |data|, that is, a start code
+ * followed by the NALU, and moves |*offset| to the start code of the next NALU. Zero bytes in front
+ * of a start code belong to that start code. Returns the size of the NALU including its start
+ * code, or 0 if there is no NALU at |*offset|. Defined in signed_video_h26x_auth.c. */
+size_t
+get_next_nalu_in_bytestream(const uint8_t *data, size_t data_size, size_t *offset);
+
+/* Counts a parsed |nalu| added to the session. Defined in signed_video_counters.c. */
+void
+counters_add_nalu(signed_video_t *self, const h26x_nalu_t *nalu);
+
+/* Raises the high-water marks of the session counters to the current levels, if above. Defined in
+ * signed_video_counters.c. */
+void
+counters_update_high_water_marks(signed_video_t *self);
+
+/* Collects the verdicts of the coming validations in |results|, except the first one, which is of
+ * the GOP before the range. At most |num_gops| verdicts are written. Defined in
+ * signed_video_h26x_auth.c. */
+void
+range_validation_begin(signed_video_t *self,
+    SignedVideoAuthenticityResult *results,
+    size_t num_gops);
+
+/* Stops collecting verdicts. Returns the number of validations after the first one, which may
+ * exceed the number of written verdicts. */
+size_t
+range_validation_end(signed_video_t *self);
+
 #ifdef SV_UNIT_TEST
 /**
  * @brief Sets the recurrence offset for the signed video session
@@ -333,6 +333,7 @@ h26x_nalu_list_copy_last_item(h26x_nalu_list_t *list)
     memcpy(copied_nalu, item->nalu, sizeof(h26x_nalu_t));
     copied_nalu->nalu_data = NULL;
     copied_nalu->hashable_data = NULL;
+    copied_nalu->precomputed_hash = NULL;
     copied_nalu->payload = NULL;
     copied_nalu->tlv_start_in_nalu_data = NULL;
     copied_nalu->tmp_tlv_memory = tmp_tlv_memory;
@@ -496,7 +497,9 @@ h26x_nalu_list_get_validation_str(const h26x_nalu_list_t *list)
     h26x_nalu_list_item_t *item = list->first_item;
     int idx = 0;
     while (item) {
-      memcpy(validation_str + idx, &item->validation_status, 1);
+      // A pending item with a provisional status from an early verdict reports that status.
+      const bool is_provisional = item->validation_status == 'P' && item->provisional_status;
+      validation_str[idx] = is_provisional ? item->provisional_status : item->validation_status;
       item = item->next;
       idx++;
     }
@@ -40,9 +40,14 @@ get_sign_and_complete_sei_nalu(signed_video_t *self,
 
 /* Functions for payload_buffer. */
 static void
-add_payload_to_buffer(signed_video_t *self, uint8_t *payload_ptr, uint8_t *payload_signature_ptr);
+add_payload_to_buffer(signed_video_t *self,
+    uint8_t *payload_ptr,
+    uint8_t *payload_signature_ptr,
+    bool is_intermediate);
 static svi_rc
 complete_sei_nalu_and_add_to_prepend(signed_video_t *self);
+static void
+write_gop_index_record(signed_video_t *self, size_t sei_size);
 
 /* Functions related to the list of NALUs to prepend. */
 static void
@@ -86,21 +91,57 @@ free_payload_buffer(uint8_t *payload_buffer[])
   }
 }
 
-/* Adds the |payload| to the next available slot in |payload_buffer|. */
+/* Adds the |payload| to the next available slot in |payload_buffer|, together with the GOP index
+ * record of the SEI. */
 static void
-add_payload_to_buffer(signed_video_t *self, uint8_t *payload, uint8_t *payload_signature_ptr)
+add_payload_to_buffer(signed_video_t *self,
+    uint8_t *payload,
+    uint8_t *payload_signature_ptr,
+    bool is_intermediate)
 {
   assert(self);
 
+  self->counters.num_generated_seis++;
   if (self->payload_buffer_idx >= MAX_NALUS_TO_PREPEND) {
     // Not enough space for this payload. Free the memory and return.
     free(payload);
+    self->counters.num_dropped_seis++;
     return;
   }
 
+  // The SEI offset and size are set when the SEI is completed.
+  sv_gop_index_record_t *record = &self->gop_index_buffer[self->payload_buffer_idx];
+  memset(record, 0, sizeof(sv_gop_index_record_t));
+  record->gop_offset = self->gop_offset;
+  record->gop_counter = self->gop_info->global_gop_counter;
+  record->num_nalus = self->nalus_since_sei;
+  record->is_intermediate = is_intermediate;
+  memcpy(record->hash, self->signature_info->hash, SV_GOP_INDEX_HASH_SIZE);
+  self->nalus_since_sei = 0;
+
   self->payload_buffer[2 * self->payload_buffer_idx] = payload;
   self->payload_buffer[2 * self->payload_buffer_idx + 1] = payload_signature_ptr;
   self->payload_buffer_idx += 1;
+  counters_update_high_water_marks(self);
+}
+
+/* Completes the GOP index record of the oldest SEI in the |payload_buffer| with its position in the
+ * stream, and passes it on to the GOP index sink, if any. The SEI is prepended to the current NALU,
+ * hence it takes the place of the current NALU in the stream. A detached SEI takes no place in the
+ * stream. */
+static void
+write_gop_index_record(signed_video_t *self, size_t sei_size)
+{
+  sv_gop_index_record_t *record = &self->gop_index_buffer[0];
+  record->sei_offset = self->stream_offset;
+  record->sei_size = (uint32_t)sei_size;
+  if (!self->detached_sei_sink) self->stream_offset += sei_size;
+
+  if (self->gop_index_sink) {
+    uint8_t data[SV_GOP_INDEX_RECORD_SIZE];
+    gop_index_record_write(record, data);
+    self->gop_index_sink(data, SV_GOP_INDEX_RECORD_SIZE, self->gop_index_user_data);
+  }
 }
 
 /* Picks the oldest payload from the payload_buffer and completes it with the generated signature.
@@ -126,6 +167,7 @@ complete_sei_nalu_and_add_to_prepend(signed_video_t *self)
   // move on. This is a valid operation. What will happen is that the video will have an unsigned
   // GOP.
   if (self->signature_info->signature_size == 0) {
+    if (payload) self->counters.num_dropped_seis++;
     signed_video_nalu_data_free(payload);
     status = SVI_OK;
     goto done;
@@ -139,14 +181,29 @@ complete_sei_nalu_and_add_to_prepend(signed_video_t *self)
     // Add the signature to the SEI payload.
     data_size = get_sign_and_complete_sei_nalu(self, &payload, payload_signature_ptr);
     SVI_THROW_IF(!data_size, SVI_UNKNOWN);
-    // Add created SEI to the prepend list.
-    prepend_instruction = SIGNED_VIDEO_PREPEND_NALU;
-    signed_video_nalu_to_prepend_t *nalu_to_prepend =
-        &(self->nalus_to_prepend_list[self->num_nalus_to_prepend]);
-    // TODO: Include setting |nalu_data| in add_nalu_to_prepend().
-    // Transfer |payload| to |nalu_to_prepend|.
-    nalu_to_prepend->nalu_data = payload;
-    SVI_THROW(add_nalu_to_prepend(self, prepend_instruction, data_size));
+    if (self->detached_sei_sink) {
+      // Pass the SEI on to the sidecar, at the position of the current NALU, instead of prepending
+      // it.
+      size_t record_size = 0;
+      uint8_t *record =
+          detached_sei_record_create(payload, data_size, self->num_video_nalus, &record_size);
+      signed_video_nalu_data_free(payload);
+      SVI_THROW_IF(!record, SVI_MEMORY);
+      self->detached_sei_sink(record, record_size, self->detached_sei_user_data);
+      free(record);
+    } else {
+      // Add created SEI to the prepend list.
+      prepend_instruction = SIGNED_VIDEO_PREPEND_NALU;
+      signed_video_nalu_to_prepend_t *nalu_to_prepend =
+          &(self->nalus_to_prepend_list[self->num_nalus_to_prepend]);
+      // TODO: Include setting |nalu_data| in add_nalu_to_prepend().
+      // Transfer |payload| to |nalu_to_prepend|.
+      nalu_to_prepend->nalu_data = payload;
+      SVI_THROW(add_nalu_to_prepend(self, prepend_instruction, data_size));
+    }
+    // The SEI is prepended to the current NALU, after any SEIs already completed.
+    write_gop_index_record(self, data_size);
+    self->counters.num_signatures++;
 
     // Unset flag when SEI is completed and prepended.
     // Note: If signature could not be generated then nalu data is freed. See
@@ -160,9 +217,10 @@ done:
   // Done with the SEI payload. Move |payload_buffer|. This should be done even if we caught a
   // failure.
   if (buffer_end > 0) {
-    for (int i = 2; i < buffer_end; i++) {
+    for (int i = 1; i < buffer_end; i++) {
       self->payload_buffer[2 * (i - 1)] = self->payload_buffer[2 * i];
       self->payload_buffer[2 * (i - 1) + 1] = self->payload_buffer[2 * i + 1];
+      self->gop_index_buffer[i - 1] = self->gop_index_buffer[i];
     }
     self->payload_buffer[2 * (buffer_end - 1)] = NULL;
     self->payload_buffer[2 * (buffer_end - 1) + 1] = NULL;
@@ -257,7 +315,7 @@ generate_sei_nalu(signed_video_t *self, uint8_t **payload, uint8_t **payload_sig
 
       signature_info->signature_size = 0;
       signature_info->max_signature_size = 0;
-      signature_info->signature = sv_interface_malloc(max_signature_size);
+      signature_info->signature = self->plugin.malloc(max_signature_size);
       SVI_THROW_IF(!signature_info->signature, SVI_MEMORY);
       signature_info->max_signature_size = max_signature_size;
     }
@@ -374,7 +432,10 @@ generate_sei_nalu(signed_video_t *self, uint8_t **payload, uint8_t **payload_sig
     // End of GOP. Reset flag to get new reference.
     self->gop_info->has_reference_hash = false;
 
-    SVI_THROW(sv_rc_to_svi_rc(sv_interface_sign_hash(self->plugin_handle, signature_info)));
+    const uint64_t sign_start_ns = get_monotonic_time_ns();
+    const SignedVideoReturnCode sv_rc = self->plugin.sign_hash(self->plugin_handle, signature_info);
+    counters_add_stage_time(self, SV_STAGE_SIGN, sign_start_ns);
+    SVI_THROW(sv_rc_to_svi_rc(sv_rc));
 
   SVI_CATCH()
   {
@@ -481,6 +542,81 @@ prepare_for_nalus_to_prepend(signed_video_t *self)
   return status;
 }
 
+/* Collects all available signatures from the signing plugin and completes the corresponding SEI
+ * NALUs, which are then added to the list of NALUs to prepend. If any SEI was completed
+ * |signing_present| is set to 1. */
+static svi_rc
+get_signatures_and_complete_sei_nalus(signed_video_t *self, int *signing_present)
+{
+  signature_info_t *signature_info = self->signature_info;
+
+  svi_rc status = SVI_UNKNOWN;
+  SVI_TRY()
+    SignedVideoReturnCode signature_error = SV_UNKNOWN_FAILURE;
+    while (self->plugin.get_signature(self->plugin_handle, signature_info->signature,
+        signature_info->max_signature_size, &signature_info->signature_size, &signature_error)) {
+      SVI_THROW(sv_rc_to_svi_rc(signature_error));
+#ifdef SIGNED_VIDEO_DEBUG
+      // TODO: This might not work for blocked signatures, that is if the hash in
+      // |signature_info| does not correspond to the copied |signature|.
+      // Verify the just signed hash.
+      int verified = -1;
+      SVI_THROW_WITH_MSG(sv_rc_to_svi_rc(openssl_verify_hash(signature_info, &verified)),
+          "Verification test had errors");
+      SVI_THROW_IF_WITH_MSG(verified != 1, SVI_EXTERNAL_FAILURE, "Verification test failed");
+#endif
+      SVI_THROW(complete_sei_nalu_and_add_to_prepend(self));
+      *signing_present = 1;  // At least one SEI NALU present.
+    }
+  SVI_CATCH()
+  SVI_DONE(status)
+
+  return status;
+}
+
+/* Returns true if an intermediate SEI should be generated before the |nalu|. Intermediate SEIs
+ * are only generated in front of primary P slices, which then act as the linking NALU, just like
+ * the first NALU in a GOP does for SEIs generated at GOP transitions. */
+static bool
+is_time_for_intermediate_sei(signed_video_t *self, const h26x_nalu_t *nalu)
+{
+  if (nalu->nalu_type != NALU_TYPE_P || !nalu->is_primary_slice) return false;
+  // Wait for the first GOP transition.
+  if (self->frames_since_sei < 0) return false;
+
+  const unsigned interval_frames = self->intermediate_sei_interval_frames;
+  const unsigned interval_ms = self->intermediate_sei_interval_ms;
+  // The current frame is not part of the interval, since it completes the intermediate SEI.
+  if (interval_frames > 0 && (unsigned)self->frames_since_sei > interval_frames) return true;
+  if (interval_ms > 0 &&
+      get_monotonic_time_ns() - self->latest_sei_time_ns >= (uint64_t)interval_ms * 1000000) {
+    return true;
+  }
+
+  return false;
+}
+
+/* Generates a SEI signing the NALUs added since the latest SEI and puts it in the payload buffer
+ * until the signature is available. The current NALU, which has already been added, is the
+ * last one signed. */
+static svi_rc
+generate_sei_and_add_to_buffer(signed_video_t *self, bool is_intermediate)
+{
+  uint8_t *payload = NULL;
+  uint8_t *payload_signature_ptr = NULL;
+
+  svi_rc status = generate_sei_nalu(self, &payload, &payload_signature_ptr);
+  if (status != SVI_OK) return status;
+
+  // Add |payload| to buffer. Will be picked up again when the signature has been generated.
+  add_payload_to_buffer(self, payload, payload_signature_ptr, is_intermediate);
+  // The current frame is the first one of the next interval.
+  self->frames_since_sei = 1;
+  if (self->intermediate_sei_interval_ms > 0) self->latest_sei_time_ns = get_monotonic_time_ns();
+
+  return SVI_OK;
+}
+
 /**
  * @brief Public signed_video_sign.h APIs
  */
@@ -495,7 +631,10 @@ signed_video_add_nalu_for_signing(signed_video_t *self,
     return SV_INVALID_PARAMETER;
   }
 
+  const uint64_t start_ns = get_monotonic_time_ns();
   h26x_nalu_t nalu = parse_nalu_info(nalu_data, nalu_data_size, self->codec, true);
+  counters_add_stage_time(self, SV_STAGE_PARSE, start_ns);
+  counters_add_nalu(self, &nalu);
 
   signature_info_t *signature_info = self->signature_info;
   int signing_present = self->signing_present;
@@ -513,7 +652,9 @@ signed_video_add_nalu_for_signing(signed_video_t *self,
         self->has_recurrent_data = true;
       }
       self->frame_count++;  // It is ok for this variable to wrap around
+      if (self->frames_since_sei >= 0) self->frames_since_sei++;
     }
+    if (nalu.is_hashable) self->nalus_since_sei++;
 
     SVI_THROW(hash_and_add(self, &nalu));
     // Depending on the input NALU, we need to take different actions. If the input is an I-NALU we
@@ -522,42 +663,35 @@ signed_video_add_nalu_for_signing(signed_video_t *self,
     if (nalu.is_first_nalu_in_gop) {
       // An I-NALU indicates the start of a new GOP, hence prepend with SEI-NALUs. This also means
       // that the signing feature is present.
-
-      uint8_t *payload = NULL;
-      uint8_t *payload_signature_ptr = NULL;
       signing_present = 0;  // About to add SEI NALUs.
 
-      SVI_THROW(generate_sei_nalu(self, &payload, &payload_signature_ptr));
-      // Add |payload| to buffer. Will be picked up again when the signature has been generated.
-      add_payload_to_buffer(self, payload, payload_signature_ptr);
+      SVI_THROW(generate_sei_and_add_to_buffer(self, false));
       // Now we are done with the previous GOP. The gop_hash was reset right after signing and
       // adding it to the SEI NALU. Now it is time to start a new GOP, that is, hash and add this
       // first NALU of the GOP.
       SVI_THROW(hash_and_add(self, &nalu));
+    } else if (is_time_for_intermediate_sei(self, &nalu)) {
+      // Sign the part of the GOP added so far, ending with this P-NALU. The reference hash of the
+      // GOP is kept, hence the P-NALU gets the same hash in the next part.
+      SVI_THROW(generate_sei_and_add_to_buffer(self, true));
+      // When validating at frame level a P-NALU is only verified once, whereas a gop_hash also
+      // includes the NALU after its SEI a second time. Hence, only start the next gop_hash with
+      // this P-NALU.
+      if (self->gop_info->signature_hash_type == GOP_HASH) SVI_THROW(hash_and_add(self, &nalu));
     }
 
     // Only add a SEI if the current NALU is the primary picture NALU and of course if signing is
     // completed.
     if ((nalu.nalu_type == NALU_TYPE_I || nalu.nalu_type == NALU_TYPE_P) && nalu.is_primary_slice &&
         signature_info->signature) {
-      SignedVideoReturnCode signature_error = SV_UNKNOWN_FAILURE;
-      while (sv_interface_get_signature(self->plugin_handle, signature_info->signature,
-          signature_info->max_signature_size, &signature_info->signature_size, &signature_error)) {
-        SVI_THROW(sv_rc_to_svi_rc(signature_error));
-#ifdef SIGNED_VIDEO_DEBUG
-        // TODO: This might not work for blocked signatures, that is if the hash in
-        // |signature_info| does not correspond to the copied |signature|.
-        // Verify the just signed hash.
-        int verified = -1;
-        SVI_THROW_WITH_MSG(sv_rc_to_svi_rc(openssl_verify_hash(signature_info, &verified)),
-            "Verification test had errors");
-        SVI_THROW_IF_WITH_MSG(verified != 1, SVI_EXTERNAL_FAILURE, "Verification test failed");
-#endif
-        SVI_THROW(complete_sei_nalu_and_add_to_prepend(self));
-        signing_present = 1;  // At least one SEI NALU present.
-      }
+      SVI_THROW(get_signatures_and_complete_sei_nalus(self, &signing_present));
     }
 
+    // All SEIs prepended to this NALU have been completed. Now, the position of the NALU in the
+    // stream is known.
+    if (nalu.is_first_nalu_in_gop) self->gop_offset = self->stream_offset;
+    self->stream_offset += nalu_data_size;
+    self->num_video_nalus++;
   SVI_CATCH()
   SVI_DONE(status)
 
@@ -565,7 +699,12 @@ signed_video_add_nalu_for_signing(signed_video_t *self,
 
   if (signing_present > self->signing_present) self->signing_present = signing_present;
 
-  return svi_rc_to_signed_video_rc(status);
+  const SignedVideoReturnCode return_code = svi_rc_to_signed_video_rc(status);
+  if (self->trace_sink) {
+    trace_nalu(self, false, nalu_data, nalu_data_size, start_ns, return_code, false);
+  }
+
+  return return_code;
 }
 
 SignedVideoReturnCode
@@ -599,6 +738,41 @@ signed_video_nalu_data_free(uint8_t *nalu_data)
   if (nalu_data) free(nalu_data);
 }
 
+SignedVideoReturnCode
+signed_video_get_signature_fd(signed_video_t *self, int *fd)
+{
+  if (!self || !fd) return SV_INVALID_PARAMETER;
+
+  int signature_fd = self->plugin.get_signature_fd(self->plugin_handle);
+  if (signature_fd < 0) return SV_NOT_SUPPORTED;
+
+  *fd = signature_fd;
+
+  return SV_OK;
+}
+
+SignedVideoReturnCode
+signed_video_finalize_pending_seis(signed_video_t *self)
+{
+  if (!self) return SV_INVALID_PARAMETER;
+
+  int signing_present = self->signing_present;
+
+  svi_rc status = SVI_UNKNOWN;
+  SVI_TRY()
+    SVI_THROW(prepare_for_nalus_to_prepend(self));
+    // Nothing has been signed yet if there is no memory for the signature.
+    if (self->signature_info->signature) {
+      SVI_THROW(get_signatures_and_complete_sei_nalus(self, &signing_present));
+    }
+  SVI_CATCH()
+  SVI_DONE(status)
+
+  if (signing_present > self->signing_present) self->signing_present = signing_present;
+
+  return svi_rc_to_signed_video_rc(status);
+}
+
 // Note that this API only works for a plugin that blocks the worker thread.
 SignedVideoReturnCode
 signed_video_set_end_of_stream(signed_video_t *self)
@@ -611,11 +785,11 @@ signed_video_set_end_of_stream(signed_video_t *self)
   SVI_TRY()
     SVI_THROW(prepare_for_nalus_to_prepend(self));
     SVI_THROW(generate_sei_nalu(self, &payload, &payload_signature_ptr));
-    add_payload_to_buffer(self, payload, payload_signature_ptr);
+    add_payload_to_buffer(self, payload, payload_signature_ptr, false);
     // Fetch the signature. If it is not ready we exit without generating the SEI.
     signature_info_t *signature_info = self->signature_info;
     SignedVideoReturnCode signature_error = SV_UNKNOWN_FAILURE;
-    while (sv_interface_get_signature(self->plugin_handle, signature_info->signature,
+    while (self->plugin.get_signature(self->plugin_handle, signature_info->signature,
         signature_info->max_signature_size, &signature_info->signature_size, &signature_error)) {
       SVI_THROW(sv_rc_to_svi_rc(signature_error));
       SVI_THROW(complete_sei_nalu_and_add_to_prepend(self));
@@ -695,6 +869,66 @@ signed_video_set_private_key(signed_video_t *self,
   return svi_rc_to_signed_video_rc(status);
 }
 
+SignedVideoReturnCode
+signed_video_set_signing_plugin(signed_video_t *self, const char *plugin)
+{
+  if (!self || !plugin) return SV_INVALID_PARAMETER;
+
+  sv_plugin_t new_plugin = {0};
+  void *new_plugin_handle = NULL;
+  svi_rc status = SVI_UNKNOWN;
+  SVI_TRY()
+    // The signature memory is owned by the current plugin, hence changing plugin is only possible
+    // before it has been allocated.
+    SVI_THROW_IF_WITH_MSG(self->signature_info->signature, SVI_NOT_SUPPORTED,
+        "Cannot change signing plugin after signing has started");
+    SVI_THROW(plugin_load(&new_plugin, plugin));
+    new_plugin_handle = new_plugin.setup();
+    SVI_THROW_IF_WITH_MSG(!new_plugin_handle, SVI_EXTERNAL_FAILURE, "Could not set up plugin");
+
+    // Replace the current plugin.
+    self->plugin.teardown(self->plugin_handle);
+    plugin_unload(&self->plugin);
+    self->plugin = new_plugin;
+    self->plugin_handle = new_plugin_handle;
+  SVI_CATCH()
+  {
+    plugin_unload(&new_plugin);
+  }
+  SVI_DONE(status)
+
+  return svi_rc_to_signed_video_rc(status);
+}
+
+SignedVideoReturnCode
+signed_video_set_signing_worker_config(signed_video_t *self, const sv_worker_config_t *config)
+{
+  if (!self || !config) return SV_INVALID_PARAMETER;
+
+  return self->plugin.set_worker_config(self->plugin_handle, config);
+}
+
+SignedVideoReturnCode
+signed_video_get_signing_worker_stats(signed_video_t *self,
+    sv_worker_stats_t *stats,
+    size_t max_stats,
+    size_t *num_stats)
+{
+  if (!self || !stats || max_stats == 0 || !num_stats) return SV_INVALID_PARAMETER;
+
+  *num_stats = self->plugin.get_worker_stats(self->plugin_handle, stats, max_stats);
+
+  return *num_stats > 0 ? SV_OK : SV_NOT_SUPPORTED;
+}
+
+SignedVideoReturnCode
+signed_video_get_signing_deadline_stats(signed_video_t *self, sv_deadline_stats_t *stats)
+{
+  if (!self || !stats) return SV_INVALID_PARAMETER;
+
+  return self->plugin.get_deadline_stats(self->plugin_handle, stats);
+}
+
 SignedVideoReturnCode
 signed_video_set_authenticity_level(signed_video_t *self,
     SignedVideoAuthenticityLevel authenticity_level)
@@ -725,6 +959,46 @@ signed_video_set_recurrence_interval_frames(signed_video_t *self, unsigned recur
   return SV_OK;
 }
 
+SignedVideoReturnCode
+signed_video_set_intermediate_sei_interval(signed_video_t *self,
+    unsigned interval_frames,
+    unsigned interval_ms)
+{
+  if (!self) return SV_INVALID_PARAMETER;
+  // Longer intervals would overflow the hash list of frame level signing.
+  if (interval_frames > MAX_GOP_LENGTH) return SV_NOT_SUPPORTED;
+
+  self->intermediate_sei_interval_frames = interval_frames;
+  self->intermediate_sei_interval_ms = interval_ms;
+  self->latest_sei_time_ns = get_monotonic_time_ns();
+
+  return SV_OK;
+}
+
+SignedVideoReturnCode
+signed_video_set_gop_index_sink(signed_video_t *self, sv_gop_index_sink_t sink, void *user_data)
+{
+  if (!self) return SV_INVALID_PARAMETER;
+
+  self->gop_index_sink = sink;
+  self->gop_index_user_data = user_data;
+
+  return SV_OK;
+}
+
+SignedVideoReturnCode
+signed_video_set_detached_sei_sink(signed_video_t *self,
+    sv_detached_sei_sink_t sink,
+    void *user_data)
+{
+  if (!self) return SV_INVALID_PARAMETER;
+
+  self->detached_sei_sink = sink;
+  self->detached_sei_user_data = user_data;
+
+  return SV_OK;
+}
+
 #ifdef SV_UNIT_TEST
 SignedVideoReturnCode
 signed_video_set_recurrence_offset(signed_video_t *self, unsigned offset)
@@ -27,8 +27,15 @@
 
 #include "includes/signed_video_auth.h"  // signed_video_product_info_t
 #include "includes/signed_video_common.h"  // signed_video_t
+#include "includes/signed_video_counters.h"  // sv_counters_t
+#include "includes/signed_video_detached.h"  // sv_detached_sei_sink_t
+#include "includes/signed_video_result_store.h"  // sv_result_record_t
 #include "includes/signed_video_sign.h"  // SignedVideoAuthenticityLevel
+#include "includes/signed_video_trace.h"  // sv_trace_sink_t
 #include "signed_video_defines.h"  // svi_rc, sv_tlv_tag_t
+#include "signed_video_plugin.h"  // sv_plugin_t
+#include "signed_video_sequencer.h"  // sequencer_t
+#include "signed_video_verification_cache.h"  // verification_cache_t
 
 typedef struct _gop_info_t gop_info_t;
 typedef struct _gop_state_t gop_state_t;
@@ -36,6 +43,8 @@ typedef struct _gop_info_detected_t gop_info_detected_t;
 
 // Forward declare h26x_nalu_list_t here for signed_video_t.
 typedef struct _h26x_nalu_list_t h26x_nalu_list_t;
+// Forward declare service_session_t here for signed_video_t.
+typedef struct _service_session_t service_session_t;
 
 #if defined(_WIN32) || defined(_WIN64)
 #define ATTR_UNUSED
@@ -109,8 +118,18 @@ struct _gop_state_t {
   // states of |auth_state|, after calling gop_state_pre_actions(), are stored.
   auth_state_t cur_auth_state;  // Current |auth_state| after gop_state_pre_actions().
   auth_state_t prev_auth_state;  // Previous |cur_auth_state|.
+  bool has_early_verdict;  // State to indicate that the pending SEI was decoded, and its signature
+  // verified, upon arrival to produce a provisional result. Cleared when the GOP is validated.
 };
 
+/* A SEI from a sidecar waiting to be added in front of the video NALU at its position; See
+ * signed_video_add_detached_sei(). */
+typedef struct {
+  uint64_t nalu_idx;  // Position in the video stream.
+  uint8_t *sei;  // A copy of the SEI owned by this struct.
+  size_t sei_size;
+} detached_sei_t;
+
 struct _gop_info_detected_t {
   bool has_gop_sei;  // State to indicate that the current GOP has received a SEI NALU.
   // The authenticity is not always validated directly when a SEI NALU is received.
@@ -146,6 +165,30 @@ struct _signed_video_t {
   // when added, that is, in signed_video_add_nalu_and_authenticate(). Items are removed when
   // reported through the authenticity_report.
   h26x_nalu_list_t *nalu_list;
+  // Reorder stage for NALUs added with sequence numbers, possibly from several threads, through
+  // signed_video_add_sequenced_nalu_and_authenticate(). Also queues the authenticity reports.
+  sequencer_t *sequencer;
+  // The state of the validation service this session is registered to, if any; See
+  // signed_video_service.h.
+  service_session_t *service_session;
+  // Verify the signature of a SEI signing at frame level as soon as it arrives and report a
+  // provisional result; See signed_video_set_early_verdict().
+  bool early_verdict;
+  // Verdicts of an ongoing GOP range validation; See signed_video_validate_gop_range().
+  SignedVideoAuthenticityResult *range_results;  // NULL if no range validation is ongoing.
+  size_t range_num_gops;  // Number of GOPs in the range.
+  size_t range_num_validations;  // Number of validations so far, including the GOP before.
+  // States of a seek; See signed_video_reset_after_seek().
+  bool is_after_seek;  // Set until the first hashable NALU after a seek has been added.
+  bool skip_boundary_validation;  // Set if the first validation after a seek is of the GOP before.
+  // Outcomes of recent signature verifications. NULL if disabled.
+  verification_cache_t *verification_cache;
+  // Positions in the stream of added NALUs; See signed_video_get_checkpoint().
+  uint64_t num_added_nalus;  // Number of NALUs added since the start, or the latest reset.
+  uint64_t latest_sei_idx;  // Position of the latest added SEI.
+  bool is_latest_nalu_sei;  // Set if the latest added NALU is a SEI.
+  uint64_t checkpoint_idx;  // Position of the SEI completing the latest validated GOP.
+  bool has_validated_gop;  // Set when a GOP has been validated since the start.
 
   gop_state_t gop_state;
   gop_info_detected_t gop_info_detected;
@@ -156,6 +199,35 @@ struct _signed_video_t {
   bool has_recurrent_data;
   int frame_count;
 
+  // Intermediate SEIs signing parts of long GOPs; See signed_video_set_intermediate_sei_interval().
+  unsigned intermediate_sei_interval_frames;  // Frames per intermediate SEI. 0 if disabled.
+  unsigned intermediate_sei_interval_ms;  // Milliseconds per intermediate SEI. 0 if disabled.
+  int frames_since_sei;  // Frames added since the latest SEI, including the first NALU after it.
+  // Negative until the first SEI has been generated.
+  uint64_t latest_sei_time_ns;  // Monotonic time when the latest SEI was generated.
+
+  // GOP index sidecar; See signed_video_set_gop_index_sink().
+  sv_gop_index_sink_t gop_index_sink;
+  void *gop_index_user_data;
+  uint64_t stream_offset;  // Bytes of the signed stream so far, that is, added NALUs and SEIs.
+  uint64_t gop_offset;  // Byte offset of the first NALU of the current GOP.
+  uint32_t nalus_since_sei;  // Hashable NALUs added since the latest SEI was generated.
+  // Records of the SEIs in |payload_buffer|, completed when the SEIs are added to the prepend list.
+  sv_gop_index_record_t gop_index_buffer[MAX_NALUS_TO_PREPEND];
+
+  sv_counters_t counters;  // Performance counters; See signed_video_get_counters().
+
+  // NALU trace; See signed_video_set_trace_sink().
+  sv_trace_sink_t trace_sink;  // NULL if disabled.
+  void *trace_user_data;
+
+  // Detached SEIs; See signed_video_set_detached_sei_sink() and signed_video_add_detached_sei().
+  sv_detached_sei_sink_t detached_sei_sink;  // NULL if the SEIs are added to the video stream.
+  void *detached_sei_user_data;
+  uint64_t num_video_nalus;  // Video NALUs added so far, that is, not counting detached SEIs.
+  detached_sei_t *detached_seis;  // SEIs waiting for their positions, in stream order.
+  size_t num_detached_seis;
+
   int signing_present;
   // State to indicate if Signed Video is present or not. Used for signing, and can only move
   // downwards between the states below.
@@ -173,6 +245,7 @@ struct _signed_video_t {
   // will be written.
 
   // For signing plugin
+  sv_plugin_t plugin;  // The signing plugin in use. All plugin calls should go through this.
   void *plugin_handle;
   signature_info_t *signature_info;  // Pointer to all necessary information to sign in a plugin.
 
@@ -266,4 +339,57 @@ free_and_reset_nalu_to_prepend_list(signed_video_t *signed_video);
 void
 free_payload_buffer(uint8_t *payload_buffer[]);
 
+/* Defined in signed_video_gop_index.c */
+void
+gop_index_record_write(const sv_gop_index_record_t *record, uint8_t *data);
+
+uint8_t *
+write_be(uint8_t *data, uint64_t value, int num_bytes);
+
+const uint8_t *
+read_be(const uint8_t *data, uint64_t *value, int num_bytes);
+
+/* Defined in signed_video_counters.c */
+uint64_t
+get_monotonic_time_ns(void);
+
+/* Adds the time passed since |start_ns| to the |stage| of the session counters. */
+void
+counters_add_stage_time(signed_video_t *self, SignedVideoStage stage, uint64_t start_ns);
+
+/* Counts a signature verification with |status| and |verified| result. */
+void
+counters_add_verification(signed_video_t *self, svi_rc status, int verified);
+
+/* Defined in signed_video_trace.c */
+/* Produces a trace record of a NALU added to the session |self| at |start_ns|, if a trace sink is
+ * set. */
+void
+trace_nalu(signed_video_t *self,
+    bool is_validation,
+    const uint8_t *nalu_data,
+    size_t nalu_data_size,
+    uint64_t start_ns,
+    SignedVideoReturnCode return_code,
+    bool has_report);
+
+/* Defined in signed_video_result_store.c */
+void
+result_record_write(const sv_result_record_t *record, uint8_t *data);
+
+/* Defined in signed_video_service.c */
+/* Removes |sv| from the service it is registered to, if any, after all its NALUs are validated. */
+void
+service_remove_session(signed_video_t *sv);
+
+/* Defined in signed_video_detached.c */
+uint8_t *
+detached_sei_record_create(const uint8_t *sei,
+    size_t sei_size,
+    uint64_t nalu_idx,
+    size_t *record_size);
+
+void
+free_detached_seis(signed_video_t *self);
+
 #endif  // __SIGNED_VIDEO_INTERNAL__
@@ -0,0 +1,522 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2023 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next paragraph) shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "includes/signed_video_mp4.h"
+
+#include <stdbool.h>  // bool
+#include <stdlib.h>  // calloc, free
+
+// Memory mapping of files is not supported on Windows.
+#if !defined(_WIN32) && !defined(_WIN64)
+#include <fcntl.h>  // open, O_RDONLY
+#include <sys/mman.h>  // mmap, munmap
+#include <sys/stat.h>  // fstat
+#include <unistd.h>  // close
+#endif
+
+#include "signed_video_authenticity.h"  // create_local_authenticity_report_if_needed()
+#include "signed_video_h26x_internal.h"  // range_validation_begin(), parse_nalu_info()
+#include "signed_video_internal.h"  // read_be()
+#include "signed_video_tlv.h"  // tlv_find_tag(), tlv_find_and_decode_recurrent_tags()
+#include "signed_video_worker_pool.h"  // worker_pool_run()
+
+#define FOURCC(a, b, c, d) \
+  (((uint32_t)(a) << 24) | ((uint32_t)(b) << 16) | ((uint32_t)(c) << 8) | (uint32_t)(d))
+
+#define BOX_HEADER_SIZE 8
+// Bytes of a VisualSampleEntry before its child boxes, excluding the box header.
+#define VISUAL_SAMPLE_ENTRY_SIZE 78
+// Bytes of a full box header, that is, version and flags.
+#define FULL_BOX_HEADER_SIZE 4
+
+struct _sv_mp4_t {
+  const uint8_t *data;
+  size_t data_size;
+  bool is_mapped;  // Set if |data| is memory mapped by signed_video_mp4_open().
+  SignedVideoCodec codec;
+  int length_size;  // Number of bytes of the NALU length prefix.
+  size_t num_samples;
+  uint64_t *sample_offsets;  // Byte offsets of the samples in |data|.
+  uint32_t *sample_sizes;
+  size_t num_sync_samples;
+  uint32_t *sync_samples;  // Sample indices, counted from 0, of the sync samples. NULL if the track
+  // has no sync sample table.
+};
+
+/* A part of the video track validated in a session of its own. */
+typedef struct {
+  const sv_mp4_t *mp4;
+  size_t first_sample;
+  size_t last_sample;  // The sync sample starting the next part, if any, which completes the last
+  // GOP of this part.
+  const uint8_t *key_sei;  // A SEI with the public key, decoded before the part is validated.
+  size_t key_sei_size;
+  SignedVideoAuthenticityResult *results;
+  size_t max_results;
+  size_t num_results;
+  SignedVideoReturnCode rc;
+} mp4_part_t;
+
+static uint32_t
+read_u32(const uint8_t *data)
+{
+  uint64_t value = 0;
+  read_be(data, &value, 4);
+  return (uint32_t)value;
+}
+
+/* Finds the first child box of |type| in the box payload |data|. Returns true and sets |payload|
+ * and |payload_size| if found. */
+static bool
+find_box(const uint8_t *data,
+    size_t data_size,
+    uint32_t type,
+    const uint8_t **payload,
+    size_t *payload_size)
+{
+  size_t offset = 0;
+  while (data_size - offset >= BOX_HEADER_SIZE) {
+    uint64_t box_size = read_u32(data + offset);
+    const uint32_t box_type = read_u32(data + offset + 4);
+    size_t header_size = BOX_HEADER_SIZE;
+    if (box_size == 1) {
+      // A 64 bits size follows the type.
+      if (data_size - offset < BOX_HEADER_SIZE + 8) return false;
+      read_be(data + offset + BOX_HEADER_SIZE, &box_size, 8);
+      header_size += 8;
+    } else if (box_size == 0) {
+      // The box extends to the end.
+      box_size = data_size - offset;
+    }
+    if (box_size < header_size || box_size > data_size - offset) return false;
+
+    if (box_type == type) {
+      *payload = data + offset + header_size;
+      *payload_size = (size_t)box_size - header_size;
+      return true;
+    }
+    offset += (size_t)box_size;
+  }
+
+  return false;
+}
+
+/* Finds the sample table box of the first video track. */
+static bool
+find_video_sample_table(const uint8_t *moov,
+    size_t moov_size,
+    const uint8_t **stbl,
+    size_t *stbl_size)
+{
+  const uint8_t *trak = NULL;
+  size_t trak_size = 0;
+  size_t offset = 0;
+  // Loop through the tracks, by searching from the end of the previous one.
+  while (find_box(moov + offset, moov_size - offset, FOURCC('t', 'r', 'a', 'k'), &trak,
+      &trak_size)) {
+    offset = (size_t)(trak - moov) + trak_size;
+    const uint8_t *mdia = NULL, *hdlr = NULL, *minf = NULL;
+    size_t mdia_size = 0, hdlr_size = 0, minf_size = 0;
+    if (!find_box(trak, trak_size, FOURCC('m', 'd', 'i', 'a'), &mdia, &mdia_size)) continue;
+    // The handler type follows the full box header and 4 pre-defined bytes.
+    if (!find_box(mdia, mdia_size, FOURCC('h', 'd', 'l', 'r'), &hdlr, &hdlr_size) ||
+        hdlr_size < 12 || read_u32(hdlr + 8) != FOURCC('v', 'i', 'd', 'e')) {
+      continue;
+    }
+    if (find_box(mdia, mdia_size, FOURCC('m', 'i', 'n', 'f'), &minf, &minf_size) &&
+        find_box(minf, minf_size, FOURCC('s', 't', 'b', 'l'), stbl, stbl_size)) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+/* Detects the codec and the size of the NALU length prefix from the sample description box. */
+static SignedVideoReturnCode
+parse_stsd(sv_mp4_t *self, const uint8_t *stsd, size_t stsd_size)
+{
+  // The first sample entry follows the full box header and the entry count.
+  if (stsd_size < FULL_BOX_HEADER_SIZE + 4 + BOX_HEADER_SIZE + VISUAL_SAMPLE_ENTRY_SIZE) {
+    return SV_NOT_SUPPORTED;
+  }
+  const uint8_t *entry = stsd + FULL_BOX_HEADER_SIZE + 4;
+  const size_t entry_size = read_u32(entry);
+  if (entry_size < BOX_HEADER_SIZE + VISUAL_SAMPLE_ENTRY_SIZE ||
+      entry_size > stsd_size - FULL_BOX_HEADER_SIZE - 4) {
+    return SV_NOT_SUPPORTED;
+  }
+  const uint8_t *children = entry + BOX_HEADER_SIZE + VISUAL_SAMPLE_ENTRY_SIZE;
+  const size_t children_size = entry_size - BOX_HEADER_SIZE - VISUAL_SAMPLE_ENTRY_SIZE;
+
+  const uint8_t *config = NULL;
+  size_t config_size = 0;
+  if (find_box(children, children_size, FOURCC('a', 'v', 'c', 'C'), &config, &config_size)) {
+    // lengthSizeMinusOne is stored in the 2 least significant bits of the fifth byte.
+    if (config_size < 5) return SV_NOT_SUPPORTED;
+    self->codec = SV_CODEC_H264;
+    self->length_size = (config[4] & 0x03) + 1;
+  } else if (find_box(children, children_size, FOURCC('h', 'v', 'c', 'C'), &config, &config_size)) {
+    // lengthSizeMinusOne is stored in the 2 least significant bits of the 22nd byte.
+    if (config_size < 22) return SV_NOT_SUPPORTED;
+    self->codec = SV_CODEC_H265;
+    self->length_size = (config[21] & 0x03) + 1;
+  } else {
+    return SV_NOT_SUPPORTED;
+  }
+  // A length prefix of 3 bytes is not allowed.
+  return self->length_size == 3 ? SV_NOT_SUPPORTED : SV_OK;
+}
+
+/* Builds the sample table, that is, the byte offset and size of each sample, from the sample size,
+ * sample to chunk and chunk offset boxes. */
+static SignedVideoReturnCode
+parse_sample_table(sv_mp4_t *self, const uint8_t *stbl, size_t stbl_size)
+{
+  const uint8_t *stsz = NULL, *stsc = NULL, *stco = NULL, *stss = NULL;
+  size_t stsz_size = 0, stsc_size = 0, stco_size = 0, stss_size = 0;
+  int chunk_offset_size = 4;
+  if (!find_box(stbl, stbl_size, FOURCC('s', 't', 's', 'z'), &stsz, &stsz_size) ||
+      !find_box(stbl, stbl_size, FOURCC('s', 't', 's', 'c'), &stsc, &stsc_size)) {
+    return SV_NOT_SUPPORTED;
+  }
+  if (!find_box(stbl, stbl_size, FOURCC('s', 't', 'c', 'o'), &stco, &stco_size)) {
+    if (!find_box(stbl, stbl_size, FOURCC('c', 'o', '6', '4'), &stco, &stco_size)) {
+      return SV_NOT_SUPPORTED;
+    }
+    chunk_offset_size = 8;
+  }
+
+  // Sample sizes.
+  if (stsz_size < FULL_BOX_HEADER_SIZE + 8) return SV_NOT_SUPPORTED;
+  const uint32_t fixed_sample_size = read_u32(stsz + FULL_BOX_HEADER_SIZE);
+  const size_t num_samples = read_u32(stsz + FULL_BOX_HEADER_SIZE + 4);
+  // Without samples the file is most likely fragmented.
+  if (num_samples == 0) return SV_NOT_SUPPORTED;
+  if (fixed_sample_size == 0 && (stsz_size - FULL_BOX_HEADER_SIZE - 8) / 4 < num_samples) {
+    return SV_INVALID_PARAMETER;
+  }
+  self->sample_offsets = calloc(num_samples, sizeof(uint64_t));
+  self->sample_sizes = calloc(num_samples, sizeof(uint32_t));
+  if (!self->sample_offsets || !self->sample_sizes) return SV_MEMORY;
+  for (size_t i = 0; i < num_samples; i++) {
+    self->sample_sizes[i] =
+        fixed_sample_size ? fixed_sample_size : read_u32(stsz + FULL_BOX_HEADER_SIZE + 8 + 4 * i);
+  }
+
+  // Chunk offsets and the number of samples per chunk.
+  if (stsc_size < FULL_BOX_HEADER_SIZE + 4 || stco_size < FULL_BOX_HEADER_SIZE + 4) {
+    return SV_INVALID_PARAMETER;
+  }
+  const size_t num_entries = read_u32(stsc + FULL_BOX_HEADER_SIZE);
+  const size_t num_chunks = read_u32(stco + FULL_BOX_HEADER_SIZE);
+  if ((stsc_size - FULL_BOX_HEADER_SIZE - 4) / 12 < num_entries ||
+      (stco_size - FULL_BOX_HEADER_SIZE - 4) / chunk_offset_size < num_chunks) {
+    return SV_INVALID_PARAMETER;
+  }
+  const uint8_t *entries = stsc + FULL_BOX_HEADER_SIZE + 4;
+  const uint8_t *chunk_offsets = stco + FULL_BOX_HEADER_SIZE + 4;
+  size_t sample_idx = 0;
+  for (size_t i = 0; i < num_entries && sample_idx < num_samples; i++) {
+    // Chunks are counted from 1. An entry applies until the first chunk of the next entry.
+    const size_t first_chunk = read_u32(entries + 12 * i);
+    const size_t samples_per_chunk = read_u32(entries + 12 * i + 4);
+    const size_t end_chunk =
+        i + 1 < num_entries ? read_u32(entries + 12 * (i + 1)) : num_chunks + 1;
+    if (first_chunk == 0 || end_chunk > num_chunks + 1) return SV_INVALID_PARAMETER;
+    for (size_t chunk = first_chunk; chunk < end_chunk && sample_idx < num_samples; chunk++) {
+      uint64_t offset = 0;
+      read_be(chunk_offsets + chunk_offset_size * (chunk - 1), &offset, chunk_offset_size);
+      for (size_t j = 0; j < samples_per_chunk && sample_idx < num_samples; j++) {
+        if (offset > self->data_size || self->sample_sizes[sample_idx] > self->data_size - offset) {
+          return SV_INVALID_PARAMETER;
+        }
+        self->sample_offsets[sample_idx] = offset;
+        offset += self->sample_sizes[sample_idx++];
+      }
+    }
+  }
+  if (sample_idx < num_samples) return SV_INVALID_PARAMETER;
+  self->num_samples = num_samples;
+
+  // Sync samples, that is, the samples starting a GOP. Without a table all samples are sync
+  // samples.
+  if (find_box(stbl, stbl_size, FOURCC('s', 't', 's', 's'), &stss, &stss_size)) {
+    if (stss_size < FULL_BOX_HEADER_SIZE + 4) return SV_INVALID_PARAMETER;
+    const size_t num_sync_samples = read_u32(stss + FULL_BOX_HEADER_SIZE);
+    if ((stss_size - FULL_BOX_HEADER_SIZE - 4) / 4 < num_sync_samples) return SV_INVALID_PARAMETER;
+    self->sync_samples = calloc(num_sync_samples + 1, sizeof(uint32_t));
+    if (!self->sync_samples) return SV_MEMORY;
+    for (size_t i = 0; i < num_sync_samples; i++) {
+      // Samples are counted from 1.
+      const uint32_t sample_number = read_u32(stss + FULL_BOX_HEADER_SIZE + 4 + 4 * i);
+      if (sample_number == 0 || sample_number > num_samples) return SV_INVALID_PARAMETER;
+      // The GOPs are sliced by consecutive sync samples, hence they have to be strictly increasing.
+      if (i > 0 && sample_number - 1 <= self->sync_samples[i - 1]) return SV_INVALID_PARAMETER;
+      self->sync_samples[i] = sample_number - 1;
+    }
+    self->num_sync_samples = num_sync_samples;
+  }
+
+  return SV_OK;
+}
+
+/* Adds all NALUs of a sample, which are stored length prefixed, for validation. */
+static SignedVideoReturnCode
+add_sample(signed_video_t *sv, const sv_mp4_t *mp4, size_t sample_idx)
+{
+  const uint8_t *sample = mp4->data + mp4->sample_offsets[sample_idx];
+  const size_t sample_size = mp4->sample_sizes[sample_idx];
+  size_t offset = 0;
+  while (offset < sample_size) {
+    if (sample_size - offset < (size_t)mp4->length_size) return SV_INVALID_PARAMETER;
+    uint64_t nalu_size = 0;
+    read_be(sample + offset, &nalu_size, mp4->length_size);
+    offset += mp4->length_size;
+    if (nalu_size == 0 || nalu_size > sample_size - offset) return SV_INVALID_PARAMETER;
+    // The NALU is read in place. A NALU without start code is supported.
+    SignedVideoReturnCode rc =
+        signed_video_add_nalu_and_authenticate(sv, sample + offset, (size_t)nalu_size, NULL);
+    if (rc != SV_OK) return rc;
+    offset += (size_t)nalu_size;
+  }
+
+  return SV_OK;
+}
+
+/* Finds the first SEI of the video track holding the public key. Returns NULL if there is none. */
+static const uint8_t *
+find_public_key_sei(const sv_mp4_t *mp4, size_t *sei_size)
+{
+  for (size_t i = 0; i < mp4->num_samples; i++) {
+    const uint8_t *sample = mp4->data + mp4->sample_offsets[i];
+    const size_t sample_size = mp4->sample_sizes[i];
+    size_t offset = 0;
+    while (sample_size - offset > (size_t)mp4->length_size) {
+      uint64_t nalu_size = 0;
+      read_be(sample + offset, &nalu_size, mp4->length_size);
+      offset += mp4->length_size;
+      if (nalu_size == 0 || nalu_size > sample_size - offset) break;
+      const uint8_t *nalu_data = sample + offset;
+      offset += (size_t)nalu_size;
+
+      h26x_nalu_t nalu = parse_nalu_info(nalu_data, (size_t)nalu_size, mp4->codec, true);
+      const bool has_public_key = nalu.is_gop_sei &&
+          tlv_find_tag(nalu.tlv_data, nalu.tlv_size, PUBLIC_KEY_TAG, false) != NULL;
+      free(nalu.tmp_tlv_memory);
+      if (has_public_key) {
+        *sei_size = (size_t)nalu_size;
+        return nalu_data;
+      }
+    }
+  }
+
+  return NULL;
+}
+
+/* Decodes the public key, and the other recurrent data, of the |sei| into the session. */
+static SignedVideoReturnCode
+decode_public_key_sei(signed_video_t *sv, const uint8_t *sei, size_t sei_size)
+{
+  svi_rc status = create_local_authenticity_report_if_needed(sv);
+  if (status != SVI_OK) return svi_rc_to_signed_video_rc(status);
+
+  h26x_nalu_t nalu = parse_nalu_info(sei, sei_size, sv->codec, true);
+  const bool is_decoded = tlv_find_and_decode_recurrent_tags(sv, nalu.tlv_data, nalu.tlv_size);
+  free(nalu.tmp_tlv_memory);
+
+  return is_decoded ? SV_OK : SV_UNKNOWN_FAILURE;
+}
+
+/* Validates one part of the video track. Runs as a worker_pool_run() job. */
+static void
+validate_part(void *job)
+{
+  mp4_part_t *part = (mp4_part_t *)job;
+  signed_video_t *sv = signed_video_create(part->mp4->codec);
+  if (!sv) {
+    part->rc = SV_MEMORY;
+    return;
+  }
+
+  // The first validation is of the GOP before the part.
+  range_validation_begin(sv, part->results, part->max_results);
+  part->rc = part->key_sei ? decode_public_key_sei(sv, part->key_sei, part->key_sei_size) : SV_OK;
+  for (size_t i = part->first_sample; i <= part->last_sample && part->rc == SV_OK; i++) {
+    part->rc = add_sample(sv, part->mp4, i);
+  }
+  part->num_results = range_validation_end(sv);
+
+  signed_video_free(sv);
+}
+
+/**
+ * @brief Public signed_video_mp4.h APIs
+ */
+
+SignedVideoReturnCode
+signed_video_mp4_open_buffer(const uint8_t *data, size_t data_size, sv_mp4_t **mp4)
+{
+  if (!data || data_size == 0 || !mp4) return SV_INVALID_PARAMETER;
+
+  *mp4 = NULL;
+  sv_mp4_t *self = calloc(1, sizeof(sv_mp4_t));
+  if (!self) return SV_MEMORY;
+  self->data = data;
+  self->data_size = data_size;
+
+  const uint8_t *moov = NULL, *stbl = NULL, *stsd = NULL;
+  size_t moov_size = 0, stbl_size = 0, stsd_size = 0;
+  SignedVideoReturnCode rc = SV_NOT_SUPPORTED;
+  if (find_box(data, data_size, FOURCC('m', 'o', 'o', 'v'), &moov, &moov_size) &&
+      find_video_sample_table(moov, moov_size, &stbl, &stbl_size) &&
+      find_box(stbl, stbl_size, FOURCC('s', 't', 's', 'd'), &stsd, &stsd_size)) {
+    rc = parse_stsd(self, stsd, stsd_size);
+    if (rc == SV_OK) rc = parse_sample_table(self, stbl, stbl_size);
+  }
+  if (rc != SV_OK) {
+    signed_video_mp4_close(self);
+    return rc;
+  }
+  *mp4 = self;
+
+  return SV_OK;
+}
+
+SignedVideoReturnCode
+signed_video_mp4_open(const char *path, sv_mp4_t **mp4)
+{
+  if (!path || !mp4) return SV_INVALID_PARAMETER;
+#if defined(_WIN32) || defined(_WIN64)
+  return SV_NOT_SUPPORTED;
+#else
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) return SV_INVALID_PARAMETER;
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0 || file_stat.st_size <= 0) {
+    close(fd);
+    return SV_INVALID_PARAMETER;
+  }
+  const size_t data_size = (size_t)file_stat.st_size;
+  void *data = mmap(NULL, data_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  // The mapping is kept when the file is closed.
+  close(fd);
+  if (data == MAP_FAILED) return SV_MEMORY;
+
+  SignedVideoReturnCode rc = signed_video_mp4_open_buffer(data, data_size, mp4);
+  if (rc != SV_OK) {
+    munmap(data, data_size);
+    return rc;
+  }
+  (*mp4)->is_mapped = true;
+
+  return SV_OK;
+#endif
+}
+
+void
+signed_video_mp4_close(sv_mp4_t *mp4)
+{
+  if (!mp4) return;
+
+#if !defined(_WIN32) && !defined(_WIN64)
+  if (mp4->is_mapped) munmap((void *)mp4->data, mp4->data_size);
+#endif
+  free(mp4->sample_offsets);
+  free(mp4->sample_sizes);
+  free(mp4->sync_samples);
+  free(mp4);
+}
+
+SignedVideoReturnCode
+signed_video_mp4_get_codec(const sv_mp4_t *mp4, SignedVideoCodec *codec)
+{
+  if (!mp4 || !codec) return SV_INVALID_PARAMETER;
+
+  *codec = mp4->codec;
+
+  return SV_OK;
+}
+
+SignedVideoReturnCode
+signed_video_mp4_validate(const sv_mp4_t *mp4,
+    unsigned num_parts,
+    SignedVideoAuthenticityResult *results,
+    size_t max_results,
+    size_t *num_results)
+{
+  if (!mp4 || num_parts == 0 || (!results && max_results > 0) || !num_results) {
+    return SV_INVALID_PARAMETER;
+  }
+
+  *num_results = 0;
+  // Parts start at sync samples. Without a sync sample table the GOP boundaries are unknown.
+  if (!mp4->sync_samples) num_parts = 1;
+  if (num_parts > mp4->num_sync_samples) num_parts = mp4->num_sync_samples;
+  if (num_parts == 0) num_parts = 1;
+
+  // The public key may not be sent in every SEI. Hence, the parts after the first one get the
+  // public key of the stream up front.
+  size_t key_sei_size = 0;
+  const uint8_t *key_sei = num_parts > 1 ? find_public_key_sei(mp4, &key_sei_size) : NULL;
+
+  // A part cannot have more validations than samples, since each SEI is stored in a sample of its
+  // own GOP.
+  mp4_part_t *parts = calloc(num_parts, sizeof(mp4_part_t));
+  SignedVideoAuthenticityResult *part_results =
+      calloc(mp4->num_samples + num_parts, sizeof(SignedVideoAuthenticityResult));
+  SignedVideoReturnCode rc = (parts && part_results) ? SV_OK : SV_MEMORY;
+  size_t results_offset = 0;
+  for (unsigned i = 0; i < num_parts && rc == SV_OK; i++) {
+    mp4_part_t *part = &parts[i];
+    part->mp4 = mp4;
+    part->first_sample = i == 0 ? 0 : mp4->sync_samples[i * mp4->num_sync_samples / num_parts];
+    part->last_sample = i + 1 == num_parts
+        ? mp4->num_samples - 1
+        : mp4->sync_samples[(i + 1) * mp4->num_sync_samples / num_parts];
+    if (i > 0) {
+      part->key_sei = key_sei;
+      part->key_sei_size = key_sei_size;
+    }
+    part->results = part_results + results_offset;
+    part->max_results = part->last_sample - part->first_sample + 1;
+    results_offset += part->max_results;
+  }
+  if (rc == SV_OK &&
+      worker_pool_run(validate_part, parts, sizeof(mp4_part_t), num_parts) != SVI_OK) {
+    rc = SV_UNKNOWN_FAILURE;
+  }
+
+  // Collect the verdicts in stream order.
+  for (unsigned i = 0; i < num_parts && rc == SV_OK; i++) {
+    const mp4_part_t *part = &parts[i];
+    rc = part->rc;
+    for (size_t j = 0; j < part->num_results; j++, (*num_results)++) {
+      if (j < part->max_results && *num_results < max_results) {
+        results[*num_results] = part->results[j];
+      }
+    }
+  }
+
+  free(part_results);
+  free(parts);
+
+  return rc;
+}
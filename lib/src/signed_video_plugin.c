@@ -0,0 +1,254 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2023 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next paragraph) shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+// Plugins are loaded at runtime through dlopen(), which is not available on Windows. There, only
+// the built-in plugin can be used.
+#if !defined(_WIN32) && !defined(_WIN64)
+#define _GNU_SOURCE  // dladdr, dlinfo
+#endif
+#include "signed_video_plugin.h"
+
+#include <stdio.h>  // snprintf
+#if !defined(_WIN32) && !defined(_WIN64)
+#include <dlfcn.h>  // dlopen, dlsym, dlclose, dladdr
+#if defined(__GLIBC__)
+#include <link.h>  // struct link_map, dlinfo
+#endif
+#endif
+
+#define MAX_PLUGIN_PATH_LENGTH 512
+
+#if !defined(_WIN32) && !defined(_WIN64)
+/* Checks if the |symbol| is defined in the shared object of |dl_handle| itself. With dlinfo(), the
+ * file of the symbol is compared with the file of the shared object. Elsewhere, e.g., on macOS,
+ * there is no dlinfo(), and the symbol is only checked to not be defined in this library. */
+static bool
+is_defined_in_plugin(void *dl_handle, const void *symbol)
+{
+  Dl_info symbol_info = {0};
+  if (dladdr(symbol, &symbol_info) == 0 || !symbol_info.dli_fname) return false;
+#if defined(__GLIBC__)
+  struct link_map *plugin_map = NULL;
+  if (dlinfo(dl_handle, RTLD_DI_LINKMAP, &plugin_map) != 0) return false;
+  return strcmp(symbol_info.dli_fname, plugin_map->l_name) == 0;
+#else
+  (void)dl_handle;
+  Dl_info library_info = {0};
+  if (dladdr((const void *)&plugin_load, &library_info) == 0) return false;
+  return symbol_info.dli_fbase != library_info.dli_fbase;
+#endif
+}
+
+/* Resolves the symbol |name| from |dl_handle| into the function pointer |fn|. The assignment
+ * through a void pointer is the POSIX way of converting an object pointer to a function pointer.
+ *
+ * Since dlsym() also searches the dependencies of the shared object, a plugin linked against this
+ * library would otherwise resolve symbols it lacks to the built-in plugin. Hence, the symbol has to
+ * be defined in the shared object itself. */
+static bool
+resolve_symbol(void *dl_handle, const char *name, void *fn)
+{
+  void *symbol = dlsym(dl_handle, name);
+  if (!symbol || !is_defined_in_plugin(dl_handle, symbol)) {
+    DEBUG_LOG("Plugin lacks symbol %s", name);
+    return false;
+  }
+  *(void **)fn = symbol;
+  return true;
+}
+
+/* Used for plugins without the optional sv_interface_get_signature_fd(). */
+static int
+no_signature_fd(void *plugin_handle)
+{
+  (void)plugin_handle;
+  return -1;
+}
+
+/* Used for plugins without the optional sv_interface_set_worker_config(). */
+static SignedVideoReturnCode
+no_worker_config(void *plugin_handle, const sv_worker_config_t *config)
+{
+  (void)plugin_handle;
+  (void)config;
+  return SV_NOT_SUPPORTED;
+}
+
+/* Used for plugins without the optional sv_interface_get_worker_stats(). */
+static size_t
+no_worker_stats(void *plugin_handle, sv_worker_stats_t *stats, size_t max_workers)
+{
+  (void)plugin_handle;
+  (void)stats;
+  (void)max_workers;
+  return 0;
+}
+
+/* Used for plugins without the optional sv_interface_get_deadline_stats(). */
+static SignedVideoReturnCode
+no_deadline_stats(void *plugin_handle, sv_deadline_stats_t *stats)
+{
+  (void)plugin_handle;
+  (void)stats;
+  return SV_NOT_SUPPORTED;
+}
+
+/* Opens the shared object of |plugin_name|. See plugin_load(...) for the search order. */
+static void *
+open_plugin(const char *plugin_name)
+{
+  void *dl_handle = NULL;
+
+  if (strchr(plugin_name, '/')) {
+    return dlopen(plugin_name, RTLD_NOW | RTLD_LOCAL);
+  }
+
+  char path[MAX_PLUGIN_PATH_LENGTH] = {0};
+#ifdef SV_PLUGIN_DIR
+  if (snprintf(path, sizeof(path), "%s/%s.so", SV_PLUGIN_DIR, plugin_name) < (int)sizeof(path)) {
+    dl_handle = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+  }
+#endif
+  if (!dl_handle && snprintf(path, sizeof(path), "%s.so", plugin_name) < (int)sizeof(path)) {
+    dl_handle = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+  }
+
+  return dl_handle;
+}
+
+#if defined(__GNUC__)
+/* Defaults of the optional interfaces for the built-in plugin. They are weak symbols, hence only
+ * used if the built-in plugin does not define the interface itself. On Windows, the built-in plugin
+ * has to define all interfaces. */
+
+__attribute__((weak)) int
+sv_interface_get_signature_fd(void *plugin_handle)
+{
+  return no_signature_fd(plugin_handle);
+}
+
+__attribute__((weak)) SignedVideoReturnCode
+sv_interface_set_worker_config(void *plugin_handle, const sv_worker_config_t *config)
+{
+  return no_worker_config(plugin_handle, config);
+}
+
+__attribute__((weak)) size_t
+sv_interface_get_worker_stats(void *plugin_handle, sv_worker_stats_t *stats, size_t max_workers)
+{
+  return no_worker_stats(plugin_handle, stats, max_workers);
+}
+
+__attribute__((weak)) SignedVideoReturnCode
+sv_interface_get_deadline_stats(void *plugin_handle, sv_deadline_stats_t *stats)
+{
+  return no_deadline_stats(plugin_handle, stats);
+}
+#endif
+#endif
+
+void
+plugin_init_builtin(sv_plugin_t *plugin)
+{
+  if (!plugin) return;
+
+  plugin->sign_hash = sv_interface_sign_hash;
+  plugin->get_signature = sv_interface_get_signature;
+  plugin->get_signature_fd = sv_interface_get_signature_fd;
+  plugin->set_worker_config = sv_interface_set_worker_config;
+  plugin->get_worker_stats = sv_interface_get_worker_stats;
+  plugin->get_deadline_stats = sv_interface_get_deadline_stats;
+  plugin->setup = sv_interface_setup;
+  plugin->teardown = sv_interface_teardown;
+  plugin->malloc = sv_interface_malloc;
+  plugin->free = sv_interface_free;
+  plugin->dl_handle = NULL;
+}
+
+#if defined(_WIN32) || defined(_WIN64)
+svi_rc
+plugin_load(sv_plugin_t *plugin, const char *plugin_name)
+{
+  if (!plugin || !plugin_name || *plugin_name == '\0') return SVI_INVALID_PARAMETER;
+
+  return SVI_NOT_SUPPORTED;
+}
+
+void
+plugin_unload(sv_plugin_t *plugin)
+{
+  plugin_init_builtin(plugin);
+}
+#else
+svi_rc
+plugin_load(sv_plugin_t *plugin, const char *plugin_name)
+{
+  if (!plugin || !plugin_name || *plugin_name == '\0') return SVI_INVALID_PARAMETER;
+
+  sv_plugin_t loaded = {0};
+  // Optional interfaces fall back to these if not present.
+  loaded.get_signature_fd = no_signature_fd;
+  loaded.set_worker_config = no_worker_config;
+  loaded.get_worker_stats = no_worker_stats;
+  loaded.get_deadline_stats = no_deadline_stats;
+  const struct {
+    const char *name;
+    void *fn;
+    bool is_optional;
+  } symbols[] = {
+      {"sv_interface_sign_hash", &loaded.sign_hash, false},
+      {"sv_interface_get_signature", &loaded.get_signature, false},
+      {"sv_interface_get_signature_fd", &loaded.get_signature_fd, true},
+      {"sv_interface_set_worker_config", &loaded.set_worker_config, true},
+      {"sv_interface_get_worker_stats", &loaded.get_worker_stats, true},
+      {"sv_interface_get_deadline_stats", &loaded.get_deadline_stats, true},
+      {"sv_interface_setup", &loaded.setup, false},
+      {"sv_interface_teardown", &loaded.teardown, false},
+      {"sv_interface_malloc", &loaded.malloc, false},
+      {"sv_interface_free", &loaded.free, false},
+  };
+  svi_rc status = SVI_UNKNOWN;
+  SVI_TRY()
+    loaded.dl_handle = open_plugin(plugin_name);
+    SVI_THROW_IF_WITH_MSG(!loaded.dl_handle, SVI_EXTERNAL_FAILURE, "Could not open plugin");
+    for (size_t i = 0; i < sizeof(symbols) / sizeof(symbols[0]); i++) {
+      bool has_symbol = resolve_symbol(loaded.dl_handle, symbols[i].name, symbols[i].fn);
+      SVI_THROW_IF(!has_symbol && !symbols[i].is_optional, SVI_EXTERNAL_FAILURE);
+    }
+  SVI_CATCH()
+  {
+    if (loaded.dl_handle) dlclose(loaded.dl_handle);
+  }
+  SVI_DONE(status)
+
+  if (status == SVI_OK) *plugin = loaded;
+
+  return status;
+}
+
+void
+plugin_unload(sv_plugin_t *plugin)
+{
+  if (!plugin) return;
+
+  if (plugin->dl_handle) dlclose(plugin->dl_handle);
+  plugin_init_builtin(plugin);
+}
+#endif
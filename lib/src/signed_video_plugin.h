@@ -0,0 +1,100 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2023 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next paragraph) shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef __SIGNED_VIDEO_PLUGIN_H__
+#define __SIGNED_VIDEO_PLUGIN_H__
+
+#include <stdbool.h>  // bool
+#include <stdint.h>  // uint8_t
+#include <string.h>  // size_t
+
+#include "includes/signed_video_common.h"  // SignedVideoReturnCode
+#include "includes/signed_video_interfaces.h"  // signature_info_t
+#include "signed_video_defines.h"  // svi_rc
+
+/**
+ * The signing plugin in use by a session.
+ *
+ * All calls to a signing plugin go through these function pointers, which match the interfaces
+ * declared in signed_video_interfaces.h. By default they point to the plugin built into the
+ * library. A plugin loaded at runtime through plugin_load(...) resolves them from a shared object,
+ * and |dl_handle| then holds the handle returned by dlopen(...).
+ */
+typedef struct {
+  SignedVideoReturnCode (*sign_hash)(void *plugin_handle, signature_info_t *signature_info);
+  bool (*get_signature)(void *plugin_handle,
+      uint8_t *signature,
+      size_t max_signature_size,
+      size_t *written_signature_size,
+      SignedVideoReturnCode *error);
+  int (*get_signature_fd)(void *plugin_handle);
+  SignedVideoReturnCode (*set_worker_config)(void *plugin_handle, const sv_worker_config_t *config);
+  size_t (*get_worker_stats)(void *plugin_handle, sv_worker_stats_t *stats, size_t max_workers);
+  SignedVideoReturnCode (*get_deadline_stats)(void *plugin_handle, sv_deadline_stats_t *stats);
+  void *(*setup)();
+  void (*teardown)(void *plugin_handle);
+  uint8_t *(*malloc)(size_t data_size);
+  void (*free)(uint8_t *data);
+  void *dl_handle;  // NULL for the built-in plugin.
+} sv_plugin_t;
+
+/**
+ * @brief Points the |plugin| to the signing plugin built into the library
+ *
+ * @param plugin Pointer to the plugin to initialize.
+ */
+void
+plugin_init_builtin(sv_plugin_t *plugin);
+
+/**
+ * @brief Loads a signing plugin from a shared object
+ *
+ * If |plugin_name| contains a '/' it is treated as a path to the shared object. Otherwise, the
+ * shared object <plugin_name>.so is first searched for in the installed plugin directory, and then
+ * through the default search path of the dynamic linker. All sv_interface_* symbols have to be
+ * present in the shared object, except the optional ones for the signature file descriptor, worker
+ * threads and deadlines. If those are missing, the plugin is treated as having none of them.
+ *
+ * The |plugin| is only written upon success.
+ *
+ * @param plugin Pointer to the plugin to load into.
+ * @param plugin_name A path to, or the name of, the plugin.
+ *
+ * @returns SVI_OK if the plugin was loaded,
+ *          SVI_INVALID_PARAMETER if any input is a NULL pointer, or |plugin_name| is empty,
+ *          SVI_NOT_SUPPORTED on Windows, where plugins cannot be loaded at runtime,
+ *          SVI_EXTERNAL_FAILURE if the shared object could not be opened, or lacks a symbol.
+ */
+svi_rc
+plugin_load(sv_plugin_t *plugin, const char *plugin_name);
+
+/**
+ * @brief Unloads a signing plugin
+ *
+ * Closes the shared object of a plugin loaded through plugin_load(...) and points the |plugin| back
+ * to the built-in one. Any plugin handle must have been torn down, and all memory allocated by the
+ * plugin freed, before unloading.
+ *
+ * @param plugin Pointer to the plugin to unload.
+ */
+void
+plugin_unload(sv_plugin_t *plugin);
+
+#endif  // __SIGNED_VIDEO_PLUGIN_H__
@@ -0,0 +1,109 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2023 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next paragraph) shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "includes/signed_video_result_store.h"
+
+#include <assert.h>  // assert
+
+#include "includes/signed_video_openssl.h"  // openssl_hash_data()
+#include "signed_video_internal.h"  // result_record_write(), write_be(), read_be()
+
+/* Serializes |record| into SV_RESULT_RECORD_SIZE bytes of |data|. Declared in
+ * signed_video_internal.h */
+void
+result_record_write(const sv_result_record_t *record, uint8_t *data)
+{
+  uint8_t *data_ptr = data;
+  *data_ptr++ = SV_RESULT_RECORD_VERSION;
+  *data_ptr++ = (uint8_t)record->authenticity;
+  data_ptr = write_be(data_ptr, 0, 2);  // Reserved
+  data_ptr = write_be(data_ptr, record->gop_counter, 4);
+  data_ptr = write_be(data_ptr, record->sei_offset, 8);
+  data_ptr = write_be(data_ptr, record->sei_size, 4);
+  data_ptr = write_be(data_ptr, (uint32_t)record->number_of_expected_picture_nalus, 4);
+  data_ptr = write_be(data_ptr, (uint32_t)record->number_of_received_picture_nalus, 4);
+  data_ptr = write_be(data_ptr, 0, 4);  // Reserved
+  memcpy(data_ptr, record->sei_digest, SV_RESULT_DIGEST_SIZE);
+  data_ptr += SV_RESULT_DIGEST_SIZE;
+  assert(data_ptr - data == SV_RESULT_RECORD_SIZE);
+}
+
+/**
+ * @brief Public signed_video_result_store.h APIs
+ */
+
+SignedVideoReturnCode
+signed_video_result_store_parse_record(const uint8_t *data,
+    size_t data_size,
+    sv_result_record_t *record)
+{
+  if (!data || data_size < SV_RESULT_RECORD_SIZE || !record) return SV_INVALID_PARAMETER;
+  if (data[0] != SV_RESULT_RECORD_VERSION) return SV_INCOMPATIBLE_VERSION;
+
+  uint64_t value = 0;
+  const uint8_t *data_ptr = data + 1;
+  record->authenticity = (SignedVideoAuthenticityResult)*data_ptr++;
+  data_ptr += 2;  // Reserved
+  data_ptr = read_be(data_ptr, &value, 4);
+  record->gop_counter = (uint32_t)value;
+  data_ptr = read_be(data_ptr, &record->sei_offset, 8);
+  data_ptr = read_be(data_ptr, &value, 4);
+  record->sei_size = (uint32_t)value;
+  data_ptr = read_be(data_ptr, &value, 4);
+  record->number_of_expected_picture_nalus = (int32_t)(uint32_t)value;
+  data_ptr = read_be(data_ptr, &value, 4);
+  record->number_of_received_picture_nalus = (int32_t)(uint32_t)value;
+  data_ptr += 4;  // Reserved
+  memcpy(record->sei_digest, data_ptr, SV_RESULT_DIGEST_SIZE);
+
+  return SV_OK;
+}
+
+SignedVideoReturnCode
+signed_video_result_store_check(const uint8_t *data,
+    size_t data_size,
+    const uint8_t *results,
+    size_t results_size,
+    size_t *num_changed_records)
+{
+  if (!data || !results || !num_changed_records) return SV_INVALID_PARAMETER;
+
+  const size_t num_records = results_size / SV_RESULT_RECORD_SIZE;
+  if (num_records == 0) return SV_INVALID_PARAMETER;
+
+  *num_changed_records = 0;
+  for (size_t i = 0; i < num_records; i++) {
+    sv_result_record_t record = {0};
+    SignedVideoReturnCode rc = signed_video_result_store_parse_record(
+        results + i * SV_RESULT_RECORD_SIZE, SV_RESULT_RECORD_SIZE, &record);
+    if (rc != SV_OK) return rc;
+    // A GOP without a SEI has nothing to check.
+    if (record.sei_size == 0) continue;
+
+    uint8_t sei_digest[SV_RESULT_DIGEST_SIZE] = {0};
+    if (record.sei_offset > data_size || record.sei_size > data_size - record.sei_offset ||
+        openssl_hash_data(data + record.sei_offset, record.sei_size, sei_digest) != SV_OK ||
+        memcmp(sei_digest, record.sei_digest, SV_RESULT_DIGEST_SIZE)) {
+      (*num_changed_records)++;
+    }
+  }
+
+  return SV_OK;
+}
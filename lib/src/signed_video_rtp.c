@@ -0,0 +1,405 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2023 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next paragraph) shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "includes/signed_video_rtp.h"
+
+#include <stdbool.h>  // bool
+#include <stdlib.h>  // calloc, free, realloc
+
+#include "signed_video_internal.h"  // signed_video_t
+
+#define RTP_VERSION 2
+#define RTP_HEADER_SIZE 12
+#define H264_STAP_A 24
+#define H264_FU_A 28
+#define H265_AP 48
+#define H265_FU 49
+#define FU_START_BIT 0x80
+#define FU_END_BIT 0x40
+#define FRAGMENT_INITIAL_CAPACITY 65536
+// Packets further behind than this are not considered late, but a restart of the sender; See
+// RFC 3550, Appendix A.1.
+#define RTP_MAX_MISORDER 100
+#define RTP_SEQ_MOD (1 << 16)
+
+#define PCAP_HEADER_SIZE 24
+#define PCAP_RECORD_HEADER_SIZE 16
+#define PCAP_MAGIC_US 0xa1b2c3d4
+#define PCAP_MAGIC_NS 0xa1b23c4d
+#define PCAP_LINKTYPE_ETHERNET 1
+#define ETHERNET_HEADER_SIZE 14
+#define ETHERTYPE_VLAN 0x8100
+#define ETHERTYPE_IPV4 0x0800
+#define ETHERTYPE_IPV6 0x86dd
+#define IPV6_HEADER_SIZE 40
+#define IP_PROTOCOL_UDP 17
+#define UDP_HEADER_SIZE 8
+
+struct _sv_rtp_depacketizer_t {
+  signed_video_t *sv;
+  sv_rtp_report_cb_t report_cb;
+  void *user_data;
+
+  bool has_sequence_number;  // Set once the first packet has been added.
+  uint32_t ssrc;  // Of the stream being depacketized.
+  uint16_t next_sequence_number;
+  // The sequence number following a packet far behind |next_sequence_number|, or RTP_SEQ_MOD + 1
+  // if there is none. If the next packet has this sequence number, the sender has restarted.
+  uint32_t bad_sequence_number;
+
+  uint8_t *fragment;  // The NALU being gathered from fragmentation units.
+  size_t fragment_size;
+  size_t fragment_capacity;
+  bool has_fragment;  // Set if a NALU is being gathered.
+
+  sv_rtp_stats_t stats;
+};
+
+static uint16_t
+read_u16(const uint8_t *data)
+{
+  return (uint16_t)((data[0] << 8) | data[1]);
+}
+
+static uint32_t
+read_u32(const uint8_t *data, bool is_big_endian)
+{
+  if (is_big_endian) {
+    return ((uint32_t)data[0] << 24) | ((uint32_t)data[1] << 16) | ((uint32_t)data[2] << 8) |
+        data[3];
+  }
+  return ((uint32_t)data[3] << 24) | ((uint32_t)data[2] << 16) | ((uint32_t)data[1] << 8) |
+      data[0];
+}
+
+/* Adds a complete NALU, without start code, for validation. */
+static SignedVideoReturnCode
+add_nalu(sv_rtp_depacketizer_t *self, const uint8_t *nalu_data, size_t nalu_data_size)
+{
+  signed_video_authenticity_t *report = NULL;
+  SignedVideoReturnCode rc = signed_video_add_nalu_and_authenticate(
+      self->sv, nalu_data, nalu_data_size, self->report_cb ? &report : NULL);
+  if (rc != SV_OK) return rc;
+  self->stats.num_nalus++;
+  if (report) self->report_cb(report, self->user_data);
+
+  return SV_OK;
+}
+
+/* Drops the NALU being gathered, if any. */
+static void
+drop_fragment(sv_rtp_depacketizer_t *self)
+{
+  if (!self->has_fragment) return;
+  self->has_fragment = false;
+  self->stats.num_dropped_nalus++;
+}
+
+/* Appends |data| to the NALU being gathered. */
+static SignedVideoReturnCode
+append_to_fragment(sv_rtp_depacketizer_t *self, const uint8_t *data, size_t data_size)
+{
+  if (self->fragment_size + data_size > self->fragment_capacity) {
+    size_t capacity = self->fragment_capacity ? self->fragment_capacity : FRAGMENT_INITIAL_CAPACITY;
+    while (capacity < self->fragment_size + data_size) capacity *= 2;
+    uint8_t *fragment = realloc(self->fragment, capacity);
+    if (!fragment) return SV_MEMORY;
+    self->fragment = fragment;
+    self->fragment_capacity = capacity;
+  }
+  memcpy(self->fragment + self->fragment_size, data, data_size);
+  self->fragment_size += data_size;
+
+  return SV_OK;
+}
+
+/* Reads a fragmentation unit. The |nalu_header| of the fragmented NALU has been restored from the
+ * payload header and the FU header. */
+static SignedVideoReturnCode
+read_fragmentation_unit(sv_rtp_depacketizer_t *self,
+    const uint8_t *payload,
+    size_t payload_size,
+    const uint8_t *nalu_header,
+    size_t nalu_header_size)
+{
+  // The FU header follows the payload header, which is as large as the NALU header.
+  const size_t fu_header_size = nalu_header_size + 1;
+  if (payload_size <= fu_header_size) return SV_INVALID_PARAMETER;
+  const uint8_t fu_header = payload[nalu_header_size];
+
+  SignedVideoReturnCode rc = SV_OK;
+  if (fu_header & FU_START_BIT) {
+    // A new NALU starts before the previous one ended.
+    drop_fragment(self);
+    self->has_fragment = true;
+    self->fragment_size = 0;
+    rc = append_to_fragment(self, nalu_header, nalu_header_size);
+  }
+  // Without its start, a fragment is useless. The NALU has already been dropped.
+  if (!self->has_fragment) return SV_OK;
+  if (rc == SV_OK) {
+    rc = append_to_fragment(self, payload + fu_header_size, payload_size - fu_header_size);
+  }
+  if (rc == SV_OK && (fu_header & FU_END_BIT)) {
+    self->has_fragment = false;
+    rc = add_nalu(self, self->fragment, self->fragment_size);
+  }
+
+  return rc;
+}
+
+/* Adds the NALUs of an aggregation packet in place. Each NALU is preceded by its 16 bits size. */
+static SignedVideoReturnCode
+read_aggregation_packet(sv_rtp_depacketizer_t *self,
+    const uint8_t *payload,
+    size_t payload_size,
+    size_t payload_header_size)
+{
+  size_t offset = payload_header_size;
+  while (offset + 2 <= payload_size) {
+    const size_t nalu_data_size = read_u16(payload + offset);
+    offset += 2;
+    if (nalu_data_size == 0 || offset + nalu_data_size > payload_size) {
+      return SV_INVALID_PARAMETER;
+    }
+    SignedVideoReturnCode rc = add_nalu(self, payload + offset, nalu_data_size);
+    if (rc != SV_OK) return rc;
+    offset += nalu_data_size;
+  }
+
+  return SV_OK;
+}
+
+static SignedVideoReturnCode
+read_h264_payload(sv_rtp_depacketizer_t *self, const uint8_t *payload, size_t payload_size)
+{
+  const uint8_t type = payload[0] & 0x1f;
+  if (type >= 1 && type <= 23) return add_nalu(self, payload, payload_size);
+  if (type == H264_STAP_A) return read_aggregation_packet(self, payload, payload_size, 1);
+  if (type == H264_FU_A) {
+    if (payload_size < 2) return SV_INVALID_PARAMETER;
+    // The NALU header is the F and NRI bits of the FU indicator, and the type of the FU header.
+    const uint8_t nalu_header = (payload[0] & 0xe0) | (payload[1] & 0x1f);
+    return read_fragmentation_unit(self, payload, payload_size, &nalu_header, 1);
+  }
+
+  return SV_NOT_SUPPORTED;
+}
+
+static SignedVideoReturnCode
+read_h265_payload(sv_rtp_depacketizer_t *self, const uint8_t *payload, size_t payload_size)
+{
+  if (payload_size < 2) return SV_INVALID_PARAMETER;
+  const uint8_t type = (payload[0] >> 1) & 0x3f;
+  if (type <= 47) return add_nalu(self, payload, payload_size);
+  if (type == H265_AP) return read_aggregation_packet(self, payload, payload_size, 2);
+  if (type == H265_FU) {
+    if (payload_size < 3) return SV_INVALID_PARAMETER;
+    // The NALU header is the payload header with the type of the FU header.
+    const uint8_t nalu_header[2] = {
+        (uint8_t)((payload[0] & 0x81) | ((payload[2] & 0x3f) << 1)), payload[1]};
+    return read_fragmentation_unit(self, payload, payload_size, nalu_header, 2);
+  }
+
+  return SV_NOT_SUPPORTED;
+}
+
+/* Gets the UDP payload of an Ethernet frame. Returns false if the frame is not a UDP packet to
+ * |udp_port|, or if it is truncated. */
+static bool
+get_udp_payload(const uint8_t *frame,
+    size_t frame_size,
+    uint16_t udp_port,
+    const uint8_t **payload,
+    size_t *payload_size)
+{
+  if (frame_size < ETHERNET_HEADER_SIZE) return false;
+  size_t offset = ETHERNET_HEADER_SIZE;
+  uint16_t ethertype = read_u16(frame + 12);
+  if (ethertype == ETHERTYPE_VLAN) {
+    if (frame_size < ETHERNET_HEADER_SIZE + 4) return false;
+    ethertype = read_u16(frame + 16);
+    offset += 4;
+  }
+
+  const uint8_t *ip = frame + offset;
+  const size_t ip_size = frame_size - offset;
+  size_t ip_header_size = 0;
+  if (ethertype == ETHERTYPE_IPV4) {
+    if (ip_size < 20) return false;
+    ip_header_size = (ip[0] & 0x0f) * 4;
+    // Fragmented datagrams, that is, with the MF flag or an offset, are not reassembled.
+    const bool is_fragmented = (read_u16(ip + 6) & 0x3fff) != 0;
+    if (ip[9] != IP_PROTOCOL_UDP || is_fragmented) return false;
+  } else if (ethertype == ETHERTYPE_IPV6) {
+    ip_header_size = IPV6_HEADER_SIZE;
+    if (ip_size < ip_header_size || ip[6] != IP_PROTOCOL_UDP) return false;
+  } else {
+    return false;
+  }
+  if (ip_size < ip_header_size + UDP_HEADER_SIZE) return false;
+
+  const uint8_t *udp = ip + ip_header_size;
+  const size_t udp_length = read_u16(udp + 4);
+  if (udp_port != 0 && read_u16(udp + 2) != udp_port) return false;
+  if (udp_length < UDP_HEADER_SIZE || ip_header_size + udp_length > ip_size) return false;
+  *payload = udp + UDP_HEADER_SIZE;
+  *payload_size = udp_length - UDP_HEADER_SIZE;
+
+  return true;
+}
+
+/**
+ * @brief Public signed_video_rtp.h APIs
+ */
+
+sv_rtp_depacketizer_t *
+signed_video_rtp_depacketizer_create(signed_video_t *sv,
+    sv_rtp_report_cb_t report_cb,
+    void *user_data)
+{
+  if (!sv) return NULL;
+
+  sv_rtp_depacketizer_t *self = calloc(1, sizeof(sv_rtp_depacketizer_t));
+  if (!self) return NULL;
+  self->sv = sv;
+  self->report_cb = report_cb;
+  self->user_data = user_data;
+  self->bad_sequence_number = RTP_SEQ_MOD + 1;
+
+  return self;
+}
+
+void
+signed_video_rtp_depacketizer_free(sv_rtp_depacketizer_t *rtp)
+{
+  if (!rtp) return;
+
+  free(rtp->fragment);
+  free(rtp);
+}
+
+SignedVideoReturnCode
+signed_video_rtp_depacketizer_add_packet(sv_rtp_depacketizer_t *rtp,
+    const uint8_t *packet,
+    size_t packet_size)
+{
+  if (!rtp || !packet || packet_size < RTP_HEADER_SIZE) return SV_INVALID_PARAMETER;
+  if ((packet[0] >> 6) != RTP_VERSION) return SV_INVALID_PARAMETER;
+
+  // Skip the CSRCs and the header extension, and remove the padding.
+  size_t header_size = RTP_HEADER_SIZE + 4 * (packet[0] & 0x0f);
+  if (packet[0] & 0x10) {
+    if (header_size + 4 > packet_size) return SV_INVALID_PARAMETER;
+    header_size += 4 + 4 * (size_t)read_u16(packet + header_size + 2);
+  }
+  size_t padding_size = (packet[0] & 0x20) ? packet[packet_size - 1] : 0;
+  if (header_size + padding_size >= packet_size) return SV_INVALID_PARAMETER;
+  rtp->stats.num_packets++;
+
+  const uint16_t sequence_number = read_u16(packet + 2);
+  const uint32_t ssrc = read_u32(packet + 8, true);
+  bool is_resync = false;
+  if (rtp->has_sequence_number && ssrc != rtp->ssrc) {
+    // A new stream, for example, after the sender restarted.
+    is_resync = true;
+  } else if (rtp->has_sequence_number) {
+    const uint16_t gap = (uint16_t)(sequence_number - rtp->next_sequence_number);
+    if (gap >= 0x8000) {
+      // A sequence number slightly behind the expected one belongs to a late or duplicate packet.
+      // Far behind, it may also be the sender restarting the numbering, which is assumed if the
+      // next packet follows in sequence.
+      const uint16_t distance = (uint16_t)(rtp->next_sequence_number - sequence_number);
+      if (distance > RTP_MAX_MISORDER && sequence_number == rtp->bad_sequence_number) {
+        is_resync = true;
+      } else {
+        if (distance > RTP_MAX_MISORDER) {
+          rtp->bad_sequence_number = (uint16_t)(sequence_number + 1);
+        }
+        rtp->stats.num_ignored_packets++;
+        return SV_OK;
+      }
+    } else if (gap > 0) {
+      rtp->stats.num_lost_packets += gap;
+      drop_fragment(rtp);
+    }
+  }
+  if (is_resync) {
+    rtp->stats.num_resyncs++;
+    drop_fragment(rtp);
+  }
+  rtp->has_sequence_number = true;
+  rtp->ssrc = ssrc;
+  rtp->next_sequence_number = (uint16_t)(sequence_number + 1);
+  rtp->bad_sequence_number = RTP_SEQ_MOD + 1;
+
+  const uint8_t *payload = packet + header_size;
+  const size_t payload_size = packet_size - header_size - padding_size;
+  return rtp->sv->codec == SV_CODEC_H264 ? read_h264_payload(rtp, payload, payload_size)
+                                         : read_h265_payload(rtp, payload, payload_size);
+}
+
+SignedVideoReturnCode
+signed_video_rtp_depacketizer_add_pcap(sv_rtp_depacketizer_t *rtp,
+    const uint8_t *data,
+    size_t data_size,
+    uint16_t udp_port)
+{
+  if (!rtp || !data || data_size < PCAP_HEADER_SIZE) return SV_INVALID_PARAMETER;
+
+  // The byte order of the file is given by the magic number.
+  bool is_big_endian = false;
+  uint32_t magic = read_u32(data, is_big_endian);
+  if (magic != PCAP_MAGIC_US && magic != PCAP_MAGIC_NS) {
+    is_big_endian = true;
+    magic = read_u32(data, is_big_endian);
+  }
+  if (magic != PCAP_MAGIC_US && magic != PCAP_MAGIC_NS) return SV_NOT_SUPPORTED;
+  if (read_u32(data + 20, is_big_endian) != PCAP_LINKTYPE_ETHERNET) return SV_NOT_SUPPORTED;
+
+  size_t offset = PCAP_HEADER_SIZE;
+  while (offset < data_size) {
+    if (offset + PCAP_RECORD_HEADER_SIZE > data_size) return SV_INVALID_PARAMETER;
+    const size_t captured_size = read_u32(data + offset + 8, is_big_endian);
+    offset += PCAP_RECORD_HEADER_SIZE;
+    if (captured_size > data_size - offset) return SV_INVALID_PARAMETER;
+
+    const uint8_t *payload = NULL;
+    size_t payload_size = 0;
+    if (get_udp_payload(data + offset, captured_size, udp_port, &payload, &payload_size)) {
+      SignedVideoReturnCode rc =
+          signed_video_rtp_depacketizer_add_packet(rtp, payload, payload_size);
+      if (rc != SV_OK) return rc;
+    }
+    offset += captured_size;
+  }
+
+  return SV_OK;
+}
+
+SignedVideoReturnCode
+signed_video_rtp_depacketizer_get_stats(const sv_rtp_depacketizer_t *rtp, sv_rtp_stats_t *stats)
+{
+  if (!rtp || !stats) return SV_INVALID_PARAMETER;
+
+  *stats = rtp->stats;
+
+  return SV_OK;
+}
@@ -0,0 +1,293 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2023 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next paragraph) shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "signed_video_sequencer.h"
+
+#if !defined(_WIN32) && !defined(_WIN64)
+#include <pthread.h>  // pthread_mutex_t, pthread_cond_t
+#endif
+#include <stdbool.h>  // bool
+#include <stdlib.h>  // calloc, realloc, free
+
+/* Items are stored in a ring of SEQUENCER_WINDOW_SIZE slots, indexed by sequence number. Outputs
+ * are stored in a growing FIFO. All members are protected by |lock|. */
+struct _sequencer_t {
+  sequencer_process_fn process_fn;
+  sequencer_free_fn item_free_fn;
+  sequencer_free_fn output_free_fn;
+  void *user_data;
+
+#if !defined(_WIN32) && !defined(_WIN64)
+  pthread_mutex_t lock;
+  pthread_cond_t has_room;  // Broadcasted when an item has been processed.
+  pthread_cond_t is_idle;  // Broadcasted when a thread stops processing items.
+#endif
+  void *items[SEQUENCER_WINDOW_SIZE];
+  uint64_t next_sequence_number;  // The sequence number of the next item to process.
+  bool is_processing;  // A thread is processing items.
+
+  void **outputs;
+  size_t first_output;
+  size_t num_outputs;
+  size_t outputs_capacity;
+};
+
+#if defined(_WIN32) || defined(_WIN64)
+/* There are no threads on Windows, hence a sequencer is only used by one thread and needs no
+ * locking. */
+static void
+lock_sequencer(sequencer_t *self)
+{
+  (void)self;
+}
+
+static void
+unlock_sequencer(sequencer_t *self)
+{
+  (void)self;
+}
+#else
+static void
+lock_sequencer(sequencer_t *self)
+{
+  pthread_mutex_lock(&self->lock);
+}
+
+static void
+unlock_sequencer(sequencer_t *self)
+{
+  pthread_mutex_unlock(&self->lock);
+}
+#endif
+
+/* Frees all items and outputs. Called without concurrent users, hence no locking. */
+static void
+free_items_and_outputs(sequencer_t *self)
+{
+  for (int i = 0; i < SEQUENCER_WINDOW_SIZE; i++) {
+    if (self->items[i]) self->item_free_fn(self->items[i]);
+    self->items[i] = NULL;
+  }
+  for (size_t i = 0; i < self->num_outputs; i++) {
+    self->output_free_fn(self->outputs[(self->first_output + i) % self->outputs_capacity]);
+  }
+  self->first_output = 0;
+  self->num_outputs = 0;
+}
+
+sequencer_t *
+sequencer_create(sequencer_process_fn process_fn,
+    sequencer_free_fn item_free_fn,
+    sequencer_free_fn output_free_fn,
+    void *user_data)
+{
+  if (!process_fn || !item_free_fn || !output_free_fn) return NULL;
+
+  sequencer_t *self = calloc(1, sizeof(sequencer_t));
+  if (!self) return NULL;
+
+  self->process_fn = process_fn;
+  self->item_free_fn = item_free_fn;
+  self->output_free_fn = output_free_fn;
+  self->user_data = user_data;
+
+#if !defined(_WIN32) && !defined(_WIN64)
+  if (pthread_mutex_init(&self->lock, NULL) != 0) goto catch_error;
+  if (pthread_cond_init(&self->has_room, NULL) != 0) {
+    pthread_mutex_destroy(&self->lock);
+    goto catch_error;
+  }
+  if (pthread_cond_init(&self->is_idle, NULL) != 0) {
+    pthread_cond_destroy(&self->has_room);
+    pthread_mutex_destroy(&self->lock);
+    goto catch_error;
+  }
+#endif
+
+  return self;
+
+#if !defined(_WIN32) && !defined(_WIN64)
+catch_error:
+  free(self);
+  return NULL;
+#endif
+}
+
+void
+sequencer_free(sequencer_t *self)
+{
+  if (!self) return;
+
+  free_items_and_outputs(self);
+  free(self->outputs);
+#if !defined(_WIN32) && !defined(_WIN64)
+  pthread_cond_destroy(&self->is_idle);
+  pthread_cond_destroy(&self->has_room);
+  pthread_mutex_destroy(&self->lock);
+#endif
+  free(self);
+}
+
+void
+sequencer_reset(sequencer_t *self)
+{
+  if (!self) return;
+
+  free_items_and_outputs(self);
+  self->next_sequence_number = 0;
+  self->is_processing = false;
+}
+
+svi_rc
+sequencer_submit(sequencer_t *self, uint64_t sequence_number, void *item)
+{
+  if (!self || !item) return SVI_INVALID_PARAMETER;
+
+  svi_rc status = SVI_OK;
+
+  lock_sequencer(self);
+  while (sequence_number >= self->next_sequence_number + SEQUENCER_WINDOW_SIZE) {
+#if defined(_WIN32) || defined(_WIN64)
+    // Without other threads there is no one to make room.
+    unlock_sequencer(self);
+    self->item_free_fn(item);
+    return SVI_NOT_SUPPORTED;
+#else
+    pthread_cond_wait(&self->has_room, &self->lock);
+#endif
+  }
+  void **slot = &self->items[sequence_number % SEQUENCER_WINDOW_SIZE];
+  if (sequence_number < self->next_sequence_number || *slot) {
+    // Already submitted.
+    unlock_sequencer(self);
+    self->item_free_fn(item);
+    return SVI_NOT_SUPPORTED;
+  }
+  *slot = item;
+
+  // Process items in sequence, unless another thread already does.
+  if (!self->is_processing) {
+    self->is_processing = true;
+    slot = &self->items[self->next_sequence_number % SEQUENCER_WINDOW_SIZE];
+    while (*slot) {
+      void *next_item = *slot;
+      *slot = NULL;
+      unlock_sequencer(self);
+
+      svi_rc process_status = self->process_fn(self->user_data, next_item);
+      if (status == SVI_OK) status = process_status;
+
+      lock_sequencer(self);
+      self->next_sequence_number++;
+#if !defined(_WIN32) && !defined(_WIN64)
+      pthread_cond_broadcast(&self->has_room);
+#endif
+      slot = &self->items[self->next_sequence_number % SEQUENCER_WINDOW_SIZE];
+    }
+    self->is_processing = false;
+#if !defined(_WIN32) && !defined(_WIN64)
+    pthread_cond_broadcast(&self->is_idle);
+#endif
+  }
+  unlock_sequencer(self);
+
+  return status;
+}
+
+svi_rc
+sequencer_run_exclusive(sequencer_t *self, sequencer_exclusive_fn fn, void *arg)
+{
+  if (!self || !fn) return SVI_INVALID_PARAMETER;
+
+  lock_sequencer(self);
+#if !defined(_WIN32) && !defined(_WIN64)
+  // A thread processing items releases the lock meanwhile. Holding the lock while not processing
+  // prevents any thread from starting.
+  while (self->is_processing) {
+    pthread_cond_wait(&self->is_idle, &self->lock);
+  }
+#endif
+  fn(self->user_data, arg);
+  unlock_sequencer(self);
+
+  return SVI_OK;
+}
+
+uint64_t
+sequencer_get_next_sequence_number(sequencer_t *self)
+{
+  if (!self) return 0;
+
+  lock_sequencer(self);
+  uint64_t next_sequence_number = self->next_sequence_number;
+  unlock_sequencer(self);
+
+  return next_sequence_number;
+}
+
+svi_rc
+sequencer_push_output(sequencer_t *self, void *output)
+{
+  if (!self || !output) return SVI_INVALID_PARAMETER;
+
+  svi_rc status = SVI_OK;
+
+  lock_sequencer(self);
+  if (self->num_outputs == self->outputs_capacity) {
+    // Grow the FIFO and move the outputs to the beginning of the new memory.
+    size_t new_capacity = self->outputs_capacity ? 2 * self->outputs_capacity : 8;
+    void **new_outputs = calloc(new_capacity, sizeof(void *));
+    if (!new_outputs) {
+      status = SVI_MEMORY;
+      goto done;
+    }
+    for (size_t i = 0; i < self->num_outputs; i++) {
+      new_outputs[i] = self->outputs[(self->first_output + i) % self->outputs_capacity];
+    }
+    free(self->outputs);
+    self->outputs = new_outputs;
+    self->outputs_capacity = new_capacity;
+    self->first_output = 0;
+  }
+  self->outputs[(self->first_output + self->num_outputs) % self->outputs_capacity] = output;
+  self->num_outputs++;
+
+done:
+  unlock_sequencer(self);
+  return status;
+}
+
+void *
+sequencer_pop_output(sequencer_t *self)
+{
+  if (!self) return NULL;
+
+  void *output = NULL;
+
+  lock_sequencer(self);
+  if (self->num_outputs > 0) {
+    output = self->outputs[self->first_output];
+    self->first_output = (self->first_output + 1) % self->outputs_capacity;
+    self->num_outputs--;
+  }
+  unlock_sequencer(self);
+
+  return output;
+}
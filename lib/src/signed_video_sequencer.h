@@ -0,0 +1,171 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2023 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next paragraph) shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef __SIGNED_VIDEO_SEQUENCER_H__
+#define __SIGNED_VIDEO_SEQUENCER_H__
+
+#include <stdint.h>  // uint64_t
+#include <string.h>  // size_t
+
+#include "signed_video_defines.h"  // svi_rc
+
+/* The number of items that can be submitted ahead of the next one to process. */
+#define SEQUENCER_WINDOW_SIZE 256
+
+typedef struct _sequencer_t sequencer_t;
+
+/**
+ * Function processing one item in sequence. The function takes ownership of the |item|.
+ */
+typedef svi_rc (*sequencer_process_fn)(void *user_data, void *item);
+
+/**
+ * Function freeing an item, or an output, that has not been processed.
+ */
+typedef void (*sequencer_free_fn)(void *item);
+
+/**
+ * Function run by sequencer_run_exclusive(...) while no items are processed.
+ */
+typedef void (*sequencer_exclusive_fn)(void *user_data, void *arg);
+
+/**
+ * @brief Creates a sequencer
+ *
+ * A sequencer lets several threads submit items with explicit sequence numbers, in any order. The
+ * items are then processed in sequence, starting from sequence number 0, by one thread at a time.
+ * Further, the sequencer holds a queue of outputs produced when processing.
+ *
+ * @param process_fn The function processing items in sequence.
+ * @param item_free_fn The function freeing items not processed.
+ * @param output_free_fn The function freeing outputs not popped.
+ * @param user_data Passed on to |process_fn|.
+ *
+ * @returns A pointer to the sequencer, or NULL upon failure.
+ */
+sequencer_t *
+sequencer_create(sequencer_process_fn process_fn,
+    sequencer_free_fn item_free_fn,
+    sequencer_free_fn output_free_fn,
+    void *user_data);
+
+/**
+ * @brief Frees a sequencer
+ *
+ * All items not yet processed and all outputs not yet popped are freed. Must not be called while
+ * other threads use the sequencer.
+ *
+ * @param self Pointer to the sequencer.
+ */
+void
+sequencer_free(sequencer_t *self);
+
+/**
+ * @brief Resets a sequencer
+ *
+ * Frees all items and outputs as in sequencer_free(...) and starts over from sequence number 0.
+ * Must not be called while other threads use the sequencer.
+ *
+ * @param self Pointer to the sequencer.
+ */
+void
+sequencer_reset(sequencer_t *self);
+
+/**
+ * @brief Submits an item to process in sequence
+ *
+ * The |item| is stored until all items with lower sequence numbers have been processed. If no
+ * other thread is processing items, the calling thread processes all items that are next in
+ * sequence, including items submitted by other threads meanwhile, before returning. Otherwise, the
+ * function returns at once and the thread already processing takes care of the |item|.
+ *
+ * If the |sequence_number| is SEQUENCER_WINDOW_SIZE or more ahead of the next item to process, the
+ * call blocks until there is room. On Windows, where there are no other threads to make room, the
+ * |item| is rejected instead.
+ *
+ * The sequencer takes ownership of the |item|, also if rejected, in which case it is freed at once.
+ *
+ * @param self Pointer to the sequencer.
+ * @param sequence_number The sequence number of the |item|.
+ * @param item The item to process.
+ *
+ * @returns SVI_OK if the |item| was submitted and, if processed by this thread, all items were
+ *            processed successfully,
+ *          SVI_INVALID_PARAMETER if any pointer is NULL,
+ *          SVI_NOT_SUPPORTED if the |sequence_number| has already been submitted, or on Windows,
+ *            is too far ahead,
+ *          otherwise the first failure returned by the |process_fn| in this call.
+ */
+svi_rc
+sequencer_submit(sequencer_t *self, uint64_t sequence_number, void *item);
+
+/**
+ * @brief Runs a function while no items are processed
+ *
+ * Waits until no thread is processing items and runs |fn|, with the |user_data| of the sequencer
+ * and |arg|, before any thread starts processing again. Hence, |fn| may access the same states as
+ * the |process_fn|. Since the sequencer is locked meanwhile, |fn| should be short and must not use
+ * the sequencer. Must not be called from the |process_fn|.
+ *
+ * @param self Pointer to the sequencer.
+ * @param fn The function to run.
+ * @param arg Passed on to |fn|.
+ *
+ * @returns SVI_OK if |fn| was run, SVI_INVALID_PARAMETER if |self| or |fn| is NULL.
+ */
+svi_rc
+sequencer_run_exclusive(sequencer_t *self, sequencer_exclusive_fn fn, void *arg);
+
+/**
+ * @brief Gets the sequence number of the next item to process
+ *
+ * All items with lower sequence numbers have been processed.
+ *
+ * @param self Pointer to the sequencer.
+ *
+ * @returns The next sequence number, or 0 if |self| is NULL.
+ */
+uint64_t
+sequencer_get_next_sequence_number(sequencer_t *self);
+
+/**
+ * @brief Adds an output to the queue of outputs
+ *
+ * Typically called by the |process_fn| to hand over a result to any thread.
+ *
+ * @param self Pointer to the sequencer.
+ * @param output The output to add. The sequencer takes ownership upon success.
+ *
+ * @returns SVI_OK upon success, SVI_INVALID_PARAMETER or SVI_MEMORY otherwise.
+ */
+svi_rc
+sequencer_push_output(sequencer_t *self, void *output);
+
+/**
+ * @brief Pops the oldest output
+ *
+ * @param self Pointer to the sequencer.
+ *
+ * @returns The oldest output, with ownership transferred, or NULL if there are no outputs.
+ */
+void *
+sequencer_pop_output(sequencer_t *self);
+
+#endif  // __SIGNED_VIDEO_SEQUENCER_H__
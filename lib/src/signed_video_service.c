@@ -0,0 +1,451 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2023 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next paragraph) shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "includes/signed_video_service.h"
+
+#include "signed_video_internal.h"  // signed_video_t, service_remove_session()
+
+#if defined(_WIN32) || defined(_WIN64)
+// The service runs its workers as POSIX threads, hence it is not supported on Windows.
+
+void
+service_remove_session(signed_video_t *sv)
+{
+  (void)sv;
+}
+
+signed_video_service_t *
+signed_video_service_create(unsigned num_workers)
+{
+  (void)num_workers;
+  return NULL;
+}
+
+void
+signed_video_service_free(signed_video_service_t *service)
+{
+  (void)service;
+}
+
+SignedVideoReturnCode
+signed_video_service_add_session(signed_video_service_t *service, signed_video_t *sv)
+{
+  if (!service || !sv) return SV_INVALID_PARAMETER;
+  return SV_NOT_SUPPORTED;
+}
+
+SignedVideoReturnCode
+signed_video_service_remove_session(signed_video_service_t *service, signed_video_t *sv)
+{
+  (void)service;
+  (void)sv;
+  return SV_INVALID_PARAMETER;
+}
+
+SignedVideoReturnCode
+signed_video_service_add_nalu(signed_video_service_t *service,
+    signed_video_t *sv,
+    const uint8_t *nalu_data,
+    size_t nalu_data_size)
+{
+  (void)service;
+  (void)sv;
+  (void)nalu_data;
+  (void)nalu_data_size;
+  return SV_INVALID_PARAMETER;
+}
+
+SignedVideoReturnCode
+signed_video_service_flush(signed_video_service_t *service, signed_video_t *sv)
+{
+  (void)service;
+  (void)sv;
+  return SV_INVALID_PARAMETER;
+}
+
+#else
+#include <pthread.h>  // pthread_t, pthread_mutex_t, pthread_cond_t
+#include <stdbool.h>  // bool
+#include <stdlib.h>  // calloc, malloc, free
+#include <string.h>  // memcpy
+#include <unistd.h>  // sysconf
+
+#include "signed_video_defines.h"  // svi_rc
+#include "signed_video_h26x_internal.h"  // add_sequenced_nalu()
+#include "signed_video_sequencer.h"  // sequencer_get_next_sequence_number()
+
+/* A NALU waiting in the queue of a worker to be parsed, hashed and submitted to the |sequencer| of
+ * its session. */
+typedef struct _service_task_t {
+  struct _service_task_t *next;
+  service_session_t *session;
+  uint64_t sequence_number;
+  uint8_t *nalu_data;  // A copy of the NALU data owned by the task.
+  size_t nalu_data_size;
+} service_task_t;
+
+/* A worker thread with its own queue of tasks. The queue has its own lock, hence workers only
+ * contend with each other when stealing. */
+typedef struct {
+  signed_video_service_t *service;
+  unsigned index;
+  pthread_t thread;
+  pthread_mutex_t lock;  // Protects the queue.
+  service_task_t *first_task;
+  service_task_t *last_task;
+} service_worker_t;
+
+/* The service state of a registered session. All members are protected by the |lock| of the
+ * service. */
+struct _service_session_t {
+  signed_video_service_t *service;
+  signed_video_t *sv;
+  unsigned home_worker;  // The worker whose queue the tasks of this session are pushed to.
+  uint64_t next_sequence_number;  // The sequence number given to the next NALU added.
+  uint64_t num_pending_tasks;  // Tasks added, but not yet done.
+  svi_rc status;  // The first failure since the last flush.
+  struct _service_session_t *prev;
+  struct _service_session_t *next;
+};
+
+struct _signed_video_service_t {
+  pthread_mutex_t lock;
+  pthread_cond_t has_work;  // Signaled when a task has been queued, or when stopping.
+  pthread_cond_t task_done;  // Broadcasted when a task is done.
+  size_t num_queued_tasks;  // Tasks queued, but not yet picked by a worker.
+  bool is_stopping;
+  service_session_t *sessions;  // Linked list of registered sessions.
+  unsigned next_home_worker;
+
+  service_worker_t *workers;
+  unsigned num_workers;  // The number of workers with a running thread.
+};
+
+/* Appends a |task| to the queue of a |worker|. */
+static void
+push_task(service_worker_t *worker, service_task_t *task)
+{
+  task->next = NULL;
+  pthread_mutex_lock(&worker->lock);
+  if (worker->last_task) {
+    worker->last_task->next = task;
+  } else {
+    worker->first_task = task;
+  }
+  worker->last_task = task;
+  pthread_mutex_unlock(&worker->lock);
+}
+
+/* Pops the oldest task from the queue of a |worker|, or returns NULL if the queue is empty. Both
+ * the owner and thieves take the oldest task, since older NALUs are the ones holding back the
+ * sequencers of their sessions. */
+static service_task_t *
+pop_task(service_worker_t *worker)
+{
+  pthread_mutex_lock(&worker->lock);
+  service_task_t *task = worker->first_task;
+  if (task) {
+    worker->first_task = task->next;
+    if (!worker->first_task) worker->last_task = NULL;
+  }
+  pthread_mutex_unlock(&worker->lock);
+
+  return task;
+}
+
+/* Hands over the NALU of a |task| to its session and records the outcome. */
+static void
+run_task(signed_video_service_t *service, service_task_t *task)
+{
+  service_session_t *session = task->session;
+  // Ownership of |nalu_data| is transferred, also upon failure.
+  svi_rc status = add_sequenced_nalu(
+      session->sv, task->sequence_number, task->nalu_data, task->nalu_data_size);
+  free(task);
+
+  pthread_mutex_lock(&service->lock);
+  if (session->status == SVI_OK) session->status = status;
+  session->num_pending_tasks--;
+  pthread_cond_broadcast(&service->task_done);
+  pthread_mutex_unlock(&service->lock);
+}
+
+/* The worker loop. A worker reserves a task by decrementing |num_queued_tasks|, then picks it from
+ * its own queue, or steals it from another worker. Since tasks are queued before they are counted,
+ * a reserved task always exists in one of the queues. Stops when the service is stopping and all
+ * tasks are done. */
+static void *
+worker_thread(void *user_data)
+{
+  service_worker_t *worker = (service_worker_t *)user_data;
+  signed_video_service_t *service = worker->service;
+
+  while (true) {
+    pthread_mutex_lock(&service->lock);
+    while (service->num_queued_tasks == 0 && !service->is_stopping) {
+      pthread_cond_wait(&service->has_work, &service->lock);
+    }
+    if (service->num_queued_tasks == 0) {
+      pthread_mutex_unlock(&service->lock);
+      break;
+    }
+    service->num_queued_tasks--;
+    const unsigned num_workers = service->num_workers;
+    pthread_mutex_unlock(&service->lock);
+
+    service_task_t *task = pop_task(worker);
+    for (unsigned i = 1; !task; i++) {
+      task = pop_task(&service->workers[(worker->index + i) % num_workers]);
+    }
+    run_task(service, task);
+  }
+
+  return NULL;
+}
+
+/* Waits until all tasks of a |session| are done, then returns and clears its first failure. Must
+ * be called with the |lock| of the service held. */
+static svi_rc
+wait_for_session(signed_video_service_t *service, service_session_t *session)
+{
+  while (session->num_pending_tasks > 0) {
+    pthread_cond_wait(&service->task_done, &service->lock);
+  }
+  svi_rc status = session->status;
+  session->status = SVI_OK;
+
+  return status;
+}
+
+/* Returns the session state of |sv| if registered to |service|, otherwise NULL. */
+static service_session_t *
+get_session(signed_video_service_t *service, signed_video_t *sv)
+{
+  if (!service || !sv || !sv->service_session) return NULL;
+
+  return sv->service_session->service == service ? sv->service_session : NULL;
+}
+
+/* Stops and joins all running workers and frees the service. */
+static void
+service_destroy(signed_video_service_t *service)
+{
+  pthread_mutex_lock(&service->lock);
+  service->is_stopping = true;
+  pthread_cond_broadcast(&service->has_work);
+  pthread_mutex_unlock(&service->lock);
+  for (unsigned i = 0; i < service->num_workers; i++) {
+    pthread_join(service->workers[i].thread, NULL);
+  }
+  // All tasks have been run, hence the queues are empty.
+  for (unsigned i = 0; i < service->num_workers; i++) {
+    pthread_mutex_destroy(&service->workers[i].lock);
+  }
+
+  // Unregister the remaining sessions.
+  while (service->sessions) {
+    service_session_t *session = service->sessions;
+    service->sessions = session->next;
+    session->sv->service_session = NULL;
+    free(session);
+  }
+
+  free(service->workers);
+  pthread_cond_destroy(&service->task_done);
+  pthread_cond_destroy(&service->has_work);
+  pthread_mutex_destroy(&service->lock);
+  free(service);
+}
+
+void
+service_remove_session(signed_video_t *sv)
+{
+  if (!sv || !sv->service_session) return;
+
+  signed_video_service_remove_session(sv->service_session->service, sv);
+}
+
+/**
+ * Public signed_video_service.h APIs
+ */
+
+signed_video_service_t *
+signed_video_service_create(unsigned num_workers)
+{
+  if (num_workers == 0) {
+    long num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    num_workers = num_cpus > 0 ? (unsigned)num_cpus : 1;
+  }
+
+  signed_video_service_t *service = calloc(1, sizeof(signed_video_service_t));
+  if (!service) return NULL;
+  service->workers = calloc(num_workers, sizeof(service_worker_t));
+  if (!service->workers) {
+    free(service);
+    return NULL;
+  }
+  pthread_mutex_init(&service->lock, NULL);
+  pthread_cond_init(&service->has_work, NULL);
+  pthread_cond_init(&service->task_done, NULL);
+
+  for (unsigned i = 0; i < num_workers; i++) {
+    service_worker_t *worker = &service->workers[i];
+    worker->service = service;
+    worker->index = i;
+    pthread_mutex_init(&worker->lock, NULL);
+    // Workers read |num_workers| under the |lock|, hence count the worker before it starts.
+    pthread_mutex_lock(&service->lock);
+    service->num_workers++;
+    pthread_mutex_unlock(&service->lock);
+    if (pthread_create(&worker->thread, NULL, worker_thread, worker) != 0) {
+      pthread_mutex_lock(&service->lock);
+      service->num_workers--;
+      pthread_mutex_unlock(&service->lock);
+      pthread_mutex_destroy(&worker->lock);
+      service_destroy(service);
+      return NULL;
+    }
+  }
+
+  return service;
+}
+
+void
+signed_video_service_free(signed_video_service_t *service)
+{
+  if (!service) return;
+
+  service_destroy(service);
+}
+
+SignedVideoReturnCode
+signed_video_service_add_session(signed_video_service_t *service, signed_video_t *sv)
+{
+  if (!service || !sv) return SV_INVALID_PARAMETER;
+  if (sv->service_session) return SV_NOT_SUPPORTED;
+  // If there is no |sequencer| we failed allocating memory for it.
+  if (!sv->sequencer) return SV_MEMORY;
+
+  service_session_t *session = calloc(1, sizeof(service_session_t));
+  if (!session) return SV_MEMORY;
+
+  session->service = service;
+  session->sv = sv;
+  session->status = SVI_OK;
+  // Continue from where the session is, in case NALUs have been added with sequence numbers before.
+  session->next_sequence_number = sequencer_get_next_sequence_number(sv->sequencer);
+
+  pthread_mutex_lock(&service->lock);
+  session->home_worker = service->next_home_worker;
+  service->next_home_worker = (service->next_home_worker + 1) % service->num_workers;
+  session->next = service->sessions;
+  if (service->sessions) service->sessions->prev = session;
+  service->sessions = session;
+  pthread_mutex_unlock(&service->lock);
+  sv->service_session = session;
+
+  return SV_OK;
+}
+
+SignedVideoReturnCode
+signed_video_service_remove_session(signed_video_service_t *service, signed_video_t *sv)
+{
+  service_session_t *session = get_session(service, sv);
+  if (!session) return SV_INVALID_PARAMETER;
+
+  pthread_mutex_lock(&service->lock);
+  svi_rc status = wait_for_session(service, session);
+  if (session->prev) {
+    session->prev->next = session->next;
+  } else {
+    service->sessions = session->next;
+  }
+  if (session->next) session->next->prev = session->prev;
+  pthread_mutex_unlock(&service->lock);
+  sv->service_session = NULL;
+  free(session);
+
+  return svi_rc_to_signed_video_rc(status);
+}
+
+SignedVideoReturnCode
+signed_video_service_add_nalu(signed_video_service_t *service,
+    signed_video_t *sv,
+    const uint8_t *nalu_data,
+    size_t nalu_data_size)
+{
+  service_session_t *session = get_session(service, sv);
+  if (!session || !nalu_data || nalu_data_size == 0) return SV_INVALID_PARAMETER;
+
+  service_task_t *task = NULL;
+
+  svi_rc status = SVI_UNKNOWN;
+  SVI_TRY()
+    task = calloc(1, sizeof(service_task_t));
+    SVI_THROW_IF(!task, SVI_MEMORY);
+    task->session = session;
+    task->nalu_data = malloc(nalu_data_size);
+    SVI_THROW_IF(!task->nalu_data, SVI_MEMORY);
+    memcpy(task->nalu_data, nalu_data, nalu_data_size);
+    task->nalu_data_size = nalu_data_size;
+
+    pthread_mutex_lock(&service->lock);
+    // Limit the number of NALUs of the session not yet added to the session. This keeps all
+    // sequence numbers in flight within the window of the |sequencer|, hence a worker never blocks
+    // in sequencer_submit(...) waiting for a NALU queued behind it.
+    while (session->next_sequence_number - sequencer_get_next_sequence_number(sv->sequencer) >=
+        SEQUENCER_WINDOW_SIZE) {
+      pthread_cond_wait(&service->task_done, &service->lock);
+    }
+    task->sequence_number = session->next_sequence_number++;
+    session->num_pending_tasks++;
+    service_worker_t *worker = &service->workers[session->home_worker];
+    pthread_mutex_unlock(&service->lock);
+
+    push_task(worker, task);
+    task = NULL;
+
+    pthread_mutex_lock(&service->lock);
+    service->num_queued_tasks++;
+    pthread_cond_signal(&service->has_work);
+    pthread_mutex_unlock(&service->lock);
+  SVI_CATCH()
+  {
+    if (task) free(task->nalu_data);
+    free(task);
+  }
+  SVI_DONE(status)
+
+  return svi_rc_to_signed_video_rc(status);
+}
+
+SignedVideoReturnCode
+signed_video_service_flush(signed_video_service_t *service, signed_video_t *sv)
+{
+  service_session_t *session = get_session(service, sv);
+  if (!session) return SV_INVALID_PARAMETER;
+
+  pthread_mutex_lock(&service->lock);
+  svi_rc status = wait_for_session(service, session);
+  pthread_mutex_unlock(&service->lock);
+
+  return svi_rc_to_signed_video_rc(status);
+}
+#endif
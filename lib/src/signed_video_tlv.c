@@ -599,6 +599,8 @@ decode_public_key(signed_video_t *self, const uint8_t *data, size_t data_size)
 
     if (self->has_public_key && memcmp(data_ptr, signature_info->public_key, pubkey_size)) {
       self->latest_validation->public_key_has_changed = true;
+      // Cached verification outcomes are only valid with the previous public key.
+      verification_cache_clear(self->verification_cache);
     }
     memcpy(signature_info->public_key, data_ptr, pubkey_size);
     self->has_public_key = true;
@@ -773,7 +775,7 @@ decode_signature(signed_video_t *self, const uint8_t *data, size_t data_size)
       signature_info->max_signature_size = 0;
       signature_info->signature_size = 0;
       // Allocate enough space for future signatures as well, that is, max_signature_size.
-      *signature_ptr = sv_interface_malloc(max_signature_size);
+      *signature_ptr = self->plugin.malloc(max_signature_size);
       SVI_THROW_IF(!*signature_ptr, SVI_MEMORY);
       // Set memory size.
       signature_info->max_signature_size = max_signature_size;
@@ -887,6 +889,7 @@ tlv_list_encode_or_get_size(signed_video_t *self,
 {
   if (!self || !tags || !num_tags) return SVI_INVALID_PARAMETER;
 
+  const uint64_t start_ns = get_monotonic_time_ns();
   size_t tlv_list_size = 0;
   uint8_t *data_ptr = data;
 
@@ -905,6 +908,8 @@ tlv_list_encode_or_get_size(signed_video_t *self,
       if (data) data_ptr += tlv_size;
     }
   }
+  counters_add_stage_time(self, SV_STAGE_TLV_ENCODE, start_ns);
+
   return tlv_list_size;
 }
 
@@ -943,6 +948,7 @@ tlv_decode(signed_video_t *self, const uint8_t *data, size_t data_size)
 
   if (!self || !data || data_size == 0) return SVI_INVALID_PARAMETER;
 
+  const uint64_t start_ns = get_monotonic_time_ns();
   while (data_ptr < data + data_size) {
     sv_tlv_tag_t tag = 0;
     size_t tlv_header_size = 0;
@@ -962,6 +968,7 @@ tlv_decode(signed_video_t *self, const uint8_t *data, size_t data_size)
     }
     data_ptr += length;
   }
+  counters_add_stage_time(self, SV_STAGE_TLV_DECODE, start_ns);
 
   return status;
 }
@@ -998,6 +1005,50 @@ tlv_find_tag(const uint8_t *tlv_data, size_t tlv_data_size, sv_tlv_tag_t tag, bo
   return NULL;
 }
 
+svi_rc
+tlv_find_signature(const uint8_t *tlv_data,
+    size_t tlv_data_size,
+    hash_type_t *hash_type,
+    const uint8_t **signature,
+    size_t *signature_size)
+{
+  if (!tlv_data || tlv_data_size == 0 || !hash_type || !signature || !signature_size) {
+    return SVI_INVALID_PARAMETER;
+  }
+
+  const uint8_t *tag_ptr = tlv_find_tag(tlv_data, tlv_data_size, SIGNATURE_TAG, false);
+  if (!tag_ptr) return SVI_INVALID_PARAMETER;
+
+  svi_rc status = SVI_UNKNOWN;
+  SVI_TRY()
+    size_t tlv_header_size = 0;
+    size_t length = 0;
+    sv_tlv_tag_t tag = UNDEFINED_TAG;
+    SVI_THROW(decode_tlv_header(tag_ptr, &tlv_header_size, &tag, &length));
+    const uint8_t *data = tag_ptr + tlv_header_size;
+    const uint8_t *data_ptr = data;
+    // Same layout as in decode_signature(...); version, encoding_status, hash_type, signature_size
+    // (2 bytes) and the signature padded to its max size.
+    SVI_THROW_IF(data + length > tlv_data + tlv_data_size, SVI_DECODING_ERROR);
+    SVI_THROW_IF(length < 5, SVI_DECODING_ERROR);
+    uint8_t version = *data_ptr++;
+    data_ptr++;  // Skip encoding_status
+    hash_type_t type = *data_ptr++;
+    uint16_t true_signature_size = 0;
+    data_ptr += read_16bits(data_ptr, &true_signature_size);
+    SVI_THROW_IF(version == 0, SVI_INCOMPATIBLE_VERSION);
+    SVI_THROW_IF(type < 0 || type >= NUM_HASH_TYPES, SVI_DECODING_ERROR);
+    SVI_THROW_IF((size_t)(data + length - data_ptr) < true_signature_size, SVI_DECODING_ERROR);
+
+    *hash_type = type;
+    *signature = data_ptr;
+    *signature_size = true_signature_size;
+  SVI_CATCH()
+  SVI_DONE(status)
+
+  return status;
+}
+
 bool
 tlv_find_and_decode_recurrent_tags(signed_video_t *self,
     const uint8_t *tlv_data,
@@ -1007,6 +1058,7 @@ tlv_find_and_decode_recurrent_tags(signed_video_t *self,
 
   if (!self || !tlv_data || tlv_data_size == 0) return false;
 
+  const uint64_t start_ns = get_monotonic_time_ns();
   svi_rc status = SVI_UNKNOWN;
   bool recurrent_tags_decoded = false;
   while (tlv_data_ptr < tlv_data + tlv_data_size) {
@@ -1030,6 +1082,7 @@ tlv_find_and_decode_recurrent_tags(signed_video_t *self,
     }
     tlv_data_ptr += length;
   }
+  counters_add_stage_time(self, SV_STAGE_TLV_DECODE, start_ns);
 
   return recurrent_tags_decoded;
 }
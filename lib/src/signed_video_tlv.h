@@ -27,6 +27,7 @@
 
 #include "includes/signed_video_common.h"  // signed_video_t
 #include "signed_video_defines.h"  // svi_rc, sv_tlv_tag_t
+#include "signed_video_internal.h"  // hash_type_t
 
 /**
  * @brief Encodes a SEI-nalu payload defined by a list of tags.
@@ -143,4 +144,30 @@ tlv_find_and_decode_recurrent_tags(signed_video_t *self,
     const uint8_t *tlv_data,
     size_t tlv_data_size);
 
+/**
+ * @brief Scans the TLV part of a SEI payload and reads the signature without decoding it.
+ *
+ * Finds the SIGNATURE_TAG in |tlv_data| and points |signature| to the signature bytes inside
+ * |tlv_data|. Contrary to tlv_decode(...) nothing is written to the session, hence the function can
+ * be used to collect signatures for verification outside the session, e.g., in parallel. The
+ * |tlv_data| is assumed to be without emulation prevention bytes.
+ *
+ * @param tlv_data Pointer to the TLV data to scan.
+ * @param tlv_data_size Size of the TLV data.
+ * @param hash_type Pointer to where the type of hash that has been signed is written.
+ * @param signature Pointer to where the location of the signature is written.
+ * @param signature_size Pointer to where the size of the signature is written.
+ *
+ * @returns SVI_OK if a signature was found,
+ *          SVI_INVALID_PARAMETER for NULL pointer inputs, or if no signature is present,
+ *          SVI_INCOMPATIBLE_VERSION if the signature has an unknown version,
+ *          SVI_DECODING_ERROR if the signature data is corrupt.
+ */
+svi_rc
+tlv_find_signature(const uint8_t *tlv_data,
+    size_t tlv_data_size,
+    hash_type_t *hash_type,
+    const uint8_t **signature,
+    size_t *signature_size);
+
 #endif  // __SIGNED_VIDEO_TLV_H__
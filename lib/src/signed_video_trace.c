@@ -0,0 +1,140 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2023 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next paragraph) shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "includes/signed_video_trace.h"
+
+#include <assert.h>  // assert
+#include <stdlib.h>  // free
+
+#include "signed_video_h26x_internal.h"  // parse_nalu_info()
+#include "signed_video_internal.h"  // get_monotonic_time_ns(), write_be(), read_be()
+
+#define TRACE_FLAG_VALIDATION 0x01
+#define TRACE_FLAG_SIGNED_VIDEO_SEI 0x02
+#define TRACE_FLAG_PRIMARY_SLICE 0x04
+#define TRACE_FLAG_REPORT 0x08
+
+#define FNV_OFFSET_BASIS 0xcbf29ce484222325ULL
+#define FNV_PRIME 0x100000001b3ULL
+
+static uint64_t
+get_digest(const uint8_t *data, size_t data_size)
+{
+  uint64_t digest = FNV_OFFSET_BASIS;
+  for (size_t i = 0; i < data_size; i++) {
+    digest ^= data[i];
+    digest *= FNV_PRIME;
+  }
+
+  return digest;
+}
+
+/* Serializes a record of the added NALU and passes it on to the trace sink. The end of the call is
+ * taken first, hence the parsing is not part of the recorded duration. Declared in
+ * signed_video_internal.h */
+void
+trace_nalu(signed_video_t *self,
+    bool is_validation,
+    const uint8_t *nalu_data,
+    size_t nalu_data_size,
+    uint64_t start_ns,
+    SignedVideoReturnCode return_code,
+    bool has_report)
+{
+  const uint64_t end_ns = get_monotonic_time_ns();
+  if (!self->trace_sink) return;
+
+  h26x_nalu_t nalu = parse_nalu_info(nalu_data, nalu_data_size, self->codec, false);
+  free(nalu.tmp_tlv_memory);
+  // The |hashable_data| starts right after any start code.
+  const uint8_t *data = nalu.hashable_data ? nalu.hashable_data : nalu_data;
+  const size_t data_size = nalu_data_size - (data - nalu_data);
+
+  uint8_t flags = 0;
+  if (is_validation) flags |= TRACE_FLAG_VALIDATION;
+  if (nalu.is_gop_sei) flags |= TRACE_FLAG_SIGNED_VIDEO_SEI;
+  if (nalu.is_primary_slice) flags |= TRACE_FLAG_PRIMARY_SLICE;
+  if (has_report) flags |= TRACE_FLAG_REPORT;
+
+  uint8_t record[SV_TRACE_RECORD_SIZE] = {0};
+  uint8_t *record_ptr = record;
+  *record_ptr++ = SV_TRACE_VERSION;
+  *record_ptr++ = flags;
+  *record_ptr++ = (uint8_t)self->codec;
+  record_ptr++;  // Reserved
+  memcpy(record_ptr, data, data_size < SV_TRACE_HEADER_SIZE ? data_size : SV_TRACE_HEADER_SIZE);
+  record_ptr += SV_TRACE_HEADER_SIZE;
+  record_ptr = write_be(record_ptr, data_size > UINT32_MAX ? UINT32_MAX : data_size, 4);
+  record_ptr = write_be(record_ptr, (uint32_t)return_code, 4);
+  record_ptr = write_be(record_ptr, start_ns, 8);
+  record_ptr = write_be(record_ptr, end_ns - start_ns, 8);
+  record_ptr = write_be(record_ptr, get_digest(data, data_size), 8);
+  assert(record_ptr - record == SV_TRACE_RECORD_SIZE);
+
+  self->trace_sink(record, SV_TRACE_RECORD_SIZE, self->trace_user_data);
+}
+
+/**
+ * @brief Public signed_video_trace.h APIs
+ */
+
+SignedVideoReturnCode
+signed_video_set_trace_sink(signed_video_t *self, sv_trace_sink_t sink, void *user_data)
+{
+  if (!self) return SV_INVALID_PARAMETER;
+  // Workers of a validation service may be producing records meanwhile.
+  if (self->service_session) return SV_NOT_SUPPORTED;
+
+  self->trace_sink = sink;
+  self->trace_user_data = user_data;
+
+  return SV_OK;
+}
+
+SignedVideoReturnCode
+signed_video_trace_parse_record(const uint8_t *data, size_t data_size, sv_trace_record_t *record)
+{
+  if (!data || data_size < SV_TRACE_RECORD_SIZE || !record) return SV_INVALID_PARAMETER;
+  if (data[0] != SV_TRACE_VERSION) return SV_INCOMPATIBLE_VERSION;
+  if (data[2] >= SV_CODEC_NUM) return SV_INVALID_PARAMETER;
+
+  uint64_t value = 0;
+  const uint8_t *data_ptr = data + 1;
+  const uint8_t flags = *data_ptr++;
+  record->is_validation = (flags & TRACE_FLAG_VALIDATION) != 0;
+  record->is_signed_video_sei = (flags & TRACE_FLAG_SIGNED_VIDEO_SEI) != 0;
+  record->is_primary_slice = (flags & TRACE_FLAG_PRIMARY_SLICE) != 0;
+  record->has_report = (flags & TRACE_FLAG_REPORT) != 0;
+  record->codec = (SignedVideoCodec)*data_ptr++;
+  data_ptr++;  // Reserved
+  memcpy(record->header, data_ptr, SV_TRACE_HEADER_SIZE);
+  data_ptr += SV_TRACE_HEADER_SIZE;
+  record->nalu_type = record->codec == SV_CODEC_H264 ? record->header[0] & 0x1f
+                                                     : (record->header[0] & 0x7e) >> 1;
+  data_ptr = read_be(data_ptr, &value, 4);
+  record->nalu_size = (uint32_t)value;
+  data_ptr = read_be(data_ptr, &value, 4);
+  record->return_code = (SignedVideoReturnCode)(int32_t)(uint32_t)value;
+  data_ptr = read_be(data_ptr, &record->timestamp_ns, 8);
+  data_ptr = read_be(data_ptr, &record->duration_ns, 8);
+  read_be(data_ptr, &record->digest, 8);
+
+  return SV_OK;
+}
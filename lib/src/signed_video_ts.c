@@ -0,0 +1,375 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2023 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next paragraph) shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "includes/signed_video_ts.h"
+
+#include <stdbool.h>  // bool
+#include <stdlib.h>  // calloc, free, realloc
+#include <string.h>  // memcmp, memcpy
+
+#include "signed_video_h26x_internal.h"  // get_next_nalu_in_bytestream()
+#include "signed_video_internal.h"  // signed_video_t, get_monotonic_time_ns()
+
+#define TS_PACKET_SIZE 188
+#define TS_SYNC_BYTE 0x47
+#define TS_HEADER_SIZE 4
+#define PAT_PID 0x0000
+#define PAT_TABLE_ID 0x00
+#define PMT_TABLE_ID 0x02
+#define STREAM_TYPE_H264 0x1b
+#define STREAM_TYPE_H265 0x24
+// Bytes of the fixed part of a PES header, up to and including PES_header_data_length.
+#define PES_HEADER_SIZE 9
+#define PES_INITIAL_CAPACITY 65536
+
+struct _sv_ts_reader_t {
+  signed_video_t *sv;
+  sv_ts_report_cb_t report_cb;
+  void *user_data;
+
+  uint8_t packet[TS_PACKET_SIZE];  // A packet split between two chunks of data.
+  size_t packet_size;  // Bytes of |packet| received so far.
+  int pmt_pid;  // Negative until the PAT has been read.
+  int video_pid;  // Negative until the PMT has been read.
+  int continuity_counter;  // Of the latest packet of the video PID. Negative before the first one.
+  uint8_t previous_payload[TS_PACKET_SIZE];  // Of the latest packet of the video PID.
+  size_t previous_payload_size;
+
+  uint8_t *pes;  // The payload of the PES being reassembled.
+  size_t pes_size;
+  size_t pes_capacity;
+  bool has_pes;  // Set if a PES is being reassembled.
+
+  sv_ts_stats_t stats;
+};
+
+/* Returns a pointer to the PSI section in the |payload| of a packet starting a section, or NULL if
+ * the section does not fit in the packet. Sets |section_end| to the end of the section, excluding
+ * the CRC. */
+static const uint8_t *
+get_psi_section(const uint8_t *payload,
+    const uint8_t *payload_end,
+    uint8_t table_id,
+    const uint8_t **section_end)
+{
+  // The section follows the pointer field.
+  const uint8_t *section = payload + 1 + payload[0];
+  if (section + 3 > payload_end || section[0] != table_id) return NULL;
+  const size_t section_length = ((section[1] & 0x0f) << 8) | section[2];
+  // The CRC takes the last 4 bytes of the section.
+  if (section_length < 4 || section + 3 + section_length > payload_end) return NULL;
+  *section_end = section + 3 + section_length - 4;
+
+  return section;
+}
+
+/* Reads the PID of the PMT of the first program from the PAT. */
+static void
+read_pat(sv_ts_reader_t *self, const uint8_t *payload, const uint8_t *payload_end)
+{
+  const uint8_t *section_end = NULL;
+  const uint8_t *section = get_psi_section(payload, payload_end, PAT_TABLE_ID, &section_end);
+  if (!section) return;
+
+  // The programs follow the 8 bytes section header.
+  for (const uint8_t *program = section + 8; program + 4 <= section_end; program += 4) {
+    const int program_number = (program[0] << 8) | program[1];
+    // Program number 0 holds the network PID.
+    if (program_number == 0) continue;
+    self->pmt_pid = ((program[2] & 0x1f) << 8) | program[3];
+    break;
+  }
+}
+
+/* Reads the PID of the first H.264 or H.265 stream from the PMT. */
+static SignedVideoReturnCode
+read_pmt(sv_ts_reader_t *self, const uint8_t *payload, const uint8_t *payload_end)
+{
+  const uint8_t *section_end = NULL;
+  const uint8_t *section = get_psi_section(payload, payload_end, PMT_TABLE_ID, &section_end);
+  if (!section || section + 12 > section_end) return SV_OK;
+
+  // The elementary streams follow the 12 bytes section header and the program info.
+  const size_t program_info_length = ((section[10] & 0x0f) << 8) | section[11];
+  const uint8_t *stream = section + 12 + program_info_length;
+  while (stream + 5 <= section_end) {
+    const uint8_t stream_type = stream[0];
+    const int pid = ((stream[1] & 0x1f) << 8) | stream[2];
+    const size_t es_info_length = ((stream[3] & 0x0f) << 8) | stream[4];
+    if (stream_type == STREAM_TYPE_H264 || stream_type == STREAM_TYPE_H265) {
+      const SignedVideoCodec codec =
+          stream_type == STREAM_TYPE_H264 ? SV_CODEC_H264 : SV_CODEC_H265;
+      if (codec != self->sv->codec) return SV_NOT_SUPPORTED;
+      self->video_pid = pid;
+      break;
+    }
+    stream += 5 + es_info_length;
+  }
+
+  return SV_OK;
+}
+
+/* Appends |data| to the PES being reassembled. */
+static SignedVideoReturnCode
+append_to_pes(sv_ts_reader_t *self, const uint8_t *data, size_t data_size)
+{
+  if (self->pes_size + data_size > self->pes_capacity) {
+    size_t capacity = self->pes_capacity ? self->pes_capacity : PES_INITIAL_CAPACITY;
+    while (capacity < self->pes_size + data_size) capacity *= 2;
+    uint8_t *pes = realloc(self->pes, capacity);
+    if (!pes) return SV_MEMORY;
+    self->pes = pes;
+    self->pes_capacity = capacity;
+  }
+  memcpy(self->pes + self->pes_size, data, data_size);
+  self->pes_size += data_size;
+
+  return SV_OK;
+}
+
+/* Adds the NALUs of the reassembled PES for validation, in place. A PES not starting with a NALU is
+ * malformed and dropped. If the validation of a NALU fails, the remaining NALUs are still added and
+ * the first error is returned. */
+static SignedVideoReturnCode
+add_pes(sv_ts_reader_t *self)
+{
+  self->has_pes = false;
+  SignedVideoReturnCode rc = SV_OK;
+  size_t offset = 0;
+  while (offset < self->pes_size) {
+    const uint8_t *nalu_data = self->pes + offset;
+    const size_t nalu_data_size = get_next_nalu_in_bytestream(self->pes, self->pes_size, &offset);
+    if (nalu_data_size == 0) {
+      self->stats.num_dropped_pes++;
+      break;
+    }
+
+    signed_video_authenticity_t *report = NULL;
+    SignedVideoReturnCode nalu_rc = signed_video_add_nalu_and_authenticate(
+        self->sv, nalu_data, nalu_data_size, self->report_cb ? &report : NULL);
+    if (nalu_rc != SV_OK) {
+      if (rc == SV_OK) rc = nalu_rc;
+      continue;
+    }
+    self->stats.num_nalus++;
+    if (report) self->report_cb(report, self->user_data);
+  }
+
+  return rc;
+}
+
+/* Reads a packet of the video PID. */
+static SignedVideoReturnCode
+read_video_packet(sv_ts_reader_t *self,
+    const uint8_t *packet,
+    const uint8_t *payload,
+    const uint8_t *payload_end)
+{
+  const int continuity_counter = packet[3] & 0x0f;
+  const bool is_unit_start = (packet[1] & 0x40) != 0;
+  const size_t payload_size = payload_end - payload;
+  // The continuity counter may jump at a packet with the discontinuity_indicator set in its
+  // adaptation field.
+  const bool has_adaptation_field = (packet[3] & 0x20) != 0;
+  const bool is_discontinuity = has_adaptation_field && packet[4] > 0 && (packet[5] & 0x80);
+  // A duplicate packet repeats the previous one and is ignored. With a different payload, the
+  // continuity counter has instead wrapped around after 15 lost packets.
+  if (!is_discontinuity && continuity_counter == self->continuity_counter &&
+      payload_size == self->previous_payload_size &&
+      memcmp(payload, self->previous_payload, payload_size) == 0) {
+    return SV_OK;
+  }
+  const bool is_lost_packet = !is_discontinuity && self->continuity_counter >= 0 &&
+      continuity_counter != ((self->continuity_counter + 1) & 0x0f);
+  self->continuity_counter = continuity_counter;
+  memcpy(self->previous_payload, payload, payload_size);
+  self->previous_payload_size = payload_size;
+  if (is_lost_packet && self->has_pes) {
+    // The PES is incomplete. Drop it and let the validation report the missing NALUs.
+    self->has_pes = false;
+    self->stats.num_dropped_pes++;
+  }
+
+  SignedVideoReturnCode rc = SV_OK;
+  if (is_unit_start) {
+    // An error from validating the previous PES is returned, but the new PES is still read.
+    if (self->has_pes) rc = add_pes(self);
+    const bool is_pes = payload + PES_HEADER_SIZE <= payload_end && payload[0] == 0x00 &&
+        payload[1] == 0x00 && payload[2] == 0x01 &&
+        payload + PES_HEADER_SIZE + payload[PES_HEADER_SIZE - 1] <= payload_end;
+    if (!is_pes) {
+      // A malformed PES header. Drop the PES and let the validation report the missing NALUs.
+      self->stats.num_dropped_pes++;
+      return rc;
+    }
+    payload += PES_HEADER_SIZE + payload[PES_HEADER_SIZE - 1];
+    self->has_pes = true;
+    self->pes_size = 0;
+  }
+  if (!self->has_pes) return rc;
+
+  SignedVideoReturnCode append_rc = append_to_pes(self, payload, payload_end - payload);
+
+  return rc != SV_OK ? rc : append_rc;
+}
+
+/* Returns the offset of the first sync byte in |data| from |offset|, or |data_size| if there is
+ * none. A sync byte is only taken as the start of a packet if the byte a packet later, when
+ * present, is also a sync byte. */
+static size_t
+find_sync_byte(const uint8_t *data, size_t data_size, size_t offset)
+{
+  for (; offset < data_size; offset++) {
+    if (data[offset] != TS_SYNC_BYTE) continue;
+    if (data_size - offset <= TS_PACKET_SIZE || data[offset + TS_PACKET_SIZE] == TS_SYNC_BYTE) {
+      break;
+    }
+  }
+
+  return offset;
+}
+
+/* Reads a complete packet. */
+static SignedVideoReturnCode
+read_packet(sv_ts_reader_t *self, const uint8_t *packet)
+{
+  if (packet[0] != TS_SYNC_BYTE) return SV_INVALID_PARAMETER;
+  self->stats.num_packets++;
+
+  const int pid = ((packet[1] & 0x1f) << 8) | packet[2];
+  const bool is_unit_start = (packet[1] & 0x40) != 0;
+  const int adaptation_field_control = (packet[3] >> 4) & 0x03;
+  const uint8_t *payload = packet + TS_HEADER_SIZE;
+  const uint8_t *payload_end = packet + TS_PACKET_SIZE;
+  // Skip the adaptation field, if any.
+  if (adaptation_field_control & 0x02) payload += 1 + payload[0];
+  // Packets without payload carry nothing of interest.
+  if (!(adaptation_field_control & 0x01) || payload >= payload_end) return SV_OK;
+
+  if (pid == self->video_pid) return read_video_packet(self, packet, payload, payload_end);
+  if (pid == PAT_PID && is_unit_start) read_pat(self, payload, payload_end);
+  if (pid == self->pmt_pid && is_unit_start && self->video_pid < 0) {
+    return read_pmt(self, payload, payload_end);
+  }
+
+  return SV_OK;
+}
+
+/**
+ * @brief Public signed_video_ts.h APIs
+ */
+
+sv_ts_reader_t *
+signed_video_ts_reader_create(signed_video_t *sv, sv_ts_report_cb_t report_cb, void *user_data)
+{
+  if (!sv) return NULL;
+
+  sv_ts_reader_t *self = calloc(1, sizeof(sv_ts_reader_t));
+  if (!self) return NULL;
+  self->sv = sv;
+  self->report_cb = report_cb;
+  self->user_data = user_data;
+  self->pmt_pid = -1;
+  self->video_pid = -1;
+  self->continuity_counter = -1;
+
+  return self;
+}
+
+void
+signed_video_ts_reader_free(sv_ts_reader_t *reader)
+{
+  if (!reader) return;
+
+  free(reader->pes);
+  free(reader);
+}
+
+SignedVideoReturnCode
+signed_video_ts_reader_add_data(sv_ts_reader_t *reader, const uint8_t *data, size_t data_size)
+{
+  if (!reader || !data || data_size == 0) return SV_INVALID_PARAMETER;
+
+  const uint64_t start_ns = get_monotonic_time_ns();
+  // The first error is returned, but all data is read to not lose the packet alignment.
+  SignedVideoReturnCode rc = SV_OK;
+  size_t offset = 0;
+  // Complete a packet split between chunks.
+  if (reader->packet_size > 0) {
+    size_t num_bytes = TS_PACKET_SIZE - reader->packet_size;
+    if (num_bytes > data_size) num_bytes = data_size;
+    memcpy(reader->packet + reader->packet_size, data, num_bytes);
+    reader->packet_size += num_bytes;
+    offset = num_bytes;
+    if (reader->packet_size == TS_PACKET_SIZE) {
+      reader->packet_size = 0;
+      rc = read_packet(reader, reader->packet);
+    }
+  }
+  while (offset < data_size) {
+    if (data[offset] != TS_SYNC_BYTE) {
+      // The packet alignment is lost, e.g., due to corrupt data. Skip to the next sync byte.
+      offset = find_sync_byte(data, data_size, offset);
+      reader->stats.num_resyncs++;
+      if (rc == SV_OK) rc = SV_INVALID_PARAMETER;
+      continue;
+    }
+    // Keep the remaining bytes until the next chunk.
+    if (data_size - offset < TS_PACKET_SIZE) {
+      reader->packet_size = data_size - offset;
+      memcpy(reader->packet, data + offset, reader->packet_size);
+      break;
+    }
+    // Read the complete packets in place.
+    SignedVideoReturnCode packet_rc = read_packet(reader, data + offset);
+    if (rc == SV_OK) rc = packet_rc;
+    offset += TS_PACKET_SIZE;
+  }
+  reader->stats.num_bytes += data_size;
+  reader->stats.processing_time_us += (get_monotonic_time_ns() - start_ns) / 1000;
+
+  return rc;
+}
+
+SignedVideoReturnCode
+signed_video_ts_reader_flush(sv_ts_reader_t *reader)
+{
+  if (!reader) return SV_INVALID_PARAMETER;
+
+  const uint64_t start_ns = get_monotonic_time_ns();
+  SignedVideoReturnCode rc = reader->has_pes ? add_pes(reader) : SV_OK;
+  reader->stats.processing_time_us += (get_monotonic_time_ns() - start_ns) / 1000;
+
+  return rc;
+}
+
+SignedVideoReturnCode
+signed_video_ts_reader_get_stats(const sv_ts_reader_t *reader, sv_ts_stats_t *stats)
+{
+  if (!reader || !stats) return SV_INVALID_PARAMETER;
+
+  *stats = reader->stats;
+  // Bytes per microsecond equals megabytes per second.
+  stats->megabytes_per_second = stats->processing_time_us > 0
+      ? (double)stats->num_bytes / (double)stats->processing_time_us
+      : 0.0;
+
+  return SV_OK;
+}
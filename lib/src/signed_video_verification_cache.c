@@ -0,0 +1,127 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2023 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next paragraph) shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "signed_video_verification_cache.h"
+
+#include <stdint.h>  // uint64_t
+#include <stdlib.h>  // calloc, free
+
+#include "includes/signed_video_openssl.h"  // openssl_hash_data()
+#include "signed_video_internal.h"  // sv_rc_to_svi_rc()
+
+typedef struct {
+  verification_cache_key_t key;
+  int verified_result;
+  uint64_t last_used;  // The |tick| when last used. Zero if the entry is empty.
+} verification_cache_entry_t;
+
+/* The entries are few and searched linearly, which is negligible compared to a signature
+ * verification. */
+struct _verification_cache_t {
+  verification_cache_entry_t *entries;
+  size_t num_entries;
+  uint64_t tick;  // Increased upon every use of an entry.
+};
+
+verification_cache_t *
+verification_cache_create(size_t num_entries)
+{
+  if (num_entries == 0) return NULL;
+
+  verification_cache_t *self = calloc(1, sizeof(verification_cache_t));
+  if (!self) return NULL;
+
+  self->entries = calloc(num_entries, sizeof(verification_cache_entry_t));
+  if (!self->entries) {
+    free(self);
+    return NULL;
+  }
+  self->num_entries = num_entries;
+
+  return self;
+}
+
+void
+verification_cache_free(verification_cache_t *self)
+{
+  if (!self) return;
+
+  free(self->entries);
+  free(self);
+}
+
+void
+verification_cache_clear(verification_cache_t *self)
+{
+  if (!self) return;
+
+  memset(self->entries, 0, self->num_entries * sizeof(verification_cache_entry_t));
+  self->tick = 0;
+}
+
+svi_rc
+verification_cache_key_init(verification_cache_key_t *key, const signature_info_t *signature_info)
+{
+  if (!key || !signature_info || !signature_info->hash || !signature_info->signature) {
+    return SVI_INVALID_PARAMETER;
+  }
+  if (signature_info->hash_size != VERIFICATION_CACHE_DIGEST_SIZE) return SVI_NOT_SUPPORTED;
+
+  memcpy(key->hash, signature_info->hash, VERIFICATION_CACHE_DIGEST_SIZE);
+  return sv_rc_to_svi_rc(openssl_hash_data(
+      signature_info->signature, signature_info->signature_size, key->signature_digest));
+}
+
+bool
+verification_cache_lookup(verification_cache_t *self,
+    const verification_cache_key_t *key,
+    int *verified_result)
+{
+  if (!self || !key || !verified_result) return false;
+
+  for (size_t i = 0; i < self->num_entries; i++) {
+    verification_cache_entry_t *entry = &self->entries[i];
+    if (entry->last_used && !memcmp(&entry->key, key, sizeof(verification_cache_key_t))) {
+      entry->last_used = ++self->tick;
+      *verified_result = entry->verified_result;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void
+verification_cache_store(verification_cache_t *self,
+    const verification_cache_key_t *key,
+    int verified_result)
+{
+  if (!self || !key) return;
+  if (verified_result != 0 && verified_result != 1) return;
+
+  // Replace the least recently used entry. Empty entries have never been used.
+  verification_cache_entry_t *lru_entry = &self->entries[0];
+  for (size_t i = 1; i < self->num_entries; i++) {
+    if (self->entries[i].last_used < lru_entry->last_used) lru_entry = &self->entries[i];
+  }
+  lru_entry->key = *key;
+  lru_entry->verified_result = verified_result;
+  lru_entry->last_used = ++self->tick;
+}
@@ -0,0 +1,117 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2023 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next paragraph) shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef __SIGNED_VIDEO_VERIFICATION_CACHE_H__
+#define __SIGNED_VIDEO_VERIFICATION_CACHE_H__
+
+#include <stdbool.h>  // bool
+#include <stdint.h>  // uint8_t
+#include <string.h>  // size_t
+
+#include "includes/signed_video_interfaces.h"  // signature_info_t
+#include "signed_video_defines.h"  // svi_rc
+
+/* The default number of verification outcomes kept by a session. */
+#define VERIFICATION_CACHE_DEFAULT_SIZE 64
+/* The size of the digests in a key, SHA-256 as HASH_DIGEST_SIZE. */
+#define VERIFICATION_CACHE_DIGEST_SIZE (256 / 8)
+
+typedef struct _verification_cache_t verification_cache_t;
+
+/* The key of a verification outcome, that is, the verified hash and a digest of the signature. */
+typedef struct {
+  uint8_t hash[VERIFICATION_CACHE_DIGEST_SIZE];
+  uint8_t signature_digest[VERIFICATION_CACHE_DIGEST_SIZE];
+} verification_cache_key_t;
+
+/**
+ * @brief Creates a verification cache
+ *
+ * A verification cache keeps the outcomes of the latest signature verifications. When the same
+ * content is validated again, for example, when scrubbing back and forth in a recording, the
+ * outcome is looked up instead of verifying the signature once more. The least recently used
+ * outcome is replaced when the cache is full.
+ *
+ * The outcomes are only valid with the public key used when verifying, hence the cache has to be
+ * cleared if the public key changes. The cache is not thread safe.
+ *
+ * @param num_entries The number of outcomes to keep. Must be larger than 0.
+ *
+ * @returns A pointer to the cache, or NULL upon failure.
+ */
+verification_cache_t *
+verification_cache_create(size_t num_entries);
+
+/**
+ * @brief Frees a verification cache
+ *
+ * @param self Pointer to the cache.
+ */
+void
+verification_cache_free(verification_cache_t *self);
+
+/**
+ * @brief Removes all outcomes from a verification cache
+ *
+ * @param self Pointer to the cache.
+ */
+void
+verification_cache_clear(verification_cache_t *self);
+
+/**
+ * @brief Computes the key of a signature verification
+ *
+ * @param key Pointer to the key to fill in.
+ * @param signature_info Pointer to the hash and signature to verify.
+ *
+ * @returns SVI_OK upon success, otherwise an error code.
+ */
+svi_rc
+verification_cache_key_init(verification_cache_key_t *key, const signature_info_t *signature_info);
+
+/**
+ * @brief Looks up a verification outcome
+ *
+ * @param self Pointer to the cache. NULL is treated as an empty cache.
+ * @param key Pointer to the key of the verification.
+ * @param verified_result Pointer to where the outcome is written, as by openssl_verify_hash(...).
+ *
+ * @returns true if the outcome was found, otherwise false.
+ */
+bool
+verification_cache_lookup(verification_cache_t *self,
+    const verification_cache_key_t *key,
+    int *verified_result);
+
+/**
+ * @brief Stores a verification outcome
+ *
+ * Only definitive outcomes, that is, 1 (verified) and 0 (not verified) are stored.
+ *
+ * @param self Pointer to the cache. Nothing is stored if NULL.
+ * @param key Pointer to the key of the verification.
+ * @param verified_result The outcome as by openssl_verify_hash(...).
+ */
+void
+verification_cache_store(verification_cache_t *self,
+    const verification_cache_key_t *key,
+    int verified_result);
+
+#endif  // __SIGNED_VIDEO_VERIFICATION_CACHE_H__
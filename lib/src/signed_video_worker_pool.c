@@ -0,0 +1,131 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2023 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next paragraph) shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "signed_video_worker_pool.h"
+
+#include <stdint.h>  // uint8_t
+
+// There are no worker threads on Windows. The jobs are then processed on the calling thread.
+#if defined(_WIN32) || defined(_WIN64)
+svi_rc
+worker_pool_run(worker_pool_job_fn job_fn, void *jobs, size_t job_size, size_t num_jobs)
+{
+  if (!job_fn || !jobs || job_size == 0) return SVI_INVALID_PARAMETER;
+
+  for (size_t i = 0; i < num_jobs; i++) {
+    job_fn((uint8_t *)jobs + i * job_size);
+  }
+
+  return SVI_OK;
+}
+#else
+#include <pthread.h>  // pthread_create, pthread_join, pthread_mutex_t
+#include <unistd.h>  // sysconf
+
+/* The state shared by all threads in the pool. Jobs are handed out in order through |next_job|. */
+typedef struct {
+  worker_pool_job_fn job_fn;
+  uint8_t *jobs;
+  size_t job_size;
+  size_t num_jobs;
+  size_t next_job;  // Index of the next job to process. Protected by |lock|.
+  pthread_mutex_t lock;
+} worker_pool_t;
+
+/* Picks the next unprocessed job, or returns NULL if all jobs have been handed out. */
+static void *
+get_next_job(worker_pool_t *pool)
+{
+  void *job = NULL;
+
+  pthread_mutex_lock(&pool->lock);
+  if (pool->next_job < pool->num_jobs) {
+    job = pool->jobs + pool->next_job * pool->job_size;
+    pool->next_job++;
+  }
+  pthread_mutex_unlock(&pool->lock);
+
+  return job;
+}
+
+/* The worker loop. Processes jobs until there are no more left. */
+static void *
+worker_thread(void *user_data)
+{
+  worker_pool_t *pool = (worker_pool_t *)user_data;
+
+  void *job = get_next_job(pool);
+  while (job) {
+    pool->job_fn(job);
+    job = get_next_job(pool);
+  }
+
+  return NULL;
+}
+
+/* Returns the number of threads, including the calling thread, to use for |num_jobs| jobs. */
+static size_t
+get_num_threads(size_t num_jobs)
+{
+  long num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  size_t num_threads = num_cpus > 0 ? (size_t)num_cpus : 1;
+
+  if (num_threads > MAX_WORKER_POOL_THREADS) num_threads = MAX_WORKER_POOL_THREADS;
+  if (num_threads > num_jobs) num_threads = num_jobs;
+
+  return num_threads;
+}
+
+svi_rc
+worker_pool_run(worker_pool_job_fn job_fn, void *jobs, size_t job_size, size_t num_jobs)
+{
+  if (!job_fn || !jobs || job_size == 0) return SVI_INVALID_PARAMETER;
+  if (num_jobs == 0) return SVI_OK;
+
+  worker_pool_t pool = {
+      .job_fn = job_fn,
+      .jobs = (uint8_t *)jobs,
+      .job_size = job_size,
+      .num_jobs = num_jobs,
+      .next_job = 0,
+  };
+  if (pthread_mutex_init(&pool.lock, NULL) != 0) return SVI_UNKNOWN;
+
+  // The calling thread is one of the workers, hence one thread less to create.
+  pthread_t threads[MAX_WORKER_POOL_THREADS - 1];
+  size_t num_created_threads = 0;
+  const size_t num_threads = get_num_threads(num_jobs);
+  for (size_t i = 0; i < num_threads - 1; i++) {
+    // Failing to create a thread is not critical. The remaining jobs are processed by the threads
+    // that do exist, at worst only the calling thread.
+    if (pthread_create(&threads[num_created_threads], NULL, worker_thread, &pool) != 0) break;
+    num_created_threads++;
+  }
+
+  worker_thread(&pool);
+
+  for (size_t i = 0; i < num_created_threads; i++) {
+    pthread_join(threads[i], NULL);
+  }
+  pthread_mutex_destroy(&pool.lock);
+
+  return SVI_OK;
+}
+#endif
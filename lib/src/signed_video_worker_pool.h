@@ -0,0 +1,61 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2023 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next paragraph) shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef __SIGNED_VIDEO_WORKER_POOL_H__
+#define __SIGNED_VIDEO_WORKER_POOL_H__
+
+#include <string.h>  // size_t
+
+#include "signed_video_defines.h"  // svi_rc
+
+/* The maximum number of threads, including the calling thread, used to process jobs. */
+#define MAX_WORKER_POOL_THREADS 8
+
+/**
+ * Function processing one job. The |job| points to the element in the array of jobs passed to
+ * worker_pool_run(...). Each job is processed exactly once and jobs may run concurrently, hence
+ * they should not touch memory shared with other jobs unless it is read-only.
+ */
+typedef void (*worker_pool_job_fn)(void *job);
+
+/**
+ * @brief Processes an array of jobs in parallel
+ *
+ * Spawns a pool of worker threads which, together with the calling thread, picks jobs from |jobs|
+ * until all have been processed. The number of threads used is limited by |num_jobs|, the number
+ * of online CPUs and MAX_WORKER_POOL_THREADS. The function blocks until all jobs are done.
+ *
+ * If no worker threads can be created, all jobs are processed on the calling thread. Hence, the
+ * jobs are always processed when the function returns SVI_OK. On Windows there are no worker
+ * threads, and the jobs are processed on the calling thread one by one.
+ *
+ * @param job_fn The function to apply on each job.
+ * @param jobs Pointer to the first element of the array of jobs.
+ * @param job_size The size of one job, that is, the size of one element in |jobs|.
+ * @param num_jobs The number of jobs in |jobs|.
+ *
+ * @returns SVI_OK if all jobs were processed,
+ *          SVI_INVALID_PARAMETER if |job_fn| or |jobs| is a NULL pointer, or |job_size| is zero,
+ *          SVI_UNKNOWN if the pool could not be initialized. No jobs have then been processed.
+ */
+svi_rc
+worker_pool_run(worker_pool_job_fn job_fn, void *jobs, size_t job_size, size_t num_jobs);
+
+#endif  // __SIGNED_VIDEO_WORKER_POOL_H__
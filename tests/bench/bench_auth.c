@@ -0,0 +1,367 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2023 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next paragraph) shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <getopt.h>  // getopt_long
+#include <stdio.h>  // printf, fprintf
+#include <stdlib.h>  // calloc, free, strtod, strtoul
+
+#include "bench_helpers.h"  // generate_stream(), sign_stream()
+#include "lib/src/includes/signed_video_auth.h"  // signed_video_add_nalu_and_authenticate()
+#include "lib/src/includes/signed_video_counters.h"  // signed_video_get_counters()
+
+/* A benchmark of the validation side. A synthetic stream is generated and signed once. Then the
+ * signed stream, altered by a loss scenario, is added through
+ * signed_video_add_nalu_and_authenticate(), where each call, including generating the authenticity
+ * report, is timed. The cost of the reports is told apart through the session counters. The result
+ * is printed as JSON to stdout, to be compared across commits.
+ *
+ * The scenarios are
+ *   lossless         The stream as signed.
+ *   nalu-loss        NALUs, other than SEIs, are lost at random with --loss-rate.
+ *   sei-loss         Every second SEI is lost.
+ *   sei-delay        Each SEI is moved --sei-delay NALUs later in the stream.
+ *   late-public-key  The validation starts at the second SEI, hence the public key is first
+ *                    received with its next recurrence. The stream is signed separately with a
+ *                    recurrence of at least three GOPs, so that the second SEI lacks the key.
+ * GOP level versus frame level signing, and long GOPs, are benchmarked through --level and --gop.
+ *
+ * With glibc, allocations are counted by interposing malloc(), calloc() and realloc(). */
+
+typedef enum {
+  SCENARIO_LOSSLESS = 0,
+  SCENARIO_NALU_LOSS,
+  SCENARIO_SEI_LOSS,
+  SCENARIO_SEI_DELAY,
+  SCENARIO_LATE_PUBLIC_KEY,
+  SCENARIO_NUM
+} bench_scenario_t;
+
+static const char *scenario_names[SCENARIO_NUM] = {
+    "lossless", "nalu-loss", "sei-loss", "sei-delay", "late-public-key"};
+
+typedef struct {
+  int scenario;  // A bench_scenario_t, or SCENARIO_NUM for all of them.
+  double loss_rate;
+  unsigned sei_delay;
+} bench_auth_config_t;
+
+#ifdef __GLIBC__
+extern void *
+__libc_malloc(size_t size);
+extern void *
+__libc_calloc(size_t num, size_t size);
+extern void *
+__libc_realloc(void *ptr, size_t size);
+
+static uint64_t num_allocations = 0;
+
+void *
+malloc(size_t size)
+{
+  __atomic_add_fetch(&num_allocations, 1, __ATOMIC_RELAXED);
+  return __libc_malloc(size);
+}
+
+void *
+calloc(size_t num, size_t size)
+{
+  __atomic_add_fetch(&num_allocations, 1, __ATOMIC_RELAXED);
+  return __libc_calloc(num, size);
+}
+
+void *
+realloc(void *ptr, size_t size)
+{
+  __atomic_add_fetch(&num_allocations, 1, __ATOMIC_RELAXED);
+  return __libc_realloc(ptr, size);
+}
+
+static uint64_t
+get_num_allocations(void)
+{
+  return __atomic_load_n(&num_allocations, __ATOMIC_RELAXED);
+}
+#else
+static uint64_t
+get_num_allocations(void)
+{
+  return 0;
+}
+#endif
+
+/* Puts the order in which the |signed_nalus| are added for the |scenario| in |order|. Returns the
+ * number of NALUs to add, or 0 upon failure. */
+static size_t
+create_scenario(const bench_auth_config_t *auth_config,
+    bench_scenario_t scenario,
+    const bench_nalu_t *signed_nalus,
+    size_t num_signed_nalus,
+    size_t *order)
+{
+  uint32_t seed = 0x9e3779b9;
+  size_t num_nalus = 0;
+  size_t num_seis = 0;
+  size_t num_delayed = 0;
+  // The SEIs waiting to be added, and after which number of added NALUs.
+  size_t *delayed = calloc(num_signed_nalus, sizeof(size_t));
+  size_t *delayed_until = calloc(num_signed_nalus, sizeof(size_t));
+  if (!delayed || !delayed_until) {
+    free(delayed);
+    free(delayed_until);
+    return 0;
+  }
+  bool has_started = scenario != SCENARIO_LATE_PUBLIC_KEY;
+  for (size_t i = 0; i < num_signed_nalus; i++) {
+    const bool is_sei = signed_nalus[i].is_sei;
+    if (is_sei) num_seis++;
+    switch (scenario) {
+      case SCENARIO_NALU_LOSS:
+        // A linear congruential generator in [0, 1).
+        seed = seed * 1664525 + 1013904223;
+        if (!is_sei && (seed >> 8) / (double)(1 << 24) < auth_config->loss_rate) continue;
+        break;
+      case SCENARIO_SEI_LOSS:
+        if (is_sei && num_seis % 2 == 0) continue;
+        break;
+      case SCENARIO_SEI_DELAY:
+        if (is_sei) {
+          delayed[num_delayed] = i;
+          delayed_until[num_delayed++] = num_nalus + auth_config->sei_delay;
+          continue;
+        }
+        break;
+      case SCENARIO_LATE_PUBLIC_KEY:
+        // Start at the SEI ending the second GOP.
+        has_started |= is_sei && num_seis == 2;
+        if (!has_started) continue;
+        break;
+      default:
+        break;
+    }
+    order[num_nalus++] = i;
+    // Add the delayed SEIs that are due.
+    size_t num_remaining = 0;
+    for (size_t j = 0; j < num_delayed; j++) {
+      if (delayed_until[j] < num_nalus) {
+        order[num_nalus++] = delayed[j];
+      } else {
+        delayed[num_remaining] = delayed[j];
+        delayed_until[num_remaining++] = delayed_until[j];
+      }
+    }
+    num_delayed = num_remaining;
+  }
+  // Add the SEIs delayed beyond the end of the stream.
+  for (size_t j = 0; j < num_delayed; j++) {
+    order[num_nalus++] = delayed[j];
+  }
+  free(delayed);
+  free(delayed_until);
+
+  return num_nalus;
+}
+
+/* Validates the NALUs of a scenario and prints the result as a JSON object. */
+static SignedVideoReturnCode
+run_scenario(const bench_config_t *config,
+    bench_scenario_t scenario,
+    const bench_nalu_t *signed_nalus,
+    const size_t *order,
+    size_t num_nalus,
+    uint64_t *latencies)
+{
+  signed_video_t *sv = signed_video_create(config->codec);
+  if (!sv) return SV_MEMORY;
+
+  SignedVideoReturnCode rc = SV_OK;
+  uint64_t num_bytes = 0;
+  size_t num_results[SV_AUTH_RESULT_OK + 1] = {0};
+  size_t num_reports = 0;
+  const uint64_t start_allocations = get_num_allocations();
+  const uint64_t start_ns = get_time_ns();
+  for (size_t i = 0; i < num_nalus && rc == SV_OK; i++) {
+    const bench_nalu_t *nalu = &signed_nalus[order[i]];
+    signed_video_authenticity_t *report = NULL;
+    const uint64_t call_start_ns = get_time_ns();
+    rc = signed_video_add_nalu_and_authenticate(sv, nalu->data, nalu->data_size, &report);
+    latencies[i] = get_time_ns() - call_start_ns;
+    num_bytes += nalu->data_size;
+    if (!report) continue;
+    const SignedVideoAuthenticityResult authenticity = report->latest_validation.authenticity;
+    if (authenticity <= SV_AUTH_RESULT_OK) num_results[authenticity]++;
+    num_reports++;
+    signed_video_authenticity_report_free(report);
+  }
+  const uint64_t elapsed_ns = get_time_ns() - start_ns;
+  const uint64_t num_allocations = get_num_allocations() - start_allocations;
+  sv_counters_t counters = {0};
+  signed_video_get_counters(sv, &counters, false);
+  const uint64_t report_ns = counters.stage_time_ns[SV_STAGE_REPORT];
+  signed_video_free(sv);
+  if (rc != SV_OK) fprintf(stderr, "Validation failed (%d)\n", rc);
+
+  const double elapsed_s = elapsed_ns / 1e9;
+  printf("    {\n");
+  printf("      \"scenario\": \"%s\",\n", scenario_names[scenario]);
+  printf("      \"status\": %d,\n", rc);
+  printf("      \"num_nalus\": %zu,\n", num_nalus);
+  printf("      \"num_reports\": %zu,\n", num_reports);
+  printf("      \"results\": {\"not_signed\": %zu, \"signature_present\": %zu, \"not_ok\": %zu, "
+         "\"ok_with_missing_info\": %zu, \"ok\": %zu},\n",
+      num_results[SV_AUTH_RESULT_NOT_SIGNED], num_results[SV_AUTH_RESULT_SIGNATURE_PRESENT],
+      num_results[SV_AUTH_RESULT_NOT_OK], num_results[SV_AUTH_RESULT_OK_WITH_MISSING_INFO],
+      num_results[SV_AUTH_RESULT_OK]);
+  printf("      \"elapsed_s\": %.6f,\n", elapsed_s);
+  printf("      \"nalus_per_second\": %.1f,\n", elapsed_s > 0 ? num_nalus / elapsed_s : 0.0);
+  printf("      \"megabytes_per_second\": %.3f,\n",
+      elapsed_s > 0 ? num_bytes / 1e6 / elapsed_s : 0.0);
+  printf("      \"time_per_validated_gop_us\": %.3f,\n",
+      num_reports > 0 ? elapsed_ns / 1e3 / num_reports : 0.0);
+  printf("      \"report_cost_us\": %.3f,\n",
+      num_reports > 0 ? report_ns / 1e3 / num_reports : 0.0);
+  printf("      \"peak_list_length\": %llu,\n", (unsigned long long)counters.max_nalu_list_length);
+#ifdef __GLIBC__
+  printf("      \"allocations_per_nalu\": %.3f,\n",
+      num_nalus > 0 ? (double)num_allocations / num_nalus : 0.0);
+#else
+  printf("      \"allocations_per_nalu\": null,\n");
+#endif
+  printf("    ");
+  print_latencies("add_latency_us", latencies, num_nalus);
+  printf("\n    }");
+
+  return rc;
+}
+
+static void
+print_usage(const char *name)
+{
+  fprintf(stderr,
+      "Usage: %s [options]\n" BENCH_COMMON_USAGE
+      "  --scenario NAME       lossless, nalu-loss, sei-loss, sei-delay, late-public-key or all\n"
+      "                        (default all)\n"
+      "  --loss-rate R         Probability of losing a NALU in nalu-loss (default 0.01)\n"
+      "  --sei-delay N         NALUs to delay each SEI in sei-delay (default 2)\n",
+      name);
+}
+
+static bool
+parse_options(int argc, char **argv, bench_config_t *config, bench_auth_config_t *auth_config)
+{
+  const struct option options[] = {BENCH_COMMON_OPTIONS,
+      {"scenario", required_argument, NULL, 'S'}, {"loss-rate", required_argument, NULL, 'L'},
+      {"sei-delay", required_argument, NULL, 'D'}, {NULL, 0, NULL, 0}};
+
+  int opt = 0;
+  while ((opt = getopt_long(argc, argv, "", options, NULL)) != -1) {
+    switch (opt) {
+      case 'S':
+        auth_config->scenario = -1;
+        for (int i = 0; i < SCENARIO_NUM; i++) {
+          if (strcmp(optarg, scenario_names[i]) == 0) auth_config->scenario = i;
+        }
+        if (strcmp(optarg, "all") == 0) auth_config->scenario = SCENARIO_NUM;
+        if (auth_config->scenario < 0) return false;
+        break;
+      case 'L':
+        auth_config->loss_rate = strtod(optarg, NULL);
+        break;
+      case 'D':
+        auth_config->sei_delay = (unsigned)strtoul(optarg, NULL, 10);
+        break;
+      default:
+        if (!set_common_option(opt, optarg, config)) return false;
+        break;
+    }
+  }
+
+  return optind == argc && is_valid_config(config);
+}
+
+int
+main(int argc, char **argv)
+{
+  bench_config_t config = BENCH_DEFAULT_CONFIG;
+  bench_auth_config_t auth_config = {SCENARIO_NUM, 0.01, 2};
+  if (!parse_options(argc, argv, &config, &auth_config)) {
+    print_usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  bench_nalu_t *nalus = NULL;
+  bench_nalu_t *signed_nalus = NULL;
+  const size_t num_nalus = generate_stream(&config, &nalus);
+  const size_t num_signed_nalus =
+      num_nalus > 0 ? sign_stream(&config, nalus, num_nalus, &signed_nalus) : 0;
+  // For late-public-key the second SEI has to lack the public key. A recurrence of at least three
+  // GOPs guarantees that; See create_scenario().
+  const bool has_late_key = auth_config.scenario == SCENARIO_NUM ||
+      auth_config.scenario == SCENARIO_LATE_PUBLIC_KEY;
+  bench_config_t late_key_config = config;
+  if (late_key_config.recurrence < 3 * config.gop_length) {
+    late_key_config.recurrence = 3 * config.gop_length;
+  }
+  bench_nalu_t *late_key_nalus = NULL;
+  const size_t num_late_key_nalus = has_late_key && num_nalus > 0
+      ? sign_stream(&late_key_config, nalus, num_nalus, &late_key_nalus)
+      : 0;
+  free_stream(nalus, num_nalus);
+  const size_t max_num_nalus =
+      num_late_key_nalus > num_signed_nalus ? num_late_key_nalus : num_signed_nalus;
+  size_t *order = calloc(max_num_nalus + 1, sizeof(size_t));
+  uint64_t *latencies = calloc(max_num_nalus + 1, sizeof(uint64_t));
+  if (num_signed_nalus == 0 || (has_late_key && num_late_key_nalus == 0) || !order ||
+      !latencies) {
+    fprintf(stderr, "Failed setting up the benchmark\n");
+    return EXIT_FAILURE;
+  }
+
+  printf("{\n");
+  printf("  \"benchmark\": \"auth\",\n");
+  print_config(&config);
+  printf("  \"loss_rate\": %.4f,\n  \"sei_delay\": %u,\n", auth_config.loss_rate,
+      auth_config.sei_delay);
+  printf("  \"late_public_key_recurrence\": %u,\n", late_key_config.recurrence);
+  printf("  \"scenarios\": [\n");
+  SignedVideoReturnCode rc = SV_OK;
+  bool is_first = true;
+  for (int scenario = 0; scenario < SCENARIO_NUM && rc == SV_OK; scenario++) {
+    if (auth_config.scenario != SCENARIO_NUM && auth_config.scenario != scenario) continue;
+    const bool is_late_key = scenario == SCENARIO_LATE_PUBLIC_KEY;
+    const bench_nalu_t *scenario_nalus = is_late_key ? late_key_nalus : signed_nalus;
+    const size_t num_scenario_nalus = create_scenario(&auth_config, scenario, scenario_nalus,
+        is_late_key ? num_late_key_nalus : num_signed_nalus, order);
+    if (num_scenario_nalus == 0) {
+      rc = SV_MEMORY;
+      break;
+    }
+    if (!is_first) printf(",\n");
+    is_first = false;
+    rc = run_scenario(&config, scenario, scenario_nalus, order, num_scenario_nalus, latencies);
+  }
+  printf("\n  ]\n}\n");
+
+  free_stream(signed_nalus, num_signed_nalus);
+  free_stream(late_key_nalus, num_late_key_nalus);
+  free(order);
+  free(latencies);
+
+  return rc == SV_OK ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,279 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2023 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next paragraph) shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "bench_helpers.h"
+
+#include <stdio.h>  // printf, fprintf
+#include <stdlib.h>  // calloc, free, qsort, realloc, strtoul
+#include <time.h>  // clock_gettime
+
+#include "lib/src/includes/signed_video_openssl.h"  // signed_video_generate_private_key()
+#include "stream_generator.h"
+
+/* Makes room for at least |size| NALUs in |nalus|. */
+static bool
+reserve_nalus(bench_nalu_t **nalus, size_t *capacity, size_t size)
+{
+  if (size <= *capacity) return true;
+  bench_nalu_t *grown = realloc(*nalus, 2 * size * sizeof(bench_nalu_t));
+  if (!grown) return false;
+  memset(grown + *capacity, 0, (2 * size - *capacity) * sizeof(bench_nalu_t));
+  *nalus = grown;
+  *capacity = 2 * size;
+
+  return true;
+}
+
+static int
+compare_u64(const void *a, const void *b)
+{
+  const uint64_t x = *(const uint64_t *)a;
+  const uint64_t y = *(const uint64_t *)b;
+
+  return (x > y) - (x < y);
+}
+
+bool
+set_common_option(int opt, const char *arg, bench_config_t *config)
+{
+  switch (opt) {
+    case 'c':
+      if (strcmp(arg, "h264") && strcmp(arg, "h265")) return false;
+      config->codec = strcmp(arg, "h264") == 0 ? SV_CODEC_H264 : SV_CODEC_H265;
+      break;
+    case 'w':
+      config->width = (unsigned)strtoul(arg, NULL, 10);
+      break;
+    case 'h':
+      config->height = (unsigned)strtoul(arg, NULL, 10);
+      break;
+    case 'g':
+      config->gop_length = (unsigned)strtoul(arg, NULL, 10);
+      break;
+    case 's':
+      config->num_slices = (unsigned)strtoul(arg, NULL, 10);
+      break;
+    case 'f':
+      config->num_frames = (unsigned)strtoul(arg, NULL, 10);
+      break;
+    case 'b':
+      config->num_b_frames = (unsigned)strtoul(arg, NULL, 10);
+      break;
+    case 'a':
+      if (strcmp(arg, "rsa") && strcmp(arg, "ecdsa")) return false;
+      config->algo = strcmp(arg, "rsa") == 0 ? SIGN_ALGO_RSA : SIGN_ALGO_ECDSA;
+      break;
+    case 'l':
+      if (strcmp(arg, "gop") && strcmp(arg, "frame")) return false;
+      config->auth_level =
+          strcmp(arg, "gop") == 0 ? SV_AUTHENTICITY_LEVEL_GOP : SV_AUTHENTICITY_LEVEL_FRAME;
+      break;
+    case 'r':
+      config->recurrence = (unsigned)strtoul(arg, NULL, 10);
+      break;
+    case 'p':
+      config->plugin = arg;
+      break;
+    case 'k':
+      config->key_dir = arg;
+      break;
+    default:
+      return false;
+  }
+
+  return true;
+}
+
+bool
+is_valid_config(const bench_config_t *config)
+{
+  return config->width > 0 && config->height > 0 && config->gop_length > 0 &&
+      config->num_slices > 0 && config->num_frames > 0;
+}
+
+void
+print_config(const bench_config_t *config)
+{
+  printf("  \"version\": \"%s\",\n", signed_video_get_version());
+  printf("  \"codec\": \"%s\",\n", config->codec == SV_CODEC_H264 ? "h264" : "h265");
+  printf("  \"width\": %u,\n  \"height\": %u,\n", config->width, config->height);
+  printf("  \"gop_length\": %u,\n  \"slices\": %u,\n", config->gop_length, config->num_slices);
+  printf("  \"frames\": %u,\n  \"b_frames\": %u,\n", config->num_frames, config->num_b_frames);
+  printf("  \"algo\": \"%s\",\n", config->algo == SIGN_ALGO_RSA ? "rsa" : "ecdsa");
+  printf("  \"level\": \"%s\",\n",
+      config->auth_level == SV_AUTHENTICITY_LEVEL_GOP ? "gop" : "frame");
+  printf("  \"recurrence\": %u,\n", config->recurrence);
+  printf("  \"plugin\": \"%s\",\n", config->plugin ? config->plugin : "built-in");
+}
+
+size_t
+generate_stream(const bench_config_t *config, bench_nalu_t **nalus)
+{
+  stream_generator_config_t generator_config = stream_generator_get_default_config(config->codec);
+  generator_config.width = config->width;
+  generator_config.height = config->height;
+  generator_config.num_frames = config->num_frames;
+  generator_config.gop_length = config->gop_length;
+  generator_config.num_b_frames = config->num_b_frames;
+  generator_config.num_slices = config->num_slices;
+  stream_generator_t *generator = stream_generator_create(&generator_config);
+  if (!generator) return 0;
+
+  *nalus = NULL;
+  size_t capacity = 0;
+  size_t num_nalus = 0;
+  stream_generator_nalu_t nalu = {0};
+  bool success = true;
+  while (success && stream_generator_get_next_nalu(generator, &nalu)) {
+    success = reserve_nalus(nalus, &capacity, num_nalus + 1);
+    if (!success) break;
+    bench_nalu_t *copy = &(*nalus)[num_nalus++];
+    copy->data = malloc(nalu.data_size);
+    success = copy->data != NULL;
+    if (!success) break;
+    memcpy(copy->data, nalu.data, nalu.data_size);
+    copy->data_size = nalu.data_size;
+  }
+  stream_generator_free(generator);
+  if (!success || num_nalus == 0) {
+    free_stream(*nalus, num_nalus);
+    *nalus = NULL;
+    return 0;
+  }
+
+  return num_nalus;
+}
+
+size_t
+sign_stream(const bench_config_t *config,
+    const bench_nalu_t *nalus,
+    size_t num_nalus,
+    bench_nalu_t **signed_nalus)
+{
+  signed_video_t *sv = create_signing_session(config);
+  size_t capacity = 2 * num_nalus;
+  *signed_nalus = calloc(capacity, sizeof(bench_nalu_t));
+  if (!sv || !*signed_nalus) {
+    signed_video_free(sv);
+    free(*signed_nalus);
+    *signed_nalus = NULL;
+    return 0;
+  }
+
+  SignedVideoReturnCode rc = SV_OK;
+  size_t num_signed_nalus = 0;
+  for (size_t i = 0; i < num_nalus && rc == SV_OK; i++) {
+    rc = signed_video_add_nalu_for_signing(sv, nalus[i].data, nalus[i].data_size);
+    signed_video_nalu_to_prepend_t nalu_to_prepend = {0};
+    while (rc == SV_OK) {
+      rc = signed_video_get_nalu_to_prepend(sv, &nalu_to_prepend);
+      if (rc != SV_OK || nalu_to_prepend.prepend_instruction == SIGNED_VIDEO_PREPEND_NOTHING) break;
+      if (!reserve_nalus(signed_nalus, &capacity, num_signed_nalus + 1)) {
+        signed_video_nalu_data_free(nalu_to_prepend.nalu_data);
+        rc = SV_MEMORY;
+        break;
+      }
+      // The SEI is taken over as is, hence freed with free_stream().
+      bench_nalu_t *sei = &(*signed_nalus)[num_signed_nalus++];
+      sei->data = nalu_to_prepend.nalu_data;
+      sei->data_size = nalu_to_prepend.nalu_data_size;
+      sei->is_sei = true;
+    }
+    if (rc != SV_OK) break;
+    if (!reserve_nalus(signed_nalus, &capacity, num_signed_nalus + 1)) {
+      rc = SV_MEMORY;
+      break;
+    }
+    bench_nalu_t *copy = &(*signed_nalus)[num_signed_nalus++];
+    copy->data = malloc(nalus[i].data_size);
+    copy->data_size = nalus[i].data_size;
+    if (!copy->data) rc = SV_MEMORY;
+    if (copy->data) memcpy(copy->data, nalus[i].data, nalus[i].data_size);
+  }
+  signed_video_free(sv);
+  if (rc != SV_OK) {
+    fprintf(stderr, "Signing failed (%d)\n", rc);
+    free_stream(*signed_nalus, num_signed_nalus);
+    *signed_nalus = NULL;
+    return 0;
+  }
+
+  return num_signed_nalus;
+}
+
+void
+free_stream(bench_nalu_t *nalus, size_t num_nalus)
+{
+  if (!nalus) return;
+
+  for (size_t i = 0; i < num_nalus; i++) free(nalus[i].data);
+  free(nalus);
+}
+
+signed_video_t *
+create_signing_session(const bench_config_t *config)
+{
+  signed_video_t *sv = signed_video_create(config->codec);
+  if (!sv) return NULL;
+
+  char *private_key = NULL;
+  size_t private_key_size = 0;
+  SignedVideoReturnCode rc = signed_video_generate_private_key(
+      config->algo, config->key_dir, &private_key, &private_key_size);
+  if (rc == SV_OK && config->plugin) rc = signed_video_set_signing_plugin(sv, config->plugin);
+  if (rc == SV_OK) {
+    rc = signed_video_set_private_key(sv, config->algo, private_key, private_key_size);
+  }
+  if (rc == SV_OK) rc = signed_video_set_authenticity_level(sv, config->auth_level);
+  if (rc == SV_OK && config->recurrence > 0) {
+    rc = signed_video_set_recurrence_interval_frames(sv, config->recurrence);
+  }
+  if (rc == SV_OK) {
+    rc = signed_video_set_product_info(sv, "bench", "1.0", "0", "Signed Video", "bench");
+  }
+  free(private_key);
+  if (rc != SV_OK) {
+    fprintf(stderr, "Failed setting up the signing session (%d)\n", rc);
+    signed_video_free(sv);
+    return NULL;
+  }
+
+  return sv;
+}
+
+uint64_t
+get_time_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+}
+
+void
+print_latencies(const char *name, uint64_t *latencies, size_t num_latencies)
+{
+  qsort(latencies, num_latencies, sizeof(uint64_t), compare_u64);
+  const size_t last = num_latencies > 0 ? num_latencies - 1 : 0;
+  const double p50 = num_latencies > 0 ? latencies[last * 50 / 100] / 1000.0 : 0.0;
+  const double p99 = num_latencies > 0 ? latencies[last * 99 / 100] / 1000.0 : 0.0;
+  const double max = num_latencies > 0 ? latencies[last] / 1000.0 : 0.0;
+  printf("  \"%s\": {\"p50\": %.3f, \"p99\": %.3f, \"max\": %.3f}", name, p50, p99, max);
+}
@@ -0,0 +1,129 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2023 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next paragraph) shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef __BENCH_HELPERS_H__
+#define __BENCH_HELPERS_H__
+
+#include <getopt.h>  // struct option
+#include <stdbool.h>  // bool
+#include <stdint.h>  // uint8_t, uint64_t
+#include <string.h>  // size_t
+
+#include "lib/src/includes/signed_video_common.h"  // signed_video_t, SignedVideoCodec
+#include "lib/src/includes/signed_video_interfaces.h"  // sign_algo_t
+#include "lib/src/includes/signed_video_sign.h"  // SignedVideoAuthenticityLevel
+
+#define START_CODE_SIZE 4
+
+/* The configuration shared by the benchmarks. */
+typedef struct {
+  SignedVideoCodec codec;
+  unsigned width;
+  unsigned height;
+  unsigned gop_length;
+  unsigned num_slices;
+  unsigned num_frames;
+  unsigned num_b_frames;  // B-frames after each P-frame.
+  sign_algo_t algo;
+  SignedVideoAuthenticityLevel auth_level;
+  unsigned recurrence;  // Recurrence of the public key in frames. 0 keeps the default.
+  const char *plugin;  // NULL for the built-in plugin.
+  const char *key_dir;
+} bench_config_t;
+
+#define BENCH_DEFAULT_CONFIG \
+  { SV_CODEC_H264, 1920, 1080, 60, 1, 600, 0, SIGN_ALGO_ECDSA, SV_AUTHENTICITY_LEVEL_FRAME, 0, \
+    NULL, "/tmp" }
+
+/* The options of bench_config_t, to be listed first in the options of a benchmark. The short
+ * option values are the characters of BENCH_COMMON_OPTION_CHARS. */
+#define BENCH_COMMON_OPTIONS \
+  {"codec", required_argument, NULL, 'c'}, {"width", required_argument, NULL, 'w'}, \
+      {"height", required_argument, NULL, 'h'}, {"gop", required_argument, NULL, 'g'}, \
+      {"slices", required_argument, NULL, 's'}, {"frames", required_argument, NULL, 'f'}, \
+      {"b-frames", required_argument, NULL, 'b'}, \
+      {"algo", required_argument, NULL, 'a'}, {"level", required_argument, NULL, 'l'}, \
+      {"recurrence", required_argument, NULL, 'r'}, {"plugin", required_argument, NULL, 'p'}, \
+      {"key-dir", required_argument, NULL, 'k'}
+#define BENCH_COMMON_OPTION_CHARS "cwhgsfbalrpk"
+#define BENCH_COMMON_USAGE \
+  "  --codec h264|h265     Codec (default h264)\n" \
+  "  --width N             Width in pixels (default 1920)\n" \
+  "  --height N            Height in pixels (default 1080)\n" \
+  "  --gop N               GOP length in frames (default 60)\n" \
+  "  --slices N            Slices per frame (default 1)\n" \
+  "  --frames N            Number of frames (default 600)\n" \
+  "  --b-frames N          B-frames after each P-frame (default 0)\n" \
+  "  --algo rsa|ecdsa      Signing algorithm (default ecdsa)\n" \
+  "  --level gop|frame     Authenticity level (default frame)\n" \
+  "  --recurrence N        Recurrence of the public key in frames (default the library's)\n" \
+  "  --plugin NAME|PATH    Signing plugin to load (default the built-in plugin)\n" \
+  "  --key-dir DIR         Where to generate the private key (default /tmp)\n"
+
+/* A NALU, including its start code. */
+typedef struct {
+  uint8_t *data;
+  size_t data_size;
+  bool is_sei;  // Set for the SEIs generated when signing.
+} bench_nalu_t;
+
+/* Sets the option |opt| of BENCH_COMMON_OPTIONS. Returns false if the |arg| is invalid. */
+bool
+set_common_option(int opt, const char *arg, bench_config_t *config);
+
+/* Returns true if the |config| is complete. */
+bool
+is_valid_config(const bench_config_t *config);
+
+/* Prints the |config| as JSON members, each line ending with a comma. */
+void
+print_config(const bench_config_t *config);
+
+/* Generates a synthetic stream with the default configuration of stream_generator.h, but the
+ * resolution, GOP structure and number of slices of the |config|. The stream is the same in every
+ * run. Returns the number of NALUs, or 0 upon failure. */
+size_t
+generate_stream(const bench_config_t *config, bench_nalu_t **nalus);
+
+/* Signs the |nalus| and returns the number of NALUs in the |signed_nalus|, with the SEIs added
+ * where instructed, or 0 upon failure. */
+size_t
+sign_stream(const bench_config_t *config,
+    const bench_nalu_t *nalus,
+    size_t num_nalus,
+    bench_nalu_t **signed_nalus);
+
+/* Frees the |nalus| and their data. */
+void
+free_stream(bench_nalu_t *nalus, size_t num_nalus);
+
+/* Creates a signing session according to |config|, with a newly generated private key. */
+signed_video_t *
+create_signing_session(const bench_config_t *config);
+
+uint64_t
+get_time_ns(void);
+
+/* Prints the p50, p99 and max of |latencies|, in nanoseconds, as a JSON member in microseconds.
+ * Sorts the |latencies|. */
+void
+print_latencies(const char *name, uint64_t *latencies, size_t num_latencies);
+
+#endif  // __BENCH_HELPERS_H__
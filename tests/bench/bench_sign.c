@@ -0,0 +1,120 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2023 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next paragraph) shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <getopt.h>  // getopt_long
+#include <stdio.h>  // printf, fprintf
+#include <stdlib.h>  // calloc, free
+
+#include "bench_helpers.h"  // generate_stream(), create_signing_session()
+#include "lib/src/includes/signed_video_sign.h"  // signed_video_add_nalu_for_signing()
+
+/* A benchmark of the signing side. A synthetic stream is generated up front and added for signing
+ * frame by frame, pulling the generated SEIs after each NALU, as a camera would. Each call to
+ * signed_video_add_nalu_for_signing() and signed_video_get_nalu_to_prepend() is timed. The result
+ * is printed as JSON to stdout, to be compared across commits. */
+
+static void
+print_usage(const char *name)
+{
+  fprintf(stderr, "Usage: %s [options]\n" BENCH_COMMON_USAGE, name);
+}
+
+static bool
+parse_options(int argc, char **argv, bench_config_t *config)
+{
+  const struct option options[] = {BENCH_COMMON_OPTIONS, {NULL, 0, NULL, 0}};
+
+  int opt = 0;
+  while ((opt = getopt_long(argc, argv, "", options, NULL)) != -1) {
+    if (!set_common_option(opt, optarg, config)) return false;
+  }
+
+  return optind == argc && is_valid_config(config);
+}
+
+int
+main(int argc, char **argv)
+{
+  bench_config_t config = BENCH_DEFAULT_CONFIG;
+  if (!parse_options(argc, argv, &config)) {
+    print_usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  bench_nalu_t *nalus = NULL;
+  const size_t num_nalus = generate_stream(&config, &nalus);
+  signed_video_t *sv = num_nalus > 0 ? create_signing_session(&config) : NULL;
+  uint64_t *add_latencies = calloc(num_nalus, sizeof(uint64_t));
+  // At most one SEI is expected per NALU, plus the pull returning nothing.
+  uint64_t *prepend_latencies = calloc(2 * num_nalus, sizeof(uint64_t));
+  if (!sv || !add_latencies || !prepend_latencies) {
+    fprintf(stderr, "Failed setting up the benchmark\n");
+    return EXIT_FAILURE;
+  }
+
+  size_t num_prepend_calls = 0;
+  size_t num_seis = 0;
+  uint64_t num_bytes_hashed = 0;
+  SignedVideoReturnCode rc = SV_OK;
+  const uint64_t start_ns = get_time_ns();
+  for (size_t i = 0; i < num_nalus && rc == SV_OK; i++) {
+    uint64_t call_start_ns = get_time_ns();
+    rc = signed_video_add_nalu_for_signing(sv, nalus[i].data, nalus[i].data_size);
+    add_latencies[i] = get_time_ns() - call_start_ns;
+    num_bytes_hashed += nalus[i].data_size - START_CODE_SIZE;
+
+    signed_video_nalu_to_prepend_t nalu_to_prepend = {0};
+    do {
+      call_start_ns = get_time_ns();
+      if (rc == SV_OK) rc = signed_video_get_nalu_to_prepend(sv, &nalu_to_prepend);
+      if (num_prepend_calls < 2 * num_nalus) {
+        prepend_latencies[num_prepend_calls++] = get_time_ns() - call_start_ns;
+      }
+      if (rc != SV_OK || nalu_to_prepend.prepend_instruction == SIGNED_VIDEO_PREPEND_NOTHING) break;
+      num_seis++;
+      signed_video_nalu_data_free(nalu_to_prepend.nalu_data);
+    } while (true);
+  }
+  const uint64_t elapsed_ns = get_time_ns() - start_ns;
+  if (rc != SV_OK) fprintf(stderr, "Signing failed (%d)\n", rc);
+
+  const double elapsed_s = elapsed_ns / 1e9;
+  printf("{\n");
+  printf("  \"benchmark\": \"sign\",\n");
+  print_config(&config);
+  printf("  \"status\": %d,\n", rc);
+  printf("  \"num_nalus\": %zu,\n  \"num_seis\": %zu,\n", num_nalus, num_seis);
+  printf("  \"bytes_hashed\": %llu,\n", (unsigned long long)num_bytes_hashed);
+  printf("  \"elapsed_s\": %.6f,\n", elapsed_s);
+  printf("  \"nalus_per_second\": %.1f,\n", elapsed_s > 0 ? num_nalus / elapsed_s : 0.0);
+  printf("  \"megabytes_per_second\": %.3f,\n",
+      elapsed_s > 0 ? num_bytes_hashed / 1e6 / elapsed_s : 0.0);
+  print_latencies("add_latency_us", add_latencies, num_nalus);
+  printf(",\n");
+  print_latencies("prepend_latency_us", prepend_latencies, num_prepend_calls);
+  printf("\n}\n");
+
+  signed_video_free(sv);
+  free_stream(nalus, num_nalus);
+  free(add_latencies);
+  free(prepend_latencies);
+
+  return rc == SV_OK ? EXIT_SUCCESS : EXIT_FAILURE;
+}
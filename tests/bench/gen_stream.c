@@ -0,0 +1,169 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2023 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next paragraph) shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <getopt.h>  // getopt_long
+#include <stdio.h>  // fprintf
+#include <stdlib.h>  // strtod, strtoul
+
+#include "stream_generator.h"
+
+/* Writes a synthetic H.264 or H.265 stream in Annex B format to a file, for feeding the signing
+ * and validation side from outside the benchmarks. The statistics of the stream are printed to
+ * stderr. */
+
+static void
+print_usage(const char *name)
+{
+  fprintf(stderr,
+      "Usage: %s [options] --output FILE\n"
+      "  --codec h264|h265     Codec (default h264)\n"
+      "  --width N             Width in pixels (default 1920)\n"
+      "  --height N            Height in pixels (default 1080)\n"
+      "  --frames N            Number of frames (default 600)\n"
+      "  --gop N               GOP length in frames (default 60)\n"
+      "  --b-frames N          B-frames after each P-frame (default 0)\n"
+      "  --slices N            Slices per frame (default 1)\n"
+      "  --i-size N            Mean I-frame size in bytes (default from the resolution)\n"
+      "  --p-size N            Mean P-frame size in bytes (default a tenth of an I-frame)\n"
+      "  --distribution NAME   Slice sizes; fixed, uniform or normal (default normal)\n"
+      "  --deviation R         Relative deviation of the slice sizes (default 0.1)\n"
+      "  --zero-rate R         Rate of extra zero bytes in the slice data (default 0)\n"
+      "  --ps-interval N       Parameter sets every N GOPs, 0 for only the first (default 1)\n"
+      "  --aud                 Start each access unit with an AUD\n"
+      "  --sei-interval N      A user data unregistered SEI every N frames (default none)\n"
+      "  --seed N              Seed of the random data (default 0x12345678)\n",
+      name);
+}
+
+static bool
+parse_options(int argc, char **argv, stream_generator_config_t *config, const char **output)
+{
+  const struct option options[] = {{"codec", required_argument, NULL, 'c'},
+      {"width", required_argument, NULL, 'w'}, {"height", required_argument, NULL, 'h'},
+      {"frames", required_argument, NULL, 'f'}, {"gop", required_argument, NULL, 'g'},
+      {"b-frames", required_argument, NULL, 'b'}, {"slices", required_argument, NULL, 's'},
+      {"i-size", required_argument, NULL, 'I'}, {"p-size", required_argument, NULL, 'P'},
+      {"distribution", required_argument, NULL, 'd'}, {"deviation", required_argument, NULL, 'v'},
+      {"zero-rate", required_argument, NULL, 'z'}, {"ps-interval", required_argument, NULL, 'i'},
+      {"aud", no_argument, NULL, 'a'}, {"sei-interval", required_argument, NULL, 'e'},
+      {"seed", required_argument, NULL, 'S'}, {"output", required_argument, NULL, 'o'},
+      {NULL, 0, NULL, 0}};
+
+  int opt = 0;
+  while ((opt = getopt_long(argc, argv, "", options, NULL)) != -1) {
+    switch (opt) {
+      case 'c':
+        if (strcmp(optarg, "h264") && strcmp(optarg, "h265")) return false;
+        config->codec = strcmp(optarg, "h264") == 0 ? SV_CODEC_H264 : SV_CODEC_H265;
+        break;
+      case 'w':
+        config->width = (unsigned)strtoul(optarg, NULL, 10);
+        break;
+      case 'h':
+        config->height = (unsigned)strtoul(optarg, NULL, 10);
+        break;
+      case 'f':
+        config->num_frames = (unsigned)strtoul(optarg, NULL, 10);
+        break;
+      case 'g':
+        config->gop_length = (unsigned)strtoul(optarg, NULL, 10);
+        break;
+      case 'b':
+        config->num_b_frames = (unsigned)strtoul(optarg, NULL, 10);
+        break;
+      case 's':
+        config->num_slices = (unsigned)strtoul(optarg, NULL, 10);
+        break;
+      case 'I':
+        config->i_frame_size = strtoul(optarg, NULL, 10);
+        break;
+      case 'P':
+        config->p_frame_size = strtoul(optarg, NULL, 10);
+        break;
+      case 'd':
+        if (strcmp(optarg, "fixed") == 0) {
+          config->size_distribution = SIZE_DISTRIBUTION_FIXED;
+        } else if (strcmp(optarg, "uniform") == 0) {
+          config->size_distribution = SIZE_DISTRIBUTION_UNIFORM;
+        } else if (strcmp(optarg, "normal") == 0) {
+          config->size_distribution = SIZE_DISTRIBUTION_NORMAL;
+        } else {
+          return false;
+        }
+        break;
+      case 'v':
+        config->size_deviation = strtod(optarg, NULL);
+        break;
+      case 'z':
+        config->zero_byte_rate = strtod(optarg, NULL);
+        break;
+      case 'i':
+        config->parameter_set_interval = (unsigned)strtoul(optarg, NULL, 10);
+        break;
+      case 'a':
+        config->with_aud = true;
+        break;
+      case 'e':
+        config->sei_interval = (unsigned)strtoul(optarg, NULL, 10);
+        break;
+      case 'S':
+        config->seed = (uint32_t)strtoul(optarg, NULL, 0);
+        break;
+      case 'o':
+        *output = optarg;
+        break;
+      default:
+        return false;
+    }
+  }
+
+  return optind == argc && *output;
+}
+
+int
+main(int argc, char **argv)
+{
+  stream_generator_config_t config = stream_generator_get_default_config(SV_CODEC_H264);
+  const char *output = NULL;
+  if (!parse_options(argc, argv, &config, &output)) {
+    print_usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  stream_generator_t *generator = stream_generator_create(&config);
+  if (!generator) {
+    fprintf(stderr, "Invalid configuration\n");
+    return EXIT_FAILURE;
+  }
+  const bool success = stream_generator_write_file(generator, output);
+  stream_generator_stats_t stats = {0};
+  stream_generator_get_stats(generator, &stats);
+  stream_generator_free(generator);
+  if (!success) {
+    fprintf(stderr, "Failed writing %s\n", output);
+    return EXIT_FAILURE;
+  }
+
+  fprintf(stderr, "Wrote %llu NALUs, %llu bytes, with %llu emulation prevention bytes, to %s\n",
+      (unsigned long long)stats.num_nalus, (unsigned long long)stats.num_bytes,
+      (unsigned long long)stats.num_emulation_prevention_bytes, output);
+
+  return EXIT_SUCCESS;
+}
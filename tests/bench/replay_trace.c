@@ -0,0 +1,361 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2023 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next paragraph) shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <getopt.h>  // getopt_long
+#include <stdio.h>  // FILE, fopen, fread, printf, fprintf
+#include <stdlib.h>  // calloc, free, malloc
+#include <time.h>  // clock_nanosleep
+
+#include "bench_helpers.h"  // sign_stream(), create_signing_session()
+#include "lib/src/includes/signed_video_auth.h"  // signed_video_add_nalu_and_authenticate()
+#include "lib/src/includes/signed_video_sign.h"  // signed_video_add_nalu_for_signing()
+#include "lib/src/includes/signed_video_trace.h"  // signed_video_trace_parse_record()
+
+/* Replays a NALU trace, captured through signed_video_set_trace_sink(), on a new session of the
+ * same kind. Each traced NALU is replaced by a synthetic NALU with the same header bytes and size,
+ * and a payload seeded by the digest of the original NALU. Hence, NALUs that were identical are
+ * still identical. A validation trace is first signed, and the Signed Video SEIs of the trace are
+ * replaced by the generated SEIs at the traced positions. Hence, SEIs lost or delayed in the field
+ * are lost or delayed in the replay as well.
+ *
+ * The NALUs are added at maximum speed, or at the traced timestamps. The result is printed as JSON
+ * to stdout, together with the traced latencies for comparison. */
+
+typedef struct {
+  bool is_realtime;  // Add the NALUs at the traced timestamps.
+} replay_config_t;
+
+static void
+print_usage(const char *name)
+{
+  fprintf(stderr,
+      "Usage: %s [options] TRACE\n"
+      "  --speed original|max  Add the NALUs at the traced timestamps, or as fast as possible\n"
+      "                        (default max)\n"
+      "  --algo rsa|ecdsa      Signing algorithm (default ecdsa)\n"
+      "  --level gop|frame     Authenticity level (default frame)\n"
+      "  --recurrence N        Recurrence of the public key in frames (default the library's)\n"
+      "  --plugin NAME|PATH    Signing plugin to load (default the built-in plugin)\n"
+      "  --key-dir DIR         Where to generate the private key (default /tmp)\n",
+      name);
+}
+
+static bool
+parse_options(int argc, char **argv, bench_config_t *config, replay_config_t *replay_config)
+{
+  const struct option options[] = {{"speed", required_argument, NULL, 'S'},
+      {"algo", required_argument, NULL, 'a'}, {"level", required_argument, NULL, 'l'},
+      {"recurrence", required_argument, NULL, 'r'}, {"plugin", required_argument, NULL, 'p'},
+      {"key-dir", required_argument, NULL, 'k'}, {NULL, 0, NULL, 0}};
+
+  int opt = 0;
+  while ((opt = getopt_long(argc, argv, "", options, NULL)) != -1) {
+    switch (opt) {
+      case 'S':
+        if (strcmp(optarg, "original") && strcmp(optarg, "max")) return false;
+        replay_config->is_realtime = strcmp(optarg, "original") == 0;
+        break;
+      default:
+        if (!set_common_option(opt, optarg, config)) return false;
+        break;
+    }
+  }
+
+  return optind == argc - 1;
+}
+
+/* Reads and parses all records of the trace file at |path|. Returns the number of records, or 0
+ * upon failure. */
+static size_t
+read_trace(const char *path, sv_trace_record_t **records)
+{
+  FILE *file = fopen(path, "rb");
+  if (!file) return 0;
+
+  size_t capacity = 0;
+  size_t num_records = 0;
+  uint8_t data[SV_TRACE_RECORD_SIZE];
+  bool success = true;
+  *records = NULL;
+  while (success && fread(data, 1, SV_TRACE_RECORD_SIZE, file) == SV_TRACE_RECORD_SIZE) {
+    if (num_records == capacity) {
+      capacity = capacity ? 2 * capacity : 1024;
+      sv_trace_record_t *grown = realloc(*records, capacity * sizeof(sv_trace_record_t));
+      success = grown != NULL;
+      if (!success) break;
+      *records = grown;
+    }
+    sv_trace_record_t *record = &(*records)[num_records];
+    success = signed_video_trace_parse_record(data, SV_TRACE_RECORD_SIZE, record) == SV_OK;
+    if (!success) break;
+    // All records are expected to come from the same session.
+    const sv_trace_record_t *first = &(*records)[0];
+    success = record->codec == first->codec && record->is_validation == first->is_validation;
+    num_records++;
+  }
+  fclose(file);
+  if (!success || num_records == 0) {
+    free(*records);
+    *records = NULL;
+    return 0;
+  }
+
+  return num_records;
+}
+
+/* Synthesizes a NALU with a start code, the traced header bytes and a payload seeded by the
+ * digest. The payload bytes are odd, hence no emulation prevention is needed, and the NALU ends
+ * with a stop bit. */
+static bench_nalu_t
+synthesize_nalu(const sv_trace_record_t *record)
+{
+  bench_nalu_t nalu = {0};
+  const size_t nalu_size = record->nalu_size > 0 ? record->nalu_size : 1;
+  nalu.data_size = START_CODE_SIZE + nalu_size;
+  nalu.data = malloc(nalu.data_size);
+  if (!nalu.data) return nalu;
+
+  const uint8_t start_code[START_CODE_SIZE] = {0x00, 0x00, 0x00, 0x01};
+  memcpy(nalu.data, start_code, START_CODE_SIZE);
+  const size_t header_size = nalu_size < SV_TRACE_HEADER_SIZE ? nalu_size : SV_TRACE_HEADER_SIZE;
+  memcpy(nalu.data + START_CODE_SIZE, record->header, header_size);
+  // A xorshift generator, where a zero state would only generate zeros.
+  uint32_t state = (uint32_t)(record->digest ^ (record->digest >> 32));
+  if (state == 0) state = 1;
+  for (size_t i = START_CODE_SIZE + header_size; i < nalu.data_size; i++) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    nalu.data[i] = (uint8_t)state | 0x01;
+  }
+  if (nalu_size > header_size) nalu.data[nalu.data_size - 1] = 0x80;
+
+  return nalu;
+}
+
+/* Finds the generated SEI to put at a traced SEI added before video NALU |video_pos|, that is, the
+ * latest SEI, from |next_sei| on, generated at, or before, that position. Of SEIs generated at the
+ * same position the first one is taken. Hence, a lost SEI is skipped and a delayed SEI is moved.
+ * Returns the index in |sei_pos|, or |num_seis| if there is none. */
+static size_t
+find_generated_sei(const size_t *sei_pos, size_t num_seis, size_t video_pos, size_t next_sei)
+{
+  size_t sei = num_seis;
+  for (size_t i = next_sei; i < num_seis && sei_pos[i] <= video_pos; i++) {
+    if (sei == num_seis || sei_pos[i] != sei_pos[sei]) sei = i;
+  }
+
+  return sei;
+}
+
+/* Builds the NALUs to replay. For a validation trace the synthetic video NALUs are signed and the
+ * generated SEIs are put at the traced SEI positions; See find_generated_sei(). Traced SEIs without
+ * a generated SEI are left out, and counted in |num_missing_seis|. The |replayed_records| maps the
+ * NALUs to the records. Returns the number of NALUs, or 0 upon failure. */
+static size_t
+build_replay_stream(const bench_config_t *config,
+    const sv_trace_record_t *records,
+    size_t num_records,
+    bench_nalu_t **nalus,
+    size_t **replayed_records,
+    size_t *num_missing_seis)
+{
+  bench_nalu_t *video_nalus = calloc(num_records, sizeof(bench_nalu_t));
+  *nalus = calloc(num_records, sizeof(bench_nalu_t));
+  *replayed_records = calloc(num_records, sizeof(size_t));
+  bench_nalu_t *signed_nalus = NULL;
+  size_t num_signed_nalus = 0;
+  // The generated SEIs, as indices in |signed_nalus|, and their positions as the number of video
+  // NALUs before them.
+  size_t *seis = NULL;
+  size_t *sei_pos = NULL;
+  size_t num_seis = 0;
+  size_t num_video_nalus = 0;
+  size_t num_nalus = 0;
+  bool success = video_nalus && *nalus && *replayed_records;
+  for (size_t i = 0; success && i < num_records; i++) {
+    if (records[i].is_signed_video_sei) continue;
+    video_nalus[num_video_nalus] = synthesize_nalu(&records[i]);
+    success = video_nalus[num_video_nalus++].data != NULL;
+  }
+  if (success && records[0].is_validation) {
+    num_signed_nalus = sign_stream(config, video_nalus, num_video_nalus, &signed_nalus);
+    seis = calloc(num_signed_nalus, sizeof(size_t));
+    sei_pos = calloc(num_signed_nalus, sizeof(size_t));
+    success = num_signed_nalus > 0 && seis && sei_pos;
+    for (size_t i = 0, video_pos = 0; success && i < num_signed_nalus; i++) {
+      if (!signed_nalus[i].is_sei) {
+        video_pos++;
+        continue;
+      }
+      seis[num_seis] = i;
+      sei_pos[num_seis++] = video_pos;
+    }
+  }
+
+  size_t video_idx = 0;
+  size_t next_sei = 0;
+  *num_missing_seis = 0;
+  for (size_t i = 0; success && i < num_records; i++) {
+    bench_nalu_t *nalu = &(*nalus)[num_nalus];
+    if (records[i].is_signed_video_sei) {
+      const size_t sei = find_generated_sei(sei_pos, num_seis, video_idx, next_sei);
+      if (sei == num_seis) {
+        (*num_missing_seis)++;
+        continue;
+      }
+      // Take over the generated SEI.
+      *nalu = signed_nalus[seis[sei]];
+      signed_nalus[seis[sei]].data = NULL;
+      next_sei = sei + 1;
+    } else {
+      *nalu = video_nalus[video_idx];
+      video_nalus[video_idx++].data = NULL;
+    }
+    (*replayed_records)[num_nalus++] = i;
+  }
+
+  free(sei_pos);
+  free(seis);
+  free_stream(video_nalus, num_video_nalus);
+  free_stream(signed_nalus, num_signed_nalus);
+  if (!success || num_nalus == 0) {
+    free_stream(*nalus, num_nalus);
+    free(*replayed_records);
+    *nalus = NULL;
+    *replayed_records = NULL;
+    return 0;
+  }
+
+  return num_nalus;
+}
+
+/* Waits until |offset_ns| after |start_ns|. */
+static void
+wait_until(uint64_t start_ns, uint64_t offset_ns)
+{
+  const uint64_t deadline_ns = start_ns + offset_ns;
+  const struct timespec deadline = {
+      (time_t)(deadline_ns / 1000000000), (long)(deadline_ns % 1000000000)};
+  while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL) != 0) {
+  }
+}
+
+int
+main(int argc, char **argv)
+{
+  bench_config_t config = BENCH_DEFAULT_CONFIG;
+  replay_config_t replay_config = {false};
+  if (!parse_options(argc, argv, &config, &replay_config)) {
+    print_usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+  const char *path = argv[optind];
+
+  sv_trace_record_t *records = NULL;
+  const size_t num_records = read_trace(path, &records);
+  if (num_records == 0) {
+    fprintf(stderr, "Failed reading the trace %s\n", path);
+    return EXIT_FAILURE;
+  }
+  config.codec = records[0].codec;
+  const bool is_validation = records[0].is_validation;
+
+  bench_nalu_t *nalus = NULL;
+  size_t *replayed_records = NULL;
+  size_t num_missing_seis = 0;
+  const size_t num_nalus = build_replay_stream(
+      &config, records, num_records, &nalus, &replayed_records, &num_missing_seis);
+  uint64_t *latencies = calloc(num_nalus, sizeof(uint64_t));
+  uint64_t *original_latencies = calloc(num_nalus, sizeof(uint64_t));
+  signed_video_t *sv =
+      is_validation ? signed_video_create(config.codec) : create_signing_session(&config);
+  if (num_nalus == 0 || !latencies || !original_latencies || !sv) {
+    fprintf(stderr, "Failed setting up the replay\n");
+    return EXIT_FAILURE;
+  }
+
+  size_t num_mismatches = 0;
+  size_t num_reports = 0;
+  size_t num_original_reports = 0;
+  const uint64_t first_timestamp_ns = records[0].timestamp_ns;
+  const uint64_t start_ns = get_time_ns();
+  for (size_t i = 0; i < num_nalus; i++) {
+    const sv_trace_record_t *record = &records[replayed_records[i]];
+    if (replay_config.is_realtime) wait_until(start_ns, record->timestamp_ns - first_timestamp_ns);
+    SignedVideoReturnCode rc = SV_OK;
+    const uint64_t t0 = get_time_ns();
+    if (is_validation) {
+      signed_video_authenticity_t *auth_report = NULL;
+      rc = signed_video_add_nalu_and_authenticate(sv, nalus[i].data, nalus[i].data_size,
+          &auth_report);
+      latencies[i] = get_time_ns() - t0;
+      if (auth_report) num_reports++;
+      signed_video_authenticity_report_free(auth_report);
+    } else {
+      rc = signed_video_add_nalu_for_signing(sv, nalus[i].data, nalus[i].data_size);
+      // As traced, only the call adding the NALU is timed.
+      latencies[i] = get_time_ns() - t0;
+      // The SEIs are pulled after each NALU, as a camera would.
+      signed_video_nalu_to_prepend_t nalu_to_prepend = {0};
+      while (signed_video_get_nalu_to_prepend(sv, &nalu_to_prepend) == SV_OK &&
+          nalu_to_prepend.prepend_instruction != SIGNED_VIDEO_PREPEND_NOTHING) {
+        signed_video_nalu_data_free(nalu_to_prepend.nalu_data);
+      }
+    }
+    original_latencies[i] = record->duration_ns;
+    if (record->has_report) num_original_reports++;
+    if (rc != record->return_code) num_mismatches++;
+  }
+  const double elapsed_s = (get_time_ns() - start_ns) / 1e9;
+  const double original_elapsed_s =
+      (records[num_records - 1].timestamp_ns + records[num_records - 1].duration_ns -
+          first_timestamp_ns) /
+      1e9;
+
+  printf("{\n  \"benchmark\": \"replay\",\n");
+  printf("  \"version\": \"%s\",\n", signed_video_get_version());
+  printf("  \"trace\": \"%s\",\n", path);
+  printf("  \"session\": \"%s\",\n", is_validation ? "validation" : "signing");
+  printf("  \"codec\": \"%s\",\n", config.codec == SV_CODEC_H264 ? "h264" : "h265");
+  printf("  \"speed\": \"%s\",\n", replay_config.is_realtime ? "original" : "max");
+  printf("  \"records\": %zu,\n  \"replayed_nalus\": %zu,\n", num_records, num_nalus);
+  printf("  \"missing_seis\": %zu,\n", num_missing_seis);
+  printf("  \"return_code_mismatches\": %zu,\n", num_mismatches);
+  if (is_validation) {
+    printf("  \"reports\": {\"original\": %zu, \"replayed\": %zu},\n", num_original_reports,
+        num_reports);
+  }
+  printf("  \"elapsed_s\": %.6f,\n  \"original_elapsed_s\": %.6f,\n", elapsed_s,
+      original_elapsed_s);
+  print_latencies("add_latency_us", latencies, num_nalus);
+  printf(",\n");
+  print_latencies("original_add_latency_us", original_latencies, num_nalus);
+  printf("\n}\n");
+
+  signed_video_free(sv);
+  free(original_latencies);
+  free(latencies);
+  free_stream(nalus, num_nalus);
+  free(replayed_records);
+  free(records);
+
+  return EXIT_SUCCESS;
+}
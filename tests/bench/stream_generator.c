@@ -0,0 +1,718 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2023 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next paragraph) shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "stream_generator.h"
+
+#include <stdio.h>  // FILE, fopen, fwrite, fclose
+#include <stdlib.h>  // calloc, free, realloc
+#include <string.h>  // memcpy
+
+#define START_CODE_SIZE 4
+#define BITS_PER_PIXEL_I 1.2
+#define I_TO_P_SIZE_RATIO 10
+#define SEI_USER_DATA_SIZE 64
+// Both codecs use 8 bits POC LSBs, 4 bits frame numbers, and 64x64 CTBs in H.265.
+#define LOG2_MAX_POC_LSB 8
+#define LOG2_MAX_FRAME_NUM 4
+#define H265_CTB_SIZE 64
+// The maximum number of NALUs of an access unit, besides the slices; AUD, VPS, SPS, PPS and SEI.
+#define MAX_NUM_NON_SLICE_NALUS 5
+
+typedef enum {
+  NALU_AUD = 0,
+  NALU_VPS,
+  NALU_SPS,
+  NALU_PPS,
+  NALU_SEI,
+  NALU_SLICE,
+} nalu_kind_t;
+
+typedef enum { FRAME_I = 0, FRAME_P, FRAME_B } frame_type_t;
+
+/* Writes bits to a growing buffer, most significant bit first. */
+typedef struct {
+  uint8_t *data;
+  size_t size;
+  size_t capacity;
+  int bit_pos;  // Bits written to the last byte, or 0 if it is complete.
+  bool has_failed;
+} bit_writer_t;
+
+struct _stream_generator_t {
+  stream_generator_config_t config;
+  size_t i_frame_size;
+  size_t p_frame_size;
+  uint32_t random_state;
+
+  // The access unit being generated.
+  unsigned frame;
+  frame_type_t frame_type;
+  unsigned display_idx;  // The position of the frame in the GOP in output order.
+  unsigned prev_ref_display_idx;  // That of the latest reference frame before in output order.
+  unsigned next_ref_display_idx;  // That of the reference frame after, for B-frames.
+  unsigned frame_num;
+  unsigned prev_ref_frame_num;
+  unsigned idr_pic_id;
+  nalu_kind_t nalus[MAX_NUM_NON_SLICE_NALUS];
+  unsigned num_nalus;  // Non slice NALUs of the access unit.
+  unsigned nalu_idx;  // The next NALU of the access unit to generate, slices counted last.
+
+  bit_writer_t rbsp;  // The NALU before emulation prevention.
+  uint8_t *nalu;  // The NALU with start code and emulation prevention.
+  size_t nalu_size;
+  size_t nalu_capacity;
+
+  stream_generator_stats_t stats;
+};
+
+static bool
+reserve(bit_writer_t *writer, size_t size)
+{
+  if (size <= writer->capacity) return true;
+  size_t capacity = writer->capacity ? writer->capacity : 256;
+  while (capacity < size) capacity *= 2;
+  uint8_t *data = realloc(writer->data, capacity);
+  if (!data) {
+    writer->has_failed = true;
+    return false;
+  }
+  writer->data = data;
+  writer->capacity = capacity;
+
+  return true;
+}
+
+static void
+put_bit(bit_writer_t *writer, unsigned bit)
+{
+  if (writer->bit_pos == 0) {
+    if (!reserve(writer, writer->size + 1)) return;
+    writer->data[writer->size++] = 0;
+  }
+  if (bit) writer->data[writer->size - 1] |= 0x80 >> writer->bit_pos;
+  writer->bit_pos = (writer->bit_pos + 1) & 0x07;
+}
+
+static void
+put_bits(bit_writer_t *writer, uint32_t value, int num_bits)
+{
+  for (int i = num_bits - 1; i >= 0; i--) put_bit(writer, (value >> i) & 1);
+}
+
+/* Writes an unsigned Exp-Golomb code, ue(v). */
+static void
+put_ue(bit_writer_t *writer, uint32_t value)
+{
+  const uint64_t code = (uint64_t)value + 1;
+  int num_bits = 0;
+  while ((code >> num_bits) > 1) num_bits++;
+  put_bits(writer, 0, num_bits);
+  put_bits(writer, (uint32_t)code, num_bits + 1);
+}
+
+/* Writes a signed Exp-Golomb code, se(v). */
+static void
+put_se(bit_writer_t *writer, int32_t value)
+{
+  put_ue(writer, value > 0 ? 2 * (uint32_t)value - 1 : 2 * (uint32_t)(-value));
+}
+
+/* Writes the stop bit and aligns to a byte, rbsp_trailing_bits(). */
+static void
+put_trailing_bits(bit_writer_t *writer)
+{
+  put_bit(writer, 1);
+  while (writer->bit_pos != 0) put_bit(writer, 0);
+}
+
+static uint32_t
+next_random(stream_generator_t *self)
+{
+  // xorshift32
+  uint32_t x = self->random_state;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  self->random_state = x;
+
+  return x;
+}
+
+/* Returns a random number in [0, 1). */
+static double
+next_uniform(stream_generator_t *self)
+{
+  return (next_random(self) >> 8) / (double)(1 << 24);
+}
+
+/* Draws a size around |mean| according to the configured distribution. */
+static size_t
+draw_size(stream_generator_t *self, size_t mean)
+{
+  const double deviation = self->config.size_deviation;
+  double factor = 1.0;
+  switch (self->config.size_distribution) {
+    case SIZE_DISTRIBUTION_UNIFORM:
+      factor += deviation * (2.0 * next_uniform(self) - 1.0);
+      break;
+    case SIZE_DISTRIBUTION_NORMAL: {
+      // The sum of 12 uniform numbers approximates a normal distribution with variance 1.
+      double sum = -6.0;
+      for (int i = 0; i < 12; i++) sum += next_uniform(self);
+      factor += deviation * sum;
+      break;
+    }
+    default:
+      break;
+  }
+  const double size = mean * factor;
+
+  return size < 1.0 ? 1 : (size_t)size;
+}
+
+static unsigned
+ceil_log2(unsigned value)
+{
+  unsigned num_bits = 0;
+  while ((1u << num_bits) < value) num_bits++;
+
+  return num_bits;
+}
+
+static void
+put_nalu_header(stream_generator_t *self, unsigned h264_header, unsigned h265_type)
+{
+  if (self->config.codec == SV_CODEC_H264) {
+    put_bits(&self->rbsp, h264_header, 8);
+  } else {
+    // forbidden_zero_bit, nal_unit_type, nuh_layer_id = 0 and nuh_temporal_id_plus1 = 1.
+    put_bits(&self->rbsp, h265_type << 1, 8);
+    put_bits(&self->rbsp, 0x01, 8);
+  }
+}
+
+static void
+write_aud(stream_generator_t *self)
+{
+  put_nalu_header(self, 0x09, 35);
+  // primary_pic_type, or pic_type; I, or I and P, or I, P and B.
+  put_bits(&self->rbsp, self->frame_type == FRAME_I ? 0 : self->frame_type == FRAME_P ? 1 : 2, 3);
+  put_trailing_bits(&self->rbsp);
+}
+
+/* Writes profile_tier_level() of H.265 without sub-layers; Main profile at level 5.1. */
+static void
+put_profile_tier_level(bit_writer_t *writer)
+{
+  put_bits(writer, 0, 2);  // general_profile_space
+  put_bits(writer, 0, 1);  // general_tier_flag
+  put_bits(writer, 1, 5);  // general_profile_idc
+  put_bits(writer, 0x60000000, 32);  // general_profile_compatibility_flag[j]
+  put_bits(writer, 1, 1);  // general_progressive_source_flag
+  put_bits(writer, 0, 1);  // general_interlaced_source_flag
+  put_bits(writer, 0, 1);  // general_non_packed_constraint_flag
+  put_bits(writer, 1, 1);  // general_frame_only_constraint_flag
+  put_bits(writer, 0, 32);  // general_reserved_zero_43bits and general_inbld_flag
+  put_bits(writer, 0, 12);
+  put_bits(writer, 153, 8);  // general_level_idc
+}
+
+static void
+write_vps(stream_generator_t *self)
+{
+  bit_writer_t *w = &self->rbsp;
+  const bool has_b_frames = self->config.num_b_frames > 0;
+  put_nalu_header(self, 0, 32);
+  put_bits(w, 0, 4);  // vps_video_parameter_set_id
+  put_bits(w, 1, 1);  // vps_base_layer_internal_flag
+  put_bits(w, 1, 1);  // vps_base_layer_available_flag
+  put_bits(w, 0, 6);  // vps_max_layers_minus1
+  put_bits(w, 0, 3);  // vps_max_sub_layers_minus1
+  put_bits(w, 1, 1);  // vps_temporal_id_nesting_flag
+  put_bits(w, 0xffff, 16);  // vps_reserved_0xffff_16bits
+  put_profile_tier_level(w);
+  put_bits(w, 1, 1);  // vps_sub_layer_ordering_info_present_flag
+  put_ue(w, has_b_frames ? 2 : 1);  // vps_max_dec_pic_buffering_minus1
+  put_ue(w, has_b_frames ? 1 : 0);  // vps_max_num_reorder_pics
+  put_ue(w, 0);  // vps_max_latency_increase_plus1
+  put_bits(w, 0, 6);  // vps_max_layer_id
+  put_ue(w, 0);  // vps_num_layer_sets_minus1
+  put_bits(w, 0, 1);  // vps_timing_info_present_flag
+  put_bits(w, 0, 1);  // vps_extension_flag
+  put_trailing_bits(w);
+}
+
+static void
+write_sps(stream_generator_t *self)
+{
+  bit_writer_t *w = &self->rbsp;
+  const unsigned width = self->config.width;
+  const unsigned height = self->config.height;
+  const bool has_b_frames = self->config.num_b_frames > 0;
+  if (self->config.codec == SV_CODEC_H264) {
+    const unsigned width_in_mbs = (width + 15) / 16;
+    const unsigned height_in_mbs = (height + 15) / 16;
+    const bool is_cropped = width % 16 || height % 16;
+    put_nalu_header(self, 0x67, 0);
+    put_bits(w, 77, 8);  // profile_idc, Main
+    put_bits(w, 0, 8);  // constraint_set flags and reserved_zero_2bits
+    put_bits(w, 51, 8);  // level_idc
+    put_ue(w, 0);  // seq_parameter_set_id
+    put_ue(w, LOG2_MAX_FRAME_NUM - 4);  // log2_max_frame_num_minus4
+    put_ue(w, 0);  // pic_order_cnt_type
+    put_ue(w, LOG2_MAX_POC_LSB - 4);  // log2_max_pic_order_cnt_lsb_minus4
+    put_ue(w, has_b_frames ? 2 : 1);  // max_num_ref_frames
+    put_bits(w, 0, 1);  // gaps_in_frame_num_value_allowed_flag
+    put_ue(w, width_in_mbs - 1);  // pic_width_in_mbs_minus1
+    put_ue(w, height_in_mbs - 1);  // pic_height_in_map_units_minus1
+    put_bits(w, 1, 1);  // frame_mbs_only_flag
+    put_bits(w, 1, 1);  // direct_8x8_inference_flag
+    put_bits(w, is_cropped, 1);  // frame_cropping_flag
+    if (is_cropped) {
+      // In units of two pixels for 4:2:0.
+      put_ue(w, 0);  // frame_crop_left_offset
+      put_ue(w, (width_in_mbs * 16 - width) / 2);  // frame_crop_right_offset
+      put_ue(w, 0);  // frame_crop_top_offset
+      put_ue(w, (height_in_mbs * 16 - height) / 2);  // frame_crop_bottom_offset
+    }
+    put_bits(w, 0, 1);  // vui_parameters_present_flag
+  } else {
+    const unsigned coded_width = (width + 7) / 8 * 8;
+    const unsigned coded_height = (height + 7) / 8 * 8;
+    const bool is_cropped = width % 8 || height % 8;
+    put_nalu_header(self, 0, 33);
+    put_bits(w, 0, 4);  // sps_video_parameter_set_id
+    put_bits(w, 0, 3);  // sps_max_sub_layers_minus1
+    put_bits(w, 1, 1);  // sps_temporal_id_nesting_flag
+    put_profile_tier_level(w);
+    put_ue(w, 0);  // sps_seq_parameter_set_id
+    put_ue(w, 1);  // chroma_format_idc, 4:2:0
+    put_ue(w, coded_width);  // pic_width_in_luma_samples
+    put_ue(w, coded_height);  // pic_height_in_luma_samples
+    put_bits(w, is_cropped, 1);  // conformance_window_flag
+    if (is_cropped) {
+      put_ue(w, 0);  // conf_win_left_offset
+      put_ue(w, (coded_width - width) / 2);  // conf_win_right_offset
+      put_ue(w, 0);  // conf_win_top_offset
+      put_ue(w, (coded_height - height) / 2);  // conf_win_bottom_offset
+    }
+    put_ue(w, 0);  // bit_depth_luma_minus8
+    put_ue(w, 0);  // bit_depth_chroma_minus8
+    put_ue(w, LOG2_MAX_POC_LSB - 4);  // log2_max_pic_order_cnt_lsb_minus4
+    put_bits(w, 1, 1);  // sps_sub_layer_ordering_info_present_flag
+    put_ue(w, has_b_frames ? 2 : 1);  // sps_max_dec_pic_buffering_minus1
+    put_ue(w, has_b_frames ? 1 : 0);  // sps_max_num_reorder_pics
+    put_ue(w, 0);  // sps_max_latency_increase_plus1
+    put_ue(w, 0);  // log2_min_luma_coding_block_size_minus3
+    put_ue(w, 3);  // log2_diff_max_min_luma_coding_block_size
+    put_ue(w, 0);  // log2_min_luma_transform_block_size_minus2
+    put_ue(w, 3);  // log2_diff_max_min_luma_transform_block_size
+    put_ue(w, 0);  // max_transform_hierarchy_depth_inter
+    put_ue(w, 0);  // max_transform_hierarchy_depth_intra
+    put_bits(w, 0, 1);  // scaling_list_enabled_flag
+    put_bits(w, 0, 1);  // amp_enabled_flag
+    put_bits(w, 0, 1);  // sample_adaptive_offset_enabled_flag
+    put_bits(w, 0, 1);  // pcm_enabled_flag
+    put_ue(w, 0);  // num_short_term_ref_pic_sets
+    put_bits(w, 0, 1);  // long_term_ref_pics_present_flag
+    put_bits(w, 0, 1);  // sps_temporal_mvp_enabled_flag
+    put_bits(w, 0, 1);  // strong_intra_smoothing_enabled_flag
+    put_bits(w, 0, 1);  // vui_parameters_present_flag
+    put_bits(w, 0, 1);  // sps_extension_present_flag
+  }
+  put_trailing_bits(w);
+}
+
+static void
+write_pps(stream_generator_t *self)
+{
+  bit_writer_t *w = &self->rbsp;
+  if (self->config.codec == SV_CODEC_H264) {
+    put_nalu_header(self, 0x68, 0);
+    put_ue(w, 0);  // pic_parameter_set_id
+    put_ue(w, 0);  // seq_parameter_set_id
+    put_bits(w, 0, 1);  // entropy_coding_mode_flag, CAVLC
+    put_bits(w, 0, 1);  // bottom_field_pic_order_in_frame_present_flag
+    put_ue(w, 0);  // num_slice_groups_minus1
+    put_ue(w, 0);  // num_ref_idx_l0_default_active_minus1
+    put_ue(w, 0);  // num_ref_idx_l1_default_active_minus1
+    put_bits(w, 0, 1);  // weighted_pred_flag
+    put_bits(w, 0, 2);  // weighted_bipred_idc
+    put_se(w, 0);  // pic_init_qp_minus26
+    put_se(w, 0);  // pic_init_qs_minus26
+    put_se(w, 0);  // chroma_qp_index_offset
+    put_bits(w, 1, 1);  // deblocking_filter_control_present_flag
+    put_bits(w, 0, 1);  // constrained_intra_pred_flag
+    put_bits(w, 0, 1);  // redundant_pic_cnt_present_flag
+  } else {
+    put_nalu_header(self, 0, 34);
+    put_ue(w, 0);  // pps_pic_parameter_set_id
+    put_ue(w, 0);  // pps_seq_parameter_set_id
+    put_bits(w, 0, 1);  // dependent_slice_segments_enabled_flag
+    put_bits(w, 0, 1);  // output_flag_present_flag
+    put_bits(w, 0, 3);  // num_extra_slice_header_bits
+    put_bits(w, 0, 1);  // sign_data_hiding_enabled_flag
+    put_bits(w, 0, 1);  // cabac_init_present_flag
+    put_ue(w, 0);  // num_ref_idx_l0_default_active_minus1
+    put_ue(w, 0);  // num_ref_idx_l1_default_active_minus1
+    put_se(w, 0);  // init_qp_minus26
+    put_bits(w, 0, 1);  // constrained_intra_pred_flag
+    put_bits(w, 0, 1);  // transform_skip_enabled_flag
+    put_bits(w, 0, 1);  // cu_qp_delta_enabled_flag
+    put_se(w, 0);  // pps_cb_qp_offset
+    put_se(w, 0);  // pps_cr_qp_offset
+    put_bits(w, 0, 1);  // pps_slice_chroma_qp_offsets_present_flag
+    put_bits(w, 0, 1);  // weighted_pred_flag
+    put_bits(w, 0, 1);  // weighted_bipred_flag
+    put_bits(w, 0, 1);  // transquant_bypass_enabled_flag
+    put_bits(w, 0, 1);  // tiles_enabled_flag
+    put_bits(w, 0, 1);  // entropy_coding_sync_enabled_flag
+    put_bits(w, 0, 1);  // pps_loop_filter_across_slices_enabled_flag
+    put_bits(w, 0, 1);  // deblocking_filter_control_present_flag
+    put_bits(w, 0, 1);  // pps_scaling_list_data_present_flag
+    put_bits(w, 0, 1);  // lists_modification_present_flag
+    put_ue(w, 0);  // log2_parallel_merge_level_minus2
+    put_bits(w, 0, 1);  // slice_segment_header_extension_present_flag
+    put_bits(w, 0, 1);  // pps_extension_present_flag
+  }
+  put_trailing_bits(w);
+}
+
+/* Writes a user data unregistered SEI with a UUID not belonging to Signed Video. */
+static void
+write_sei(stream_generator_t *self)
+{
+  bit_writer_t *w = &self->rbsp;
+  const uint8_t uuid[16] = {0xdc, 0x45, 0xe9, 0xbd, 0xe6, 0xd9, 0x48, 0xb7, 0x96, 0x2c, 0xd8, 0x20,
+      0xd9, 0x23, 0xee, 0xef};
+  put_nalu_header(self, 0x06, 39);
+  put_bits(w, 5, 8);  // payloadType, user_data_unregistered
+  put_bits(w, sizeof(uuid) + SEI_USER_DATA_SIZE, 8);  // payloadSize
+  for (size_t i = 0; i < sizeof(uuid); i++) put_bits(w, uuid[i], 8);
+  for (int i = 0; i < SEI_USER_DATA_SIZE; i++) put_bits(w, next_random(self) & 0xff, 8);
+  put_trailing_bits(w);
+}
+
+/* Writes st_ref_pic_set() of H.265 in the slice header, referring to the reference frames
+ * before, and for B-frames after, the current frame. */
+static void
+put_short_term_ref_pic_set(stream_generator_t *self)
+{
+  bit_writer_t *w = &self->rbsp;
+  const bool is_b_frame = self->frame_type == FRAME_B;
+  put_ue(w, 1);  // num_negative_pics
+  put_ue(w, is_b_frame ? 1 : 0);  // num_positive_pics
+  put_ue(w, self->display_idx - self->prev_ref_display_idx - 1);  // delta_poc_s0_minus1[0]
+  put_bits(w, 1, 1);  // used_by_curr_pic_s0_flag[0]
+  if (is_b_frame) {
+    put_ue(w, self->next_ref_display_idx - self->display_idx - 1);  // delta_poc_s1_minus1[0]
+    put_bits(w, 1, 1);  // used_by_curr_pic_s1_flag[0]
+  }
+}
+
+static void
+write_slice(stream_generator_t *self, unsigned slice)
+{
+  bit_writer_t *w = &self->rbsp;
+  const stream_generator_config_t *config = &self->config;
+  const frame_type_t type = self->frame_type;
+  if (config->codec == SV_CODEC_H264) {
+    const unsigned num_mbs = ((config->width + 15) / 16) * ((config->height + 15) / 16);
+    // IDR with nal_ref_idc 3, P with nal_ref_idc 2, and non-reference B.
+    put_nalu_header(self, type == FRAME_I ? 0x65 : type == FRAME_P ? 0x41 : 0x01, 0);
+    put_ue(w, slice * num_mbs / config->num_slices);  // first_mb_in_slice
+    put_ue(w, type == FRAME_I ? 7 : type == FRAME_P ? 5 : 6);  // slice_type
+    put_ue(w, 0);  // pic_parameter_set_id
+    put_bits(w, self->frame_num, LOG2_MAX_FRAME_NUM);  // frame_num
+    if (type == FRAME_I) put_ue(w, self->idr_pic_id);  // idr_pic_id
+    put_bits(w, (2 * self->display_idx) % (1 << LOG2_MAX_POC_LSB),
+        LOG2_MAX_POC_LSB);  // pic_order_cnt_lsb
+    if (type == FRAME_B) put_bits(w, 1, 1);  // direct_spatial_mv_pred_flag
+    if (type != FRAME_I) {
+      put_bits(w, 0, 1);  // num_ref_idx_active_override_flag
+      put_bits(w, 0, 1);  // ref_pic_list_modification_flag_l0
+    }
+    if (type == FRAME_B) put_bits(w, 0, 1);  // ref_pic_list_modification_flag_l1
+    // dec_ref_pic_marking() of reference pictures.
+    if (type == FRAME_I) {
+      put_bits(w, 0, 1);  // no_output_of_prior_pics_flag
+      put_bits(w, 0, 1);  // long_term_reference_flag
+    } else if (type == FRAME_P) {
+      put_bits(w, 0, 1);  // adaptive_ref_pic_marking_mode_flag
+    }
+    put_se(w, 0);  // slice_qp_delta
+    put_ue(w, 0);  // disable_deblocking_filter_idc
+    put_se(w, 0);  // slice_alpha_c0_offset_div2
+    put_se(w, 0);  // slice_beta_offset_div2
+  } else {
+    const unsigned coded_width = (config->width + 7) / 8 * 8;
+    const unsigned coded_height = (config->height + 7) / 8 * 8;
+    const unsigned num_ctbs = ((coded_width + H265_CTB_SIZE - 1) / H265_CTB_SIZE) *
+        ((coded_height + H265_CTB_SIZE - 1) / H265_CTB_SIZE);
+    // IDR_W_RADL, TRAIL_R and TRAIL_N.
+    put_nalu_header(self, 0, type == FRAME_I ? 19 : type == FRAME_P ? 1 : 0);
+    put_bits(w, slice == 0, 1);  // first_slice_segment_in_pic_flag
+    if (type == FRAME_I) put_bits(w, 0, 1);  // no_output_of_prior_pics_flag
+    put_ue(w, 0);  // slice_pic_parameter_set_id
+    if (slice > 0) {
+      put_bits(w, slice * num_ctbs / config->num_slices, ceil_log2(num_ctbs));  // slice_address
+    }
+    put_ue(w, type == FRAME_I ? 2 : type == FRAME_P ? 1 : 0);  // slice_type
+    if (type != FRAME_I) {
+      put_bits(w, self->display_idx % (1 << LOG2_MAX_POC_LSB),
+          LOG2_MAX_POC_LSB);  // slice_pic_order_cnt_lsb
+      put_bits(w, 0, 1);  // short_term_ref_pic_set_sps_flag
+      put_short_term_ref_pic_set(self);
+      put_bits(w, 0, 1);  // num_ref_idx_active_override_flag
+      if (type == FRAME_B) put_bits(w, 0, 1);  // mvd_l1_zero_flag
+      put_ue(w, 0);  // five_minus_max_num_merge_cand
+    }
+    put_se(w, 0);  // slice_qp_delta
+    // byte_alignment()
+    put_bit(w, 1);
+    while (w->bit_pos != 0) put_bit(w, 0);
+  }
+
+  // The slice data, first completing the byte of the header.
+  const size_t mean_size = (type == FRAME_I ? self->i_frame_size
+                                : type == FRAME_P ? self->p_frame_size
+                                                  : self->p_frame_size / 2) /
+      config->num_slices;
+  const size_t size = draw_size(self, mean_size);
+  while (w->bit_pos != 0) put_bit(w, next_random(self) & 1);
+  if (!reserve(w, w->size + size + 1)) return;
+  const size_t end = w->size + size;
+  while (w->size < end) {
+    const bool is_zero =
+        config->zero_byte_rate > 0.0 && next_uniform(self) < config->zero_byte_rate;
+    w->data[w->size++] = is_zero ? 0x00 : (uint8_t)next_random(self);
+  }
+  put_trailing_bits(w);
+}
+
+/* Copies the RBSP to the NALU with a start code, inserting emulation prevention bytes. */
+static bool
+apply_emulation_prevention(stream_generator_t *self)
+{
+  const bit_writer_t *rbsp = &self->rbsp;
+  // At most one emulation prevention byte per two bytes.
+  const size_t max_size = START_CODE_SIZE + rbsp->size + rbsp->size / 2 + 1;
+  if (max_size > self->nalu_capacity) {
+    uint8_t *nalu = realloc(self->nalu, max_size);
+    if (!nalu) return false;
+    self->nalu = nalu;
+    self->nalu_capacity = max_size;
+  }
+
+  const uint8_t start_code[START_CODE_SIZE] = {0x00, 0x00, 0x00, 0x01};
+  memcpy(self->nalu, start_code, START_CODE_SIZE);
+  size_t size = START_CODE_SIZE;
+  int num_zeros = 0;
+  for (size_t i = 0; i < rbsp->size; i++) {
+    const uint8_t byte = rbsp->data[i];
+    if (num_zeros >= 2 && byte <= 0x03) {
+      self->nalu[size++] = 0x03;
+      self->stats.num_emulation_prevention_bytes++;
+      num_zeros = 0;
+    }
+    self->nalu[size++] = byte;
+    num_zeros = byte == 0x00 ? num_zeros + 1 : 0;
+  }
+  self->nalu_size = size;
+
+  return true;
+}
+
+/* Sets up the next access unit. */
+static void
+start_access_unit(stream_generator_t *self)
+{
+  const stream_generator_config_t *config = &self->config;
+  const unsigned gop_idx = self->frame / config->gop_length;
+  const unsigned pos = self->frame % config->gop_length;
+  const unsigned group_size = config->num_b_frames + 1;
+  if (pos == 0) {
+    self->frame_type = FRAME_I;
+    self->display_idx = 0;
+    self->frame_num = 0;
+    self->prev_ref_frame_num = 0;
+    if (self->frame > 0) self->idr_pic_id = (self->idr_pic_id + 1) % 65536;
+  } else {
+    // In decoding order a P-frame is followed by the B-frames before it in output order.
+    const unsigned group = (pos - 1) / group_size;
+    const unsigned group_pos = (pos - 1) % group_size;
+    self->frame_type = group_pos == 0 ? FRAME_P : FRAME_B;
+    self->prev_ref_display_idx = group * group_size;
+    self->next_ref_display_idx = (group + 1) * group_size;
+    self->display_idx = self->frame_type == FRAME_P ? self->next_ref_display_idx
+                                                    : self->prev_ref_display_idx + group_pos;
+    self->frame_num = (self->prev_ref_frame_num + 1) % (1 << LOG2_MAX_FRAME_NUM);
+    if (self->frame_type == FRAME_P) self->prev_ref_frame_num = self->frame_num;
+  }
+
+  self->num_nalus = 0;
+  self->nalu_idx = 0;
+  if (config->with_aud) self->nalus[self->num_nalus++] = NALU_AUD;
+  const bool has_parameter_sets = pos == 0 &&
+      (gop_idx == 0 ||
+          (config->parameter_set_interval > 0 && gop_idx % config->parameter_set_interval == 0));
+  if (has_parameter_sets) {
+    if (config->codec == SV_CODEC_H265) self->nalus[self->num_nalus++] = NALU_VPS;
+    self->nalus[self->num_nalus++] = NALU_SPS;
+    self->nalus[self->num_nalus++] = NALU_PPS;
+  }
+  if (config->sei_interval > 0 && self->frame % config->sei_interval == 0) {
+    self->nalus[self->num_nalus++] = NALU_SEI;
+  }
+}
+
+stream_generator_config_t
+stream_generator_get_default_config(SignedVideoCodec codec)
+{
+  stream_generator_config_t config = {0};
+  config.codec = codec;
+  config.width = 1920;
+  config.height = 1080;
+  config.num_frames = 600;
+  config.gop_length = 60;
+  config.num_slices = 1;
+  config.size_distribution = SIZE_DISTRIBUTION_NORMAL;
+  config.size_deviation = 0.1;
+  config.parameter_set_interval = 1;
+  config.seed = 0x12345678;
+
+  return config;
+}
+
+stream_generator_t *
+stream_generator_create(const stream_generator_config_t *config)
+{
+  if (!config || config->codec >= SV_CODEC_NUM || config->width < 2 || config->height < 2 ||
+      config->width % 2 || config->height % 2 || config->gop_length == 0 ||
+      config->num_slices == 0 || config->size_deviation < 0.0 || config->zero_byte_rate < 0.0 ||
+      config->zero_byte_rate > 1.0) {
+    return NULL;
+  }
+
+  stream_generator_t *self = calloc(1, sizeof(stream_generator_t));
+  if (!self) return NULL;
+  self->config = *config;
+  self->i_frame_size = config->i_frame_size
+      ? config->i_frame_size
+      : (size_t)((double)config->width * config->height * BITS_PER_PIXEL_I / 8);
+  self->p_frame_size =
+      config->p_frame_size ? config->p_frame_size : self->i_frame_size / I_TO_P_SIZE_RATIO;
+  // A zero state would only generate zeros.
+  self->random_state = config->seed ? config->seed : 1;
+  start_access_unit(self);
+
+  return self;
+}
+
+void
+stream_generator_free(stream_generator_t *generator)
+{
+  if (!generator) return;
+
+  free(generator->rbsp.data);
+  free(generator->nalu);
+  free(generator);
+}
+
+bool
+stream_generator_get_next_nalu(stream_generator_t *generator, stream_generator_nalu_t *nalu)
+{
+  if (!generator || !nalu) return false;
+  stream_generator_t *self = generator;
+  if (self->nalu_idx >= self->num_nalus + self->config.num_slices) {
+    self->frame++;
+    start_access_unit(self);
+  }
+  if (self->frame >= self->config.num_frames) return false;
+
+  self->rbsp.size = 0;
+  self->rbsp.bit_pos = 0;
+  const nalu_kind_t kind =
+      self->nalu_idx < self->num_nalus ? self->nalus[self->nalu_idx] : NALU_SLICE;
+  const unsigned slice = self->nalu_idx - self->num_nalus;
+  const char frame_types[] = {'I', 'P', 'B'};
+  char type = 'V';
+  switch (kind) {
+    case NALU_AUD:
+      write_aud(self);
+      type = 'A';
+      break;
+    case NALU_VPS:
+      write_vps(self);
+      break;
+    case NALU_SPS:
+      write_sps(self);
+      break;
+    case NALU_PPS:
+      write_pps(self);
+      break;
+    case NALU_SEI:
+      write_sei(self);
+      type = 'S';
+      break;
+    default:
+      write_slice(self, slice);
+      type = frame_types[self->frame_type];
+      // Lower case for all but the first slice.
+      if (slice > 0) type += 'a' - 'A';
+      break;
+  }
+  self->nalu_idx++;
+  if (self->rbsp.has_failed || !apply_emulation_prevention(self)) return false;
+
+  nalu->data = self->nalu;
+  nalu->data_size = self->nalu_size;
+  nalu->frame = self->frame;
+  nalu->type = type;
+  self->stats.num_nalus++;
+  self->stats.num_bytes += nalu->data_size;
+
+  return true;
+}
+
+bool
+stream_generator_write_file(stream_generator_t *generator, const char *path)
+{
+  if (!generator || !path) return false;
+
+  FILE *file = fopen(path, "wb");
+  if (!file) return false;
+  stream_generator_nalu_t nalu = {0};
+  bool success = true;
+  while (success && stream_generator_get_next_nalu(generator, &nalu)) {
+    success = fwrite(nalu.data, 1, nalu.data_size, file) == nalu.data_size;
+  }
+  if (fclose(file) != 0) success = false;
+
+  return success;
+}
+
+void
+stream_generator_get_stats(const stream_generator_t *generator, stream_generator_stats_t *stats)
+{
+  if (!generator || !stats) return;
+
+  *stats = generator->stats;
+}
@@ -0,0 +1,113 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2023 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next paragraph) shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef __STREAM_GENERATOR_H__
+#define __STREAM_GENERATOR_H__
+
+#include <stdbool.h>  // bool
+#include <stdint.h>  // uint8_t, uint32_t, uint64_t
+#include <string.h>  // size_t
+
+#include "lib/src/includes/signed_video_common.h"  // SignedVideoCodec
+
+/* A generator of synthetic H.264 and H.265 streams in Annex B format, for benchmarks. Unlike the
+ * NALUs of nalu_list.c the streams resemble real ones. The parameter sets (VPS, SPS and PPS) and
+ * the slice headers are written bit by bit according to the standards, and the slice data is
+ * random, with emulation prevention applied. Only the slice data can not be decoded.
+ *
+ * The stream is generated in decoding order. A GOP starts with an IDR picture. It is followed by
+ * P-pictures, each followed by |num_b_frames| non-reference B-pictures. The parameter sets start
+ * every |parameter_set_interval| GOP, and an AUD may start each access unit. A user data
+ * unregistered SEI, not belonging to Signed Video, may be added before the picture of every
+ * |sei_interval| frame.
+ *
+ * The mean sizes of the pictures are derived from the resolution, unless set. The size of each
+ * slice then varies according to |size_distribution|. The same configuration, including |seed|,
+ * always generates the same stream. */
+
+typedef enum {
+  SIZE_DISTRIBUTION_FIXED = 0,
+  SIZE_DISTRIBUTION_UNIFORM,  // Uniform in mean * (1 +- |size_deviation|).
+  SIZE_DISTRIBUTION_NORMAL,  // Normal with a standard deviation of mean * |size_deviation|.
+} size_distribution_t;
+
+typedef struct {
+  SignedVideoCodec codec;
+  unsigned width;
+  unsigned height;
+  unsigned num_frames;
+  unsigned gop_length;  // Frames per GOP.
+  unsigned num_b_frames;  // B-frames after each P-frame.
+  unsigned num_slices;  // Slices per frame.
+  size_t i_frame_size;  // Mean size of an I-frame in bytes. 0 derives it from the resolution.
+  size_t p_frame_size;  // Mean size of a P-frame in bytes. 0 derives it from the I-frame. B-frames
+  // are half the size of P-frames.
+  size_distribution_t size_distribution;
+  double size_deviation;
+  double zero_byte_rate;  // Rate of extra zero bytes in the slice data, in [0, 1]. Raises the
+  // density of emulation prevention bytes above that of random data.
+  unsigned parameter_set_interval;  // In GOPs. 0 only adds parameter sets to the first GOP.
+  bool with_aud;  // Start each access unit with an access unit delimiter.
+  unsigned sei_interval;  // In frames. 0 adds no SEIs.
+  uint32_t seed;
+} stream_generator_config_t;
+
+/* A generated NALU. */
+typedef struct {
+  const uint8_t *data;  // The NALU including a 4 bytes start code, owned by the generator.
+  size_t data_size;
+  unsigned frame;  // The frame, in decoding order, the NALU belongs to.
+  char type;  // As in nalu_list.h; 'I', 'P' or 'B' for a first slice, 'i', 'p' or 'b' for other
+  // slices, 'V' for parameter sets, 'A' for AUDs and 'S' for SEIs.
+} stream_generator_nalu_t;
+
+typedef struct {
+  uint64_t num_nalus;
+  uint64_t num_bytes;
+  uint64_t num_emulation_prevention_bytes;
+} stream_generator_stats_t;
+
+typedef struct _stream_generator_t stream_generator_t;
+
+/* Gets the default configuration; 1080p with 60 frames GOPs of I- and P-frames. */
+stream_generator_config_t
+stream_generator_get_default_config(SignedVideoCodec codec);
+
+/* Creates a generator, or returns NULL if the |config| is invalid or upon failure. */
+stream_generator_t *
+stream_generator_create(const stream_generator_config_t *config);
+
+void
+stream_generator_free(stream_generator_t *generator);
+
+/* Generates the next NALU. The |nalu| data is valid until the next call. Returns false at the end
+ * of the stream, or upon failure. */
+bool
+stream_generator_get_next_nalu(stream_generator_t *generator, stream_generator_nalu_t *nalu);
+
+/* Writes the remaining NALUs to the file at |path|, as an Annex B byte stream. Returns false upon
+ * failure. */
+bool
+stream_generator_write_file(stream_generator_t *generator, const char *path);
+
+void
+stream_generator_get_stats(const stream_generator_t *generator, stream_generator_stats_t *stats);
+
+#endif  // __STREAM_GENERATOR_H__
@@ -19,13 +19,24 @@
  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 #include <check.h>  // START_TEST, END_TEST
+#include <pthread.h>  // pthread_create, pthread_join
 #include <stdint.h>  // uint8_t
 #include <stdlib.h>  // EXIT_SUCCESS, EXIT_FAILURE
 #include <string.h>  // strcmp
+#include <unistd.h>  // close, unlink, write
 
 #include "lib/src/includes/signed_video_auth.h"  // signed_video_authenticity_t
 #include "lib/src/includes/signed_video_common.h"  // signed_video_t
+#include "lib/src/includes/signed_video_counters.h"  // signed_video_get_counters()
+#include "lib/src/includes/signed_video_detached.h"  // signed_video_detached_sei_parse_record()
+#include "lib/src/includes/signed_video_gop_index.h"  // signed_video_gop_index_get_record()
+#include "lib/src/includes/signed_video_mp4.h"  // signed_video_mp4_open()
+#include "lib/src/includes/signed_video_result_store.h"  // signed_video_result_store_check()
+#include "lib/src/includes/signed_video_rtp.h"  // signed_video_rtp_depacketizer_create()
+#include "lib/src/includes/signed_video_service.h"  // signed_video_service_create()
 #include "lib/src/includes/signed_video_sign.h"  // signed_video_set_authenticity_level()
+#include "lib/src/includes/signed_video_trace.h"  // signed_video_trace_parse_record()
+#include "lib/src/includes/signed_video_ts.h"  // signed_video_ts_reader_create()
 #ifdef SV_VENDOR_AXIS_COMMUNICATIONS
 #include "lib/src/includes/signed_video_openssl.h"  // signed_video_generate_private_key()
 #include "lib/src/includes/sv_vendor_axis_communications.h"
@@ -56,6 +67,8 @@ struct validation_stats {
   int pending_nalus;
   int has_signature;
   bool public_key_has_changed;
+  int provisional_valid_gops;
+  int provisional_invalid_gops;
 };
 
 // TODO: Will be used in the future, when the authenticity report is being populated.
@@ -154,6 +167,8 @@ validate_nalu_list(signed_video_t *sv, nalu_list_t *list, struct validation_stat
   int pending_nalus = 0;
   int has_signature = 0;
   bool public_key_has_changed = false;
+  int provisional_valid_gops = 0;
+  int provisional_invalid_gops = 0;
   // Pop one NALU at a time.
   nalu_list_item_t *item = nalu_list_pop_first_item(list);
   while (item) {
@@ -161,7 +176,14 @@ validate_nalu_list(signed_video_t *sv, nalu_list_t *list, struct validation_stat
         signed_video_add_nalu_and_authenticate(sv, item->data, item->data_size, &auth_report);
     ck_assert_int_eq(rc, SV_OK);
 
-    if (auth_report) {
+    if (auth_report && auth_report->latest_validation.is_provisional) {
+      // Early verdicts are followed by a final result, hence counted separately.
+      latest = &(auth_report->latest_validation);
+      if (latest->authenticity == SV_AUTH_RESULT_OK) provisional_valid_gops++;
+      if (latest->authenticity == SV_AUTH_RESULT_NOT_OK) provisional_invalid_gops++;
+      latest = NULL;
+      signed_video_authenticity_report_free(auth_report);
+    } else if (auth_report) {
       latest = &(auth_report->latest_validation);
       ck_assert(latest);
       if (latest->number_of_expected_picture_nalus >= 0) {
@@ -220,6 +242,8 @@ validate_nalu_list(signed_video_t *sv, nalu_list_t *list, struct validation_stat
   ck_assert_int_eq(pending_nalus, expected.pending_nalus);
   ck_assert_int_eq(has_signature, expected.has_signature);
   ck_assert_int_eq(public_key_has_changed, expected.public_key_has_changed);
+  ck_assert_int_eq(provisional_valid_gops, expected.provisional_valid_gops);
+  ck_assert_int_eq(provisional_invalid_gops, expected.provisional_invalid_gops);
 
   if (internal_sv) signed_video_free(sv);
 }
@@ -1226,6 +1250,65 @@ START_TEST(fast_forward_stream_without_reset)
 }
 END_TEST
 
+/* Test description
+ * Scrubbing with signed_video_reset_after_seek(...) keeps the public key and skips the verdict of
+ * the GOP before the seek point. The first report after the seek is a definitive verdict of the
+ * first complete GOP.
+ *
+ * The operation is as follows:
+ * 1. Generate a NALU list with a sequence of signed GOPs.
+ * 2. Validate the first two GOPs.
+ * 3. Mimic a seek to the access unit of a later GOP, that is, the SEI preceding the I-NALU.
+ * 4. Reset the session after the seek, and validate.
+ */
+START_TEST(fast_forward_stream_with_reset_after_seek)
+{
+  // This test runs in a loop with loop index _i, corresponding to struct sv_setting _i in
+  // |settings|; See signed_video_helpers.h.
+
+  signed_video_t *sv = signed_video_create(settings[_i].codec);
+  ck_assert(sv);
+  ck_assert_int_eq(signed_video_set_authenticity_level(sv, settings[_i].auth_level), SV_OK);
+  nalu_list_t *list = create_signed_nalus("IPPIPPIPPIPPIPPI", settings[_i]);
+  nalu_list_check_str(list, "GIPPGIPPGIPPGIPPGIPPGI");
+
+  nalu_list_t *pre_seek = nalu_list_pop(list, 6);
+  nalu_list_check_str(pre_seek, "GIPPGI");
+  struct validation_stats expected = {.valid_gops = 2, .pending_nalus = 2};
+  if (settings[_i].recurrence_offset == SV_RECURRENCE_OFFSET_THREE &&
+      settings[_i].recurrence == SV_RECURRENCE_EIGHT) {
+    // The public key has not yet arrived.
+    expected = (struct validation_stats){.has_signature = 2};
+  }
+  validate_nalu_list(sv, pre_seek, expected);
+  nalu_list_free(pre_seek);
+
+  // Seek to the SEI completing the third GOP: PPGIPP GIPPGIPPGI.
+  int remove_items = 6;
+  while (remove_items--) {
+    nalu_list_item_t *item = nalu_list_pop_first_item(list);
+    nalu_list_free_item(item);
+  }
+  nalu_list_check_str(list, "GIPPGIPPGI");
+
+  ck_assert_int_eq(signed_video_reset_after_seek(NULL), SV_INVALID_PARAMETER);
+  ck_assert_int_eq(signed_video_reset_after_seek(sv), SV_OK);
+  // The GOP before the seek point is not reported, and both complete GOPs are valid. One pending
+  // NALU per GOP.
+  expected = (struct validation_stats){.valid_gops = 2, .pending_nalus = 2};
+  if (settings[_i].recurrence_offset == SV_RECURRENCE_OFFSET_THREE &&
+      settings[_i].recurrence == SV_RECURRENCE_EIGHT) {
+    // No public key to keep. The pending GOPs are validated when the key arrives.
+    expected = (struct validation_stats){.valid_gops = 1, .pending_nalus = 1, .has_signature = 2};
+    if (settings[_i].auth_level == SV_AUTHENTICITY_LEVEL_GOP) expected.missed_nalus = 4;
+  }
+  validate_nalu_list(sv, list, expected);
+
+  nalu_list_free(list);
+  signed_video_free(sv);
+}
+END_TEST
+
 static nalu_list_t *
 mimic_au_fast_forward_on_late_seis_and_get_list(struct sv_setting setting)
 {
@@ -1491,6 +1574,40 @@ START_TEST(late_public_key_and_no_sei_before_key_arrives)
 }
 END_TEST
 
+/* Test description
+ * Check authentication if the public key arrives late and several GOPs are pending validation when
+ * it does. The signatures of those GOPs are then verified in parallel, but the result should be
+ * identical to validating them one by one.
+ *
+ * The operation is as follows:
+ * 1. Generate a nalu_list with a sequence of signed GOPs, where the public key is only sent every
+ *    12th frame, starting at frame 9.
+ * 2. Check the authentication result.
+ */
+START_TEST(late_public_key_with_many_pending_gops)
+{
+  // This test runs in a loop with loop index _i, corresponding to struct sv_setting _i in
+  // |settings|; See signed_video_helpers.h.
+
+  signed_video_t *sv = get_initialized_signed_video(settings[_i].codec, settings[_i].algo, false);
+  ck_assert(sv);
+  ck_assert_int_eq(signed_video_set_authenticity_level(sv, settings[_i].auth_level), SV_OK);
+  ck_assert_int_eq(signed_video_set_recurrence_interval_frames(sv, 12), SV_OK);
+  ck_assert_int_eq(signed_video_set_recurrence_offset(sv, 3), SV_OK);
+  nalu_list_t *list = create_signed_nalus_with_sv(sv, "IPPIPPIPPIPPIPPIPPIPPI");
+  ck_assert(list);
+  nalu_list_check_str(list, "GIPPGIPPGIPPGIPPGIPPGIPPGIPPGI");
+  signed_video_free(sv);
+
+  // The public key is first sent at frame 9, hence the first three GOPs have to wait for it. One
+  // pending NALU per GOP.
+  struct validation_stats expected = {.valid_gops = 5, .pending_nalus = 5, .has_signature = 3};
+  validate_nalu_list(NULL, list, expected);
+
+  nalu_list_free(list);
+}
+END_TEST
+
 /* Test description
  * Add some NALUs to a stream, where the last one is super long. Too long for
  * SV_AUTHENTICITY_LEVEL_FRAME to handle it. Note that in tests we run with a shorter max hash list
@@ -1534,6 +1651,409 @@ START_TEST(fallback_to_gop_level)
 }
 END_TEST
 
+/* Returns a signing session configured from |setting|, which adds an intermediate SEI every 4th
+ * frame. */
+static signed_video_t *
+get_signed_video_with_intermediate_seis(struct sv_setting setting)
+{
+  signed_video_t *sv = get_initialized_signed_video(setting.codec, setting.algo, false);
+  ck_assert(sv);
+  ck_assert_int_eq(signed_video_set_authenticity_level(sv, setting.auth_level), SV_OK);
+  ck_assert_int_eq(signed_video_set_recurrence_interval_frames(sv, setting.recurrence), SV_OK);
+#ifdef SV_UNIT_TEST
+  ck_assert_int_eq(signed_video_set_recurrence_offset(sv, setting.recurrence_offset), SV_OK);
+#endif
+  ck_assert_int_eq(signed_video_set_intermediate_sei_interval(sv, 4, 0), SV_OK);
+
+  return sv;
+}
+
+/* Test description
+ * Verify that intermediate SEIs split long GOPs into parts, which are validated one at a time.
+ * The operation is as follows:
+ * 1. Generate a nalu_list with two long GOPs and intermediate SEIs every 4th frame.
+ * 2. Validate the intact stream.
+ * 3. Generate the same stream, modify a P-NALU in the last part of the first GOP and validate.
+ * 4. Check the authentication results.
+ */
+START_TEST(intermediate_seis_in_long_gops)
+{
+  // This test runs in a loop with loop index _i, corresponding to struct sv_setting _i in
+  // |settings|; See signed_video_helpers.h.
+
+  signed_video_t *sv = get_signed_video_with_intermediate_seis(settings[_i]);
+  ck_assert(sv);
+  ck_assert_int_eq(signed_video_set_intermediate_sei_interval(NULL, 4, 0), SV_INVALID_PARAMETER);
+  ck_assert_int_eq(
+      signed_video_set_intermediate_sei_interval(sv, MAX_GOP_LENGTH + 1, 0), SV_NOT_SUPPORTED);
+
+  // Create a list of NALUs given the input string.
+  nalu_list_t *list = create_signed_nalus_with_sv(sv, "IPPPPPPPPPPPIPPPPPPPPPPPI");
+  nalu_list_check_str(list, "GIPPPGPPPPGPPPPGIPPPGPPPPGPPPPGI");
+
+  // One pending NALU per part of a GOP.
+  struct validation_stats expected = {.valid_gops = 7, .pending_nalus = 7};
+  // For Frame level the P-NALU following an intermediate SEI is identified, hence not pending.
+  if (settings[_i].auth_level == SV_AUTHENTICITY_LEVEL_FRAME) {
+    expected.pending_nalus = 3;
+  }
+  // The first two SEIs lack the public key and can therefore not be validated.
+  if (settings[_i].recurrence_offset == SV_RECURRENCE_OFFSET_THREE) {
+    if (settings[_i].recurrence == SV_RECURRENCE_EIGHT) {
+      expected.valid_gops = 5;
+      expected.pending_nalus = settings[_i].auth_level == SV_AUTHENTICITY_LEVEL_FRAME ? 2 : 5;
+      expected.has_signature = 2;
+    }
+  }
+  validate_nalu_list(NULL, list, expected);
+  nalu_list_free(list);
+
+  signed_video_free(sv);
+
+  // Start over with a new signing session.
+  sv = get_signed_video_with_intermediate_seis(settings[_i]);
+  ck_assert(sv);
+  list = create_signed_nalus_with_sv(sv, "IPPPPPPPPPPPIPPPPPPPPPPPI");
+  nalu_list_check_str(list, "GIPPPGPPPPGPPPPGIPPPGPPPPGPPPPGI");
+  // Third P-NALU in the last part of the first GOP: GIPPPGPPPPGPP P PGIPPPGPPPPGPPPPGI
+  modify_list_item(list, 13, "P");
+  // Only the modified part is invalid. For GOP level the linking to the next part is broken too.
+  struct validation_stats expected_modified = {
+      .valid_gops = 5, .invalid_gops = 2, .pending_nalus = 7};
+  if (settings[_i].auth_level == SV_AUTHENTICITY_LEVEL_FRAME) {
+    expected_modified.valid_gops = 6;
+    expected_modified.invalid_gops = 1;
+    expected_modified.pending_nalus = 3;
+  }
+  if (settings[_i].recurrence_offset == SV_RECURRENCE_OFFSET_THREE) {
+    if (settings[_i].recurrence == SV_RECURRENCE_EIGHT) {
+      expected_modified.valid_gops -= 2;
+      expected_modified.pending_nalus = expected.pending_nalus;
+      expected_modified.has_signature = 2;
+    }
+  }
+  validate_nalu_list(NULL, list, expected_modified);
+  nalu_list_free(list);
+
+  signed_video_free(sv);
+}
+END_TEST
+
+/* Pops all queued authenticity reports of |sv| and accumulates the results in |stats|. */
+static void
+pop_authenticity_reports(signed_video_t *sv, struct validation_stats *stats)
+{
+  signed_video_authenticity_t *auth_report = signed_video_pop_authenticity_report(sv);
+  while (auth_report) {
+    signed_video_latest_validation_t *latest = &(auth_report->latest_validation);
+    if (latest->authenticity == SV_AUTH_RESULT_OK) stats->valid_gops++;
+    if (latest->authenticity == SV_AUTH_RESULT_NOT_OK) stats->invalid_gops++;
+    if (latest->authenticity == SV_AUTH_RESULT_SIGNATURE_PRESENT) stats->has_signature++;
+    stats->pending_nalus += latest->number_of_pending_picture_nalus;
+    signed_video_authenticity_report_free(auth_report);
+    auth_report = signed_video_pop_authenticity_report(sv);
+  }
+}
+
+static void
+check_popped_stats(struct validation_stats stats, struct validation_stats expected)
+{
+  ck_assert_int_eq(stats.valid_gops, expected.valid_gops);
+  ck_assert_int_eq(stats.invalid_gops, expected.invalid_gops);
+  ck_assert_int_eq(stats.pending_nalus, expected.pending_nalus);
+  ck_assert_int_eq(stats.has_signature, expected.has_signature);
+}
+
+/* Test description
+ * Verify that NALUs added with sequence numbers from several threads, in any order, are validated
+ * as if they were added in order through signed_video_add_nalu_and_authenticate(...).
+ * The operation is as follows:
+ * 1. Generate a nalu_list with a sequence of signed GOPs.
+ * 2. Let a number of producer threads add every n:th NALU with its sequence number, in reversed
+ *    order.
+ * 3. Pop the authenticity reports and check the results.
+ */
+#define NUM_PRODUCERS 4
+
+struct producer {
+  signed_video_t *sv;
+  nalu_list_item_t **items;
+  int num_items;
+  int first_item;
+  SignedVideoReturnCode rc;
+};
+
+static void *
+produce_sequenced_nalus(void *arg)
+{
+  struct producer *producer = (struct producer *)arg;
+  producer->rc = SV_OK;
+  int last_item = producer->first_item;
+  while (last_item + NUM_PRODUCERS < producer->num_items) last_item += NUM_PRODUCERS;
+  for (int i = last_item; i >= producer->first_item; i -= NUM_PRODUCERS) {
+    nalu_list_item_t *item = producer->items[i];
+    SignedVideoReturnCode rc = signed_video_add_sequenced_nalu_and_authenticate(
+        producer->sv, (uint64_t)i, item->data, item->data_size);
+    if (producer->rc == SV_OK) producer->rc = rc;
+  }
+  return NULL;
+}
+
+START_TEST(sequenced_nalus_from_concurrent_producers)
+{
+  // This test runs in a loop with loop index _i, corresponding to struct sv_setting _i in
+  // |settings|; See signed_video_helpers.h.
+
+  nalu_list_t *list = create_signed_nalus("IPPIPPIPPIPPIPPIPPI", settings[_i]);
+  nalu_list_check_str(list, "GIPPGIPPGIPPGIPPGIPPGIPPGI");
+  signed_video_t *sv = signed_video_create(settings[_i].codec);
+  ck_assert(sv);
+
+  nalu_list_item_t *items[26] = {0};
+  const int num_items = list->num_items;
+  ck_assert_int_eq(num_items, 26);
+  for (int i = 0; i < num_items; i++) items[i] = nalu_list_pop_first_item(list);
+
+  // Invalid parameters.
+  ck_assert_int_eq(signed_video_add_sequenced_nalu_and_authenticate(
+                       NULL, 0, items[0]->data, items[0]->data_size),
+      SV_INVALID_PARAMETER);
+  ck_assert_int_eq(
+      signed_video_add_sequenced_nalu_and_authenticate(sv, 0, NULL, items[0]->data_size),
+      SV_INVALID_PARAMETER);
+  ck_assert_int_eq(signed_video_add_sequenced_nalu_and_authenticate(sv, 0, items[0]->data, 0),
+      SV_INVALID_PARAMETER);
+  ck_assert(!signed_video_pop_authenticity_report(NULL));
+  ck_assert(!signed_video_pop_authenticity_report(sv));
+
+  pthread_t threads[NUM_PRODUCERS];
+  struct producer producers[NUM_PRODUCERS];
+  for (int i = 0; i < NUM_PRODUCERS; i++) {
+    producers[i] = (struct producer){sv, items, num_items, i, SV_OK};
+    ck_assert_int_eq(pthread_create(&threads[i], NULL, produce_sequenced_nalus, &producers[i]), 0);
+  }
+  for (int i = 0; i < NUM_PRODUCERS; i++) {
+    ck_assert_int_eq(pthread_join(threads[i], NULL), 0);
+    ck_assert_int_eq(producers[i].rc, SV_OK);
+  }
+  // A sequence number can only be added once.
+  ck_assert_int_eq(signed_video_add_sequenced_nalu_and_authenticate(
+                       sv, 0, items[0]->data, items[0]->data_size),
+      SV_NOT_SUPPORTED);
+
+  // One pending NALU per GOP.
+  struct validation_stats expected = {.valid_gops = 7, .pending_nalus = 7};
+  if (settings[_i].recurrence_offset == SV_RECURRENCE_OFFSET_THREE) {
+    if (settings[_i].recurrence == SV_RECURRENCE_EIGHT) {
+      expected.valid_gops = 5;
+      expected.pending_nalus = 5;
+      expected.has_signature = 2;
+    }
+  }
+  struct validation_stats stats = {0};
+  pop_authenticity_reports(sv, &stats);
+  check_popped_stats(stats, expected);
+
+  // After a reset the sequence numbers start over from 0.
+  ck_assert_int_eq(signed_video_reset(sv), SV_OK);
+  ck_assert_int_eq(signed_video_add_sequenced_nalu_and_authenticate(
+                       sv, 0, items[0]->data, items[0]->data_size),
+      SV_OK);
+
+  for (int i = 0; i < num_items; i++) nalu_list_free_item(items[i]);
+  nalu_list_free(list);
+  signed_video_free(sv);
+}
+END_TEST
+
+/* Test description
+ * Verify that a validation service validates many sessions in parallel, with the same results as
+ * validating each session on its own.
+ * The operation is as follows:
+ * 1. Generate one nalu_list with a sequence of signed GOPs per session.
+ * 2. Register the sessions to a service and add the NALUs of all sessions interleaved.
+ * 3. Flush the sessions, pop the authenticity reports and check the results.
+ */
+#define NUM_SERVICE_SESSIONS 5
+
+START_TEST(validation_service_with_many_sessions)
+{
+  // This test runs in a loop with loop index _i, corresponding to struct sv_setting _i in
+  // |settings|; See signed_video_helpers.h.
+
+  signed_video_service_t *service = signed_video_service_create(3);
+  ck_assert(service);
+  signed_video_service_t *other_service = signed_video_service_create(0);
+  ck_assert(other_service);
+  signed_video_t *sv[NUM_SERVICE_SESSIONS] = {0};
+  nalu_list_t *list[NUM_SERVICE_SESSIONS] = {0};
+  for (int n = 0; n < NUM_SERVICE_SESSIONS; n++) {
+    list[n] = create_signed_nalus("IPPIPPIPPIPPIPPIPPI", settings[_i]);
+    nalu_list_check_str(list[n], "GIPPGIPPGIPPGIPPGIPPGIPPGI");
+    sv[n] = signed_video_create(settings[_i].codec);
+    ck_assert(sv[n]);
+  }
+  nalu_list_item_t *item = nalu_list_get_item(list[0], 1);
+
+  // Invalid parameters.
+  ck_assert_int_eq(signed_video_service_add_session(NULL, sv[0]), SV_INVALID_PARAMETER);
+  ck_assert_int_eq(signed_video_service_add_session(service, NULL), SV_INVALID_PARAMETER);
+  ck_assert_int_eq(signed_video_service_add_nalu(service, sv[0], item->data, item->data_size),
+      SV_INVALID_PARAMETER);
+  ck_assert_int_eq(signed_video_service_flush(service, sv[0]), SV_INVALID_PARAMETER);
+  ck_assert_int_eq(signed_video_service_remove_session(service, sv[0]), SV_INVALID_PARAMETER);
+  for (int n = 0; n < NUM_SERVICE_SESSIONS; n++) {
+    ck_assert_int_eq(signed_video_service_add_session(service, sv[n]), SV_OK);
+  }
+  ck_assert_int_eq(signed_video_service_add_nalu(NULL, sv[0], item->data, item->data_size),
+      SV_INVALID_PARAMETER);
+  ck_assert_int_eq(signed_video_service_add_nalu(service, sv[0], NULL, item->data_size),
+      SV_INVALID_PARAMETER);
+  ck_assert_int_eq(
+      signed_video_service_add_nalu(service, sv[0], item->data, 0), SV_INVALID_PARAMETER);
+  // A session can only be registered once.
+  ck_assert_int_eq(signed_video_service_add_session(service, sv[0]), SV_NOT_SUPPORTED);
+  ck_assert_int_eq(signed_video_service_add_session(other_service, sv[0]), SV_NOT_SUPPORTED);
+  ck_assert_int_eq(signed_video_service_flush(other_service, sv[0]), SV_INVALID_PARAMETER);
+  // Workers may be adding NALUs to a registered session.
+  ck_assert_int_eq(signed_video_set_trace_sink(sv[0], NULL, NULL), SV_NOT_SUPPORTED);
+  // The counters can be read, and reset, while workers add NALUs.
+  sv_counters_t counters = {0};
+  sv_counters_t total_counters = {0};
+
+  // Add the NALUs of all sessions interleaved.
+  bool has_nalus = true;
+  while (has_nalus) {
+    has_nalus = false;
+    for (int n = 0; n < NUM_SERVICE_SESSIONS; n++) {
+      item = nalu_list_pop_first_item(list[n]);
+      if (!item) continue;
+      has_nalus = true;
+      ck_assert_int_eq(
+          signed_video_service_add_nalu(service, sv[n], item->data, item->data_size), SV_OK);
+      nalu_list_free_item(item);
+    }
+    ck_assert_int_eq(signed_video_get_counters(sv[0], &counters, true), SV_OK);
+    total_counters.num_i_nalus += counters.num_i_nalus;
+    total_counters.num_p_nalus += counters.num_p_nalus;
+    total_counters.num_sei_nalus += counters.num_sei_nalus;
+  }
+
+  // One pending NALU per GOP.
+  struct validation_stats expected = {.valid_gops = 7, .pending_nalus = 7};
+  if (settings[_i].recurrence_offset == SV_RECURRENCE_OFFSET_THREE) {
+    if (settings[_i].recurrence == SV_RECURRENCE_EIGHT) {
+      expected.valid_gops = 5;
+      expected.pending_nalus = 5;
+      expected.has_signature = 2;
+    }
+  }
+  for (int n = 0; n < NUM_SERVICE_SESSIONS; n++) {
+    ck_assert_int_eq(signed_video_service_flush(service, sv[n]), SV_OK);
+    struct validation_stats stats = {0};
+    pop_authenticity_reports(sv[n], &stats);
+    check_popped_stats(stats, expected);
+  }
+  // No NALU is lost or counted twice when resetting the counters: GIPPGIPPGIPPGIPPGIPPGIPPGI
+  ck_assert_int_eq(signed_video_get_counters(sv[0], &counters, false), SV_OK);
+  ck_assert_uint_eq(total_counters.num_i_nalus + counters.num_i_nalus, 7);
+  ck_assert_uint_eq(total_counters.num_p_nalus + counters.num_p_nalus, 12);
+  ck_assert_uint_eq(total_counters.num_sei_nalus + counters.num_sei_nalus, 7);
+
+  // Removed sessions can be registered to another service. The second session is freed while
+  // registered, which removes it from the service. The last session is left registered and removed
+  // when freeing the service.
+  ck_assert_int_eq(signed_video_service_remove_session(service, sv[0]), SV_OK);
+  ck_assert_int_eq(signed_video_service_remove_session(service, sv[0]), SV_INVALID_PARAMETER);
+  ck_assert_int_eq(signed_video_service_add_session(other_service, sv[0]), SV_OK);
+  ck_assert_int_eq(signed_video_service_remove_session(other_service, sv[0]), SV_OK);
+  signed_video_free(sv[1]);
+  sv[1] = NULL;
+  for (int n = 2; n < NUM_SERVICE_SESSIONS - 1; n++) {
+    ck_assert_int_eq(signed_video_service_remove_session(service, sv[n]), SV_OK);
+  }
+  signed_video_service_free(service);
+  signed_video_service_free(other_service);
+
+  for (int n = 0; n < NUM_SERVICE_SESSIONS; n++) {
+    nalu_list_free(list[n]);
+    signed_video_free(sv[n]);
+  }
+}
+END_TEST
+
+/* Test description
+ * Verify that early verdicts are given at SEI arrival for frame level signing, and that the final
+ * results are the same as without early verdicts.
+ * The operation is as follows:
+ * 1. Generate a nalu_list with a sequence of signed GOPs and validate it with early verdicts.
+ * 2. Generate a nalu_list with a modified P-NALU and validate it with early verdicts.
+ * 3. Check the provisional and final authentication results.
+ */
+START_TEST(early_verdict_at_sei_arrival)
+{
+  // This test runs in a loop with loop index _i, corresponding to struct sv_setting _i in
+  // |settings|; See signed_video_helpers.h.
+
+  const bool is_frame_level = (settings[_i].auth_level == SV_AUTHENTICITY_LEVEL_FRAME);
+  const bool has_late_public_key = (settings[_i].recurrence_offset == SV_RECURRENCE_OFFSET_THREE &&
+      settings[_i].recurrence == SV_RECURRENCE_EIGHT);
+
+  ck_assert_int_eq(signed_video_set_early_verdict(NULL, true), SV_INVALID_PARAMETER);
+
+  signed_video_t *sv = signed_video_create(settings[_i].codec);
+  ck_assert(sv);
+  ck_assert_int_eq(signed_video_set_early_verdict(sv, true), SV_OK);
+  nalu_list_t *list = create_signed_nalus("IPPIPPIPPIPPIPPIPPI", settings[_i]);
+  nalu_list_check_str(list, "GIPPGIPPGIPPGIPPGIPPGIPPGI");
+
+  // One pending NALU per GOP. No early verdict is given for the first validation, nor while
+  // waiting for the public key.
+  struct validation_stats expected = {.valid_gops = 7, .pending_nalus = 7};
+  if (is_frame_level) expected.provisional_valid_gops = 6;
+  if (has_late_public_key) {
+    expected.valid_gops = 5;
+    expected.pending_nalus = 5;
+    expected.has_signature = 2;
+    if (is_frame_level) expected.provisional_valid_gops = 4;
+  }
+  validate_nalu_list(sv, list, expected);
+  nalu_list_free(list);
+  signed_video_free(sv);
+
+  sv = signed_video_create(settings[_i].codec);
+  ck_assert(sv);
+  ck_assert_int_eq(signed_video_set_early_verdict(sv, true), SV_OK);
+  list = create_signed_nalus("IPPIPPPIPPI", settings[_i]);
+  nalu_list_check_str(list, "GIPPGIPPPGIPPGI");
+  // Second P-NALU in first non-empty GOP: GIP P GIPPPGIPPGI
+  modify_list_item(list, 4, "P");
+
+  // Same final results as in test modify_one_p_nalu.
+  struct validation_stats expected_modified = {
+      .valid_gops = 2, .invalid_gops = 2, .pending_nalus = 4};
+  if (is_frame_level) {
+    expected_modified.valid_gops = 3;
+    expected_modified.invalid_gops = 1;
+    expected_modified.provisional_valid_gops = 2;
+    expected_modified.provisional_invalid_gops = 1;
+  }
+  if (has_late_public_key) {
+    expected_modified.valid_gops = 1;
+    expected_modified.invalid_gops = 1;
+    expected_modified.pending_nalus = 2;
+    expected_modified.has_signature = 2;
+    // Only the last GOP is validated after the public key has arrived.
+    expected_modified.provisional_valid_gops = is_frame_level ? 1 : 0;
+    expected_modified.provisional_invalid_gops = 0;
+  }
+  validate_nalu_list(sv, list, expected_modified);
+  nalu_list_free(list);
+
+  signed_video_free(sv);
+}
+END_TEST
+
 #ifdef SV_VENDOR_AXIS_COMMUNICATIONS
 /* Test description
  * APIs in vendors/axis-communications are used and tests both signing and validation parts. */
@@ -1625,6 +2145,1595 @@ START_TEST(vendor_axis_communications_operation)
 END_TEST
 #endif
 
+/* A GOP index sink storing the records back to back in a gop_index_t. */
+typedef struct {
+  uint8_t data[10 * SV_GOP_INDEX_RECORD_SIZE];
+  size_t size;
+} gop_index_t;
+
+static void
+store_gop_index_record(const uint8_t *record, size_t record_size, void *user_data)
+{
+  gop_index_t *index = (gop_index_t *)user_data;
+  ck_assert_uint_le(index->size + record_size, sizeof(index->data));
+  memcpy(index->data + index->size, record, record_size);
+  index->size += record_size;
+}
+
+/* Concatenates all NALUs of |list| into one byte stream. */
+static uint8_t *
+get_bytestream(const nalu_list_t *list, size_t *size)
+{
+  *size = 0;
+  for (nalu_list_item_t *item = list->first_item; item; item = item->next) {
+    *size += item->data_size;
+  }
+  uint8_t *data = malloc(*size);
+  ck_assert(data);
+  uint8_t *data_ptr = data;
+  for (nalu_list_item_t *item = list->first_item; item; item = item->next) {
+    memcpy(data_ptr, item->data, item->data_size);
+    data_ptr += item->data_size;
+  }
+  return data;
+}
+
+/* A validation of a range of GOPs, run on a separate thread. */
+struct gop_range {
+  signed_video_t *sv;
+  const uint8_t *data;
+  size_t data_size;
+  const gop_index_t *index;
+  size_t first_record;
+  SignedVideoAuthenticityResult results[2];
+  size_t num_validated_gops;
+  SignedVideoReturnCode rc;
+};
+
+static void *
+validate_gop_range(void *arg)
+{
+  struct gop_range *range = (struct gop_range *)arg;
+  // The range starts at the SEI completing the GOP before the first GOP of the range.
+  sv_gop_index_record_t boundary = {0};
+  range->rc = signed_video_gop_index_get_record(
+      range->index->data, range->index->size, range->first_record - 1, &boundary);
+  if (range->rc != SV_OK) return NULL;
+  range->rc = signed_video_validate_gop_range(range->sv, range->data + boundary.sei_offset,
+      range->data_size - boundary.sei_offset, range->results, 2, &range->num_validated_gops);
+  return NULL;
+}
+
+/* Test description
+ * Verify that a range of GOPs in the middle of a stream can be validated with definitive verdicts,
+ * also when several ranges of the same data are validated concurrently.
+ * The operation is as follows:
+ * 1. Generate a signed stream with a GOP index and concatenate it into one byte stream.
+ * 2. Validate two ranges of two GOPs each on separate threads, located through the GOP index.
+ * 3. Modify a P-NALU in the last GOP of the second range and validate the range again.
+ */
+START_TEST(validate_gop_range_in_the_middle)
+{
+  // This test runs in a loop with loop index _i, corresponding to struct sv_setting _i in
+  // |settings|; See signed_video_helpers.h.
+
+  gop_index_t index = {0};
+  signed_video_t *sv = get_initialized_signed_video(settings[_i].codec, settings[_i].algo, false);
+  ck_assert(sv);
+  ck_assert_int_eq(signed_video_set_authenticity_level(sv, settings[_i].auth_level), SV_OK);
+  ck_assert_int_eq(signed_video_set_recurrence_interval_frames(sv, settings[_i].recurrence), SV_OK);
+#ifdef SV_UNIT_TEST
+  ck_assert_int_eq(signed_video_set_recurrence_offset(sv, settings[_i].recurrence_offset), SV_OK);
+#endif
+  ck_assert_int_eq(signed_video_set_gop_index_sink(sv, store_gop_index_record, &index), SV_OK);
+  nalu_list_t *list = create_signed_nalus_with_sv(sv, "IPPIPPIPPIPPIPPIPPI");
+  nalu_list_check_str(list, "GIPPGIPPGIPPGIPPGIPPGIPPGI");
+  signed_video_free(sv);
+  ck_assert_int_eq(index.size, 7 * SV_GOP_INDEX_RECORD_SIZE);
+
+  size_t data_size = 0;
+  uint8_t *data = get_bytestream(list, &data_size);
+  SignedVideoAuthenticityResult results[2] = {0};
+  size_t num_validated_gops = 0;
+  signed_video_t *svs[2] = {signed_video_create(settings[_i].codec),
+      signed_video_create(settings[_i].codec)};
+  ck_assert(svs[0] && svs[1]);
+  // Invalid parameters.
+  ck_assert_int_eq(signed_video_validate_gop_range(
+                       NULL, data, data_size, results, 2, &num_validated_gops),
+      SV_INVALID_PARAMETER);
+  ck_assert_int_eq(signed_video_validate_gop_range(
+                       svs[0], NULL, data_size, results, 2, &num_validated_gops),
+      SV_INVALID_PARAMETER);
+  ck_assert_int_eq(
+      signed_video_validate_gop_range(svs[0], data, data_size, NULL, 2, &num_validated_gops),
+      SV_INVALID_PARAMETER);
+  ck_assert_int_eq(
+      signed_video_validate_gop_range(svs[0], data, data_size, results, 0, &num_validated_gops),
+      SV_INVALID_PARAMETER);
+  ck_assert_int_eq(signed_video_validate_gop_range(svs[0], data, data_size, results, 2, NULL),
+      SV_INVALID_PARAMETER);
+
+  // The second and third GOPs, and the fourth and fifth GOPs, are signed by the SEIs of records 2
+  // and 3, and records 4 and 5, respectively.
+  pthread_t threads[2];
+  struct gop_range ranges[2];
+  for (int i = 0; i < 2; i++) {
+    ranges[i] = (struct gop_range){svs[i], data, data_size, &index, 2 + 2 * i, {0}, 0, SV_OK};
+    ck_assert_int_eq(pthread_create(&threads[i], NULL, validate_gop_range, &ranges[i]), 0);
+  }
+  for (int i = 0; i < 2; i++) {
+    ck_assert_int_eq(pthread_join(threads[i], NULL), 0);
+    ck_assert_int_eq(ranges[i].rc, SV_OK);
+    ck_assert_int_eq(ranges[i].num_validated_gops, 2);
+    ck_assert_int_eq(ranges[i].results[0], SV_AUTH_RESULT_OK);
+    ck_assert_int_eq(ranges[i].results[1], SV_AUTH_RESULT_OK);
+  }
+  free(data);
+
+  // First P-NALU in the GOP signed by record 5: GIPPGIPPGIPPGIPPGI P PGIPPGI
+  modify_list_item(list, 19, "P");
+  data = get_bytestream(list, &data_size);
+  ranges[1].data = data;
+  ranges[1].data_size = data_size;
+  validate_gop_range(&ranges[1]);
+  ck_assert_int_eq(ranges[1].rc, SV_OK);
+  ck_assert_int_eq(ranges[1].num_validated_gops, 2);
+  ck_assert_int_eq(ranges[1].results[0], SV_AUTH_RESULT_OK);
+  ck_assert_int_eq(ranges[1].results[1], SV_AUTH_RESULT_NOT_OK);
+
+  free(data);
+  nalu_list_free(list);
+  signed_video_free(svs[0]);
+  signed_video_free(svs[1]);
+}
+END_TEST
+
+/* Adds all NALUs of the |list| without consuming it, and counts the verdicts of the reports. */
+static void
+scrub_nalu_list(signed_video_t *sv, const nalu_list_t *list, int *valid_gops, int *invalid_gops)
+{
+  *valid_gops = 0;
+  *invalid_gops = 0;
+  ck_assert_int_eq(signed_video_reset(sv), SV_OK);
+  for (nalu_list_item_t *item = list->first_item; item; item = item->next) {
+    signed_video_authenticity_t *auth_report = NULL;
+    SignedVideoReturnCode rc =
+        signed_video_add_nalu_and_authenticate(sv, item->data, item->data_size, &auth_report);
+    ck_assert_int_eq(rc, SV_OK);
+    if (!auth_report) continue;
+    if (!auth_report->latest_validation.is_provisional) {
+      SignedVideoAuthenticityResult authenticity = auth_report->latest_validation.authenticity;
+      if (authenticity == SV_AUTH_RESULT_OK) (*valid_gops)++;
+      if (authenticity == SV_AUTH_RESULT_NOT_OK) (*invalid_gops)++;
+    }
+    signed_video_authenticity_report_free(auth_report);
+  }
+}
+
+/* Test description
+ * Scrubbing back over already validated content looks up the signature verifications in the
+ * verification cache. The verdicts are the same as without the cache, and modified content is
+ * still detected.
+ *
+ * The operation is as follows:
+ * 1. Generate a NALU list with a sequence of signed GOPs.
+ * 2. Validate the list repeatedly, with a reset in between, with and without the cache.
+ * 3. Modify a P-NALU and validate the list again.
+ */
+START_TEST(verification_cache_on_backward_scrubbing)
+{
+  // This test runs in a loop with loop index _i, corresponding to struct sv_setting _i in
+  // |settings|; See signed_video_helpers.h.
+
+  nalu_list_t *list = create_signed_nalus("IPPIPPIPPIPPI", settings[_i]);
+  nalu_list_check_str(list, "GIPPGIPPGIPPGIPPGI");
+
+  signed_video_t *sv = signed_video_create(settings[_i].codec);
+  ck_assert(sv);
+  ck_assert_int_eq(signed_video_set_authenticity_level(sv, settings[_i].auth_level), SV_OK);
+  ck_assert_int_eq(signed_video_set_verification_cache_size(NULL, 8), SV_INVALID_PARAMETER);
+
+  // The first pass receives the public key, which is kept upon reset, and fills the cache.
+  int valid_gops = 0;
+  int invalid_gops = 0;
+  scrub_nalu_list(sv, list, &valid_gops, &invalid_gops);
+  ck_assert_int_eq(invalid_gops, 0);
+  // The second pass gets the signature verifications from the cache.
+  scrub_nalu_list(sv, list, &valid_gops, &invalid_gops);
+  ck_assert_int_gt(valid_gops, 0);
+  ck_assert_int_eq(invalid_gops, 0);
+  // The verdicts are the same without the cache, and with a too small cache evicting outcomes
+  // before they are used again.
+  int uncached_valid_gops = 0;
+  int uncached_invalid_gops = 0;
+  ck_assert_int_eq(signed_video_set_verification_cache_size(sv, 0), SV_OK);
+  scrub_nalu_list(sv, list, &uncached_valid_gops, &uncached_invalid_gops);
+  ck_assert_int_eq(uncached_valid_gops, valid_gops);
+  ck_assert_int_eq(uncached_invalid_gops, 0);
+  ck_assert_int_eq(signed_video_set_verification_cache_size(sv, 1), SV_OK);
+  scrub_nalu_list(sv, list, &uncached_valid_gops, &uncached_invalid_gops);
+  ck_assert_int_eq(uncached_valid_gops, valid_gops);
+  ck_assert_int_eq(uncached_invalid_gops, 0);
+
+  // Modify a P-NALU of the second GOP. Its SEI is still in the cache, but the NALUs are hashed.
+  ck_assert_int_eq(signed_video_set_verification_cache_size(sv, 8), SV_OK);
+  scrub_nalu_list(sv, list, &valid_gops, &invalid_gops);
+  modify_list_item(list, 7, "P");
+  scrub_nalu_list(sv, list, &valid_gops, &invalid_gops);
+  ck_assert_int_gt(invalid_gops, 0);
+
+  signed_video_free(sv);
+  nalu_list_free(list);
+}
+END_TEST
+
+/* Adds |num_nalus| NALUs of the |list|, starting at |first_nalu|, and counts the reports. */
+static void
+add_nalus_and_count_reports(signed_video_t *sv,
+    nalu_list_t *list,
+    int first_nalu,
+    int num_nalus,
+    int *valid_gops,
+    int *has_signature)
+{
+  *valid_gops = 0;
+  *has_signature = 0;
+  for (int i = first_nalu; i < first_nalu + num_nalus; i++) {
+    nalu_list_item_t *item = nalu_list_get_item(list, i + 1);
+    signed_video_authenticity_t *auth_report = NULL;
+    SignedVideoReturnCode rc =
+        signed_video_add_nalu_and_authenticate(sv, item->data, item->data_size, &auth_report);
+    ck_assert_int_eq(rc, SV_OK);
+    if (!auth_report) continue;
+    SignedVideoAuthenticityResult authenticity = auth_report->latest_validation.authenticity;
+    ck_assert(authenticity != SV_AUTH_RESULT_NOT_OK);
+    if (authenticity == SV_AUTH_RESULT_OK) (*valid_gops)++;
+    if (authenticity == SV_AUTH_RESULT_SIGNATURE_PRESENT) (*has_signature)++;
+    signed_video_authenticity_report_free(auth_report);
+  }
+}
+
+/* Test description
+ * A validation paused with a checkpoint is resumed in a new session, with the same verdicts as
+ * validating the stream in one go.
+ *
+ * The operation is as follows:
+ * 1. Generate a NALU list with a sequence of signed GOPs.
+ * 2. Validate the list in one go as reference.
+ * 3. Validate the first part of the list and get a checkpoint.
+ * 4. Restore the checkpoint in a new session and validate the rest from the resume position.
+ */
+START_TEST(checkpoint_and_restore_validation)
+{
+  // This test runs in a loop with loop index _i, corresponding to struct sv_setting _i in
+  // |settings|; See signed_video_helpers.h.
+
+  nalu_list_t *list = create_signed_nalus("IPPIPPIPPIPPIPPI", settings[_i]);
+  nalu_list_check_str(list, "GIPPGIPPGIPPGIPPGIPPGI");
+  const int num_nalus = list->num_items;
+
+  signed_video_t *sv = signed_video_create(settings[_i].codec);
+  ck_assert(sv);
+  ck_assert_int_eq(signed_video_set_authenticity_level(sv, settings[_i].auth_level), SV_OK);
+  int valid_gops = 0;
+  int has_signature = 0;
+  add_nalus_and_count_reports(sv, list, 0, num_nalus, &valid_gops, &has_signature);
+  signed_video_free(sv);
+
+  // Pause in the middle of a GOP: GIPPGIPPGIP PGIPPGIPPGI.
+  sv = signed_video_create(settings[_i].codec);
+  ck_assert(sv);
+  ck_assert_int_eq(signed_video_set_authenticity_level(sv, settings[_i].auth_level), SV_OK);
+  int paused_valid_gops = 0;
+  int paused_has_signature = 0;
+  add_nalus_and_count_reports(sv, list, 0, 11, &paused_valid_gops, &paused_has_signature);
+  size_t checkpoint_size = 0;
+  uint64_t resume_nalu_idx = 0;
+  ck_assert_int_eq(
+      signed_video_get_checkpoint(NULL, NULL, &checkpoint_size, NULL), SV_INVALID_PARAMETER);
+  ck_assert_int_eq(signed_video_get_checkpoint(sv, NULL, NULL, NULL), SV_INVALID_PARAMETER);
+  ck_assert_int_eq(signed_video_get_checkpoint(sv, NULL, &checkpoint_size, NULL), SV_OK);
+  uint8_t *checkpoint = malloc(checkpoint_size);
+  ck_assert(checkpoint);
+  size_t too_small_size = checkpoint_size - 1;
+  ck_assert_int_eq(signed_video_get_checkpoint(sv, checkpoint, &too_small_size, NULL),
+      SV_INVALID_PARAMETER);
+  ck_assert_int_eq(
+      signed_video_get_checkpoint(sv, checkpoint, &checkpoint_size, &resume_nalu_idx), SV_OK);
+  signed_video_free(sv);
+  // The latest validated GOP was completed by the SEI at position 8, unless the public key has not
+  // yet arrived.
+  if (paused_valid_gops > 0) ck_assert_uint_eq(resume_nalu_idx, 8);
+
+  // Resume in a new session.
+  sv = signed_video_create(settings[_i].codec);
+  ck_assert(sv);
+  ck_assert_int_eq(signed_video_set_authenticity_level(sv, settings[_i].auth_level), SV_OK);
+  ck_assert_int_eq(
+      signed_video_restore_checkpoint(sv, NULL, checkpoint_size), SV_INVALID_PARAMETER);
+  ck_assert_int_eq(signed_video_restore_checkpoint(sv, checkpoint, 4), SV_INVALID_PARAMETER);
+  ck_assert_int_eq(
+      signed_video_restore_checkpoint(sv, checkpoint, checkpoint_size - 1), SV_INVALID_PARAMETER);
+  checkpoint[4]++;
+  ck_assert_int_eq(
+      signed_video_restore_checkpoint(sv, checkpoint, checkpoint_size), SV_INCOMPATIBLE_VERSION);
+  checkpoint[4]--;
+  ck_assert_int_eq(signed_video_restore_checkpoint(sv, checkpoint, checkpoint_size), SV_OK);
+  int resumed_valid_gops = 0;
+  int resumed_has_signature = 0;
+  add_nalus_and_count_reports(sv, list, (int)resume_nalu_idx, num_nalus - (int)resume_nalu_idx,
+      &resumed_valid_gops, &resumed_has_signature);
+  ck_assert_int_eq(paused_valid_gops + resumed_valid_gops, valid_gops);
+  // Nothing is reported twice.
+  ck_assert_int_eq(resumed_has_signature, paused_valid_gops > 0 ? 0 : has_signature);
+
+  free(checkpoint);
+  signed_video_free(sv);
+  nalu_list_free(list);
+}
+END_TEST
+
+/* Test description
+ * Verify that the results of a validated recording can be stored, and that a check of the stored
+ * results detects a modified SEI.
+ * The operation is as follows:
+ * 1. Generate a signed stream and concatenate it into one byte stream.
+ * 2. Validate the byte stream and store the results in a gop_index_t buffer.
+ * 3. Check the unmodified byte stream against the stored results.
+ * 4. Modify a SEI, and truncate the byte stream, and check them against the stored results.
+ */
+START_TEST(validate_and_store_results)
+{
+  // This test runs in a loop with loop index _i, corresponding to struct sv_setting _i in
+  // |settings|; See signed_video_helpers.h.
+
+  nalu_list_t *list = create_signed_nalus("IPPIPPIPPIPPIPPI", settings[_i]);
+  nalu_list_check_str(list, "GIPPGIPPGIPPGIPPGIPPGI");
+  size_t data_size = 0;
+  uint8_t *data = get_bytestream(list, &data_size);
+  nalu_list_free(list);
+
+  signed_video_t *sv = signed_video_create(settings[_i].codec);
+  ck_assert(sv);
+  ck_assert_int_eq(signed_video_set_authenticity_level(sv, settings[_i].auth_level), SV_OK);
+  gop_index_t store = {0};
+  ck_assert_int_eq(signed_video_validate_and_store_results(
+                       NULL, data, data_size, store_gop_index_record, &store),
+      SV_INVALID_PARAMETER);
+  ck_assert_int_eq(signed_video_validate_and_store_results(
+                       sv, NULL, data_size, store_gop_index_record, &store),
+      SV_INVALID_PARAMETER);
+  ck_assert_int_eq(signed_video_validate_and_store_results(sv, data, data_size, NULL, &store),
+      SV_INVALID_PARAMETER);
+  ck_assert_int_eq(signed_video_validate_and_store_results(
+                       sv, data, data_size, store_gop_index_record, &store),
+      SV_OK);
+  signed_video_free(sv);
+
+  // One record per SEI.
+  const size_t num_records = store.size / SV_RESULT_RECORD_SIZE;
+  ck_assert_int_eq(store.size, 6 * SV_RESULT_RECORD_SIZE);
+  sv_result_record_t record = {0};
+  ck_assert_int_eq(
+      signed_video_result_store_parse_record(store.data, SV_RESULT_RECORD_SIZE - 1, &record),
+      SV_INVALID_PARAMETER);
+  for (size_t i = 0; i < num_records; i++) {
+    ck_assert_int_eq(signed_video_result_store_parse_record(
+                         store.data + i * SV_RESULT_RECORD_SIZE, SV_RESULT_RECORD_SIZE, &record),
+        SV_OK);
+    ck_assert_uint_gt(record.sei_size, 0);
+    ck_assert_uint_le(record.sei_offset + record.sei_size, data_size);
+    // GOPs validated before the public key has arrived are stored as such.
+    if (i == num_records - 1) ck_assert_int_eq(record.authenticity, SV_AUTH_RESULT_OK);
+  }
+
+  size_t num_changed_records = 0;
+  ck_assert_int_eq(signed_video_result_store_check(NULL, data_size, store.data, store.size,
+                       &num_changed_records),
+      SV_INVALID_PARAMETER);
+  ck_assert_int_eq(signed_video_result_store_check(data, data_size, store.data,
+                       SV_RESULT_RECORD_SIZE - 1, &num_changed_records),
+      SV_INVALID_PARAMETER);
+  ck_assert_int_eq(
+      signed_video_result_store_check(data, data_size, store.data, store.size, NULL),
+      SV_INVALID_PARAMETER);
+  ck_assert_int_eq(signed_video_result_store_check(
+                       data, data_size, store.data, store.size, &num_changed_records),
+      SV_OK);
+  ck_assert_int_eq(num_changed_records, 0);
+
+  // Modify the last byte of the SEI of the second record, that is, a part of the signature.
+  ck_assert_int_eq(signed_video_result_store_parse_record(
+                       store.data + SV_RESULT_RECORD_SIZE, SV_RESULT_RECORD_SIZE, &record),
+      SV_OK);
+  data[record.sei_offset + record.sei_size - 2] ^= 0x01;
+  ck_assert_int_eq(signed_video_result_store_check(
+                       data, data_size, store.data, store.size, &num_changed_records),
+      SV_OK);
+  ck_assert_int_eq(num_changed_records, 1);
+  data[record.sei_offset + record.sei_size - 2] ^= 0x01;
+  // A truncated recording misses the SEIs of all records after the second one.
+  ck_assert_int_eq(signed_video_result_store_check(data, record.sei_offset + record.sei_size,
+                       store.data, store.size, &num_changed_records),
+      SV_OK);
+  ck_assert_int_eq(num_changed_records, num_records - 2);
+
+  free(data);
+}
+END_TEST
+
+/* A detached SEI sink storing the records back to back in a sidecar_t. */
+typedef struct {
+  uint8_t data[16384];
+  size_t size;
+} sidecar_t;
+
+static void
+store_detached_sei_record(const uint8_t *record, size_t record_size, void *user_data)
+{
+  sidecar_t *sidecar = (sidecar_t *)user_data;
+  ck_assert_uint_le(sidecar->size + record_size, sizeof(sidecar->data));
+  memcpy(sidecar->data + sidecar->size, record, record_size);
+  sidecar->size += record_size;
+}
+
+/* Adds all records of the |sidecar|, then all NALUs of the |list|, and counts the verdicts. */
+static void
+validate_with_sidecar(signed_video_t *sv,
+    const sidecar_t *sidecar,
+    nalu_list_t *list,
+    int *valid_gops,
+    int *invalid_gops)
+{
+  size_t offset = 0;
+  while (offset < sidecar->size) {
+    uint64_t nalu_idx = 0;
+    const uint8_t *sei = NULL;
+    size_t sei_size = 0;
+    ck_assert_int_eq(signed_video_detached_sei_parse_record(sidecar->data + offset,
+                         sidecar->size - offset, &nalu_idx, &sei, &sei_size),
+        SV_OK);
+    const size_t record_size = SV_DETACHED_SEI_HEADER_SIZE + sei_size;
+    ck_assert_int_eq(signed_video_add_detached_sei(sv, sidecar->data + offset, record_size), SV_OK);
+    offset += record_size;
+  }
+
+  *valid_gops = 0;
+  *invalid_gops = 0;
+  for (nalu_list_item_t *item = list->first_item; item; item = item->next) {
+    signed_video_authenticity_t *auth_report = NULL;
+    ck_assert_int_eq(
+        signed_video_add_nalu_and_authenticate(sv, item->data, item->data_size, &auth_report),
+        SV_OK);
+    if (!auth_report) continue;
+    SignedVideoAuthenticityResult authenticity = auth_report->latest_validation.authenticity;
+    if (authenticity == SV_AUTH_RESULT_OK) (*valid_gops)++;
+    if (authenticity == SV_AUTH_RESULT_NOT_OK) (*invalid_gops)++;
+    signed_video_authenticity_report_free(auth_report);
+  }
+}
+
+/* Test description
+ * Verify that a stream signed in detached mode, with the SEIs in a sidecar stream, is validated as
+ * the same stream with the SEIs added to the video.
+ * The operation is as follows:
+ * 1. Generate a signed stream with in-band SEIs and validate it as reference.
+ * 2. Generate the same stream in detached mode, and verify that the video has no SEIs.
+ * 3. Validate the video side by side with the sidecar, and compare with the reference.
+ * 4. Modify a P-NALU of the video and validate again.
+ */
+START_TEST(detached_seis_in_sidecar_stream)
+{
+  // This test runs in a loop with loop index _i, corresponding to struct sv_setting _i in
+  // |settings|; See signed_video_helpers.h.
+
+  nalu_list_t *list = create_signed_nalus("IPPIPPIPPIPPIPPI", settings[_i]);
+  nalu_list_check_str(list, "GIPPGIPPGIPPGIPPGIPPGI");
+  signed_video_t *sv = signed_video_create(settings[_i].codec);
+  ck_assert(sv);
+  ck_assert_int_eq(signed_video_set_authenticity_level(sv, settings[_i].auth_level), SV_OK);
+  int valid_gops = 0;
+  int has_signature = 0;
+  add_nalus_and_count_reports(sv, list, 0, list->num_items, &valid_gops, &has_signature);
+  signed_video_free(sv);
+  nalu_list_free(list);
+
+  sidecar_t sidecar = {0};
+  sv = get_initialized_signed_video(settings[_i].codec, settings[_i].algo, false);
+  ck_assert(sv);
+  ck_assert_int_eq(signed_video_set_authenticity_level(sv, settings[_i].auth_level), SV_OK);
+  ck_assert_int_eq(signed_video_set_recurrence_interval_frames(sv, settings[_i].recurrence), SV_OK);
+#ifdef SV_UNIT_TEST
+  ck_assert_int_eq(signed_video_set_recurrence_offset(sv, settings[_i].recurrence_offset), SV_OK);
+#endif
+  ck_assert_int_eq(signed_video_set_detached_sei_sink(NULL, store_detached_sei_record, &sidecar),
+      SV_INVALID_PARAMETER);
+  ck_assert_int_eq(
+      signed_video_set_detached_sei_sink(sv, store_detached_sei_record, &sidecar), SV_OK);
+  list = create_signed_nalus_with_sv(sv, "IPPIPPIPPIPPIPPI");
+  signed_video_free(sv);
+  // The video is left as is.
+  nalu_list_check_str(list, "IPPIPPIPPIPPIPPI");
+  ck_assert_uint_gt(sidecar.size, 0);
+
+  sv = signed_video_create(settings[_i].codec);
+  ck_assert(sv);
+  ck_assert_int_eq(signed_video_set_authenticity_level(sv, settings[_i].auth_level), SV_OK);
+  ck_assert_int_eq(signed_video_add_detached_sei(NULL, sidecar.data, sidecar.size),
+      SV_INVALID_PARAMETER);
+  ck_assert_int_eq(signed_video_add_detached_sei(sv, sidecar.data, SV_DETACHED_SEI_HEADER_SIZE),
+      SV_INVALID_PARAMETER);
+  int detached_valid_gops = 0;
+  int detached_invalid_gops = 0;
+  validate_with_sidecar(sv, &sidecar, list, &detached_valid_gops, &detached_invalid_gops);
+  ck_assert_int_eq(detached_valid_gops, valid_gops);
+  ck_assert_int_eq(detached_invalid_gops, 0);
+  signed_video_free(sv);
+
+  // First P-NALU in the third GOP: IPPIPPI P PIPPIPPIPPI
+  modify_list_item(list, 8, "P");
+  sv = signed_video_create(settings[_i].codec);
+  ck_assert(sv);
+  ck_assert_int_eq(signed_video_set_authenticity_level(sv, settings[_i].auth_level), SV_OK);
+  validate_with_sidecar(sv, &sidecar, list, &detached_valid_gops, &detached_invalid_gops);
+  ck_assert_int_gt(detached_invalid_gops, 0);
+  signed_video_free(sv);
+
+  nalu_list_free(list);
+}
+END_TEST
+
+/* Writes |value| in big endian to |data| at |*pos|. */
+static void
+write_u32(uint8_t *data, size_t *pos, uint32_t value)
+{
+  for (int i = 3; i >= 0; i--) data[(*pos)++] = (uint8_t)(value >> (8 * i));
+}
+
+/* Starts a box of |type|. Returns the position of the box, to be passed to end_box(). */
+static size_t
+begin_box(uint8_t *data, size_t *pos, const char *type)
+{
+  const size_t box_pos = *pos;
+  write_u32(data, pos, 0);  // The size is written by end_box().
+  memcpy(data + *pos, type, 4);
+  *pos += 4;
+  return box_pos;
+}
+
+static void
+end_box(uint8_t *data, size_t *pos, size_t box_pos)
+{
+  size_t size_pos = box_pos;
+  write_u32(data, &size_pos, (uint32_t)(*pos - box_pos));
+}
+
+/* Muxes the NALUs of |list| into an MP4 file with one access unit per sample, that is, a picture
+ * NALU together with any SEIs in front of it. The NALUs are stored with 4 bytes length prefixes. */
+static uint8_t *
+create_mp4(const nalu_list_t *list, size_t *mp4_size)
+{
+  uint8_t *data = calloc(1, 65536);
+  ck_assert(data);
+  uint32_t sample_sizes[MAX_NUM_ITEMS] = {0};
+  uint32_t sample_offsets[MAX_NUM_ITEMS] = {0};
+  uint32_t sync_samples[MAX_NUM_ITEMS] = {0};
+  int num_samples = 0;
+  int num_sync_samples = 0;
+  size_t pos = 0;
+
+  size_t box = begin_box(data, &pos, "mdat");
+  bool is_new_sample = true;
+  for (nalu_list_item_t *item = list->first_item; item; item = item->next) {
+    if (is_new_sample) {
+      sample_offsets[num_samples++] = (uint32_t)pos;
+      is_new_sample = false;
+    }
+    const size_t start_code_size = item->data[2] == 0x01 ? 3 : 4;
+    const size_t nalu_size = item->data_size - start_code_size;
+    write_u32(data, &pos, (uint32_t)nalu_size);
+    memcpy(data + pos, item->data + start_code_size, nalu_size);
+    pos += nalu_size;
+    sample_sizes[num_samples - 1] += (uint32_t)(4 + nalu_size);
+    // A sample ends with a picture NALU.
+    if (item->str_code[0] == 'I') sync_samples[num_sync_samples++] = (uint32_t)num_samples;
+    if (item->str_code[0] == 'I' || item->str_code[0] == 'P') is_new_sample = true;
+  }
+  end_box(data, &pos, box);
+
+  const size_t moov = begin_box(data, &pos, "moov");
+  const size_t trak = begin_box(data, &pos, "trak");
+  const size_t mdia = begin_box(data, &pos, "mdia");
+  box = begin_box(data, &pos, "hdlr");
+  write_u32(data, &pos, 0);  // Version and flags
+  write_u32(data, &pos, 0);  // Pre-defined
+  memcpy(data + pos, "vide", 4);
+  pos += 4 + 13;  // Handler type, reserved bytes and an empty name.
+  end_box(data, &pos, box);
+  const size_t minf = begin_box(data, &pos, "minf");
+  const size_t stbl = begin_box(data, &pos, "stbl");
+
+  box = begin_box(data, &pos, "stsd");
+  write_u32(data, &pos, 0);  // Version and flags
+  write_u32(data, &pos, 1);  // Entry count
+  const bool is_h264 = list->codec == SV_CODEC_H264;
+  const size_t entry = begin_box(data, &pos, is_h264 ? "avc1" : "hvc1");
+  pos += 78;  // VisualSampleEntry fields
+  const size_t config = begin_box(data, &pos, is_h264 ? "avcC" : "hvcC");
+  // An empty configuration with lengthSizeMinusOne = 3.
+  if (is_h264) {
+    data[pos] = 1;
+    data[pos + 4] = 0xff;
+    pos += 7;
+  } else {
+    data[pos] = 1;
+    data[pos + 21] = 0x0f;
+    pos += 23;
+  }
+  end_box(data, &pos, config);
+  end_box(data, &pos, entry);
+  end_box(data, &pos, box);
+
+  box = begin_box(data, &pos, "stsz");
+  write_u32(data, &pos, 0);  // Version and flags
+  write_u32(data, &pos, 0);  // Sample size, 0 since the samples have different sizes.
+  write_u32(data, &pos, num_samples);
+  for (int i = 0; i < num_samples; i++) write_u32(data, &pos, sample_sizes[i]);
+  end_box(data, &pos, box);
+
+  box = begin_box(data, &pos, "stsc");
+  write_u32(data, &pos, 0);  // Version and flags
+  write_u32(data, &pos, 1);  // Entry count
+  // One sample per chunk, starting at chunk 1.
+  write_u32(data, &pos, 1);
+  write_u32(data, &pos, 1);
+  write_u32(data, &pos, 1);
+  end_box(data, &pos, box);
+
+  box = begin_box(data, &pos, "stco");
+  write_u32(data, &pos, 0);  // Version and flags
+  write_u32(data, &pos, num_samples);
+  for (int i = 0; i < num_samples; i++) write_u32(data, &pos, sample_offsets[i]);
+  end_box(data, &pos, box);
+
+  box = begin_box(data, &pos, "stss");
+  write_u32(data, &pos, 0);  // Version and flags
+  write_u32(data, &pos, num_sync_samples);
+  for (int i = 0; i < num_sync_samples; i++) write_u32(data, &pos, sync_samples[i]);
+  end_box(data, &pos, box);
+
+  end_box(data, &pos, stbl);
+  end_box(data, &pos, minf);
+  end_box(data, &pos, mdia);
+  end_box(data, &pos, trak);
+  end_box(data, &pos, moov);
+  ck_assert_uint_le(pos, 65536);
+
+  *mp4_size = pos;
+  return data;
+}
+
+/* Test description
+ * Verify that the video track of an MP4 file can be validated, also in parallel parts.
+ * The operation is as follows:
+ * 1. Generate a signed stream and mux it into an MP4 file.
+ * 2. Open the file, from memory and from disk, and verify the detected codec.
+ * 3. Validate the file sequentially, and in three parallel parts.
+ * 4. Swap two sync samples in the file, which then is rejected.
+ * 5. Modify a P-NALU in the file and validate again.
+ */
+START_TEST(validate_mp4_file)
+{
+  // This test runs in a loop with loop index _i, corresponding to struct sv_setting _i in
+  // |settings|; See signed_video_helpers.h.
+
+  nalu_list_t *list = create_signed_nalus("IPPIPPIPPIPPIPPI", settings[_i]);
+  nalu_list_check_str(list, "GIPPGIPPGIPPGIPPGIPPGI");
+  size_t mp4_size = 0;
+  uint8_t *mp4_data = create_mp4(list, &mp4_size);
+
+  sv_mp4_t *mp4 = NULL;
+  ck_assert_int_eq(signed_video_mp4_open_buffer(NULL, mp4_size, &mp4), SV_INVALID_PARAMETER);
+  ck_assert_int_eq(signed_video_mp4_open_buffer(mp4_data, mp4_size, NULL), SV_INVALID_PARAMETER);
+  // Without the 'moov' box there is no video track.
+  ck_assert_int_eq(signed_video_mp4_open_buffer(mp4_data, 8, &mp4), SV_NOT_SUPPORTED);
+  ck_assert_int_eq(signed_video_mp4_open_buffer(mp4_data, mp4_size, &mp4), SV_OK);
+  SignedVideoCodec codec = SV_CODEC_NUM;
+  ck_assert_int_eq(signed_video_mp4_get_codec(mp4, &codec), SV_OK);
+  ck_assert_int_eq(codec, settings[_i].codec);
+
+  // Validate sequentially. The GOP before the first SEI is not reported.
+  SignedVideoAuthenticityResult results[10] = {0};
+  size_t num_results = 0;
+  ck_assert_int_eq(signed_video_mp4_validate(mp4, 0, results, 10, &num_results),
+      SV_INVALID_PARAMETER);
+  ck_assert_int_eq(signed_video_mp4_validate(mp4, 1, results, 10, &num_results), SV_OK);
+  ck_assert_int_eq(num_results, 5);
+  ck_assert_int_eq(results[num_results - 1], SV_AUTH_RESULT_OK);
+  // Validate in parallel.
+  SignedVideoAuthenticityResult parallel_results[10] = {0};
+  ck_assert_int_eq(signed_video_mp4_validate(mp4, 3, parallel_results, 10, &num_results), SV_OK);
+  ck_assert_int_eq(num_results, 5);
+  for (size_t i = 0; i < num_results; i++) {
+    ck_assert_int_eq(parallel_results[i], results[i]);
+  }
+  // Too few |results|.
+  ck_assert_int_eq(signed_video_mp4_validate(mp4, 2, parallel_results, 2, &num_results), SV_OK);
+  ck_assert_int_eq(num_results, 5);
+  signed_video_mp4_close(mp4);
+
+  // Open the file from disk.
+  char path[] = "/tmp/signed_video_mp4_XXXXXX";
+  int fd = mkstemp(path);
+  ck_assert_int_ge(fd, 0);
+  ck_assert_int_eq(write(fd, mp4_data, mp4_size), (ssize_t)mp4_size);
+  close(fd);
+  ck_assert_int_eq(signed_video_mp4_open(path, &mp4), SV_OK);
+  ck_assert_int_eq(signed_video_mp4_validate(mp4, 2, parallel_results, 10, &num_results), SV_OK);
+  ck_assert_int_eq(num_results, 5);
+  signed_video_mp4_close(mp4);
+  unlink(path);
+
+  // Sync samples out of order would make the GOPs overlap. The 'stss' box is the last one.
+  size_t stss = mp4_size - 4;
+  while (memcmp(mp4_data + stss, "stss", 4) != 0) stss--;
+  uint8_t *sync_samples = mp4_data + stss + 12;  // After type, version and flags, and count.
+  uint8_t first_sync_sample[4] = {0};
+  memcpy(first_sync_sample, sync_samples, 4);
+  memcpy(sync_samples, sync_samples + 4, 4);
+  memcpy(sync_samples + 4, first_sync_sample, 4);
+  ck_assert_int_eq(signed_video_mp4_open_buffer(mp4_data, mp4_size, &mp4), SV_INVALID_PARAMETER);
+  // A repeated sync sample is rejected as well.
+  memcpy(sync_samples, sync_samples + 4, 4);
+  ck_assert_int_eq(signed_video_mp4_open_buffer(mp4_data, mp4_size, &mp4), SV_INVALID_PARAMETER);
+  free(mp4_data);
+
+  // First P-NALU in the third GOP: GIPPGIPPGI P PGIPPGIPPGI
+  modify_list_item(list, 11, "P");
+  mp4_data = create_mp4(list, &mp4_size);
+  ck_assert_int_eq(signed_video_mp4_open_buffer(mp4_data, mp4_size, &mp4), SV_OK);
+  ck_assert_int_eq(signed_video_mp4_validate(mp4, 3, results, 10, &num_results), SV_OK);
+  ck_assert_int_eq(num_results, 5);
+  bool has_invalid_gop = false;
+  for (size_t i = 0; i < num_results; i++) {
+    has_invalid_gop |= results[i] == SV_AUTH_RESULT_NOT_OK;
+  }
+  ck_assert(has_invalid_gop);
+  signed_video_mp4_close(mp4);
+
+  free(mp4_data);
+  nalu_list_free(list);
+}
+END_TEST
+
+#define TS_PACKET_SIZE 188
+#define TS_PMT_PID 0x100
+#define TS_VIDEO_PID 0x101
+
+/* Writes a transport stream packet with |payload|, stuffing it with an adaptation field if the
+ * |payload| does not fill the packet. Returns the number of payload bytes written. */
+static size_t
+write_ts_packet(uint8_t *data,
+    size_t *pos,
+    int pid,
+    bool is_unit_start,
+    int *continuity_counter,
+    const uint8_t *payload,
+    size_t payload_size)
+{
+  uint8_t *packet = data + *pos;
+  memset(packet, 0xff, TS_PACKET_SIZE);
+  if (payload_size > TS_PACKET_SIZE - 4) payload_size = TS_PACKET_SIZE - 4;
+  const size_t stuffing_size = TS_PACKET_SIZE - 4 - payload_size;
+  packet[0] = 0x47;
+  packet[1] = (is_unit_start ? 0x40 : 0x00) | ((pid >> 8) & 0x1f);
+  packet[2] = pid & 0xff;
+  packet[3] = (stuffing_size > 0 ? 0x30 : 0x10) | (*continuity_counter & 0x0f);
+  *continuity_counter = (*continuity_counter + 1) & 0x0f;
+  if (stuffing_size > 0) {
+    // The adaptation field length excludes the length byte itself.
+    packet[4] = (uint8_t)(stuffing_size - 1);
+    if (stuffing_size > 1) packet[5] = 0x00;  // No flags
+  }
+  memcpy(packet + 4 + stuffing_size, payload, payload_size);
+  *pos += TS_PACKET_SIZE;
+  return payload_size;
+}
+
+/* Muxes the NALUs of |list| into a transport stream with a PAT, a PMT and one PES per access unit,
+ * that is, a picture NALU together with any SEIs in front of it. If |lost_packet| is positive, that
+ * video packet is left out. */
+static uint8_t *
+create_ts(const nalu_list_t *list, int lost_packet, size_t *ts_size)
+{
+  uint8_t *data = calloc(1, 131072);
+  ck_assert(data);
+  size_t pos = 0;
+  int pat_cc = 0;
+  int pmt_cc = 0;
+  int video_cc = 0;
+  int num_video_packets = 0;
+
+  // PAT with program 1 on TS_PMT_PID. The CRC is not checked and left as 0.
+  const uint8_t pat[] = {0x00, 0x00, 0xb0, 0x0d, 0x00, 0x01, 0xc1, 0x00, 0x00, 0x00, 0x01,
+      0xe0 | (TS_PMT_PID >> 8), TS_PMT_PID & 0xff, 0x00, 0x00, 0x00, 0x00};
+  write_ts_packet(data, &pos, 0x0000, true, &pat_cc, pat, sizeof(pat));
+  // PMT with one video stream on TS_VIDEO_PID.
+  const uint8_t stream_type = list->codec == SV_CODEC_H264 ? 0x1b : 0x24;
+  const uint8_t pmt[] = {0x00, 0x02, 0xb0, 0x12, 0x00, 0x01, 0xc1, 0x00, 0x00,
+      0xe0 | (TS_VIDEO_PID >> 8), TS_VIDEO_PID & 0xff, 0xf0, 0x00, stream_type,
+      0xe0 | (TS_VIDEO_PID >> 8), TS_VIDEO_PID & 0xff, 0xf0, 0x00, 0x00, 0x00, 0x00, 0x00};
+  write_ts_packet(data, &pos, TS_PMT_PID, true, &pmt_cc, pmt, sizeof(pmt));
+
+  uint8_t pes[8192] = {0x00, 0x00, 0x01, 0xe0, 0x00, 0x00, 0x80, 0x00, 0x00};
+  size_t pes_size = 9;
+  for (nalu_list_item_t *item = list->first_item; item; item = item->next) {
+    memcpy(pes + pes_size, item->data, item->data_size);
+    pes_size += item->data_size;
+    // An access unit ends with a picture NALU.
+    if (item->next && item->str_code[0] != 'I' && item->str_code[0] != 'P') continue;
+    size_t offset = 0;
+    while (offset < pes_size) {
+      const size_t packet_pos = pos;
+      offset += write_ts_packet(
+          data, &pos, TS_VIDEO_PID, offset == 0, &video_cc, pes + offset, pes_size - offset);
+      if (++num_video_packets == lost_packet) pos = packet_pos;
+    }
+    pes_size = 9;
+  }
+  ck_assert_uint_le(pos, 131072);
+
+  *ts_size = pos;
+  return data;
+}
+
+typedef struct {
+  int valid_gops;
+  int invalid_gops;
+  int has_signature;
+} ts_reports_t;
+
+static void
+count_ts_report(signed_video_authenticity_t *report, void *user_data)
+{
+  ts_reports_t *reports = (ts_reports_t *)user_data;
+  SignedVideoAuthenticityResult authenticity = report->latest_validation.authenticity;
+  if (authenticity == SV_AUTH_RESULT_OK) reports->valid_gops++;
+  if (authenticity == SV_AUTH_RESULT_NOT_OK) reports->invalid_gops++;
+  if (authenticity == SV_AUTH_RESULT_SIGNATURE_PRESENT) reports->has_signature++;
+  signed_video_authenticity_report_free(report);
+}
+
+/* Validates a transport stream added in chunks of |chunk_size| bytes and counts the reports. */
+static void
+validate_ts(SignedVideoCodec codec,
+    const uint8_t *ts_data,
+    size_t ts_size,
+    size_t chunk_size,
+    ts_reports_t *reports,
+    sv_ts_stats_t *stats)
+{
+  signed_video_t *sv = signed_video_create(codec);
+  ck_assert(sv);
+  sv_ts_reader_t *reader = signed_video_ts_reader_create(sv, count_ts_report, reports);
+  ck_assert(reader);
+  for (size_t offset = 0; offset < ts_size; offset += chunk_size) {
+    const size_t size = ts_size - offset < chunk_size ? ts_size - offset : chunk_size;
+    ck_assert_int_eq(signed_video_ts_reader_add_data(reader, ts_data + offset, size), SV_OK);
+  }
+  ck_assert_int_eq(signed_video_ts_reader_flush(reader), SV_OK);
+  ck_assert_int_eq(signed_video_ts_reader_get_stats(reader, stats), SV_OK);
+  signed_video_ts_reader_free(reader);
+  signed_video_free(sv);
+}
+
+/* Test description
+ * Verify that the video stream of an MPEG-TS can be validated, when added in arbitrary chunks.
+ * The operation is as follows:
+ * 1. Generate a signed stream and mux it into a transport stream.
+ * 2. Validate the stream in odd sized chunks and compare with validating the NALUs directly.
+ * 3. Duplicate a packet, lose 15 packets and jump the continuity counter at a discontinuity.
+ * 4. Corrupt a PES header and put garbage between two packets, and verify that the reader goes on.
+ * 5. Modify a P-NALU and validate again.
+ * 6. Leave out a packet and verify that its PES is dropped.
+ */
+START_TEST(validate_ts_stream)
+{
+  // This test runs in a loop with loop index _i, corresponding to struct sv_setting _i in
+  // |settings|; See signed_video_helpers.h.
+
+  nalu_list_t *list = create_signed_nalus("IPPIPPIPPIPPIPPI", settings[_i]);
+  nalu_list_check_str(list, "GIPPGIPPGIPPGIPPGIPPGI");
+  size_t ts_size = 0;
+  uint8_t *ts_data = create_ts(list, 0, &ts_size);
+
+  // Invalid parameters.
+  signed_video_t *sv = signed_video_create(settings[_i].codec);
+  ck_assert(sv);
+  ck_assert(!signed_video_ts_reader_create(NULL, NULL, NULL));
+  sv_ts_reader_t *reader = signed_video_ts_reader_create(sv, NULL, NULL);
+  ck_assert(reader);
+  sv_ts_stats_t stats = {0};
+  ck_assert_int_eq(signed_video_ts_reader_add_data(NULL, ts_data, ts_size), SV_INVALID_PARAMETER);
+  ck_assert_int_eq(signed_video_ts_reader_add_data(reader, NULL, ts_size), SV_INVALID_PARAMETER);
+  ck_assert_int_eq(signed_video_ts_reader_flush(NULL), SV_INVALID_PARAMETER);
+  ck_assert_int_eq(signed_video_ts_reader_get_stats(NULL, &stats), SV_INVALID_PARAMETER);
+  ck_assert_int_eq(signed_video_ts_reader_get_stats(reader, NULL), SV_INVALID_PARAMETER);
+  // Data not starting with a sync byte. The reader skips to the next sync byte, which is the last
+  // byte of the data, and continues from there.
+  ck_assert_int_eq(signed_video_ts_reader_add_data(reader, ts_data + 1, TS_PACKET_SIZE),
+      SV_INVALID_PARAMETER);
+  ck_assert_int_eq(signed_video_ts_reader_add_data(
+                       reader, ts_data + 1 + TS_PACKET_SIZE, ts_size - 1 - TS_PACKET_SIZE),
+      SV_OK);
+  ck_assert_int_eq(signed_video_ts_reader_get_stats(reader, &stats), SV_OK);
+  ck_assert_uint_eq(stats.num_resyncs, 1);
+  ck_assert_uint_eq(stats.num_packets, ts_size / TS_PACKET_SIZE - 1);
+  signed_video_ts_reader_free(reader);
+  signed_video_free(sv);
+  // A stream of the other codec is not supported.
+  sv = signed_video_create(settings[_i].codec == SV_CODEC_H264 ? SV_CODEC_H265 : SV_CODEC_H264);
+  ck_assert(sv);
+  reader = signed_video_ts_reader_create(sv, NULL, NULL);
+  ck_assert(reader);
+  ck_assert_int_eq(
+      signed_video_ts_reader_add_data(reader, ts_data, 2 * TS_PACKET_SIZE), SV_NOT_SUPPORTED);
+  signed_video_ts_reader_free(reader);
+  signed_video_free(sv);
+
+  // The reference is to add the NALUs directly.
+  sv = signed_video_create(settings[_i].codec);
+  ck_assert(sv);
+  int valid_gops = 0;
+  int has_signature = 0;
+  add_nalus_and_count_reports(sv, list, 0, list->num_items, &valid_gops, &has_signature);
+  signed_video_free(sv);
+
+  ts_reports_t reports = {0};
+  validate_ts(settings[_i].codec, ts_data, ts_size, 100, &reports, &stats);
+  ck_assert_int_eq(reports.valid_gops, valid_gops);
+  ck_assert_int_eq(reports.has_signature, has_signature);
+  ck_assert_int_eq(reports.invalid_gops, 0);
+  ck_assert_uint_eq(stats.num_bytes, ts_size);
+  ck_assert_uint_eq(stats.num_packets, ts_size / TS_PACKET_SIZE);
+  ck_assert_uint_eq(stats.num_nalus, (uint64_t)list->num_items);
+  ck_assert_uint_eq(stats.num_dropped_pes, 0);
+  ck_assert(stats.megabytes_per_second >= 0.0);
+  // Packet sized chunks give the same result.
+  memset(&reports, 0, sizeof(reports));
+  validate_ts(settings[_i].codec, ts_data, ts_size, TS_PACKET_SIZE, &reports, &stats);
+  ck_assert_int_eq(reports.valid_gops, valid_gops);
+
+  // The first two packets are the PAT and the PMT, followed by video packets only.
+  const size_t num_packets = ts_size / TS_PACKET_SIZE;
+  uint8_t *modified_ts_data = malloc(ts_size + TS_PACKET_SIZE);
+  ck_assert(modified_ts_data);
+  // A duplicate packet is ignored.
+  memcpy(modified_ts_data, ts_data, 6 * TS_PACKET_SIZE);
+  memcpy(modified_ts_data + 6 * TS_PACKET_SIZE, ts_data + 5 * TS_PACKET_SIZE,
+      ts_size - 5 * TS_PACKET_SIZE);
+  memset(&reports, 0, sizeof(reports));
+  validate_ts(
+      settings[_i].codec, modified_ts_data, ts_size + TS_PACKET_SIZE, 1000, &reports, &stats);
+  ck_assert_uint_eq(stats.num_dropped_pes, 0);
+  ck_assert_uint_eq(stats.num_nalus, (uint64_t)list->num_items);
+  ck_assert_int_eq(reports.valid_gops, valid_gops);
+  // Losing 15 packets repeats the continuity counter of the previous packet, but is not taken as a
+  // duplicate. Since the NALUs of some access units are equal, find a packet which differs from the
+  // packet 15 packets later.
+  size_t lost = 3;
+  ck_assert_uint_lt(lost + 15, num_packets);
+  while (memcmp(ts_data + (lost - 1) * TS_PACKET_SIZE + 4,
+             ts_data + (lost + 15) * TS_PACKET_SIZE + 4, TS_PACKET_SIZE - 4) == 0) {
+    lost++;
+    ck_assert_uint_lt(lost + 15, num_packets);
+  }
+  memcpy(modified_ts_data, ts_data, lost * TS_PACKET_SIZE);
+  memcpy(modified_ts_data + lost * TS_PACKET_SIZE, ts_data + (lost + 15) * TS_PACKET_SIZE,
+      ts_size - (lost + 15) * TS_PACKET_SIZE);
+  memset(&reports, 0, sizeof(reports));
+  validate_ts(
+      settings[_i].codec, modified_ts_data, ts_size - 15 * TS_PACKET_SIZE, 1000, &reports, &stats);
+  ck_assert_uint_eq(stats.num_dropped_pes, 1);
+  // Jump the continuity counter at a packet with the discontinuity_indicator set, that is, a
+  // packet with an adaptation field of at least the flags.
+  memcpy(modified_ts_data, ts_data, ts_size);
+  bool has_discontinuity = false;
+  for (size_t i = 2; i < num_packets; i++) {
+    uint8_t *packet = modified_ts_data + i * TS_PACKET_SIZE;
+    if (!has_discontinuity && (packet[3] & 0x20) && packet[4] > 0) {
+      packet[5] |= 0x80;
+      has_discontinuity = true;
+    }
+    if (has_discontinuity) packet[3] = (packet[3] & 0xf0) | ((packet[3] + 5) & 0x0f);
+  }
+  ck_assert(has_discontinuity);
+  memset(&reports, 0, sizeof(reports));
+  validate_ts(settings[_i].codec, modified_ts_data, ts_size, 1000, &reports, &stats);
+  ck_assert_uint_eq(stats.num_dropped_pes, 0);
+  ck_assert_uint_eq(stats.num_nalus, (uint64_t)list->num_items);
+  ck_assert_int_eq(reports.valid_gops, valid_gops);
+  // A PES not starting with a start code is dropped, and the rest of the stream is still read.
+  memcpy(modified_ts_data, ts_data, ts_size);
+  int num_pes = 0;
+  for (size_t i = 2; i < num_packets && num_pes < 5; i++) {
+    uint8_t *packet = modified_ts_data + i * TS_PACKET_SIZE;
+    if (!(packet[1] & 0x40)) continue;
+    uint8_t *payload = packet + 4 + ((packet[3] & 0x20) ? 1 + packet[4] : 0);
+    if (++num_pes == 5) payload[2] = 0x02;
+  }
+  ck_assert_int_eq(num_pes, 5);
+  memset(&reports, 0, sizeof(reports));
+  validate_ts(settings[_i].codec, modified_ts_data, ts_size, 1000, &reports, &stats);
+  ck_assert_uint_eq(stats.num_dropped_pes, 1);
+  ck_assert_uint_eq(stats.num_packets, num_packets);
+  ck_assert_uint_lt(stats.num_nalus, (uint64_t)list->num_items);
+  ck_assert_int_gt(reports.valid_gops + reports.invalid_gops, 0);
+  // Garbage between two packets breaks the packet alignment. The chunk with the garbage is reported
+  // and the reader finds the next packet.
+  const size_t garbage_pos = (num_packets / 2) * TS_PACKET_SIZE;
+  const size_t garbage_size = 10;
+  memcpy(modified_ts_data, ts_data, garbage_pos);
+  memset(modified_ts_data + garbage_pos, 0, garbage_size);
+  memcpy(modified_ts_data + garbage_pos + garbage_size, ts_data + garbage_pos,
+      ts_size - garbage_pos);
+  sv = signed_video_create(settings[_i].codec);
+  ck_assert(sv);
+  memset(&reports, 0, sizeof(reports));
+  reader = signed_video_ts_reader_create(sv, count_ts_report, &reports);
+  ck_assert(reader);
+  const size_t chunk_size = 1000;
+  for (size_t offset = 0; offset < ts_size + garbage_size; offset += chunk_size) {
+    size_t size = ts_size + garbage_size - offset;
+    if (size > chunk_size) size = chunk_size;
+    const bool has_garbage = offset < garbage_pos + garbage_size && garbage_pos < offset + size;
+    ck_assert_int_eq(signed_video_ts_reader_add_data(reader, modified_ts_data + offset, size),
+        has_garbage ? SV_INVALID_PARAMETER : SV_OK);
+  }
+  ck_assert_int_eq(signed_video_ts_reader_flush(reader), SV_OK);
+  ck_assert_int_eq(signed_video_ts_reader_get_stats(reader, &stats), SV_OK);
+  ck_assert_uint_eq(stats.num_resyncs, 1);
+  ck_assert_uint_eq(stats.num_packets, num_packets);
+  ck_assert_uint_eq(stats.num_nalus, (uint64_t)list->num_items);
+  ck_assert_int_eq(reports.valid_gops, valid_gops);
+  signed_video_ts_reader_free(reader);
+  signed_video_free(sv);
+  free(modified_ts_data);
+  free(ts_data);
+
+  // First P-NALU in the third GOP: GIPPGIPPGI P PGIPPGIPPGI
+  modify_list_item(list, 11, "P");
+  ts_data = create_ts(list, 0, &ts_size);
+  memset(&reports, 0, sizeof(reports));
+  validate_ts(settings[_i].codec, ts_data, ts_size, 100, &reports, &stats);
+  ck_assert_int_gt(reports.invalid_gops, 0);
+  free(ts_data);
+
+  // Leave out a packet in the middle of the stream.
+  ts_data = create_ts(list, 10, &ts_size);
+  memset(&reports, 0, sizeof(reports));
+  validate_ts(settings[_i].codec, ts_data, ts_size, 1000, &reports, &stats);
+  ck_assert_uint_eq(stats.num_dropped_pes, 1);
+  ck_assert_uint_lt(stats.num_nalus, (uint64_t)list->num_items);
+  free(ts_data);
+
+  nalu_list_free(list);
+}
+END_TEST
+
+#define RTP_MAX_PAYLOAD_SIZE 100
+#define RTP_MAX_NUM_PACKETS 512
+
+typedef struct {
+  uint8_t data[RTP_MAX_NUM_PACKETS][12 + RTP_MAX_PAYLOAD_SIZE];
+  size_t sizes[RTP_MAX_NUM_PACKETS];
+  int num_packets;
+} rtp_packets_t;
+
+/* Starts an RTP packet and returns a pointer to its payload. */
+static uint8_t *
+begin_rtp_packet(rtp_packets_t *packets)
+{
+  ck_assert_int_lt(packets->num_packets, RTP_MAX_NUM_PACKETS);
+  uint8_t *packet = packets->data[packets->num_packets];
+  // Start the sequence numbers close to the wraparound.
+  const uint16_t sequence_number = (uint16_t)(65530 + packets->num_packets);
+  memset(packet, 0, 12);
+  packet[0] = 0x80;
+  packet[1] = 96;
+  packet[2] = sequence_number >> 8;
+  packet[3] = sequence_number & 0xff;
+  packets->sizes[packets->num_packets] = 12;
+  return packet + 12;
+}
+
+static void
+end_rtp_packet(rtp_packets_t *packets, size_t payload_size)
+{
+  packets->sizes[packets->num_packets++] += payload_size;
+}
+
+/* Packetizes the NALUs of |list| into RTP packets. NALUs too large for a packet are sent in
+ * fragmentation units, and consecutive small NALUs are aggregated. */
+static void
+create_rtp_packets(const nalu_list_t *list, rtp_packets_t *packets)
+{
+  const bool is_h264 = list->codec == SV_CODEC_H264;
+  const size_t header_size = is_h264 ? 1 : 2;
+  packets->num_packets = 0;
+  for (nalu_list_item_t *item = list->first_item; item; item = item->next) {
+    const size_t start_code_size = item->data[2] == 0x01 ? 3 : 4;
+    const uint8_t *nalu = item->data + start_code_size;
+    const size_t nalu_size = item->data_size - start_code_size;
+    nalu_list_item_t *next = item->next;
+    const size_t next_size = next ? next->data_size - (next->data[2] == 0x01 ? 3 : 4) : 0;
+
+    uint8_t *payload = begin_rtp_packet(packets);
+    if (nalu_size > RTP_MAX_PAYLOAD_SIZE) {
+      // Fragmentation units, where the first packet is already started.
+      size_t offset = header_size;
+      while (offset < nalu_size) {
+        if (offset > header_size) payload = begin_rtp_packet(packets);
+        size_t size = nalu_size - offset;
+        if (size > RTP_MAX_PAYLOAD_SIZE - header_size - 1) {
+          size = RTP_MAX_PAYLOAD_SIZE - header_size - 1;
+        }
+        uint8_t fu_header = offset == header_size ? 0x80 : 0x00;
+        if (offset + size == nalu_size) fu_header |= 0x40;
+        if (is_h264) {
+          payload[0] = (nalu[0] & 0xe0) | 28;
+          payload[1] = fu_header | (nalu[0] & 0x1f);
+        } else {
+          payload[0] = (nalu[0] & 0x81) | (49 << 1);
+          payload[1] = nalu[1];
+          payload[2] = fu_header | ((nalu[0] >> 1) & 0x3f);
+        }
+        memcpy(payload + header_size + 1, nalu + offset, size);
+        end_rtp_packet(packets, header_size + 1 + size);
+        offset += size;
+      }
+    } else if (next && header_size + 4 + nalu_size + next_size <= RTP_MAX_PAYLOAD_SIZE) {
+      // Aggregate the NALU with the next one.
+      if (is_h264) {
+        payload[0] = (nalu[0] & 0xe0) | 24;
+      } else {
+        payload[0] = (nalu[0] & 0x81) | (48 << 1);
+        payload[1] = nalu[1];
+      }
+      size_t pos = header_size;
+      for (int i = 0; i < 2; i++) {
+        const size_t size = i == 0 ? nalu_size : next_size;
+        const uint8_t *data = i == 0 ? nalu : next->data + (next->data[2] == 0x01 ? 3 : 4);
+        payload[pos++] = (uint8_t)(size >> 8);
+        payload[pos++] = (uint8_t)size;
+        memcpy(payload + pos, data, size);
+        pos += size;
+      }
+      end_rtp_packet(packets, pos);
+      item = next;
+    } else {
+      memcpy(payload, nalu, nalu_size);
+      end_rtp_packet(packets, nalu_size);
+    }
+  }
+}
+
+/* Writes |packets| as UDP over IPv4 to |udp_port| in a pcap file, leaving out |lost_packet|. */
+static uint8_t *
+create_pcap(const rtp_packets_t *packets, uint16_t udp_port, int lost_packet, size_t *pcap_size)
+{
+  uint8_t *data = calloc(1, 24 + RTP_MAX_NUM_PACKETS * (16 + 42 + 12 + RTP_MAX_PAYLOAD_SIZE));
+  ck_assert(data);
+  // Little endian global header with microsecond resolution and Ethernet link type.
+  const uint8_t header[24] = {0xd4, 0xc3, 0xb2, 0xa1, 2, 0, 4, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xff,
+      0xff, 0, 0, 1, 0, 0, 0};
+  memcpy(data, header, sizeof(header));
+  size_t pos = sizeof(header);
+  for (int i = 0; i < packets->num_packets; i++) {
+    if (i == lost_packet) continue;
+    const size_t udp_size = 8 + packets->sizes[i];
+    const size_t frame_size = 14 + 20 + udp_size;
+    // Record header with the captured and original sizes.
+    uint8_t *record = data + pos;
+    record[8] = record[12] = (uint8_t)frame_size;
+    record[9] = record[13] = (uint8_t)(frame_size >> 8);
+    uint8_t *frame = record + 16;
+    frame[12] = 0x08;  // IPv4
+    uint8_t *ip = frame + 14;
+    ip[0] = 0x45;
+    ip[2] = (uint8_t)((20 + udp_size) >> 8);
+    ip[3] = (uint8_t)(20 + udp_size);
+    ip[9] = 17;  // UDP
+    uint8_t *udp = ip + 20;
+    udp[2] = udp_port >> 8;
+    udp[3] = udp_port & 0xff;
+    udp[4] = (uint8_t)(udp_size >> 8);
+    udp[5] = (uint8_t)udp_size;
+    memcpy(udp + 8, packets->data[i], packets->sizes[i]);
+    pos += 16 + frame_size;
+  }
+
+  *pcap_size = pos;
+  return data;
+}
+
+/* Adds |packets|, except |lost_packet|, to a new session and counts the reports. */
+static void
+validate_rtp_packets(SignedVideoCodec codec,
+    const rtp_packets_t *packets,
+    int lost_packet,
+    ts_reports_t *reports,
+    sv_rtp_stats_t *stats)
+{
+  signed_video_t *sv = signed_video_create(codec);
+  ck_assert(sv);
+  sv_rtp_depacketizer_t *rtp = signed_video_rtp_depacketizer_create(sv, count_ts_report, reports);
+  ck_assert(rtp);
+  for (int i = 0; i < packets->num_packets; i++) {
+    if (i == lost_packet) continue;
+    ck_assert_int_eq(
+        signed_video_rtp_depacketizer_add_packet(rtp, packets->data[i], packets->sizes[i]), SV_OK);
+  }
+  ck_assert_int_eq(signed_video_rtp_depacketizer_get_stats(rtp, stats), SV_OK);
+  signed_video_rtp_depacketizer_free(rtp);
+  signed_video_free(sv);
+}
+
+/* Test description
+ * Verify that a stream depacketized from RTP, with aggregated and fragmented NALUs, is validated as
+ * the NALUs themselves, also when read from a pcap file.
+ * The operation is as follows:
+ * 1. Generate a signed stream and packetize it into RTP packets.
+ * 2. Add the packets and compare with validating the NALUs directly.
+ * 3. Add the packets through a pcap file.
+ * 4. Lose a fragment of an SEI and verify that the NALU is dropped.
+ * 5. Restart the stream and verify that the depacketizer resynchronizes.
+ */
+START_TEST(validate_rtp_stream)
+{
+  // This test runs in a loop with loop index _i, corresponding to struct sv_setting _i in
+  // |settings|; See signed_video_helpers.h.
+
+  nalu_list_t *list = create_signed_nalus("IPPIPPIPPIPPIPPI", settings[_i]);
+  nalu_list_check_str(list, "GIPPGIPPGIPPGIPPGIPPGI");
+  rtp_packets_t *packets = calloc(1, sizeof(rtp_packets_t));
+  ck_assert(packets);
+  create_rtp_packets(list, packets);
+
+  // Invalid parameters.
+  signed_video_t *sv = signed_video_create(settings[_i].codec);
+  ck_assert(sv);
+  ck_assert(!signed_video_rtp_depacketizer_create(NULL, NULL, NULL));
+  sv_rtp_depacketizer_t *rtp = signed_video_rtp_depacketizer_create(sv, NULL, NULL);
+  ck_assert(rtp);
+  sv_rtp_stats_t stats = {0};
+  ck_assert_int_eq(signed_video_rtp_depacketizer_add_packet(NULL, packets->data[0], 20),
+      SV_INVALID_PARAMETER);
+  ck_assert_int_eq(signed_video_rtp_depacketizer_add_packet(rtp, NULL, 20), SV_INVALID_PARAMETER);
+  ck_assert_int_eq(signed_video_rtp_depacketizer_add_packet(rtp, packets->data[0], 11),
+      SV_INVALID_PARAMETER);
+  // A header extension without room for its header.
+  const uint8_t extended_packet[14] = {0x90, 96, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+  ck_assert_int_eq(signed_video_rtp_depacketizer_add_packet(rtp, extended_packet, 14),
+      SV_INVALID_PARAMETER);
+  ck_assert_int_eq(signed_video_rtp_depacketizer_add_pcap(rtp, NULL, 24, 0), SV_INVALID_PARAMETER);
+  ck_assert_int_eq(signed_video_rtp_depacketizer_add_pcap(rtp, packets->data[0], 24, 0),
+      SV_NOT_SUPPORTED);
+  ck_assert_int_eq(signed_video_rtp_depacketizer_get_stats(NULL, &stats), SV_INVALID_PARAMETER);
+  ck_assert_int_eq(signed_video_rtp_depacketizer_get_stats(rtp, NULL), SV_INVALID_PARAMETER);
+  signed_video_rtp_depacketizer_free(rtp);
+  signed_video_free(sv);
+
+  // The reference is to add the NALUs directly.
+  sv = signed_video_create(settings[_i].codec);
+  ck_assert(sv);
+  int valid_gops = 0;
+  int has_signature = 0;
+  add_nalus_and_count_reports(sv, list, 0, list->num_items, &valid_gops, &has_signature);
+  signed_video_free(sv);
+
+  ts_reports_t reports = {0};
+  validate_rtp_packets(settings[_i].codec, packets, -1, &reports, &stats);
+  ck_assert_int_eq(reports.valid_gops, valid_gops);
+  ck_assert_int_eq(reports.has_signature, has_signature);
+  ck_assert_int_eq(reports.invalid_gops, 0);
+  ck_assert_uint_eq(stats.num_packets, (uint64_t)packets->num_packets);
+  ck_assert_uint_eq(stats.num_nalus, (uint64_t)list->num_items);
+  ck_assert_uint_eq(stats.num_lost_packets, 0);
+  ck_assert_uint_eq(stats.num_dropped_nalus, 0);
+
+  // Read the packets from a pcap file, with a duplicate packet in another UDP port.
+  size_t pcap_size = 0;
+  uint8_t *pcap_data = create_pcap(packets, 5004, -1, &pcap_size);
+  sv = signed_video_create(settings[_i].codec);
+  ck_assert(sv);
+  memset(&reports, 0, sizeof(reports));
+  rtp = signed_video_rtp_depacketizer_create(sv, count_ts_report, &reports);
+  ck_assert(rtp);
+  ck_assert_int_eq(signed_video_rtp_depacketizer_add_pcap(rtp, pcap_data, pcap_size, 5004), SV_OK);
+  ck_assert_int_eq(signed_video_rtp_depacketizer_get_stats(rtp, &stats), SV_OK);
+  ck_assert_uint_eq(stats.num_packets, (uint64_t)packets->num_packets);
+  ck_assert_int_eq(reports.valid_gops, valid_gops);
+  // The same packets again are late.
+  ck_assert_int_eq(signed_video_rtp_depacketizer_add_pcap(rtp, pcap_data, pcap_size, 0), SV_OK);
+  ck_assert_int_eq(signed_video_rtp_depacketizer_get_stats(rtp, &stats), SV_OK);
+  ck_assert_uint_eq(stats.num_ignored_packets, (uint64_t)packets->num_packets);
+  ck_assert_uint_eq(stats.num_nalus, (uint64_t)list->num_items);
+  // Other ports are skipped.
+  ck_assert_int_eq(signed_video_rtp_depacketizer_add_pcap(rtp, pcap_data, pcap_size, 5006), SV_OK);
+  ck_assert_int_eq(signed_video_rtp_depacketizer_get_stats(rtp, &stats), SV_OK);
+  ck_assert_uint_eq(stats.num_packets, 2 * (uint64_t)packets->num_packets);
+  signed_video_rtp_depacketizer_free(rtp);
+  signed_video_free(sv);
+  free(pcap_data);
+
+  // Lose the second fragment of the second SEI.
+  int lost_packet = -1;
+  int num_fragmented_nalus = 0;
+  for (int i = 0; i < packets->num_packets && lost_packet < 0; i++) {
+    const uint8_t *payload = packets->data[i] + 12;
+    const bool is_fu_start = list->codec == SV_CODEC_H264
+        ? (payload[0] & 0x1f) == 28 && (payload[1] & 0x80)
+        : ((payload[0] >> 1) & 0x3f) == 49 && (payload[2] & 0x80);
+    if (is_fu_start && ++num_fragmented_nalus == 2) lost_packet = i + 1;
+  }
+  ck_assert_int_gt(lost_packet, 0);
+  memset(&reports, 0, sizeof(reports));
+  validate_rtp_packets(settings[_i].codec, packets, lost_packet, &reports, &stats);
+  ck_assert_uint_eq(stats.num_lost_packets, 1);
+  ck_assert_uint_eq(stats.num_dropped_nalus, 1);
+  ck_assert_uint_eq(stats.num_nalus, (uint64_t)list->num_items - 1);
+  ck_assert_int_lt(reports.valid_gops, valid_gops);
+
+  // Restart the stream, first with the sequence numbers far behind, then with a new SSRC. Both
+  // resynchronize the depacketizer without any lost packets. The first packet far behind is
+  // ignored, since it cannot be told apart from a late packet.
+  sv = signed_video_create(settings[_i].codec);
+  ck_assert(sv);
+  rtp = signed_video_rtp_depacketizer_create(sv, NULL, NULL);
+  ck_assert(rtp);
+  for (int restart = 0; restart < 3; restart++) {
+    for (int i = 0; i < packets->num_packets; i++) {
+      uint8_t packet[12 + RTP_MAX_PAYLOAD_SIZE];
+      memcpy(packet, packets->data[i], packets->sizes[i]);
+      if (restart == 1) {
+        const uint16_t sequence_number = (uint16_t)(((packet[2] << 8) | packet[3]) - 1000);
+        packet[2] = sequence_number >> 8;
+        packet[3] = sequence_number & 0xff;
+      }
+      if (restart == 2) packet[11] = 1;
+      ck_assert_int_eq(
+          signed_video_rtp_depacketizer_add_packet(rtp, packet, packets->sizes[i]), SV_OK);
+    }
+  }
+  ck_assert_int_eq(signed_video_rtp_depacketizer_get_stats(rtp, &stats), SV_OK);
+  ck_assert_uint_eq(stats.num_resyncs, 2);
+  ck_assert_uint_eq(stats.num_ignored_packets, 1);
+  ck_assert_uint_eq(stats.num_lost_packets, 0);
+  signed_video_rtp_depacketizer_free(rtp);
+  signed_video_free(sv);
+
+  free(packets);
+  nalu_list_free(list);
+}
+END_TEST
+
+/* A trace sink storing the records back to back in a trace_t. */
+typedef struct {
+  uint8_t data[30 * SV_TRACE_RECORD_SIZE];
+  size_t size;
+} trace_t;
+
+static void
+store_trace_record(const uint8_t *record, size_t record_size, void *user_data)
+{
+  trace_t *trace = (trace_t *)user_data;
+  ck_assert_uint_le(trace->size + record_size, sizeof(trace->data));
+  memcpy(trace->data + trace->size, record, record_size);
+  trace->size += record_size;
+}
+
+/* Returns the size of |item| excluding the start code. */
+static size_t
+get_size_without_start_code(const nalu_list_item_t *item)
+{
+  const uint8_t start_code[4] = {0x00, 0x00, 0x00, 0x01};
+  if (item->data_size > 4 && memcmp(item->data, start_code, 4) == 0) return item->data_size - 4;
+  if (item->data_size > 3 && memcmp(item->data, start_code + 1, 3) == 0) return item->data_size - 3;
+  return item->data_size;
+}
+
+/* Test description
+ * Verify that a trace records every NALU added to a signing and a validating session.
+ * The operation is as follows:
+ * 1. Generate a signed stream with a trace sink set on the signing session.
+ * 2. Verify that there is one record per added NALU, that is, not for the generated SEIs.
+ * 3. Validate the stream with a trace sink set and verify the records against the NALUs.
+ * 4. Verify that invalid records are not parsed.
+ */
+START_TEST(trace_signing_and_validation)
+{
+  // This test runs in a loop with loop index _i, corresponding to struct sv_setting _i in
+  // |settings|; See signed_video_helpers.h.
+
+  trace_t trace = {0};
+  signed_video_t *sv = get_initialized_signed_video(settings[_i].codec, settings[_i].algo, false);
+  ck_assert(sv);
+  ck_assert_int_eq(signed_video_set_authenticity_level(sv, settings[_i].auth_level), SV_OK);
+  ck_assert_int_eq(signed_video_set_trace_sink(NULL, store_trace_record, &trace),
+      SV_INVALID_PARAMETER);
+  ck_assert_int_eq(signed_video_set_trace_sink(sv, store_trace_record, &trace), SV_OK);
+  nalu_list_t *list = create_signed_nalus_with_sv(sv, "IPPIPPIPPI");
+  nalu_list_check_str(list, "GIPPGIPPGIPPGI");
+  signed_video_free(sv);
+  ck_assert_uint_eq(trace.size, 10 * SV_TRACE_RECORD_SIZE);
+
+  sv_trace_record_t record = {0};
+  uint64_t digests[10] = {0};
+  uint64_t prev_timestamp_ns = 0;
+  size_t idx = 0;
+  for (nalu_list_item_t *item = list->first_item; item; item = item->next) {
+    if (item->str_code[0] == 'G') continue;
+    ck_assert_int_eq(
+        signed_video_trace_parse_record(trace.data + idx * SV_TRACE_RECORD_SIZE,
+            SV_TRACE_RECORD_SIZE, &record),
+        SV_OK);
+    digests[idx++] = record.digest;
+    ck_assert(!record.is_validation);
+    ck_assert(!record.is_signed_video_sei);
+    ck_assert(record.is_primary_slice);
+    ck_assert(!record.has_report);
+    ck_assert_int_eq(record.codec, settings[_i].codec);
+    ck_assert_int_eq(record.nalu_type, settings[_i].codec == SV_CODEC_H264
+            ? (item->str_code[0] == 'I' ? 5 : 1)
+            : (item->str_code[0] == 'I' ? 19 : 1));
+    ck_assert_uint_eq(record.nalu_size, get_size_without_start_code(item));
+    ck_assert_int_eq(record.return_code, SV_OK);
+    ck_assert_uint_ge(record.timestamp_ns, prev_timestamp_ns);
+    prev_timestamp_ns = record.timestamp_ns + record.duration_ns;
+  }
+
+  // Validate with a trace.
+  trace.size = 0;
+  sv = signed_video_create(settings[_i].codec);
+  ck_assert(sv);
+  ck_assert_int_eq(signed_video_set_trace_sink(sv, store_trace_record, &trace), SV_OK);
+  int num_reports = 0;
+  for (nalu_list_item_t *item = list->first_item; item; item = item->next) {
+    signed_video_authenticity_t *auth_report = NULL;
+    ck_assert_int_eq(
+        signed_video_add_nalu_and_authenticate(sv, item->data, item->data_size, &auth_report),
+        SV_OK);
+    if (auth_report) num_reports++;
+    signed_video_authenticity_report_free(auth_report);
+  }
+  signed_video_free(sv);
+  ck_assert_int_eq(num_reports, 4);
+  ck_assert_uint_eq(trace.size, (size_t)list->num_items * SV_TRACE_RECORD_SIZE);
+
+  int num_traced_reports = 0;
+  size_t num_video_nalus = 0;
+  idx = 0;
+  for (nalu_list_item_t *item = list->first_item; item; item = item->next, idx++) {
+    ck_assert_int_eq(
+        signed_video_trace_parse_record(trace.data + idx * SV_TRACE_RECORD_SIZE,
+            SV_TRACE_RECORD_SIZE, &record),
+        SV_OK);
+    ck_assert(record.is_validation);
+    ck_assert(record.is_signed_video_sei == (item->str_code[0] == 'G'));
+    ck_assert_uint_eq(record.nalu_size, get_size_without_start_code(item));
+    ck_assert_int_eq(record.return_code, SV_OK);
+    if (record.has_report) num_traced_reports++;
+    // The same NALU gives the same digest on both sides.
+    if (!record.is_signed_video_sei) {
+      ck_assert_uint_eq(record.digest, digests[num_video_nalus++]);
+    }
+  }
+  ck_assert_int_eq(num_traced_reports, num_reports);
+  ck_assert_uint_eq(num_video_nalus, 10);
+
+  // Invalid records.
+  uint8_t data[SV_TRACE_RECORD_SIZE];
+  memcpy(data, trace.data, SV_TRACE_RECORD_SIZE);
+  ck_assert_int_eq(signed_video_trace_parse_record(NULL, SV_TRACE_RECORD_SIZE, &record),
+      SV_INVALID_PARAMETER);
+  ck_assert_int_eq(signed_video_trace_parse_record(data, SV_TRACE_RECORD_SIZE - 1, &record),
+      SV_INVALID_PARAMETER);
+  ck_assert_int_eq(
+      signed_video_trace_parse_record(data, SV_TRACE_RECORD_SIZE, NULL), SV_INVALID_PARAMETER);
+  data[2] = SV_CODEC_NUM;
+  ck_assert_int_eq(
+      signed_video_trace_parse_record(data, SV_TRACE_RECORD_SIZE, &record), SV_INVALID_PARAMETER);
+  data[0] = SV_TRACE_VERSION + 1;
+  ck_assert_int_eq(signed_video_trace_parse_record(data, SV_TRACE_RECORD_SIZE, &record),
+      SV_INCOMPATIBLE_VERSION);
+
+  nalu_list_free(list);
+}
+END_TEST
+
+START_TEST(session_counters)
+{
+  // This test runs in a loop with loop index _i, corresponding to struct sv_setting _i in
+  // |settings|; See signed_video_helpers.h.
+
+  sv_counters_t counters = {0};
+  signed_video_t *sv = get_initialized_signed_video(settings[_i].codec, settings[_i].algo, false);
+  ck_assert(sv);
+  ck_assert_int_eq(signed_video_set_authenticity_level(sv, settings[_i].auth_level), SV_OK);
+  ck_assert_int_eq(signed_video_get_counters(NULL, &counters, false), SV_INVALID_PARAMETER);
+  ck_assert_int_eq(signed_video_get_counters(sv, NULL, false), SV_INVALID_PARAMETER);
+  nalu_list_t *list = create_signed_nalus_with_sv(sv, "IPPIPPIPPI");
+  nalu_list_check_str(list, "GIPPGIPPGIPPGI");
+
+  ck_assert_int_eq(signed_video_get_counters(sv, &counters, true), SV_OK);
+  ck_assert_uint_eq(counters.num_i_nalus, 4);
+  ck_assert_uint_eq(counters.num_p_nalus, 6);
+  ck_assert_uint_eq(counters.num_sei_nalus, 0);
+  ck_assert_uint_eq(counters.num_invalid_nalus, 0);
+  ck_assert_uint_eq(counters.num_generated_seis, 4);
+  ck_assert_uint_eq(counters.num_signatures, 4);
+  ck_assert_uint_eq(counters.num_dropped_seis, 0);
+  ck_assert_uint_eq(counters.num_decoded_seis, 0);
+  ck_assert_uint_eq(counters.num_verifications, 0);
+  ck_assert_uint_ge(counters.num_hash_calls, 14);
+  ck_assert_uint_gt(counters.num_hashed_bytes, 0);
+  ck_assert_uint_gt(counters.num_combination_hashes, 0);
+  ck_assert_uint_eq(counters.max_pending_gops, 1);
+  ck_assert_uint_gt(counters.stage_time_ns[SV_STAGE_TLV_ENCODE], 0);
+  ck_assert_uint_gt(counters.stage_time_ns[SV_STAGE_SIGN], 0);
+  ck_assert_uint_eq(counters.stage_time_ns[SV_STAGE_VERIFY], 0);
+  // The counters were reset when read.
+  ck_assert_int_eq(signed_video_get_counters(sv, &counters, false), SV_OK);
+  ck_assert_uint_eq(counters.num_i_nalus, 0);
+  ck_assert_uint_eq(counters.num_signatures, 0);
+  ck_assert_uint_eq(counters.num_hash_calls, 0);
+  ck_assert_uint_eq(counters.max_pending_gops, 0);
+  ck_assert_uint_eq(counters.stage_time_ns[SV_STAGE_SIGN], 0);
+  signed_video_free(sv);
+
+  sv = signed_video_create(settings[_i].codec);
+  ck_assert(sv);
+  int num_reports = 0;
+  for (nalu_list_item_t *item = list->first_item; item; item = item->next) {
+    signed_video_authenticity_t *auth_report = NULL;
+    ck_assert_int_eq(
+        signed_video_add_nalu_and_authenticate(sv, item->data, item->data_size, &auth_report),
+        SV_OK);
+    if (auth_report) num_reports++;
+    signed_video_authenticity_report_free(auth_report);
+  }
+  ck_assert_int_eq(num_reports, 4);
+
+  ck_assert_int_eq(signed_video_get_counters(sv, &counters, false), SV_OK);
+  ck_assert_uint_eq(counters.num_i_nalus, 4);
+  ck_assert_uint_eq(counters.num_p_nalus, 6);
+  ck_assert_uint_eq(counters.num_sei_nalus, 4);
+  ck_assert_uint_eq(counters.num_generated_seis, 0);
+  ck_assert_uint_eq(counters.num_decoded_seis, 4);
+  ck_assert_uint_eq(counters.num_verifications, 4);
+  ck_assert_uint_eq(counters.num_verified_ok, 4);
+  ck_assert_uint_eq(counters.num_verified_not_ok, 0);
+  ck_assert_uint_eq(counters.num_verification_errors, 0);
+  ck_assert_uint_eq(counters.num_reports, 4);
+  ck_assert_uint_ge(counters.num_hash_calls, 14);
+  ck_assert_uint_gt(counters.max_nalu_list_length, 0);
+  ck_assert_uint_gt(counters.max_pending_gops, 0);
+  ck_assert_uint_gt(counters.stage_time_ns[SV_STAGE_TLV_DECODE], 0);
+  ck_assert_uint_gt(counters.stage_time_ns[SV_STAGE_VERIFY], 0);
+  ck_assert_uint_gt(counters.stage_time_ns[SV_STAGE_REPORT], 0);
+  ck_assert_uint_eq(counters.stage_time_ns[SV_STAGE_SIGN], 0);
+  // Without a reset the counters accumulate.
+  sv_counters_t more_counters = {0};
+  ck_assert_int_eq(signed_video_get_counters(sv, &more_counters, false), SV_OK);
+  ck_assert_uint_eq(more_counters.num_reports, counters.num_reports);
+
+  signed_video_free(sv);
+  nalu_list_free(list);
+}
+END_TEST
+
 static Suite *
 signed_video_suite(void)
 {
@@ -1665,13 +3774,29 @@ signed_video_suite(void)
   tcase_add_loop_test(tc, detect_change_of_public_key, s, e);
   tcase_add_loop_test(tc, fast_forward_stream_with_reset, s, e);
   tcase_add_loop_test(tc, fast_forward_stream_without_reset, s, e);
+  tcase_add_loop_test(tc, fast_forward_stream_with_reset_after_seek, s, e);
   tcase_add_loop_test(tc, fast_forward_stream_with_delayed_seis, s, e);
   tcase_add_loop_test(tc, file_export_with_dangling_end, s, e);
   tcase_add_loop_test(tc, file_export_without_dangling_end, s, e);
   tcase_add_loop_test(tc, no_signature, s, e);
   tcase_add_loop_test(tc, multislice_no_signature, s, e);
   tcase_add_loop_test(tc, late_public_key_and_no_sei_before_key_arrives, s, e);
+  tcase_add_loop_test(tc, late_public_key_with_many_pending_gops, s, e);
   tcase_add_loop_test(tc, fallback_to_gop_level, s, e);
+  tcase_add_loop_test(tc, intermediate_seis_in_long_gops, s, e);
+  tcase_add_loop_test(tc, sequenced_nalus_from_concurrent_producers, s, e);
+  tcase_add_loop_test(tc, validation_service_with_many_sessions, s, e);
+  tcase_add_loop_test(tc, early_verdict_at_sei_arrival, s, e);
+  tcase_add_loop_test(tc, validate_gop_range_in_the_middle, s, e);
+  tcase_add_loop_test(tc, verification_cache_on_backward_scrubbing, s, e);
+  tcase_add_loop_test(tc, checkpoint_and_restore_validation, s, e);
+  tcase_add_loop_test(tc, validate_and_store_results, s, e);
+  tcase_add_loop_test(tc, detached_seis_in_sidecar_stream, s, e);
+  tcase_add_loop_test(tc, validate_mp4_file, s, e);
+  tcase_add_loop_test(tc, validate_ts_stream, s, e);
+  tcase_add_loop_test(tc, validate_rtp_stream, s, e);
+  tcase_add_loop_test(tc, trace_signing_and_validation, s, e);
+  tcase_add_loop_test(tc, session_counters, s, e);
 #ifdef SV_VENDOR_AXIS_COMMUNICATIONS
   tcase_add_loop_test(tc, vendor_axis_communications_operation, s, e);
 #endif
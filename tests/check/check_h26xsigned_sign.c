@@ -18,11 +18,22 @@
  * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
+#define _GNU_SOURCE  // CPU_SET, sched_getaffinity
 #include <check.h>
+#include <dirent.h>  // opendir, readdir, closedir
+#include <poll.h>  // poll
+#include <sched.h>  // cpu_set_t, sched_getaffinity
+#include <signal.h>  // sigaction, SIGUSR1
+#include <stdio.h>  // FILE, fopen, fgets, fclose, snprintf
 #include <stdlib.h>
 #include <string.h>
+#include <sys/syscall.h>  // SYS_tgkill
+#include <sys/types.h>  // pid_t
+#include <time.h>  // nanosleep
+#include <unistd.h>  // getpid, syscall, usleep
 
 #include "lib/src/includes/signed_video_common.h"
+#include "lib/src/includes/signed_video_counters.h"  // signed_video_get_counters()
 #include "lib/src/includes/signed_video_openssl.h"
 #include "lib/src/includes/signed_video_sign.h"
 #ifdef SV_VENDOR_AXIS_COMMUNICATIONS
@@ -74,6 +85,64 @@ done:
   return sv_rc;
 }
 
+#if defined(SV_THREADED_SIGNING_PLUGIN_PATH) || defined(SV_DEADLINE_SIGNING_PLUGIN_PATH)
+/* Returns the number of SEIs in |list|. */
+static int
+count_seis(const nalu_list_t *list)
+{
+  int num_seis = 0;
+  for (const nalu_list_item_t *item = list->first_item; item; item = item->next) {
+    if (item->str_code[0] == 'G') num_seis++;
+  }
+  return num_seis;
+}
+
+/* Waits on the file descriptor of signed_video_get_signature_fd() until the |num_pending_seis|
+ * SEIs of the session have been completed, and pulls them. Returns the number of SEIs pulled. */
+static int
+wait_for_pending_seis(signed_video_t *sv, int num_pending_seis)
+{
+  int fd = -1;
+  ck_assert_int_eq(signed_video_get_signature_fd(sv, &fd), SV_OK);
+  struct pollfd poll_fd = {.fd = fd, .events = POLLIN};
+  int num_seis = 0;
+  while (num_seis < num_pending_seis) {
+    ck_assert_int_eq(poll(&poll_fd, 1, 10000), 1);
+    ck_assert_int_eq(signed_video_finalize_pending_seis(sv), SV_OK);
+    int nalus_pulled = 0;
+    ck_assert_int_eq(pull_nalus(sv, -1, &nalus_pulled), SV_OK);
+    num_seis += nalus_pulled;
+  }
+  return num_seis;
+}
+
+/* Finds the threads of this process named |name|. Writes at most |max_tids| thread ids to |tids|
+ * and returns the number written. */
+static int
+find_threads(const char *name, pid_t *tids, int max_tids)
+{
+  int num_tids = 0;
+  DIR *tasks = opendir("/proc/self/task");
+  ck_assert(tasks);
+  struct dirent *task = NULL;
+  while (num_tids < max_tids && (task = readdir(tasks))) {
+    if (task->d_name[0] == '.') continue;
+    char path[300] = {0};
+    char comm[32] = {0};
+    snprintf(path, sizeof(path), "/proc/self/task/%s/comm", task->d_name);
+    FILE *file = fopen(path, "r");
+    if (!file) continue;
+    if (fgets(comm, sizeof(comm), file)) {
+      comm[strcspn(comm, "\n")] = '\0';
+      if (strcmp(comm, name) == 0) tids[num_tids++] = (pid_t)atoi(task->d_name);
+    }
+    fclose(file);
+  }
+  closedir(tasks);
+  return num_tids;
+}
+#endif
+
 /* Test description
  * All public APIs are checked for invalid parameters, and valid NULL pointer inputs. This is done
  * for both H264 and H265.
@@ -121,10 +190,43 @@ START_TEST(api_inputs)
   // Adding nalu for signing without setting private key is invalid.
   sv_rc = signed_video_add_nalu_for_signing(sv, p_nalu->data, p_nalu->data_size);
   ck_assert_int_eq(sv_rc, SV_NOT_SUPPORTED);
+  // Finalizing SEIs without setting private key is invalid.
+  sv_rc = signed_video_finalize_pending_seis(sv);
+  ck_assert_int_eq(sv_rc, SV_NOT_SUPPORTED);
   // Will set keys.
   sv_rc = signed_video_set_private_key(sv, algo, private_key, private_key_size);
   ck_assert_int_eq(sv_rc, SV_OK);
 
+  // Check signing worker configuration and statistics. The unthreaded plugin has no workers.
+  sv_worker_config_t worker_config = {0};
+  sv_worker_stats_t worker_stats = {0};
+  size_t num_worker_stats = 0;
+  sv_rc = signed_video_set_signing_worker_config(NULL, &worker_config);
+  ck_assert_int_eq(sv_rc, SV_INVALID_PARAMETER);
+  sv_rc = signed_video_set_signing_worker_config(sv, NULL);
+  ck_assert_int_eq(sv_rc, SV_INVALID_PARAMETER);
+  sv_rc = signed_video_set_signing_worker_config(sv, &worker_config);
+  ck_assert_int_eq(sv_rc, SV_NOT_SUPPORTED);
+  sv_rc = signed_video_get_signing_worker_stats(NULL, &worker_stats, 1, &num_worker_stats);
+  ck_assert_int_eq(sv_rc, SV_INVALID_PARAMETER);
+  sv_rc = signed_video_get_signing_worker_stats(sv, NULL, 1, &num_worker_stats);
+  ck_assert_int_eq(sv_rc, SV_INVALID_PARAMETER);
+  sv_rc = signed_video_get_signing_worker_stats(sv, &worker_stats, 0, &num_worker_stats);
+  ck_assert_int_eq(sv_rc, SV_INVALID_PARAMETER);
+  sv_rc = signed_video_get_signing_worker_stats(sv, &worker_stats, 1, NULL);
+  ck_assert_int_eq(sv_rc, SV_INVALID_PARAMETER);
+  sv_rc = signed_video_get_signing_worker_stats(sv, &worker_stats, 1, &num_worker_stats);
+  ck_assert_int_eq(sv_rc, SV_NOT_SUPPORTED);
+  ck_assert_int_eq(num_worker_stats, 0);
+  // Check deadline statistics. The unthreaded plugin has no deadlines.
+  sv_deadline_stats_t deadline_stats = {0};
+  sv_rc = signed_video_get_signing_deadline_stats(NULL, &deadline_stats);
+  ck_assert_int_eq(sv_rc, SV_INVALID_PARAMETER);
+  sv_rc = signed_video_get_signing_deadline_stats(sv, NULL);
+  ck_assert_int_eq(sv_rc, SV_INVALID_PARAMETER);
+  sv_rc = signed_video_get_signing_deadline_stats(sv, &deadline_stats);
+  ck_assert_int_eq(sv_rc, SV_NOT_SUPPORTED);
+
   // Check setting recurrence
   sv_rc = signed_video_set_recurrence_interval_frames(NULL, 1);
   ck_assert_int_eq(sv_rc, SV_INVALID_PARAMETER);
@@ -165,6 +267,25 @@ START_TEST(api_inputs)
   ck_assert_int_eq(sv_rc, SV_INVALID_PARAMETER);
   sv_rc = signed_video_get_nalu_to_prepend(sv, NULL);
   ck_assert_int_eq(sv_rc, SV_INVALID_PARAMETER);
+  // Checking signed_video_get_signature_fd() for NULL pointers. The unthreaded plugin signs at once
+  // and has no file descriptor.
+  int fd = -1;
+  sv_rc = signed_video_get_signature_fd(NULL, &fd);
+  ck_assert_int_eq(sv_rc, SV_INVALID_PARAMETER);
+  sv_rc = signed_video_get_signature_fd(sv, NULL);
+  ck_assert_int_eq(sv_rc, SV_INVALID_PARAMETER);
+  sv_rc = signed_video_get_signature_fd(sv, &fd);
+  ck_assert_int_eq(sv_rc, SV_NOT_SUPPORTED);
+  ck_assert_int_eq(fd, -1);
+  // Checking signed_video_finalize_pending_seis() for NULL pointers. Without pending SEIs there is
+  // nothing to pull.
+  sv_rc = signed_video_finalize_pending_seis(NULL);
+  ck_assert_int_eq(sv_rc, SV_INVALID_PARAMETER);
+  sv_rc = signed_video_finalize_pending_seis(sv);
+  ck_assert_int_eq(sv_rc, SV_OK);
+  sv_rc = signed_video_get_nalu_to_prepend(sv, &nalu_to_prepend);
+  ck_assert_int_eq(sv_rc, SV_OK);
+  ck_assert_int_eq(nalu_to_prepend.prepend_instruction, SIGNED_VIDEO_PREPEND_NOTHING);
   // Checking signed_video_set_end_of_stream() for NULL pointers.
   sv_rc = signed_video_set_end_of_stream(NULL);
   ck_assert_int_eq(sv_rc, SV_INVALID_PARAMETER);
@@ -588,6 +709,418 @@ START_TEST(recurrence)
 }
 END_TEST
 
+/* Test description
+ * Checks loading a signing plugin at runtime. Invalid inputs and plugins that do not exist should
+ * fail without affecting the session. If a plugin shared object is available it is loaded, and
+ * signing
+ *   IPPIPP
+ * should give
+ *   GIPPGIPP
+ * as with the built-in plugin. Changing plugin after signing has started is not supported.
+ */
+START_TEST(signing_plugin)
+{
+  signed_video_t *sv = get_initialized_signed_video(settings[_i].codec, settings[_i].algo, false);
+  ck_assert(sv);
+
+  ck_assert_int_eq(signed_video_set_signing_plugin(NULL, "unthreaded-signing"),
+      SV_INVALID_PARAMETER);
+  ck_assert_int_eq(signed_video_set_signing_plugin(sv, NULL), SV_INVALID_PARAMETER);
+  ck_assert_int_eq(signed_video_set_signing_plugin(sv, ""), SV_INVALID_PARAMETER);
+  ck_assert_int_eq(signed_video_set_signing_plugin(sv, "no-such-plugin"), SV_EXTERNAL_ERROR);
+  ck_assert_int_eq(signed_video_set_signing_plugin(sv, "./no-such-plugin.so"), SV_EXTERNAL_ERROR);
+#ifdef SV_TEST_PLUGIN_PATH
+  ck_assert_int_eq(signed_video_set_signing_plugin(sv, SV_TEST_PLUGIN_PATH), SV_OK);
+#endif
+  ck_assert_int_eq(signed_video_set_authenticity_level(sv, settings[_i].auth_level), SV_OK);
+
+  nalu_list_t *list = create_signed_nalus_with_sv(sv, "IPPIPP");
+  nalu_list_check_str(list, "GIPPGIPP");
+  nalu_list_free(list);
+
+  // The signing has started, hence the plugin cannot be changed.
+#ifdef SV_TEST_PLUGIN_PATH
+  ck_assert_int_eq(signed_video_set_signing_plugin(sv, SV_TEST_PLUGIN_PATH), SV_NOT_SUPPORTED);
+#endif
+  ck_assert_int_eq(signed_video_set_signing_plugin(sv, "no-such-plugin"), SV_NOT_SUPPORTED);
+
+  signed_video_free(sv);
+}
+END_TEST
+
+#ifdef SV_HELD_SIGNING_PLUGIN_PATH
+/* Test description
+ * Checks that no SEI is lost when several SEIs wait for their signatures. The test plugin holds the
+ * signatures until three are waiting, and then releases all of them. Signing
+ *   IPPIPPIPPIPPPP
+ * should give
+ *   IPPIPPGGGIPPIPPPP
+ * that is, the SEIs of the first three I-NALUs are all added in front of the third one.
+ */
+START_TEST(several_seis_waiting_for_signatures)
+{
+  signed_video_t *sv = get_initialized_signed_video(settings[_i].codec, settings[_i].algo, false);
+  ck_assert(sv);
+  ck_assert_int_eq(signed_video_set_signing_plugin(sv, SV_HELD_SIGNING_PLUGIN_PATH), SV_OK);
+  ck_assert_int_eq(signed_video_set_authenticity_level(sv, settings[_i].auth_level), SV_OK);
+
+  // The plugin has none of the optional interfaces.
+  int fd = -1;
+  ck_assert_int_eq(signed_video_get_signature_fd(sv, &fd), SV_NOT_SUPPORTED);
+  sv_worker_config_t worker_config = {0};
+  ck_assert_int_eq(signed_video_set_signing_worker_config(sv, &worker_config), SV_NOT_SUPPORTED);
+
+  nalu_list_t *list = create_signed_nalus_with_sv(sv, "IPPIPPIPPIPPPP");
+  nalu_list_check_str(list, "IPPIPPGGGIPPIPPPP");
+  sv_counters_t counters = {0};
+  ck_assert_int_eq(signed_video_get_counters(sv, &counters, false), SV_OK);
+  ck_assert_uint_ge(counters.max_pending_gops, 3);
+  ck_assert_uint_eq(counters.num_dropped_seis, 0);
+
+  nalu_list_free(list);
+  signed_video_free(sv);
+}
+END_TEST
+#endif
+
+#ifdef SV_THREADED_SIGNING_PLUGIN_PATH
+/* Test description
+ * Checks signing with the threaded plugin, which signs on a worker thread. Bursts of four GOPs
+ *   IPPIPPIPPIPP
+ * are added back to back, hence SEIs wait for their signatures while the next GOPs are added. The
+ * remaining SEIs are waited for after each burst. In total, many more hashes than the plugin has
+ * slots pass through its ring. Every I-NALU should get a SEI and no SEI should be dropped.
+ */
+START_TEST(threaded_signing_plugin)
+{
+  const int num_bursts = 12;
+  const int gops_per_burst = 4;
+  signed_video_t *sv = get_initialized_signed_video(settings[_i].codec, settings[_i].algo, false);
+  ck_assert(sv);
+  ck_assert_int_eq(signed_video_set_signing_plugin(sv, SV_THREADED_SIGNING_PLUGIN_PATH), SV_OK);
+  ck_assert_int_eq(signed_video_set_authenticity_level(sv, settings[_i].auth_level), SV_OK);
+
+  int num_seis = 0;
+  for (int burst = 1; burst <= num_bursts; burst++) {
+    nalu_list_t *list = create_signed_nalus_with_sv(sv, "IPPIPPIPPIPP");
+    num_seis += count_seis(list);
+    nalu_list_free(list);
+    num_seis += wait_for_pending_seis(sv, burst * gops_per_burst - num_seis);
+  }
+  ck_assert_int_eq(num_seis, num_bursts * gops_per_burst);
+
+  sv_counters_t counters = {0};
+  ck_assert_int_eq(signed_video_get_counters(sv, &counters, false), SV_OK);
+  ck_assert_uint_eq(counters.num_generated_seis, num_bursts * gops_per_burst);
+  ck_assert_uint_eq(counters.num_signatures, num_bursts * gops_per_burst);
+  ck_assert_uint_eq(counters.num_dropped_seis, 0);
+
+  signed_video_free(sv);
+}
+END_TEST
+#endif
+
+#ifdef SV_THREADED_SIGNING_PLUGIN_PATH
+/* Test description
+ * Checks that a SEI waiting for its signature can be completed without adding a new NALU. With the
+ * threaded plugin the signature of the SEI of a just ended GOP is normally not ready when the
+ * I-NALU has been added. Then the file descriptor from signed_video_get_signature_fd() becomes
+ * readable when the signature is ready, and signed_video_finalize_pending_seis() completes the SEI,
+ * which can be pulled before the next NALU is added.
+ */
+START_TEST(finalize_pending_seis_on_signature_fd)
+{
+  signed_video_t *sv = get_initialized_signed_video(settings[_i].codec, settings[_i].algo, false);
+  ck_assert(sv);
+  ck_assert_int_eq(signed_video_set_signing_plugin(sv, SV_THREADED_SIGNING_PLUGIN_PATH), SV_OK);
+  ck_assert_int_eq(signed_video_set_authenticity_level(sv, settings[_i].auth_level), SV_OK);
+  int fd = -1;
+  ck_assert_int_eq(signed_video_get_signature_fd(sv, &fd), SV_OK);
+  ck_assert_int_ge(fd, 0);
+
+  // End GOPs until a SEI is left waiting for its signature, which is normally the first one.
+  sv_counters_t counters = {0};
+  int num_gops = 0;
+  do {
+    ck_assert_int_lt(num_gops++, 100);
+    nalu_list_t *list = create_signed_nalus_with_sv(sv, "IPP");
+    nalu_list_free(list);
+    list = create_signed_nalus_with_sv(sv, "I");
+    nalu_list_free(list);
+    ck_assert_int_eq(signed_video_get_counters(sv, &counters, false), SV_OK);
+  } while (counters.num_signatures + counters.num_dropped_seis == counters.num_generated_seis);
+
+  // Wait for the signature and complete the SEI without adding a NALU.
+  struct pollfd poll_fd = {.fd = fd, .events = POLLIN};
+  ck_assert_int_eq(poll(&poll_fd, 1, 10000), 1);
+  ck_assert(poll_fd.revents & POLLIN);
+  ck_assert_int_eq(signed_video_finalize_pending_seis(sv), SV_OK);
+  signed_video_nalu_to_prepend_t nalu_to_prepend = {0};
+  ck_assert_int_eq(signed_video_get_nalu_to_prepend(sv, &nalu_to_prepend), SV_OK);
+  ck_assert_int_eq(nalu_to_prepend.prepend_instruction, SIGNED_VIDEO_PREPEND_NALU);
+  nalu_list_item_t *sei = nalu_list_create_item(
+      nalu_to_prepend.nalu_data, nalu_to_prepend.nalu_data_size, settings[_i].codec);
+  nalu_list_item_check_str(sei, "G");
+  nalu_list_free_item(sei);
+  ck_assert_int_eq(pull_nalus(sv, -1, NULL), SV_OK);
+  // Wait for the SEIs still waiting for their signatures, if any.
+  ck_assert_int_eq(signed_video_get_counters(sv, &counters, false), SV_OK);
+  wait_for_pending_seis(sv, (int)(counters.num_generated_seis - counters.num_signatures));
+  ck_assert_int_eq(signed_video_get_counters(sv, &counters, false), SV_OK);
+  ck_assert_uint_eq(counters.num_signatures, counters.num_generated_seis);
+  ck_assert_uint_eq(counters.num_dropped_seis, 0);
+
+  signed_video_free(sv);
+}
+END_TEST
+#endif
+
+#ifdef SV_THREADED_SIGNING_PLUGIN_PATH
+/* Test description
+ * Checks the configuration and statistics of the worker thread of the threaded plugin. The worker
+ * is renamed and pinned to one CPU, which is read back from the thread, and the statistics should
+ * advance when signing.
+ */
+START_TEST(threaded_signing_worker)
+{
+  signed_video_t *sv = get_initialized_signed_video(settings[_i].codec, settings[_i].algo, false);
+  ck_assert(sv);
+  ck_assert_int_eq(signed_video_set_signing_plugin(sv, SV_THREADED_SIGNING_PLUGIN_PATH), SV_OK);
+  ck_assert_int_eq(signed_video_set_authenticity_level(sv, settings[_i].auth_level), SV_OK);
+
+  // Pin the worker to the first CPU this process may run on.
+  cpu_set_t cpus;
+  CPU_ZERO(&cpus);
+  ck_assert_int_eq(sched_getaffinity(0, sizeof(cpus), &cpus), 0);
+  int cpu = 0;
+  while (cpu < 64 && !CPU_ISSET(cpu, &cpus)) cpu++;
+  ck_assert_int_lt(cpu, 64);
+  sv_worker_config_t worker_config = {0};
+  worker_config.name = "sv-test-signer";
+  worker_config.cpu_mask = (uint64_t)1 << cpu;
+  ck_assert_int_eq(signed_video_set_signing_worker_config(sv, &worker_config), SV_OK);
+  // A name longer than 15 characters is rejected.
+  worker_config.name = "sv-test-signer-too-long";
+  ck_assert_int_eq(
+      signed_video_set_signing_worker_config(sv, &worker_config), SV_INVALID_PARAMETER);
+
+  // Read back the name and the CPU affinity of the worker.
+  pid_t tid = 0;
+  ck_assert_int_eq(find_threads("sv-test-signer", &tid, 1), 1);
+  CPU_ZERO(&cpus);
+  ck_assert_int_eq(sched_getaffinity(tid, sizeof(cpus), &cpus), 0);
+  ck_assert_int_eq(CPU_COUNT(&cpus), 1);
+  ck_assert(CPU_ISSET(cpu, &cpus));
+
+  sv_worker_stats_t stats_before = {0};
+  sv_worker_stats_t stats_after = {0};
+  size_t num_stats = 0;
+  ck_assert_int_eq(signed_video_get_signing_worker_stats(sv, &stats_before, 1, &num_stats), SV_OK);
+  ck_assert_int_eq(num_stats, 1);
+  nalu_list_t *list = create_signed_nalus_with_sv(sv, "IPPIPPIPP");
+  int num_seis = count_seis(list);
+  nalu_list_free(list);
+  num_seis += wait_for_pending_seis(sv, 3 - num_seis);
+  ck_assert_int_eq(num_seis, 3);
+  ck_assert_int_eq(signed_video_get_signing_worker_stats(sv, &stats_after, 1, &num_stats), SV_OK);
+  ck_assert_int_eq(num_stats, 1);
+  ck_assert_uint_eq(stats_after.num_signed_hashes, stats_before.num_signed_hashes + 3);
+  ck_assert_uint_gt(stats_after.busy_time_us, stats_before.busy_time_us);
+  ck_assert_uint_gt(stats_after.elapsed_time_us, stats_before.elapsed_time_us);
+  ck_assert_uint_ge(stats_after.elapsed_time_us, stats_after.busy_time_us);
+
+  signed_video_free(sv);
+}
+END_TEST
+#endif
+
+#ifdef SV_DEADLINE_SIGNING_PLUGIN_PATH
+// The time the workers of the deadline plugin are stalled, to make them miss a deadline.
+#define STALL_TIME_US 50000
+
+/* Signal handler stalling the thread it runs on. */
+static void
+stall_thread(int signo)
+{
+  (void)signo;
+  struct timespec stall_time = {.tv_nsec = STALL_TIME_US * 1000};
+  nanosleep(&stall_time, NULL);
+}
+
+/* Test description
+ * Two sessions with different cadence share the workers of the deadline plugin. Session A adds a
+ * GOP every 5 ms and session B every 20 ms. Then, with all workers stalled, session A adds one more
+ * GOP, which cannot be signed before its deadline.
+ * Checks that the cadence of both sessions is estimated, that all hashes are signed, and that the
+ * missed deadline is accounted for.
+ */
+START_TEST(deadline_signing_plugin)
+{
+  signed_video_t *sv[2] = {NULL, NULL};
+  for (int i = 0; i < 2; i++) {
+    sv[i] = get_initialized_signed_video(settings[_i].codec, settings[_i].algo, false);
+    ck_assert(sv[i]);
+    ck_assert_int_eq(
+        signed_video_set_signing_plugin(sv[i], SV_DEADLINE_SIGNING_PLUGIN_PATH), SV_OK);
+    ck_assert_int_eq(signed_video_set_authenticity_level(sv[i], settings[_i].auth_level), SV_OK);
+  }
+
+  int num_seis[2] = {0, 0};
+  for (int n = 0; n < 17; n++) {
+    for (int i = 0; i < 2; i++) {
+      if (i == 1 && n % 4 != 0) continue;
+      nalu_list_t *list = create_signed_nalus_with_sv(sv[i], "IPP");
+      num_seis[i] += count_seis(list);
+      nalu_list_free(list);
+    }
+    usleep(5000);
+  }
+  sv_deadline_stats_t stats[2] = {0};
+  for (int i = 0; i < 2; i++) {
+    ck_assert_int_eq(signed_video_get_signing_deadline_stats(sv[i], &stats[i]), SV_OK);
+    ck_assert_uint_gt(stats[i].cadence_us, 0);
+  }
+  ck_assert_uint_lt(stats[0].cadence_us, stats[1].cadence_us);
+
+  // Stall all workers and add one more GOP to session A. The signal is handled before a worker
+  // can pick up the hash.
+  struct sigaction stall_action = {.sa_handler = stall_thread};
+  struct sigaction old_action = {0};
+  ck_assert_int_eq(sigaction(SIGUSR1, &stall_action, &old_action), 0);
+  pid_t tids[8] = {0};
+  int num_workers = find_threads("sv-signing-edf", tids, 8);
+  ck_assert_int_gt(num_workers, 0);
+  for (int w = 0; w < num_workers; w++) {
+    ck_assert_int_eq(syscall(SYS_tgkill, getpid(), tids[w], SIGUSR1), 0);
+  }
+  nalu_list_t *list = create_signed_nalus_with_sv(sv[0], "IPP");
+  num_seis[0] += count_seis(list);
+  nalu_list_free(list);
+
+  // Collect the remaining SEIs. One SEI is generated per GOP, i.e., 18 and 5.
+  num_seis[0] += wait_for_pending_seis(sv[0], 18 - num_seis[0]);
+  num_seis[1] += wait_for_pending_seis(sv[1], 5 - num_seis[1]);
+  ck_assert_int_eq(sigaction(SIGUSR1, &old_action, NULL), 0);
+  ck_assert_int_eq(num_seis[0], 18);
+  ck_assert_int_eq(num_seis[1], 5);
+
+  for (int i = 0; i < 2; i++) {
+    sv_counters_t counters = {0};
+    ck_assert_int_eq(signed_video_get_counters(sv[i], &counters, false), SV_OK);
+    ck_assert_uint_eq(counters.num_signatures, counters.num_generated_seis);
+    ck_assert_uint_eq(counters.num_dropped_seis, 0);
+    ck_assert_int_eq(signed_video_get_signing_deadline_stats(sv[i], &stats[i]), SV_OK);
+    ck_assert_uint_eq(stats[i].num_signed_hashes, counters.num_generated_seis);
+    ck_assert_uint_le(stats[i].num_missed_deadlines, stats[i].num_signed_hashes);
+    if (stats[i].num_missed_deadlines == 0) ck_assert_uint_eq(stats[i].max_lateness_us, 0);
+  }
+  // The stalled GOP of session A missed its deadline by about the stall time less the cadence.
+  ck_assert_uint_ge(stats[0].num_missed_deadlines, 1);
+  ck_assert_uint_gt(stats[0].max_lateness_us, 0);
+  ck_assert_uint_lt(stats[0].max_lateness_us, 10 * STALL_TIME_US);
+
+  for (int i = 0; i < 2; i++) signed_video_free(sv[i]);
+}
+END_TEST
+#endif
+
+/* A GOP index sink storing the records back to back in a gop_index_t. */
+typedef struct {
+  uint8_t data[10 * SV_GOP_INDEX_RECORD_SIZE];
+  size_t size;
+} gop_index_t;
+
+static void
+store_gop_index_record(const uint8_t *record, size_t record_size, void *user_data)
+{
+  gop_index_t *index = (gop_index_t *)user_data;
+  ck_assert_int_eq(record_size, SV_GOP_INDEX_RECORD_SIZE);
+  ck_assert_uint_le(index->size + record_size, sizeof(index->data));
+  memcpy(index->data + index->size, record, record_size);
+  index->size += record_size;
+}
+
+/* Test description
+ * Verify that a GOP index record is produced for each SEI and that the records point out the SEIs
+ * and the I-NALUs in the signed stream.
+ * The operation is as follows:
+ * 1. Generate a nalu_list with a GOP index sink set.
+ * 2. Check each record against the positions of the NALUs in the stream.
+ * 3. Look up GOPs in the index.
+ */
+START_TEST(gop_index_sidecar)
+{
+  // This test runs in a loop with loop index _i, corresponding to struct sv_setting _i in
+  // |settings|; See signed_video_helpers.h.
+
+  gop_index_t index = {0};
+  signed_video_t *sv = get_initialized_signed_video(settings[_i].codec, settings[_i].algo, false);
+  ck_assert(sv);
+  ck_assert_int_eq(signed_video_set_authenticity_level(sv, settings[_i].auth_level), SV_OK);
+  ck_assert_int_eq(
+      signed_video_set_gop_index_sink(NULL, store_gop_index_record, &index), SV_INVALID_PARAMETER);
+  ck_assert_int_eq(signed_video_set_gop_index_sink(sv, store_gop_index_record, &index), SV_OK);
+
+  nalu_list_t *list = create_signed_nalus_with_sv(sv, "IPPIPPPIPPI");
+  nalu_list_check_str(list, "GIPPGIPPPGIPPGI");
+  ck_assert_int_eq(index.size, 4 * SV_GOP_INDEX_RECORD_SIZE);
+
+  // Hashable NALUs signed by each SEI. The first SEI signs the I-NALU it is prepended to only.
+  const uint32_t expected_num_nalus[4] = {1, 3, 4, 3};
+  sv_gop_index_record_t record = {0};
+  uint64_t offset = 0;
+  uint64_t gop_offset = 0;
+  uint64_t second_gop_p_offset = 0;
+  int num_records = 0;
+  uint32_t first_gop_counter = 0;
+  for (int i = 1; i <= list->num_items; i++) {
+    nalu_list_item_t *item = nalu_list_get_item(list, i);
+    if (item->str_code[0] == 'G') {
+      ck_assert_int_eq(
+          signed_video_gop_index_get_record(index.data, index.size, num_records, &record), SV_OK);
+      if (num_records == 0) first_gop_counter = record.gop_counter;
+      ck_assert_uint_eq(record.gop_counter, first_gop_counter + num_records);
+      ck_assert_uint_eq(record.sei_offset, offset);
+      ck_assert_uint_eq(record.sei_size, item->data_size);
+      ck_assert_uint_eq(record.gop_offset, gop_offset);
+      ck_assert_uint_eq(record.num_nalus, expected_num_nalus[num_records]);
+      ck_assert(!record.is_intermediate);
+      num_records++;
+    }
+    // The GOP starting with this I-NALU is signed by the next SEI.
+    if (item->str_code[0] == 'I') gop_offset = offset;
+    if (i == 8) {
+      nalu_list_item_check_str(item, "P");
+      second_gop_p_offset = offset;
+    }
+    offset += item->data_size;
+  }
+  ck_assert_int_eq(num_records, 4);
+  ck_assert_int_eq(
+      signed_video_gop_index_get_record(index.data, index.size, 4, &record), SV_INVALID_PARAMETER);
+
+  // A P-NALU in the second GOP is found in the GOP signed by the third SEI.
+  size_t record_idx = 0;
+  SignedVideoReturnCode rc = signed_video_gop_index_find(
+      index.data, index.size, second_gop_p_offset, &record, &record_idx);
+  ck_assert_int_eq(rc, SV_OK);
+  ck_assert_int_eq(record_idx, 2);
+  ck_assert_uint_lt(record.gop_offset, second_gop_p_offset);
+  ck_assert_uint_gt(record.sei_offset, second_gop_p_offset);
+  // Only the first SEI precedes the first I-NALU, and it signs nothing before it.
+  ck_assert_int_eq(signed_video_gop_index_find(index.data, index.size, 0, &record, NULL), SV_OK);
+  ck_assert_uint_eq(record.gop_offset, 0);
+  ck_assert_int_eq(signed_video_gop_index_find(index.data, 0, 0, &record, NULL), SV_NOT_SUPPORTED);
+  // Records of unknown versions are rejected.
+  index.data[0] = SV_GOP_INDEX_VERSION + 1;
+  ck_assert_int_eq(signed_video_gop_index_parse_record(index.data, index.size, &record),
+      SV_INCOMPATIBLE_VERSION);
+
+  nalu_list_free(list);
+  signed_video_free(sv);
+}
+END_TEST
+
 static Suite *
 signed_video_suite(void)
 {
@@ -616,6 +1149,19 @@ signed_video_suite(void)
   tcase_add_loop_test(tc, fallback_to_gop_level, s, e);
   tcase_add_loop_test(tc, undefined_nalu_in_sequence, s, e);
   tcase_add_loop_test(tc, recurrence, s, e);
+  tcase_add_loop_test(tc, signing_plugin, s, e);
+#ifdef SV_HELD_SIGNING_PLUGIN_PATH
+  tcase_add_loop_test(tc, several_seis_waiting_for_signatures, s, e);
+#endif
+#ifdef SV_THREADED_SIGNING_PLUGIN_PATH
+  tcase_add_loop_test(tc, threaded_signing_plugin, s, e);
+  tcase_add_loop_test(tc, finalize_pending_seis_on_signature_fd, s, e);
+  tcase_add_loop_test(tc, threaded_signing_worker, s, e);
+#endif
+#ifdef SV_DEADLINE_SIGNING_PLUGIN_PATH
+  tcase_add_loop_test(tc, deadline_signing_plugin, s, e);
+#endif
+  tcase_add_loop_test(tc, gop_index_sidecar, s, e);
 
   // Add test case to suit
   suite_add_tcase(suite, tc);
@@ -0,0 +1,130 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2023 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next paragraph) shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * A signing plugin for tests, which signs in the calling thread, like the unthreaded plugin, but
+ * holds the signatures until HELD_SIGNATURES of them are waiting to be pulled. Then all of them are
+ * released in order. Hence, the library always has several SEIs waiting for their signatures, as
+ * happens with a slow signing thread, but in a deterministic way.
+ *
+ * Only the mandatory interfaces are defined, hence loading the plugin also tests the fallbacks of
+ * the optional ones.
+ */
+#include <stdlib.h>  // calloc, free
+#include <string.h>  // memcpy
+
+#include "lib/src/includes/signed_video_interfaces.h"
+#include "lib/src/includes/signed_video_openssl.h"
+
+// The number of signatures held before releasing them.
+#define HELD_SIGNATURES 3
+// The library never has more than MAX_NALUS_TO_PREPEND (5) SEIs waiting for a signature.
+#define MAX_SIGNATURES 8
+
+typedef struct {
+  uint8_t *signatures[MAX_SIGNATURES];
+  size_t signature_sizes[MAX_SIGNATURES];
+  size_t num_signatures;  // Signatures waiting to be pulled, the oldest first.
+  bool is_releasing;  // Set while releasing the held signatures.
+} sv_held_plugin_t;
+
+/**
+ * Definitions of declared interfaces.
+ */
+
+SignedVideoReturnCode
+sv_interface_sign_hash(void *plugin_handle, signature_info_t *signature_info)
+{
+  sv_held_plugin_t *self = (sv_held_plugin_t *)plugin_handle;
+  if (!self || !signature_info) return SV_INVALID_PARAMETER;
+  if (self->num_signatures == MAX_SIGNATURES) return SV_NOT_SUPPORTED;
+
+  SignedVideoReturnCode status = openssl_sign_hash(signature_info);
+  if (status != SV_OK) return status;
+
+  uint8_t *signature = malloc(signature_info->signature_size);
+  if (!signature) return SV_MEMORY;
+  memcpy(signature, signature_info->signature, signature_info->signature_size);
+  self->signatures[self->num_signatures] = signature;
+  self->signature_sizes[self->num_signatures++] = signature_info->signature_size;
+
+  return SV_OK;
+}
+
+bool
+sv_interface_get_signature(void *plugin_handle,
+    uint8_t *signature,
+    size_t max_signature_size,
+    size_t *written_signature_size,
+    SignedVideoReturnCode *error)
+{
+  sv_held_plugin_t *self = (sv_held_plugin_t *)plugin_handle;
+  if (!self || !signature || !written_signature_size) return false;
+  if (error) *error = SV_OK;
+
+  if (self->num_signatures >= HELD_SIGNATURES) self->is_releasing = true;
+  if (!self->is_releasing || self->num_signatures == 0) return false;
+
+  // Copy the oldest signature if there is room for it.
+  if (max_signature_size < self->signature_sizes[0]) {
+    *written_signature_size = 0;
+  } else {
+    memcpy(signature, self->signatures[0], self->signature_sizes[0]);
+    *written_signature_size = self->signature_sizes[0];
+  }
+  free(self->signatures[0]);
+  self->num_signatures--;
+  for (size_t i = 0; i < self->num_signatures; i++) {
+    self->signatures[i] = self->signatures[i + 1];
+    self->signature_sizes[i] = self->signature_sizes[i + 1];
+  }
+  self->is_releasing = self->num_signatures > 0;
+
+  return true;
+}
+
+void *
+sv_interface_setup()
+{
+  return calloc(1, sizeof(sv_held_plugin_t));
+}
+
+void
+sv_interface_teardown(void *plugin_handle)
+{
+  sv_held_plugin_t *self = (sv_held_plugin_t *)plugin_handle;
+  if (!self) return;
+
+  for (size_t i = 0; i < self->num_signatures; i++) free(self->signatures[i]);
+  free(self);
+}
+
+uint8_t *
+sv_interface_malloc(size_t data_size)
+{
+  return openssl_malloc(data_size);
+}
+
+void
+sv_interface_free(uint8_t *data)
+{
+  openssl_free(data);
+}